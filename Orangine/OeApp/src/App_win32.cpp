@@ -60,7 +60,9 @@ class App_impl {
 
     auto gltfLoader = std::make_unique<Entity_graph_loader_gltf>(
             _coreManagers->getInstance<IMaterial_manager>(),
-            _coreManagers->getInstance<ITexture_manager>());
+            _coreManagers->getInstance<ITexture_manager>(),
+            _coreManagers->getInstance<IJob_manager>());
+    gltfLoader->setMeshBufferPool(_coreManagers->getInstance<IAsset_manager>().meshBufferPool());
     _coreManagers->getInstance<IScene_graph_manager>().addLoader(std::move(gltfLoader));
   }
  public:
@@ -0,0 +1,219 @@
+#include "benchmarks_main.h"
+
+#include "Animation_manager.h"
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+#include "Time_step_manager.h"
+
+#include <OeCore/Animation_controller_component.h>
+#include <OeCore/Mesh_data.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <random>
+
+using namespace oe;
+using namespace oe::benchmarks;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+namespace {
+using Animation_channel = Animation_controller_component::Animation_channel;
+
+constexpr int g_characterCount = 500;
+constexpr int g_jointCount = 20;
+constexpr int g_keyframeCount = 61;
+constexpr double g_keyframeInterval = 1.0 / 30.0;
+constexpr double g_frameTime = 1.0 / 60.0;
+const std::string g_animationName = "walk";
+
+// The per-channel std::function dispatch that Animation_manager::tick used before samples were batched.
+const std::array<std::function<void(Entity&, const Animation_channel&, uint32_t, uint32_t, double)>, 3>
+    g_lerpHandlers = {
+        [](Entity& entity, const Animation_channel& channel, uint32_t lower, uint32_t upper, double factor) {
+          const auto& values = channel.vector3Keyframes.values;
+          entity.setPosition(SSE::lerp(static_cast<float>(factor), values[lower], values[upper]));
+        },
+        [](Entity& entity, const Animation_channel& channel, uint32_t lower, uint32_t upper, double factor) {
+          const auto& values = channel.rotationKeyframes.values;
+          entity.setRotation(SSE::slerp(static_cast<float>(factor), values[lower], values[upper]));
+        },
+        [](Entity& entity, const Animation_channel& channel, uint32_t lower, uint32_t upper, double factor) {
+          const auto& values = channel.vector3Keyframes.values;
+          entity.setScale(SSE::lerp(static_cast<float>(factor), values[lower], values[upper]));
+        },
+};
+
+std::unique_ptr<Mesh_buffer_accessor> createAccessor(const std::vector<float>& components, size_t elementSize)
+{
+  auto buffer = std::make_shared<Mesh_buffer>(components.size() * sizeof(float));
+  std::memcpy(buffer->data, components.data(), buffer->dataSize);
+  return std::make_unique<Mesh_buffer_accessor>(
+      buffer,
+      static_cast<uint32_t>(components.size() / elementSize),
+      static_cast<uint32_t>(elementSize * sizeof(float)),
+      0);
+}
+
+std::unique_ptr<Animation_channel> createChannel(
+    const std::shared_ptr<Entity>& joint,
+    Animation_type animationType,
+    const std::shared_ptr<std::vector<float>>& keyframeTimes,
+    std::mt19937& random)
+{
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<float> values;
+  for (auto keyframeIdx = 0; keyframeIdx < g_keyframeCount; ++keyframeIdx) {
+    switch (animationType) {
+    case Animation_type::Rotation: {
+      const auto rotation =
+          SSE::Quat::rotation(distribution(random), SSE::normalize(SSE::Vector3(distribution(random), 1.0f, 0.0f)));
+      values.insert(values.end(), {rotation.getX(), rotation.getY(), rotation.getZ(), rotation.getW()});
+      break;
+    }
+    case Animation_type::Scale:
+      values.insert(values.end(), {1.0f, 1.0f + 0.1f * distribution(random), 1.0f});
+      break;
+    default:
+      values.insert(values.end(), {distribution(random), distribution(random), distribution(random)});
+      break;
+    }
+  }
+
+  auto channel = std::make_unique<Animation_channel>();
+  channel->targetNode = joint;
+  channel->animationType = animationType;
+  channel->interpolationType = Animation_interpolation::Linear;
+  channel->valuesPerKeyFrame = 1;
+  channel->keyframeTimes = keyframeTimes;
+  channel->keyframeValues = createAccessor(values, animationType == Animation_type::Rotation ? 4 : 3);
+  return channel;
+}
+
+// Characters with a skeleton of g_jointCount joints, each animated by a linear translation, rotation and scale channel.
+// Every character starts at a different point in the clip. A workerCount of 0 uses all hardware threads.
+struct Crowd {
+  explicit Crowd(uint32_t workerCount = 0)
+      : sceneGraphManager(std::make_shared<Entity_repository>(), jobManager)
+      , animationManager(sceneGraphManager, timeStepManager, jobManager)
+  {
+    jobManager.preInit_setWorkerCount(workerCount);
+    jobManager.initialize();
+    sceneGraphManager.initialize();
+    animationManager.initialize();
+    timeStepManager.progressTime(g_frameTime);
+
+    auto keyframeTimes = std::make_shared<std::vector<float>>();
+    for (auto keyframeIdx = 0; keyframeIdx < g_keyframeCount; ++keyframeIdx) {
+      keyframeTimes->push_back(static_cast<float>(keyframeIdx * g_keyframeInterval));
+    }
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<double> startTimeDistribution(0.0, keyframeTimes->back());
+    for (auto characterIdx = 0; characterIdx < g_characterCount; ++characterIdx) {
+      auto root = sceneGraphManager.instantiate("Character");
+      auto& controller = root->addComponent<Animation_controller_component>();
+
+      auto animation = std::make_unique<Animation_controller_component::Animation>();
+      for (auto jointIdx = 0; jointIdx < g_jointCount; ++jointIdx) {
+        const auto joint = sceneGraphManager.instantiate("Joint", *root);
+        for (const auto animationType : {Animation_type::Translation, Animation_type::Rotation, Animation_type::Scale}) {
+          animation->channels.push_back(createChannel(joint, animationType, keyframeTimes, random));
+        }
+      }
+
+      Animation_controller_component::Animation_state state;
+      state.currentTime = startTimeDistribution(random);
+      controller.activeAnimations[g_animationName].assign(animation->channels.size(), state);
+      controller.addAnimation(g_animationName, std::move(animation));
+
+      controllers.push_back(&controller);
+      characters.push_back(root);
+    }
+  }
+
+  ~Crowd()
+  {
+    controllers.clear();
+    characters.clear();
+    animationManager.shutdown();
+    sceneGraphManager.shutdown();
+    jobManager.shutdown();
+  }
+
+  // Animation_manager::tick, as it was before samples were batched.
+  void tickPerChannel()
+  {
+    for (const auto controller : controllers) {
+      const auto& animation = controller->animationByName(g_animationName);
+      auto& states = controller->activeAnimations[g_animationName];
+      for (size_t channelIdx = 0; channelIdx < animation->channels.size(); ++channelIdx) {
+        const auto& channel = *animation->channels[channelIdx];
+        const auto& keyframeTimes = *channel.keyframeTimes;
+        auto& state = states[channelIdx];
+
+        auto upperIndex = Animation_manager::findNextKeyframe(keyframeTimes, state.currentTime, state.keyframeCursor);
+        state.keyframeCursor = upperIndex;
+        upperIndex = std::clamp<uint32_t>(upperIndex, 1, static_cast<uint32_t>(keyframeTimes.size() - 1));
+        const auto lowerIndex = upperIndex - 1;
+        const auto factor = std::min(
+            1.0,
+            (state.currentTime - keyframeTimes[lowerIndex]) / (keyframeTimes[upperIndex] - keyframeTimes[lowerIndex]));
+
+        const auto& fn = g_lerpHandlers[static_cast<size_t>(channel.animationType)];
+        fn(*channel.targetNode, channel, lowerIndex, upperIndex, factor);
+
+        state.currentTime += g_frameTime;
+        if (state.currentTime > keyframeTimes.back()) {
+          state.currentTime = 0.0;
+        }
+      }
+    }
+  }
+
+  Job_manager jobManager;
+  Time_step_manager timeStepManager;
+  Scene_graph_manager sceneGraphManager;
+  Animation_manager animationManager;
+
+  std::vector<Animation_controller_component*> controllers;
+  std::vector<std::shared_ptr<Entity>> characters;
+};
+} // namespace
+
+OE_BENCHMARK(animation_sampling)
+{
+  Component_factory::initStatics();
+  Animation_controller_component::initStatics();
+  std::printf(
+      "  %d characters, %d joints, %d channels per character, times are per frame\n",
+      g_characterCount,
+      g_jointCount,
+      g_jointCount * 3);
+
+  {
+    Crowd crowd;
+    const auto perChannel = measure("per-channel dispatch", [&]() { crowd.tickPerChannel(); });
+    const auto batched = measure("batched", [&]() { crowd.animationManager.tick(); });
+    std::printf("  speedup: %.2fx\n", perChannel / batched);
+  }
+
+  Component_factory::destroyStatics();
+}
+
+OE_BENCHMARK(animation_parallel)
+{
+  Component_factory::initStatics();
+  Animation_controller_component::initStatics();
+  std::printf("  %d characters, %d channels per character, times are per frame\n", g_characterCount, g_jointCount * 3);
+
+  measureWorkerScaling([](uint32_t workerCount) {
+    Crowd crowd(workerCount);
+    return measure(std::to_string(workerCount) + " worker(s)", [&]() { crowd.animationManager.tick(); });
+  });
+
+  Component_factory::destroyStatics();
+}
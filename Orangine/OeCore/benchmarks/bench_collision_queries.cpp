@@ -0,0 +1,194 @@
+#include "benchmarks_main.h"
+
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <OeCore/Collision.h>
+
+#include <random>
+
+using namespace oe;
+using namespace oe::benchmarks;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+namespace {
+constexpr int g_clusterCount = 1000;
+constexpr int g_entitiesPerCluster = 100;
+constexpr float g_worldExtent = 1000.0f;
+constexpr float g_clusterExtent = 10.0f;
+
+// Creates clusters of small entities scattered through the world, each cluster parented to an entity whose bound
+// sphere is calculated from its children.
+struct Collision_scene {
+  Collision_scene()
+      : entityRepository(std::make_shared<Entity_repository>())
+      , sceneGraphManager(entityRepository, jobManager)
+  {
+    jobManager.initialize();
+    sceneGraphManager.initialize();
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> worldDistribution(-g_worldExtent, g_worldExtent);
+    std::uniform_real_distribution<float> clusterDistribution(-g_clusterExtent, g_clusterExtent);
+    std::uniform_real_distribution<float> radiusDistribution(0.25f, 1.0f);
+
+    for (auto clusterIdx = 0; clusterIdx < g_clusterCount; ++clusterIdx) {
+      auto cluster = sceneGraphManager.instantiate("Cluster");
+      const auto clusterCenter =
+          SSE::Vector3(worldDistribution(random), worldDistribution(random), worldDistribution(random));
+      rootEntities.push_back(cluster);
+
+      for (auto entityIdx = 0; entityIdx < g_entitiesPerCluster; ++entityIdx) {
+        auto entity = sceneGraphManager.instantiate("Entity", *cluster);
+        const auto offset =
+            SSE::Vector3(clusterDistribution(random), clusterDistribution(random), clusterDistribution(random));
+        entity->setBoundSphere(BoundingSphere(clusterCenter + offset, radiusDistribution(random)));
+        allEntities.push_back(entity.get());
+      }
+    }
+
+    sceneGraphManager.tick();
+
+    // Rays start outside the world, aimed at random entities so that most of them hit something.
+    std::uniform_int_distribution<size_t> entityDistribution(0, allEntities.size() - 1);
+    for (auto rayIdx = 0; rayIdx < 256; ++rayIdx) {
+      const auto origin = SSE::Point3(
+          worldDistribution(random), worldDistribution(random), g_worldExtent * 2.0f + worldDistribution(random));
+      const auto target = SSE::Point3(allEntities[entityDistribution(random)]->boundSphere().center);
+      rays.push_back({origin, SSE::normalize(target - origin)});
+
+      querySpheres.push_back(BoundingSphere(
+          SSE::Vector3(worldDistribution(random), worldDistribution(random), worldDistribution(random)), 50.0f));
+    }
+  }
+
+  ~Collision_scene()
+  {
+    sceneGraphManager.shutdown();
+    jobManager.shutdown();
+  }
+
+  Job_manager jobManager;
+  std::shared_ptr<Entity_repository> entityRepository;
+  Scene_graph_manager sceneGraphManager;
+  std::vector<std::shared_ptr<Entity>> rootEntities;
+  std::vector<Entity*> allEntities;
+  std::vector<Ray> rays;
+  std::vector<BoundingSphere> querySpheres;
+};
+
+// The hierarchical walk that findCollidingEntity used before the bounding volume hierarchy was introduced.
+const Entity* findCollidingEntityBruteForce(const std::vector<std::shared_ptr<Entity>>& rootEntities, const Ray& ray)
+{
+  const Entity* foundEntity = nullptr;
+  Ray_intersection foundIntersection = {{}, FLT_MAX};
+
+  std::vector<const Entity*> work;
+  for (const auto& root : rootEntities) {
+    work.push_back(root.get());
+  }
+
+  Ray_intersection intersection;
+  while (!work.empty()) {
+    const auto ent = work.back();
+    work.pop_back();
+
+    if (ent->boundSphere().radius <= 0.0f || !intersect_ray_sphere(ray, ent->boundSphere(), intersection)) {
+      continue;
+    }
+
+    if (intersection.distance >= foundIntersection.distance && foundEntity != ent->parent().get()) {
+      continue;
+    }
+
+    foundIntersection = intersection;
+    foundEntity = ent;
+    for (const auto& child : ent->children()) {
+      work.push_back(child.get());
+    }
+  }
+  return foundEntity;
+}
+
+BoundingFrustumRH createFrustum(const SSE::Vector3& origin, const SSE::Quat& orientation)
+{
+  auto frustum = BoundingFrustumRH(SSE::Matrix4::perspective(0.8f, 16.0f / 9.0f, 0.1f, 500.0f));
+  frustum.origin = origin;
+  frustum.orientation = orientation;
+  return frustum;
+}
+} // namespace
+
+OE_BENCHMARK(collision_queries)
+{
+  Collision_scene scene;
+  auto& sceneGraphManager = scene.sceneGraphManager;
+  std::printf("  %zu entities\n", scene.allEntities.size() + scene.rootEntities.size());
+
+  // Ray picks
+  size_t rayIdx = 0;
+  measure("findCollidingEntity (brute force)", [&]() {
+    const auto& ray = scene.rays[rayIdx++ % scene.rays.size()];
+    doNotOptimize(findCollidingEntityBruteForce(scene.rootEntities, ray));
+  });
+  measure("findCollidingEntity (BVH)", [&]() {
+    const auto& ray = scene.rays[rayIdx++ % scene.rays.size()];
+    const Entity* foundEntity;
+    Ray_intersection foundIntersection;
+    doNotOptimize(sceneGraphManager.findCollidingEntity(ray, foundEntity, foundIntersection, FLT_MAX));
+  });
+
+  // Sphere overlap
+  std::vector<Entity*> foundEntities;
+  size_t sphereIdx = 0;
+  measure("sphere overlap (brute force)", [&]() {
+    const auto& sphere = scene.querySpheres[sphereIdx++ % scene.querySpheres.size()];
+    foundEntities.clear();
+    for (const auto entity : scene.allEntities) {
+      const auto& boundSphere = entity->boundSphere();
+      const auto radius = boundSphere.radius + sphere.radius;
+      if (SSE::lengthSqr(boundSphere.center - sphere.center) <= radius * radius) {
+        foundEntities.push_back(entity);
+      }
+    }
+    doNotOptimize(foundEntities.size());
+  });
+  measure("sphere overlap (BVH)", [&]() {
+    const auto& sphere = scene.querySpheres[sphereIdx++ % scene.querySpheres.size()];
+    foundEntities.clear();
+    sceneGraphManager.findEntitiesIntersectingSphere(sphere, foundEntities);
+    doNotOptimize(foundEntities.size());
+  });
+
+  // Frustum containment, from the center of the world looking down -Z.
+  const auto frustum = createFrustum(SSE::Vector3(0.0f), SSE::Quat::identity());
+  measure("frustum containment (brute force)", [&]() {
+    foundEntities.clear();
+    for (const auto entity : scene.allEntities) {
+      if (frustum.Contains(entity->boundSphere()) != DirectX::DISJOINT) {
+        foundEntities.push_back(entity);
+      }
+    }
+    doNotOptimize(foundEntities.size());
+  });
+  measure("frustum containment (BVH)", [&]() {
+    foundEntities.clear();
+    sceneGraphManager.findEntitiesInFrustum(frustum, foundEntities);
+    doNotOptimize(foundEntities.size());
+  });
+
+  // Moving a fraction of entities each frame, and refitting during tick.
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> moveDistribution(-0.5f, 0.5f);
+  measure("tick, moving 1% of entities", [&]() {
+    for (size_t entityIdx = 0; entityIdx < scene.allEntities.size(); entityIdx += 100) {
+      const auto entity = scene.allEntities[entityIdx];
+      auto boundSphere = entity->boundSphere();
+      boundSphere.center += SSE::Vector3(moveDistribution(random), moveDistribution(random), moveDistribution(random));
+      entity->setBoundSphere(boundSphere);
+    }
+    sceneGraphManager.tick();
+  });
+}
@@ -0,0 +1,135 @@
+#include "benchmarks_main.h"
+
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <OeCore/Component.h>
+
+#include <string>
+#include <utility>
+
+using namespace oe;
+using namespace oe::benchmarks;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+namespace {
+constexpr int g_entityCount = 1000;
+
+// Minimal component types, registered with the Component_factory in the same way DEFINE_COMPONENT_TYPE does.
+template <int TIndex> class Bench_component : public Component {
+ public:
+  explicit Bench_component(Entity& entity) : Component(entity) {}
+
+  static void initStatics() { _typeId = Component_factory::createComponentTypeId(&createInstance); }
+  static Component_type type() { return _typeId; }
+  static std::unique_ptr<Component> createInstance(Entity& entity)
+  {
+    return std::make_unique<Bench_component>(entity);
+  }
+
+  Component_type getType() const override { return _typeId; }
+  std::unique_ptr<Component> clone(Entity& entity) const override { return createInstance(entity); }
+
+ private:
+  static inline Component_type _typeId = 0;
+};
+
+template <int... TIndices> void initBenchComponentStatics(std::integer_sequence<int, TIndices...>)
+{
+  (Bench_component<TIndices>::initStatics(), ...);
+}
+
+template <int... TIndices>
+void addBenchComponents(Entity& entity, int count, std::integer_sequence<int, TIndices...>)
+{
+  ((TIndices < count ? static_cast<void>(entity.addComponent<Bench_component<TIndices>>()) : static_cast<void>(0)),
+   ...);
+}
+
+constexpr auto g_benchComponentIndices = std::make_integer_sequence<int, 16>();
+
+// The dynamic_cast scan that Entity::getFirstComponentOfType used before components were indexed by type.
+template <typename TComponent> TComponent* getFirstComponentOfTypeDynamicCast(const Entity& entity)
+{
+  for (size_t idx = 0; idx < entity.getComponentCount(); ++idx) {
+    const auto component = dynamic_cast<TComponent*>(&entity.getComponent(idx));
+    if (component != nullptr) {
+      return component;
+    }
+  }
+  return nullptr;
+}
+
+struct Component_scene {
+  explicit Component_scene(int componentsPerEntity)
+      : sceneGraphManager(std::make_shared<Entity_repository>(), jobManager)
+  {
+    jobManager.initialize();
+    sceneGraphManager.initialize();
+
+    for (auto entityIdx = 0; entityIdx < g_entityCount; ++entityIdx) {
+      auto entity = sceneGraphManager.instantiate("Entity");
+      addBenchComponents(*entity, componentsPerEntity, g_benchComponentIndices);
+      entities.push_back(entity);
+    }
+  }
+
+  ~Component_scene()
+  {
+    entities.clear();
+    sceneGraphManager.shutdown();
+    jobManager.shutdown();
+  }
+
+  Job_manager jobManager;
+  Scene_graph_manager sceneGraphManager;
+  std::vector<std::shared_ptr<Entity>> entities;
+};
+
+template <typename TComponent> void measureLookup(const Component_scene& scene, const std::string& label)
+{
+  measure(label + " (dynamic_cast)", [&]() {
+    for (const auto& entity : scene.entities) {
+      doNotOptimize(getFirstComponentOfTypeDynamicCast<TComponent>(*entity));
+    }
+  });
+  measure(label + " (type index)", [&]() {
+    for (const auto& entity : scene.entities) {
+      doNotOptimize(entity->getFirstComponentOfType<TComponent>());
+    }
+  });
+}
+} // namespace
+
+OE_BENCHMARK(component_lookup)
+{
+  Component_factory::initStatics();
+  initBenchComponentStatics(g_benchComponentIndices);
+  std::printf("  %d entities, times are per lookup on every entity\n", g_entityCount);
+
+  for (const auto componentCount : {1, 4, 16}) {
+    Component_scene scene(componentCount);
+    const auto prefix = std::to_string(componentCount) + " components: ";
+
+    // The last component added is the worst case for a linear scan.
+    switch (componentCount) {
+    case 1:
+      measureLookup<Bench_component<0>>(scene, prefix + "present");
+      break;
+    case 4:
+      measureLookup<Bench_component<3>>(scene, prefix + "present");
+      break;
+    default:
+      measureLookup<Bench_component<15>>(scene, prefix + "present");
+      break;
+    }
+
+    if (componentCount < 16) {
+      measureLookup<Bench_component<15>>(scene, prefix + "absent");
+    }
+  }
+
+  Component_factory::destroyStatics();
+}
@@ -0,0 +1,219 @@
+#include "benchmarks_main.h"
+
+#include "Job_manager.h"
+
+#include <OeCore/EngineUtils.h>
+#include <OeCore/Entity_graph_loader_gltf.h>
+#include <OeCore/IMaterial_manager.h>
+#include <OeCore/ITexture_manager.h>
+
+#include <Windows.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace oe;
+using namespace oe::benchmarks;
+using oe::internal::Job_manager;
+
+namespace {
+// A CAD-like model: many small meshes, each a single primitive with its own accessors.
+constexpr int g_meshCount = 2000;
+constexpr int g_gridSize = 16;
+
+// A 1x1 PNG, for the normal texture.
+constexpr uint8_t g_png[] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48,
+                             0x44, 0x52, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00,
+                             0x00, 0x1F, 0x15, 0xC4, 0x89, 0x00, 0x00, 0x00, 0x0A, 0x49, 0x44, 0x41, 0x54, 0x78,
+                             0x9C, 0x63, 0x00, 0x01, 0x00, 0x00, 0x05, 0x00, 0x01, 0x0D, 0x0A, 0x2D, 0xB4, 0x00,
+                             0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82};
+
+// prepareFile doesn't use the texture or material managers; the loader just needs something to hold on to.
+class Null_texture_manager final : public ITexture_manager {
+ public:
+  void initialize() override {}
+  void shutdown() override {}
+  const std::string& name() const override { return _name; }
+  void createDeviceDependentResources() override {}
+  void destroyDeviceDependentResources() override {}
+
+  std::shared_ptr<Texture> createTextureFromBuffer(uint32_t, uint32_t, std::unique_ptr<uint8_t>&) override
+  {
+    return nullptr;
+  }
+  std::shared_ptr<Texture> createTextureFromFile(const std::string&) override { return nullptr; }
+  std::shared_ptr<Texture> createTextureFromFile(const std::string&, const Sampler_descriptor&) override
+  {
+    return nullptr;
+  }
+  std::shared_ptr<Texture> createDepthTexture() override { return nullptr; }
+  std::shared_ptr<Texture> createRenderTargetTexture(int, int) override { return nullptr; }
+  std::shared_ptr<Texture> createRenderTargetViewTexture() override { return nullptr; }
+  std::unique_ptr<Shadow_map_texture_pool> createShadowMapTexturePool(uint32_t, uint32_t) override { return nullptr; }
+  void load(Texture&) override {}
+  void unload(Texture&) override {}
+
+ private:
+  std::string _name = "Null_texture_manager";
+};
+
+class Null_material_manager final : public IMaterial_manager {
+ public:
+  const std::string& shaderPath() const override { return _shaderPath; }
+  std::weak_ptr<Material_context> createMaterialContext() override { return {}; }
+  void bind(
+      Material_context&,
+      std::shared_ptr<const Material>,
+      const Mesh_vertex_layout&,
+      const Render_light_data*,
+      Render_pass_blend_mode,
+      bool) override
+  {}
+  void render(const Renderer_data&, const SSE::Matrix4&, const Renderer_animation_data&, const Camera_data&) override
+  {}
+  void unbind() override {}
+  void setRendererFeaturesEnabled(const Renderer_features_enabled& rendererFeaturesEnabled) override
+  {
+    _rendererFeaturesEnabled = rendererFeaturesEnabled;
+  }
+  const Renderer_features_enabled& rendererFeatureEnabled() const override { return _rendererFeaturesEnabled; }
+  void updateLightBuffers() override {}
+
+ private:
+  std::string _shaderPath;
+  Renderer_features_enabled _rendererFeaturesEnabled;
+};
+
+template <class T> void appendBytes(std::string& bin, const std::vector<T>& values)
+{
+  bin.append(reinterpret_cast<const char*>(values.data()), sizeof(T) * values.size());
+  // Keep every buffer view 4 byte aligned.
+  bin.resize((bin.size() + 3) & ~size_t(3));
+}
+
+/**
+ * Writes a .gltf, .bin and .png to the temp directory, and returns the path of the .gltf. Each mesh is a grid with
+ * positions, normals and texture coordinates, and a material with a normal texture, so the loader also generates
+ * tangents for it. Every mesh has its own copy of the grid, so no accessors are shared between primitives.
+ */
+std::string writeGltf()
+{
+  const auto directory = std::filesystem::temp_directory_path() / "oe_bench_gltf_loading";
+  std::filesystem::create_directories(directory);
+
+  std::vector<float> positions, normals, texCoords;
+  for (int y = 0; y < g_gridSize; ++y) {
+    for (int x = 0; x < g_gridSize; ++x) {
+      const auto u = static_cast<float>(x) / (g_gridSize - 1);
+      const auto v = static_cast<float>(y) / (g_gridSize - 1);
+      positions.insert(positions.end(), {u, 0.1f * std::sin(u * 6.0f), v});
+      normals.insert(normals.end(), {0.0f, 1.0f, 0.0f});
+      texCoords.insert(texCoords.end(), {u, v});
+    }
+  }
+  std::vector<uint16_t> indices;
+  for (int y = 0; y + 1 < g_gridSize; ++y) {
+    for (int x = 0; x + 1 < g_gridSize; ++x) {
+      const auto i0 = static_cast<uint16_t>(y * g_gridSize + x);
+      const auto i1 = static_cast<uint16_t>(i0 + 1);
+      const auto i2 = static_cast<uint16_t>(i0 + g_gridSize);
+      const auto i3 = static_cast<uint16_t>(i2 + 1);
+      indices.insert(indices.end(), {i0, i2, i1, i1, i2, i3});
+    }
+  }
+
+  std::string bin;
+  std::ostringstream bufferViews, accessors, meshes, nodes, sceneNodes;
+  for (int meshIdx = 0; meshIdx < g_meshCount; ++meshIdx) {
+    const auto firstView = meshIdx * 4;
+    const struct {
+      const char* type;
+      int componentType;
+      size_t count;
+      int target;
+    } streams[] = {
+        {"VEC3", 5126, positions.size() / 3, 34962},
+        {"VEC3", 5126, normals.size() / 3, 34962},
+        {"VEC2", 5126, texCoords.size() / 2, 34962},
+        {"SCALAR", 5123, indices.size(), 34963},
+    };
+    for (int streamIdx = 0; streamIdx < 4; ++streamIdx) {
+      const auto offset = bin.size();
+      switch (streamIdx) {
+      case 0:
+        appendBytes(bin, positions);
+        break;
+      case 1:
+        appendBytes(bin, normals);
+        break;
+      case 2:
+        appendBytes(bin, texCoords);
+        break;
+      default:
+        appendBytes(bin, indices);
+        break;
+      }
+
+      const auto viewIdx = firstView + streamIdx;
+      const auto& stream = streams[streamIdx];
+      bufferViews << (viewIdx ? "," : "") << R"({"buffer":0,"byteOffset":)" << offset << R"(,"byteLength":)"
+                  << bin.size() - offset << R"(,"target":)" << stream.target << "}";
+      accessors << (viewIdx ? "," : "") << R"({"bufferView":)" << viewIdx << R"(,"componentType":)"
+                << stream.componentType << R"(,"count":)" << stream.count << R"(,"type":")" << stream.type << "\"}";
+    }
+
+    meshes << (meshIdx ? "," : "") << R"({"primitives":[{"attributes":{"POSITION":)" << firstView
+           << R"(,"NORMAL":)" << firstView + 1 << R"(,"TEXCOORD_0":)" << firstView + 2 << R"(},"indices":)"
+           << firstView + 3 << R"(,"material":0}]})";
+    nodes << (meshIdx ? "," : "") << R"({"mesh":)" << meshIdx << R"(,"translation":[)" << meshIdx % 50 << ",0,"
+          << meshIdx / 50 << "]}";
+    sceneNodes << (meshIdx ? "," : "") << meshIdx;
+  }
+
+  std::ofstream(directory / "model.bin", std::ios::binary).write(bin.data(), bin.size());
+  std::ofstream(directory / "normal.png", std::ios::binary)
+      .write(reinterpret_cast<const char*>(g_png), sizeof(g_png));
+
+  const auto gltfPath = directory / "model.gltf";
+  std::ofstream(gltfPath) << R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[)" << sceneNodes.str()
+                          << R"(]}],"nodes":[)" << nodes.str() << R"(],"meshes":[)" << meshes.str()
+                          << R"(],"materials":[{"normalTexture":{"index":0}}],"textures":[{"source":0}],)"
+                          << R"("images":[{"uri":"normal.png"}],"buffers":[{"uri":"model.bin","byteLength":)"
+                          << bin.size() << R"(}],"bufferViews":[)" << bufferViews.str() << R"(],"accessors":[)"
+                          << accessors.str() << "]}";
+  return gltfPath.string();
+}
+} // namespace
+
+OE_BENCHMARK(gltf_loading)
+{
+  // The loader creates a WIC imaging factory.
+  ThrowIfFailed(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+
+  const auto gltfPath = writeGltf();
+  std::printf("  %d meshes of %d vertices, times are per file\n", g_meshCount, g_gridSize * g_gridSize);
+
+  Null_texture_manager textureManager;
+  Null_material_manager materialManager;
+  measureWorkerScaling([&](uint32_t workerCount) {
+    Job_manager jobManager;
+    jobManager.preInit_setWorkerCount(workerCount);
+    jobManager.initialize();
+
+    double seconds;
+    {
+      const Entity_graph_loader_gltf loader(materialManager, textureManager, jobManager);
+      seconds = measure(std::to_string(workerCount) + " worker(s)", [&]() {
+        const auto preparedFile = loader.prepareFile(gltfPath, true);
+        doNotOptimize(preparedFile);
+      });
+    }
+
+    jobManager.shutdown();
+    return seconds;
+  });
+
+  CoUninitialize();
+}
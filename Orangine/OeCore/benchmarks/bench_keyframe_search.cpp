@@ -0,0 +1,103 @@
+#include "benchmarks_main.h"
+
+#include "Animation_manager.h"
+
+#include <random>
+#include <string>
+
+using namespace oe;
+using namespace oe::benchmarks;
+
+namespace {
+constexpr size_t g_channelCount = 200;
+constexpr double g_keyframeInterval = 1.0 / 120.0;
+constexpr double g_frameTime = 1.0 / 60.0;
+
+// The linear scan that Animation_manager::tick used before keyframe cursors were cached.
+uint32_t findNextKeyframeLinear(const std::vector<float>& keyframeTimes, double time)
+{
+  uint32_t maxIndex = 0;
+  for (; maxIndex < keyframeTimes.size(); ++maxIndex) {
+    if (keyframeTimes[maxIndex] > time)
+      break;
+  }
+  return maxIndex;
+}
+
+// Mocap style channels, sampled at 120Hz. Each channel starts at a different point in the clip.
+struct Keyframe_channels {
+  explicit Keyframe_channels(size_t keyframeCount)
+      : keyframeTimes(keyframeCount)
+  {
+    for (size_t idx = 0; idx < keyframeCount; ++idx) {
+      keyframeTimes[idx] = static_cast<float>(idx * g_keyframeInterval);
+    }
+    duration = keyframeTimes.back();
+
+    std::mt19937 random(static_cast<uint32_t>(keyframeCount));
+    std::uniform_real_distribution<double> timeDistribution(0.0, duration);
+    for (size_t idx = 0; idx < g_channelCount; ++idx) {
+      times.push_back(timeDistribution(random));
+      cursors.push_back(0);
+    }
+  }
+
+  void advance(double deltaTime)
+  {
+    for (auto& time : times) {
+      time += deltaTime;
+      if (time > duration) {
+        time = 0.0;
+      }
+    }
+  }
+
+  std::vector<float> keyframeTimes;
+  double duration;
+  std::vector<double> times;
+  std::vector<uint32_t> cursors;
+};
+
+void printPerChannel(double secondsPerFrame)
+{
+  std::printf("  %-48s %12.3f ns\n", "  per channel", secondsPerFrame * 1e9 / g_channelCount);
+}
+} // namespace
+
+OE_BENCHMARK(keyframe_search)
+{
+  std::printf("  %zu channels, times are per frame\n", g_channelCount);
+
+  for (const auto keyframeCount : {100, 1000, 10000}) {
+    Keyframe_channels channels(keyframeCount);
+    const auto prefix = std::to_string(keyframeCount) + " keyframes: ";
+
+    printPerChannel(measure(prefix + "linear scan", [&]() {
+      channels.advance(g_frameTime);
+      for (const auto time : channels.times) {
+        doNotOptimize(findNextKeyframeLinear(channels.keyframeTimes, time));
+      }
+    }));
+
+    printPerChannel(measure(prefix + "cursor, forward playback", [&]() {
+      channels.advance(g_frameTime);
+      for (size_t idx = 0; idx < g_channelCount; ++idx) {
+        channels.cursors[idx] =
+            Animation_manager::findNextKeyframe(channels.keyframeTimes, channels.times[idx], channels.cursors[idx]);
+      }
+      doNotOptimize(channels.cursors.data());
+    }));
+
+    // Every channel seeks to a random time each frame, so the cursor never helps.
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> timeDistribution(0.0, channels.duration);
+    printPerChannel(measure(prefix + "cursor, random seeks", [&]() {
+      for (size_t idx = 0; idx < g_channelCount; ++idx) {
+        channels.times[idx] = timeDistribution(random);
+        channels.cursors[idx] =
+            Animation_manager::findNextKeyframe(channels.keyframeTimes, channels.times[idx], channels.cursors[idx]);
+      }
+      doNotOptimize(channels.cursors.data());
+    }));
+  }
+}
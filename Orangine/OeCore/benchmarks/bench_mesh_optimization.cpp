@@ -0,0 +1,112 @@
+#include "benchmarks_main.h"
+
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Mesh_optimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace oe;
+using namespace oe::benchmarks;
+
+namespace {
+// A scanned-terrain sized mesh, with its triangles in random order, as exporters that don't optimize often leave them.
+constexpr uint32_t g_gridSize = 512;
+constexpr uint32_t g_cacheSize = 16;
+
+void createShuffledTerrain(std::vector<SSE::Vector3>& positions, std::vector<uint32_t>& indices)
+{
+  for (uint32_t z = 0; z < g_gridSize; ++z) {
+    for (uint32_t x = 0; x < g_gridSize; ++x) {
+      const auto u = static_cast<float>(x) / g_gridSize;
+      const auto v = static_cast<float>(z) / g_gridSize;
+      positions.emplace_back(u, 0.1f * std::sin(u * 20.0f) * std::cos(v * 15.0f), v);
+    }
+  }
+
+  std::vector<std::array<uint32_t, 3>> triangles;
+  for (uint32_t z = 0; z + 1 < g_gridSize; ++z) {
+    for (uint32_t x = 0; x + 1 < g_gridSize; ++x) {
+      const auto i0 = z * g_gridSize + x;
+      triangles.push_back({i0, i0 + g_gridSize, i0 + 1});
+      triangles.push_back({i0 + 1, i0 + g_gridSize, i0 + g_gridSize + 1});
+    }
+  }
+  std::mt19937 random(1234);
+  std::shuffle(triangles.begin(), triangles.end(), random);
+  for (const auto& triangle : triangles) {
+    indices.insert(indices.end(), triangle.begin(), triangle.end());
+  }
+}
+
+std::shared_ptr<Mesh_data> createMeshData(
+    const std::vector<SSE::Vector3>& positions,
+    const std::vector<uint32_t>& indices)
+{
+  auto positionBuffer = std::make_shared<Mesh_buffer>(positions.size() * sizeof(float) * 3);
+  for (size_t idx = 0; idx < positions.size(); ++idx) {
+    const float value[3] = {positions[idx].getX(), positions[idx].getY(), positions[idx].getZ()};
+    std::memcpy(positionBuffer->data + idx * sizeof(value), value, sizeof(value));
+  }
+  auto indexBuffer = std::make_shared<Mesh_buffer>(indices.size() * sizeof(uint32_t));
+  std::memcpy(indexBuffer->data, indices.data(), indexBuffer->dataSize);
+
+  auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  meshData->vertexBufferAccessors[{Vertex_attribute::Position, 0}] = std::make_unique<Mesh_vertex_buffer_accessor>(
+      positionBuffer,
+      Vertex_attribute_element{{Vertex_attribute::Position, 0}, Element_type::Vector3, Element_component::Float},
+      static_cast<uint32_t>(positions.size()),
+      static_cast<uint32_t>(sizeof(float) * 3),
+      0);
+  meshData->indexBufferAccessor = std::make_unique<Mesh_index_buffer_accessor>(
+      indexBuffer,
+      Element_component::Unsigned_int,
+      static_cast<uint32_t>(indices.size()),
+      static_cast<uint32_t>(sizeof(uint32_t)),
+      0);
+  return meshData;
+}
+
+void printReport(const char* label, const Mesh_optimizer_report& report)
+{
+  std::printf(
+      "  %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+      label,
+      report.before.acmr,
+      report.after.acmr,
+      report.before.atvr,
+      report.after.atvr);
+}
+} // namespace
+
+OE_BENCHMARK(mesh_optimization)
+{
+  std::vector<SSE::Vector3> positions;
+  std::vector<uint32_t> indices;
+  createShuffledTerrain(positions, indices);
+  std::printf(
+      "  %zu vertices, %zu triangles, %u entry FIFO cache\n", positions.size(), indices.size() / 3, g_cacheSize);
+
+  std::vector<uint32_t> clusterStarts;
+  const auto vertexCacheOrder =
+      Mesh_optimizer::optimizeVertexCache(indices, positions.size(), g_cacheSize, &clusterStarts);
+  measure("vertex cache (Tipsify)", [&]() {
+    doNotOptimize(Mesh_optimizer::optimizeVertexCache(indices, positions.size(), g_cacheSize));
+  });
+  measure("overdraw", [&]() {
+    doNotOptimize(Mesh_optimizer::optimizeOverdraw(vertexCacheOrder, positions, clusterStarts, g_cacheSize, 1.05f));
+  });
+  measure("vertex fetch", [&]() {
+    doNotOptimize(Mesh_optimizer::optimizeVertexFetch(vertexCacheOrder, positions.size()));
+  });
+
+  printReport("vertex cache", Mesh_optimizer::optimize(*createMeshData(positions, indices), {}));
+  Mesh_optimizer_options overdrawOptions;
+  overdrawOptions.optimizeOverdraw = true;
+  printReport(
+      "vertex cache + overdraw", Mesh_optimizer::optimize(*createMeshData(positions, indices), overdrawOptions));
+}
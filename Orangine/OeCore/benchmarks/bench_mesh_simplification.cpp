@@ -0,0 +1,91 @@
+#include "benchmarks_main.h"
+
+#include "Job_manager.h"
+
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Mesh_data_component.h>
+#include <OeCore/Mesh_simplifier.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace oe;
+using namespace oe::benchmarks;
+using oe::internal::Job_manager;
+
+namespace {
+// A scene's worth of terrain tiles, each simplified on its own.
+constexpr int g_meshCount = 16;
+constexpr uint32_t g_gridSize = 128;
+
+std::shared_ptr<Mesh_data> createTerrain(int seed)
+{
+  std::vector<float> positions;
+  for (uint32_t z = 0; z < g_gridSize; ++z) {
+    for (uint32_t x = 0; x < g_gridSize; ++x) {
+      const auto u = static_cast<float>(x) / g_gridSize;
+      const auto v = static_cast<float>(z) / g_gridSize;
+      positions.insert(positions.end(), {u, 0.1f * std::sin(u * (10.0f + seed)) * std::cos(v * 15.0f), v});
+    }
+  }
+  std::vector<uint32_t> indices;
+  for (uint32_t z = 0; z + 1 < g_gridSize; ++z) {
+    for (uint32_t x = 0; x + 1 < g_gridSize; ++x) {
+      const auto i0 = z * g_gridSize + x;
+      indices.insert(indices.end(), {i0, i0 + g_gridSize, i0 + 1, i0 + 1, i0 + g_gridSize, i0 + g_gridSize + 1});
+    }
+  }
+
+  auto positionBuffer = std::make_shared<Mesh_buffer>(positions.size() * sizeof(float));
+  std::memcpy(positionBuffer->data, positions.data(), positionBuffer->dataSize);
+  auto indexBuffer = std::make_shared<Mesh_buffer>(indices.size() * sizeof(uint32_t));
+  std::memcpy(indexBuffer->data, indices.data(), indexBuffer->dataSize);
+
+  auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  meshData->vertexBufferAccessors[{Vertex_attribute::Position, 0}] = std::make_unique<Mesh_vertex_buffer_accessor>(
+      positionBuffer,
+      Vertex_attribute_element{{Vertex_attribute::Position, 0}, Element_type::Vector3, Element_component::Float},
+      static_cast<uint32_t>(positions.size() / 3),
+      static_cast<uint32_t>(sizeof(float) * 3),
+      0);
+  meshData->indexBufferAccessor = std::make_unique<Mesh_index_buffer_accessor>(
+      indexBuffer,
+      Element_component::Unsigned_int,
+      static_cast<uint32_t>(indices.size()),
+      static_cast<uint32_t>(sizeof(uint32_t)),
+      0);
+  return meshData;
+}
+} // namespace
+
+OE_BENCHMARK(mesh_simplification)
+{
+  std::vector<std::shared_ptr<Mesh_data>> meshes;
+  for (int idx = 0; idx < g_meshCount; ++idx) {
+    meshes.push_back(createTerrain(idx));
+  }
+  const Mesh_simplifier_options options;
+  std::printf(
+      "  %d meshes of %u triangles, %zu levels each\n",
+      g_meshCount,
+      meshes.front()->indexBufferAccessor->count / 3,
+      options.lodCount);
+
+  for (const auto& lod : Mesh_simplifier::generateLods(*meshes.front(), options)) {
+    std::printf("  level: %u triangles, error %.5f\n", lod.meshData->indexBufferAccessor->count / 3, lod.error);
+  }
+
+  measureWorkerScaling([&](uint32_t workerCount) {
+    Job_manager jobManager;
+    jobManager.preInit_setWorkerCount(workerCount);
+    jobManager.initialize();
+
+    const auto seconds = measure(std::to_string(workerCount) + " worker(s)", [&]() {
+      doNotOptimize(Mesh_simplifier::generateLods(meshes, options, jobManager));
+    });
+
+    jobManager.shutdown();
+    return seconds;
+  });
+}
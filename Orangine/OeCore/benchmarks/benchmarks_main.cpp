@@ -0,0 +1,77 @@
+#include "benchmarks_main.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace oe::benchmarks;
+
+namespace {
+struct Benchmark {
+  const char* name;
+  void (*fn)();
+};
+
+std::vector<Benchmark>& registeredBenchmarks()
+{
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+} // namespace
+
+Benchmark_registration::Benchmark_registration(const char* name, void (*fn)())
+{
+  registeredBenchmarks().push_back({name, fn});
+}
+
+double oe::benchmarks::measure(const std::string& label, const std::function<void()>& fn, double minSeconds)
+{
+  fn();
+
+  uint64_t iterations = 0;
+  auto timer = oe::Perf_timer::start();
+  do {
+    fn();
+    ++iterations;
+    timer.stop();
+  } while (timer.elapsedSeconds() < minSeconds);
+
+  const auto secondsPerIteration = timer.elapsedSeconds() / static_cast<double>(iterations);
+  std::printf("  %-48s %12.3f us  (%llu iterations)\n", label.c_str(), secondsPerIteration * 1e6,
+              static_cast<unsigned long long>(iterations));
+  return secondsPerIteration;
+}
+
+void oe::benchmarks::measureWorkerScaling(const std::function<double(uint32_t workerCount)>& run)
+{
+  const auto maxWorkerCount = std::max(1u, std::thread::hardware_concurrency());
+  double singleWorker = 0.0;
+  // Double the worker count each run, finishing with all hardware threads.
+  for (auto workerCount = 1u; workerCount <= maxWorkerCount;
+       workerCount = workerCount < maxWorkerCount ? std::min(workerCount * 2, maxWorkerCount) : workerCount + 1) {
+    const auto seconds = run(workerCount);
+    if (workerCount == 1) {
+      singleWorker = seconds;
+    } else {
+      std::printf("  speedup: %.2fx\n", singleWorker / seconds);
+    }
+  }
+}
+
+// Usage: OeCoreBenchmarks [name filter]
+// Runs every benchmark whose name contains the filter string.
+int main(int argc, char* argv[])
+{
+  const std::string filter = argc > 1 ? argv[1] : "";
+  for (const auto& benchmark : registeredBenchmarks()) {
+    if (std::string(benchmark.name).find(filter) == std::string::npos) {
+      continue;
+    }
+
+    std::printf("%s\n", benchmark.name);
+    benchmark.fn();
+  }
+
+  return 0;
+}
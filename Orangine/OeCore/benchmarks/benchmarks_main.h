@@ -0,0 +1,39 @@
+#pragma once
+
+#include <OeCore/Perf_timer.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace oe::benchmarks {
+
+// Registers a benchmark function at static initialization time. Use the OE_BENCHMARK macro.
+struct Benchmark_registration {
+  Benchmark_registration(const char* name, void (*fn)());
+};
+
+/**
+ * Runs fn repeatedly until at least minSeconds have elapsed (after a single warm-up call), then prints the mean time
+ * per call. Returns the mean time per call, in seconds.
+ */
+double measure(const std::string& label, const std::function<void()>& fn, double minSeconds = 0.5);
+
+/**
+ * Calls run with 1, 2, 4... workers, finishing with all hardware threads. Each call returns the time it measured with
+ * that many workers (usually from measure); the speedup over a single worker is printed after it.
+ */
+void measureWorkerScaling(const std::function<double(uint32_t workerCount)>& run);
+
+// Prevents the compiler from optimizing away a computed value.
+template <typename T> void doNotOptimize(const T& value)
+{
+  static volatile const void* g_sink;
+  g_sink = &value;
+}
+} // namespace oe::benchmarks
+
+#define OE_BENCHMARK(name)                                                                                             \
+  static void name();                                                                                                  \
+  static const oe::benchmarks::Benchmark_registration g_##name##_registration(#name, &name);                          \
+  static void name()
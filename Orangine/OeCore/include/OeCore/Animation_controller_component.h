@@ -9,6 +9,19 @@ class Animation_controller_component : public Component {
   DECLARE_COMPONENT_TYPE;
 
  public:
+  /**
+   * Keyframe values of a channel, decoded into the type that is applied to the target. For cubic spline channels the
+   * tangents are split out, and pre-multiplied by the duration of the keyframe interval that each applies to.
+   */
+  template <class TValue> struct Keyframe_values {
+    std::vector<TValue> values;
+
+    // Cubic spline channels only. inTangents[k] applies to the interval ending at keyframe k, outTangents[k] to the
+    // interval starting at keyframe k.
+    std::vector<TValue> inTangents;
+    std::vector<TValue> outTangents;
+  };
+
   struct Animation_channel {
     std::shared_ptr<Entity> targetNode;
     Animation_type animationType;
@@ -16,23 +29,78 @@ class Animation_controller_component : public Component {
     uint8_t valuesPerKeyFrame;
 
     std::shared_ptr<std::vector<float>> keyframeTimes;
+
+    // Keyframe values as they were loaded. These are decoded into the arrays below by addAnimation; afterwards they
+    // are only kept for debugging.
     std::unique_ptr<Mesh_buffer_accessor> keyframeValues;
+    // Rotation and morph weight keyframe values may be normalized integers.
+    Element_component keyframeValueComponent = Element_component::Float;
+
+    // Decoded keyframe values. Only the member matching animationType is populated.
+    Keyframe_values<SSE::Vector3> vector3Keyframes; // Translation and Scale
+    Keyframe_values<SSE::Quat> rotationKeyframes;
+    Keyframe_values<float> morphWeightKeyframes; // morphTargetCount weights per keyframe
+    uint8_t morphTargetCount = 0;
   };
 
   struct Animation_state {
     bool playing = true;
     double currentTime = 0.0f;
     double speed = 1.0f;
+
+    // Index of the first keyframe after currentTime, as of the last tick. Playback usually moves forward by less than a
+    // keyframe per tick, so the next search can start from here.
+    uint32_t keyframeCursor = 0;
   };
 
   struct Animation {
     std::vector<std::unique_ptr<Animation_channel>> channels;
   };
 
+  enum class Blend_mode {
+    // Replaces the result of lower layers, in proportion to weight.
+    Override,
+    // Adds the animation's difference from its first keyframe to the result of the layer's override animations.
+    Additive,
+  };
+
+  /**
+   * How an active animation contributes to the pose of the entities it animates. Layers are blended from the lowest
+   * up; within a layer, override animations that target the same property are averaged by weight.
+   */
+  struct Animation_blend {
+    uint8_t layer = 0;
+    Blend_mode mode = Blend_mode::Override;
+    float weight = 1.0f;
+
+    // While fading, weight moves toward targetWeight at fadeRate per second.
+    float targetWeight = 1.0f;
+    float fadeRate = 0.0f;
+  };
+
+  // How often Animation_manager samples this controller, based on its distance from the camera. By default, every
+  // frame; set reducedRateInterval or pauseWhenCulled to throttle it.
+  struct Update_policy {
+    // Beyond this distance from the camera, animations are sampled every reducedRateInterval frames. Frames in between
+    // interpolate between the last two samples. An interval of 1 samples every frame at any distance.
+    float fullRateDistance = 25.0f;
+    uint32_t reducedRateInterval = 1;
+
+    // Stop sampling while the entity is outside the camera frustum. Playback time still advances.
+    bool pauseWhenCulled = false;
+    // Minimum radius of the sphere around the entity that is tested against the frustum, for when the entity's own
+    // bounds don't cover everything it animates.
+    float minCullRadius = 2.0f;
+  };
+
   explicit Animation_controller_component(Entity& entity) : Component(entity) {}
 
+  // Validates the animation's channels and decodes their keyframe values.
   void addAnimation(const std::string& animationName, std::unique_ptr<Animation> animation);
 
+  // Populates the decoded keyframe values of the channel from its keyframeValues accessor.
+  static void decodeKeyframeValues(Animation_channel& channel);
+
   // A map of animation name -> Animation
   const std::map<std::string, std::unique_ptr<Animation>>& animations() const {
     return _nameToAnimation;
@@ -42,6 +110,21 @@ class Animation_controller_component : public Component {
   }
 
   const std::unique_ptr<Animation>& animationByName(const std::string& animationName);
+
+  // Makes the animation active, if it isn't already, playing from the start.
+  void playAnimation(const std::string& animationName);
+
+  // Fades the animation's weight to targetWeight over the given number of seconds.
+  void fadeAnimation(const std::string& animationName, float targetWeight, double duration);
+
+  /**
+   * Plays the animation, fading it in while every other active animation on the same layer fades out, over the given
+   * number of seconds.
+   */
+  void crossFade(const std::string& animationName, double duration);
+
+  // Returns the blend settings of an animation, creating default settings if it has none.
+  Animation_blend& animationBlend(const std::string& animationName) { return animationBlends[animationName]; }
   
   // Serializable Properties.
   BEGIN_COMPONENT_PROPERTIES();
@@ -50,6 +133,13 @@ class Animation_controller_component : public Component {
   // A map of animation names to vector of channel states.
   std::map<std::string, std::vector<Animation_state>> activeAnimations;
 
+  // Blend settings of active animations. Animations without an entry play on layer 0, overriding, at full weight.
+  std::map<std::string, Animation_blend> animationBlends;
+
+  Update_policy updatePolicy;
+  // Time that has passed since the animations were last advanced, while updates are throttled or paused.
+  double pendingTime = 0.0;
+
  private:
   std::map<std::string, std::unique_ptr<Animation>> _nameToAnimation;
 };
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <OeCore/Collision.h>
+
+#include "vectormath.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace oe {
+class Entity;
+
+/**
+ * A dynamic bounding volume hierarchy (AABB tree) over entity bound spheres.
+ *
+ * Each proxy is stored in a leaf with an axis aligned box that is slightly larger than its bound sphere, so small
+ * movements do not require the tree to be modified. When a proxy moves outside of its box, it is removed and
+ * re-inserted. Insertion chooses the sibling that least increases the total surface area of the tree, and the tree is
+ * kept balanced with rotations, so queries visit O(log n) nodes.
+ */
+class Bounding_volume_hierarchy {
+ public:
+  static constexpr uint32_t invalid_proxy = std::numeric_limits<uint32_t>::max();
+
+  struct Aabb {
+    SSE::Vector3 min;
+    SSE::Vector3 max;
+
+    static Aabb createFromSphere(const BoundingSphere& sphere, float margin)
+    {
+      const auto extent = SSE::Vector3(sphere.radius + margin);
+      return {sphere.center - extent, sphere.center + extent};
+    }
+    static Aabb createMerged(const Aabb& a, const Aabb& b)
+    {
+      return {SSE::minPerElem(a.min, b.min), SSE::maxPerElem(a.max, b.max)};
+    }
+
+    float surfaceArea() const
+    {
+      const auto d = max - min;
+      return 2.0f * (d.getX() * d.getY() + d.getY() * d.getZ() + d.getZ() * d.getX());
+    }
+    bool contains(const Aabb& other) const
+    {
+      return SSE::minElem(other.min - min) >= 0.0f && SSE::minElem(max - other.max) >= 0.0f;
+    }
+    bool overlaps(const BoundingSphere& sphere) const
+    {
+      const auto closest = SSE::minPerElem(SSE::maxPerElem(sphere.center, min), max);
+      return SSE::lengthSqr(closest - sphere.center) <= sphere.radius * sphere.radius;
+    }
+    // Returns the distance along the ray to the box, or a negative value if the ray misses.
+    float intersect(const Ray& ray, const SSE::Vector3& inverseDirection, float maxDistance) const;
+  };
+
+  // Absolute amount that leaf boxes are enlarged by, in addition to the entity bound sphere.
+  explicit Bounding_volume_hierarchy(float margin = 0.1f);
+
+  uint32_t createProxy(const BoundingSphere& sphere, Entity* entity);
+  void destroyProxy(uint32_t proxyId);
+
+  /**
+   * Updates the bound sphere of a proxy. Returns true if the proxy was re-inserted, or false if it is still enclosed
+   * by its existing box.
+   */
+  bool moveProxy(uint32_t proxyId, const BoundingSphere& sphere);
+
+  void clear();
+
+  size_t proxyCount() const { return _proxyCount; }
+  Entity* proxyEntity(uint32_t proxyId) const { return _nodes[proxyId].entity; }
+
+  // Height of the tree; zero if it is empty or contains a single proxy.
+  int32_t height() const { return _root == invalid_proxy ? 0 : _nodes[_root].height; }
+
+  /**
+   * Calls callback(Entity*) for every proxy whose box is hit by the ray closer than maxDistance. The callback returns
+   * a new maximum distance, allowing the search to be clipped once a hit is found.
+   */
+  template <typename TCallback> void queryRay(const Ray& ray, float maxDistance, TCallback&& callback) const;
+
+  // Calls callback(Entity*) for every proxy whose box overlaps the given sphere.
+  template <typename TCallback> void querySphere(const BoundingSphere& sphere, TCallback&& callback) const;
+
+  /**
+   * Calls callback(Entity*, bool contained) for every proxy whose box might intersect the frustum. Contained is true if
+   * the box is known to be entirely within the frustum.
+   */
+  template <typename TCallback> void queryFrustum(const BoundingFrustumRH& frustum, TCallback&& callback) const;
+
+ private:
+  struct Node {
+    Aabb box;
+    // For leaves, the owning entity. Null for internal nodes.
+    Entity* entity = nullptr;
+    // Next free node, while this node is in the free list.
+    uint32_t parent = invalid_proxy;
+    uint32_t child1 = invalid_proxy;
+    uint32_t child2 = invalid_proxy;
+    // Leaves have height 0; free nodes have height -1.
+    int32_t height = -1;
+
+    bool isLeaf() const { return child1 == invalid_proxy; }
+  };
+
+  uint32_t allocateNode();
+  void freeNode(uint32_t nodeId);
+  void insertLeaf(uint32_t leafId);
+  void removeLeaf(uint32_t leafId);
+
+  // Performs a left or right rotation if the subtree rooted at nodeId is imbalanced. Returns the new subtree root.
+  uint32_t balance(uint32_t nodeId);
+
+  template <typename TCallback> void visitLeaves(uint32_t nodeId, TCallback&& callback) const;
+
+  // Node ids still to be visited by a query. Each query has its own, so that queries may run concurrently. The tree is
+  // balanced, so this rarely exceeds its fixed capacity; if it does, the rest go on the heap.
+  class Traversal_stack {
+   public:
+    bool empty() const { return _size == 0; }
+    void push(uint32_t nodeId)
+    {
+      if (_size < _nodeIds.size()) {
+        _nodeIds[_size] = nodeId;
+      } else {
+        _overflow.push_back(nodeId);
+      }
+      ++_size;
+    }
+    uint32_t pop()
+    {
+      --_size;
+      if (_size < _nodeIds.size()) {
+        return _nodeIds[_size];
+      }
+      const auto nodeId = _overflow.back();
+      _overflow.pop_back();
+      return nodeId;
+    }
+
+   private:
+    std::array<uint32_t, 64> _nodeIds;
+    size_t _size = 0;
+    std::vector<uint32_t> _overflow;
+  };
+
+  float _margin;
+  uint32_t _root = invalid_proxy;
+  uint32_t _freeList = invalid_proxy;
+  size_t _proxyCount = 0;
+  std::vector<Node> _nodes;
+};
+
+template <typename TCallback>
+void Bounding_volume_hierarchy::queryRay(const Ray& ray, float maxDistance, TCallback&& callback) const
+{
+  if (_root == invalid_proxy) {
+    return;
+  }
+
+  const auto inverseDirection = SSE::divPerElem(SSE::Vector3(1.0f), ray.directionNormal);
+  Traversal_stack stack;
+  stack.push(_root);
+  while (!stack.empty()) {
+    const auto& node = _nodes[stack.pop()];
+
+    if (node.box.intersect(ray, inverseDirection, maxDistance) < 0.0f) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      maxDistance = callback(node.entity);
+    } else {
+      stack.push(node.child1);
+      stack.push(node.child2);
+    }
+  }
+}
+
+template <typename TCallback>
+void Bounding_volume_hierarchy::querySphere(const BoundingSphere& sphere, TCallback&& callback) const
+{
+  if (_root == invalid_proxy) {
+    return;
+  }
+
+  Traversal_stack stack;
+  stack.push(_root);
+  while (!stack.empty()) {
+    const auto& node = _nodes[stack.pop()];
+
+    if (!node.box.overlaps(sphere)) {
+      continue;
+    }
+
+    if (node.isLeaf()) {
+      callback(node.entity);
+    } else {
+      stack.push(node.child1);
+      stack.push(node.child2);
+    }
+  }
+}
+
+template <typename TCallback>
+void Bounding_volume_hierarchy::queryFrustum(const BoundingFrustumRH& frustum, TCallback&& callback) const
+{
+  if (_root == invalid_proxy) {
+    return;
+  }
+
+  Traversal_stack stack;
+  stack.push(_root);
+  while (!stack.empty()) {
+    const auto nodeId = stack.pop();
+    const auto& node = _nodes[nodeId];
+
+    // The frustum can only be tested against spheres; use the sphere that encloses this node's box.
+    const auto halfExtents = (node.box.max - node.box.min) * 0.5f;
+    const auto nodeSphere = BoundingSphere(node.box.min + halfExtents, SSE::length(halfExtents));
+    const auto containment = frustum.Contains(nodeSphere);
+    if (containment == DirectX::DISJOINT) {
+      continue;
+    }
+
+    if (containment == DirectX::CONTAINS) {
+      visitLeaves(nodeId, [&callback](Entity* entity) { callback(entity, true); });
+    } else if (node.isLeaf()) {
+      callback(node.entity, false);
+    } else {
+      stack.push(node.child1);
+      stack.push(node.child2);
+    }
+  }
+}
+
+template <typename TCallback> void Bounding_volume_hierarchy::visitLeaves(uint32_t nodeId, TCallback&& callback) const
+{
+  const auto& node = _nodes[nodeId];
+  if (node.isLeaf()) {
+    callback(node.entity);
+    return;
+  }
+  visitLeaves(node.child1, callback);
+  visitLeaves(node.child2, callback);
+}
+} // namespace oe
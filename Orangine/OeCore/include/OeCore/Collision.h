@@ -122,6 +122,10 @@ struct Ray_intersection {
 bool intersect_ray_sphere(const Ray& ray, const BoundingSphere& sphere,
                           Ray_intersection& intersection);
 bool test_ray_sphere(const Ray& ray, const BoundingSphere& sphere);
+
+// Ref: Fast, minimum storage ray-triangle intersection, Moller & Trumbore. Both faces of the triangle are hit.
+bool intersect_ray_triangle(const Ray& ray, const SSE::Vector3& v0, const SSE::Vector3& v1, const SSE::Vector3& v2,
+                            Ray_intersection& intersection);
 } // namespace oe
 
 #include "Collision.inl"
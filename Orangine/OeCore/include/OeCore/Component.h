@@ -1,6 +1,8 @@
 // ReSharper disable CppClangTidyCppcoreguidelinesMacroUsage
 #pragma once
 
+#include <OeCore/Component_pool.h>
+
 #include <functional>
 
 namespace oe {
@@ -38,13 +40,22 @@ class Component_factory {
   static void initStatics();
   static void destroyStatics();
 
-  /** Registers a component type, returning the TypeId it should use. */
-  static Component_type createComponentTypeId(std::unique_ptr<oe::Component>(*createInstance)(Entity&));
+  /**
+   * Registers a component type, returning the TypeId it should use. The pool, if given, is where instances of the
+   * type are stored.
+   */
+  static Component_type createComponentTypeId(
+      std::unique_ptr<oe::Component>(*createInstance)(Entity&),
+      Component_pool* pool = nullptr);
 
   static std::unique_ptr<oe::Component> createComponent(Component_type typeId, Entity& entity);
 
+  // Returns nullptr if the type doesn't store its instances in a Component_pool.
+  static Component_pool* componentPool(Component_type typeId);
+
  private:
   static std::vector<std::unique_ptr<oe::Component>(*)(Entity&)> _factories;
+  static std::vector<Component_pool*> _pools;
   static Component_type _maxComponentId;
   static bool _staticsInitialized;
 };
@@ -59,13 +70,34 @@ class Component_factory {
   template<typename TClass> static std::unique_ptr<TClass> createInstanceTyped(oe::Entity& entity);\
   static Component_type type();                                        \
   std::unique_ptr<Component> clone(oe::Entity& entity) const override; \
+  static Component_pool& componentPool();                              \
+  static void* operator new(size_t size);                              \
+  static void operator delete(void* ptr, size_t size);                 \
                                                                        \
  private:                                                              \
   static Component::Component_type _typeId;
 
 #define DEFINE_COMPONENT_TYPE(classname)                                             \
   void classname::initStatics() {                                                    \
-    _typeId = Component_factory::createComponentTypeId(&classname::createInstance);  \
+    _typeId = Component_factory::createComponentTypeId(&classname::createInstance, &componentPool()); \
+  }                                                                                  \
+  Component_pool& classname::componentPool() {                                       \
+    /* Never destroyed, so components that outlive static destruction can be freed. */ \
+    static auto* const pool = new Component_pool(sizeof(classname), alignof(classname), [](void* ptr) { \
+      return static_cast<Component*>(static_cast<classname*>(ptr));                 \
+    });                                                                              \
+    return *pool;                                                                    \
+  }                                                                                  \
+  /* Derived classes that don't declare their own type are a different size; they use the heap. */ \
+  void* classname::operator new(size_t size) {                                       \
+    return size == sizeof(classname) ? componentPool().allocate() : ::operator new(size); \
+  }                                                                                  \
+  void classname::operator delete(void* ptr, size_t size) {                          \
+    if (size == sizeof(classname)) {                                                 \
+      componentPool().deallocate(ptr);                                               \
+    } else {                                                                         \
+      ::operator delete(ptr);                                                        \
+    }                                                                                \
   }                                                                                  \
   void classname::destroyStatics() { }                                               \
   classname::Component_type classname::_typeId = 0;                                  \
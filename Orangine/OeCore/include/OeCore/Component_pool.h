@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace oe {
+class Component;
+
+/**
+ * Contiguous view of components of a single type, all stored in one chunk of a Component_pool.
+ */
+template <typename TComponent> class Component_span {
+ public:
+  Component_span(TComponent* data, size_t size) : _data(data), _size(size) {}
+
+  TComponent* begin() const { return _data; }
+  TComponent* end() const { return _data + _size; }
+  TComponent& operator[](size_t index) const { return _data[index]; }
+  TComponent* data() const { return _data; }
+  size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+
+ private:
+  TComponent* _data;
+  size_t _size;
+};
+
+/**
+ * Chunked storage for all components of one type.
+ *
+ * Each component type declared with DECLARE_COMPONENT_TYPE allocates its instances from its own pool, via a class
+ * specific operator new, so existing code that creates components with std::make_unique (and owns them through
+ * std::unique_ptr<Component>) is unchanged. Components never move once allocated, so references to them stay valid.
+ *
+ * New components fill the lowest free slot, which keeps each chunk tightly packed. Systems that process every
+ * component of a type can stream through them with forEachSpan, rather than chasing a pointer per entity.
+ *
+ * Allocation is thread safe. Iterating a pool must not overlap with components of that type being created or
+ * destroyed.
+ */
+class Component_pool {
+ public:
+  static constexpr size_t chunk_capacity = 64;
+
+  // toComponent converts a pointer to a live slot into a pointer to its Component base.
+  Component_pool(size_t componentSize, size_t componentAlignment, Component* (*toComponent)(void*));
+  ~Component_pool();
+  Component_pool(const Component_pool&) = delete;
+  Component_pool& operator=(const Component_pool&) = delete;
+
+  size_t componentSize() const { return _componentSize; }
+
+  // Number of live components.
+  size_t size() const { return _size; }
+  size_t chunkCount() const { return _chunks.size(); }
+
+  // Returns uninitialized storage for one component.
+  void* allocate();
+  void deallocate(void* ptr);
+  bool owns(const void* ptr) const;
+
+  /**
+   * Calls fn(Component_span<TComponent>) for each run of consecutive live components. TComponent must be the type
+   * that this pool was created for.
+   */
+  template <typename TComponent, typename TFn> void forEachSpan(TFn&& fn) const;
+
+  // Calls fn(Component&) for each live component, in storage order. For when the component type isn't known statically.
+  template <typename TFn> void forEachComponent(TFn&& fn) const;
+
+ private:
+  struct Chunk {
+    std::byte* storage;
+    // Bit n is set if slot n holds a live component.
+    uint64_t occupied;
+  };
+  static_assert(chunk_capacity == 64, "Chunk::occupied must have one bit per slot");
+
+  // Returns the index of the chunk containing ptr, or _chunks.size().
+  size_t findChunk(const void* ptr) const;
+
+  // Calls fn(firstSlot, slotCount) for each run of consecutive live slots.
+  template <typename TFn> void forEachRun(TFn&& fn) const;
+
+  const size_t _componentSize;
+  const size_t _componentAlignment;
+  Component* (*const _toComponent)(void*);
+
+  std::vector<Chunk> _chunks;
+  // Chunk indices, sorted by storage address, for mapping a pointer back to its chunk.
+  std::vector<size_t> _chunksByAddress;
+  // All chunks before this one are full.
+  size_t _firstFreeChunk = 0;
+  size_t _size = 0;
+
+  mutable std::mutex _mutex;
+};
+
+template <typename TFn> void Component_pool::forEachRun(TFn&& fn) const {
+  for (const auto& chunk : _chunks) {
+    auto occupied = chunk.occupied;
+
+    size_t slot = 0;
+    while (occupied) {
+      // Skip free slots, then take the run of live ones.
+      while (!(occupied & 1)) {
+        occupied >>= 1;
+        ++slot;
+      }
+      const auto first = slot;
+      while (occupied & 1) {
+        occupied >>= 1;
+        ++slot;
+      }
+      fn(chunk.storage + first * _componentSize, slot - first);
+    }
+  }
+}
+
+template <typename TComponent, typename TFn> void Component_pool::forEachSpan(TFn&& fn) const {
+  assert(sizeof(TComponent) == _componentSize);
+  forEachRun([&fn](std::byte* firstSlot, size_t count) {
+    fn(Component_span<TComponent>(reinterpret_cast<TComponent*>(firstSlot), count));
+  });
+}
+
+template <typename TFn> void Component_pool::forEachComponent(TFn&& fn) const {
+  forEachRun([this, &fn](std::byte* firstSlot, size_t count) {
+    for (size_t idx = 0; idx < count; ++idx) {
+      fn(*_toComponent(firstSlot + idx * _componentSize));
+    }
+  });
+}
+} // namespace oe
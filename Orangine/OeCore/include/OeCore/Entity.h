@@ -1,13 +1,21 @@
 ﻿#pragma once
 
+#include <OeCore/Bounding_volume_hierarchy.h>
 #include <OeCore/Collision.h>
 #include <OeCore/Component.h>
+#include <OeCore/Entity_transform_store.h>
 
 #include "vectormath.hpp"
 
+#include <algorithm>
 #include <map>
+#include <type_traits>
 #include <vector>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace oe {
 
 class Entity_repository;
@@ -41,6 +49,19 @@ class Entity : public std::enable_shared_from_this<Entity> {
   using Entity_ptr_vec = std::vector<std::shared_ptr<Entity>>;
   using Entity_ptr_map = std::map<Id_type, std::shared_ptr<Entity>>;
 
+  // Ids are generational handles. The low bits are the index of the entity's slot in the Entity_repository, and the
+  // high bits count how many times that slot has been reused, so that ids of removed entities are never valid again.
+  static constexpr uint32_t id_index_bits = 20;
+  static constexpr Id_type id_index_mask = (1u << id_index_bits) - 1;
+  static constexpr Id_type id_generation_mask = ~id_index_mask >> id_index_bits;
+  static constexpr Id_type invalid_id = 0;
+
+  static constexpr Id_type makeId(uint32_t index, uint32_t generation) {
+    return (generation << id_index_bits) | index;
+  }
+  static constexpr uint32_t idIndex(Id_type id) { return id & id_index_mask; }
+  static constexpr uint32_t idGeneration(Id_type id) { return id >> id_index_bits; }
+
   Entity(IScene_graph_manager& sceneGraph, IComponent_factory& componentFactory, std::string name, Id_type id);
 
   // Don't allow direct copy of Entity objects (we have a unique_ptr list of components).
@@ -74,6 +95,11 @@ class Entity : public std::enable_shared_from_this<Entity> {
   size_t getComponentCount() const { return _components.size(); }
   Component& getComponent(size_t index) const;
 
+  /**
+   * Typed lookups use a per-entity index of component type ids, so do not need RTTI. They match components of exactly
+   * the given type. Types that do not declare a component type (such as Light_component) fall back to dynamic_cast, and
+   * so also match derived types.
+   */
   template <typename TComponent>
   std::vector<std::reference_wrapper<TComponent>> getComponentsOfType() const;
 
@@ -86,6 +112,20 @@ class Entity : public std::enable_shared_from_this<Entity> {
    */
   template <typename TComponent> TComponent* getFirstComponentOfType() const;
 
+  // Component type ids below this value have a bit in componentTypeMask().
+  static constexpr Component::Component_type max_indexed_component_type = 64;
+
+  // Bit n is set if the entity has a component with type id n, for type ids below max_indexed_component_type.
+  uint64_t componentTypeMask() const { return _componentTypeMask; }
+
+  /**
+   * returns a nullptr if no component with the given type id was found.
+   */
+  Component* getFirstComponentOfTypeId(Component::Component_type typeId) const {
+    const auto pos = findFirstComponentByType(typeId);
+    return pos < _componentsByType.size() ? _componentsByType[pos].component : nullptr;
+  }
+
   /**
    * Helper that calls IComponent_factory::addComponentToEntity
    */
@@ -97,32 +137,48 @@ class Entity : public std::enable_shared_from_this<Entity> {
   Component& addCloneOfComponent(const Component& component);
 
   // Rotation from the forward vector, in local space
-  const SSE::Quat& rotation() const { return _localRotation; }
-  void setRotation(const SSE::Quat& vector) { _localRotation = vector; }
+  const SSE::Quat& rotation() const {
+    return isTransformStored() ? _transformStore->localRotations[_transformIndex] : _localRotation;
+  }
+  void setRotation(const SSE::Quat& vector) {
+    (isTransformStored() ? _transformStore->localRotations[_transformIndex] : _localRotation) = vector;
+    markTransformDirty();
+  }
 
   // Translation from the origin, in local space
-  const SSE::Vector3& position() const { return _localPosition; }
-  void setPosition(const SSE::Vector3& vector) { _localPosition = vector; }
+  const SSE::Vector3& position() const {
+    return isTransformStored() ? _transformStore->localPositions[_transformIndex] : _localPosition;
+  }
+  void setPosition(const SSE::Vector3& vector) {
+    (isTransformStored() ? _transformStore->localPositions[_transformIndex] : _localPosition) = vector;
+    markTransformDirty();
+  }
 
   // Scale, in local space
-  const SSE::Vector3& scale() const { return _localScale; }
-  void setScale(const SSE::Vector3& vector) { _localScale = vector; }
-  void setScale(float scale) { _localScale = SSE::Vector3(scale, scale, scale); }
+  const SSE::Vector3& scale() const {
+    return isTransformStored() ? _transformStore->localScales[_transformIndex] : _localScale;
+  }
+  void setScale(const SSE::Vector3& vector) {
+    (isTransformStored() ? _transformStore->localScales[_transformIndex] : _localScale) = vector;
+    markTransformDirty();
+  }
+  void setScale(float scale) { setScale(SSE::Vector3(scale, scale, scale)); }
 
   void setTransform(const SSE::Matrix4& transform);
 
   bool calculateBoundSphereFromChildren() const { return _calculateBoundSphereFromChildren; }
-  void setCalculateBoundSphereFromChildren(bool calculateBoundSphereFromChildren) {
-    _calculateBoundSphereFromChildren = calculateBoundSphereFromChildren;
-  }
+  void setCalculateBoundSphereFromChildren(bool calculateBoundSphereFromChildren);
 
   bool calculateWorldTransform() const { return _calculateWorldTransform; }
-  void setCalculateWorldTransform(bool calculateWorldTransform) {
-    _calculateWorldTransform = calculateWorldTransform;
-  }
+  void setCalculateWorldTransform(bool calculateWorldTransform);
 
-  const oe::BoundingSphere& boundSphere() const { return _boundSphere; }
-  void setBoundSphere(const oe::BoundingSphere& boundSphere) { _boundSphere = boundSphere; }
+  const oe::BoundingSphere& boundSphere() const {
+    return isTransformStored() ? _transformStore->boundSpheres[_transformIndex] : _boundSphere;
+  }
+  void setBoundSphere(const oe::BoundingSphere& boundSphere) {
+    (isTransformStored() ? _transformStore->boundSpheres[_transformIndex] : _boundSphere) = boundSphere;
+    markDirty(Entity_transform_store::Transform_flag_bound_sphere_dirty);
+  }
 
   /*
    * Returns the right handed world transform matrix (T*R*S).
@@ -130,21 +186,56 @@ class Entity : public std::enable_shared_from_this<Entity> {
    * Otherwise, this is localTransform * parent.worldTransform.
    */
   // TODO: This is still a LH Matrix...? :(
-  const SSE::Matrix4& worldTransform() const { return _worldTransform; }
-  void setWorldTransform(const SSE::Matrix4& worldTransform) { _worldTransform = worldTransform; }
+  const SSE::Matrix4& worldTransform() const {
+    return isTransformStored() ? _transformStore->worldTransforms[_transformIndex] : _worldTransform;
+  }
+  void setWorldTransform(const SSE::Matrix4& worldTransform) {
+    (isTransformStored() ? _transformStore->worldTransforms[_transformIndex] : _worldTransform) = worldTransform;
+    markTransformDirty();
+  }
 
   const SSE::Vector3& worldScale() const;
   SSE::Vector3 worldPosition() const;
+  // The bound sphere is in local space; this is it transformed by the world transform, enlarged by the largest scale.
+  BoundingSphere worldBoundSphere() const;
   const SSE::Quat& worldRotation() const;
 
+  // True if this entity's transform currently lives in an Entity_transform_store, rather than in this object.
+  bool isTransformStored() const { return _transformStore != nullptr; }
+
+  // True if this entity was created by the given scene graph. Component pools are shared by every scene graph, so
+  // managers use this to skip the components of other scenes.
+  bool belongsTo(const IScene_graph_manager& sceneGraph) const { return &_sceneGraph == &sceneGraph; }
+
+  // Flags the world transform of this entity and all of its descendants to be recomputed on the next scene graph tick.
+  void markTransformDirty() { markDirty(Entity_transform_store::Transform_flag_transform_dirty); }
+
  private:
   std::shared_ptr<Entity> verifyEntityPtr() const;
 
   IScene_graph_manager& getSceneGraph() const { return _sceneGraph; }
 
+  // Sets the given Entity_transform_store::Transform_flags dirty bits, and flags all ancestors as having a dirty
+  // descendant.
+  void markDirty(uint8_t dirtyFlags);
+
+  // Adds or removes a component, keeping the component type index up to date.
+  Component& attachComponent(std::unique_ptr<Component> component);
+  void eraseComponent(Component& component);
+  void rebuildComponentIndex();
+
+  // Returns the position in _componentsByType of the first component with the given type, or _componentsByType.size()
+  // if there are none.
+  size_t findFirstComponentByType(Component::Component_type typeId) const;
+
+  template <typename TComponent, typename = void> struct Has_component_type : std::false_type {};
+  template <typename TComponent>
+  struct Has_component_type<TComponent, std::void_t<decltype(TComponent::type())>> : std::true_type {};
+
   // TODO: Refactor into a public & private interface, so that friend isn't required.
   friend struct EntityRef;
   friend class Entity_repository;
+  friend class Entity_transform_store;
   friend class internal::Scene_graph_manager;
 
   ////
@@ -173,6 +264,18 @@ class Entity : public std::enable_shared_from_this<Entity> {
   IScene_graph_manager& _sceneGraph;
 
   std::vector<std::unique_ptr<Component>> _components;
+
+  // Component type index. _componentsByType holds the components sorted by type id; components with the same type
+  // keep the order they were added in. For type ids below max_indexed_component_type, a bit is set in
+  // _componentTypeMask if there is at least one component of that type, and in _repeatedComponentTypeMask if there is
+  // more than one.
+  struct Component_type_entry {
+    Component::Component_type type;
+    Component* component;
+  };
+  std::vector<Component_type_entry> _componentsByType;
+  uint64_t _componentTypeMask = 0;
+  uint64_t _repeatedComponentTypeMask = 0;
   ////
   // Runtime, generated variables
   ////
@@ -183,32 +286,81 @@ class Entity : public std::enable_shared_from_this<Entity> {
 
   BoundingSphere _boundSphere;
   IComponent_factory& _componentFactory;
+
+  // If non-null, the transform & bound sphere members above are stale; the values live in this store.
+  Entity_transform_store* _transformStore;
+  uint32_t _transformIndex;
+
+  // Entity_transform_store::Transform_flags dirty bits. Unused while the transform is stored.
+  uint8_t _dirtyFlags;
+
+  // Proxy in the scene graph's bounding volume hierarchy; invalid_proxy if the bound sphere is empty.
+  uint32_t _boundingVolumeProxy;
 };
 
+inline size_t Entity::findFirstComponentByType(Component::Component_type typeId) const {
+  if (typeId < max_indexed_component_type) {
+    const auto typeBit = uint64_t(1) << typeId;
+    if (!(_componentTypeMask & typeBit)) {
+      return _componentsByType.size();
+    }
+
+    // If every lower type has exactly one component, the position is the number of lower types present.
+    const auto lowerTypesMask = typeBit - 1;
+    if (!(_repeatedComponentTypeMask & lowerTypesMask)) {
+#ifdef _MSC_VER
+      return static_cast<size_t>(__popcnt64(_componentTypeMask & lowerTypesMask));
+#else
+      return static_cast<size_t>(__builtin_popcountll(_componentTypeMask & lowerTypesMask));
+#endif
+    }
+  }
+
+  const auto pos = std::lower_bound(
+      _componentsByType.begin(), _componentsByType.end(), typeId,
+      [](const Component_type_entry& entry, Component::Component_type type) { return entry.type < type; });
+  if (pos == _componentsByType.end() || pos->type != typeId) {
+    return _componentsByType.size();
+  }
+  return static_cast<size_t>(pos - _componentsByType.begin());
+}
+
 template <typename TComponent>
 std::vector<std::reference_wrapper<TComponent>> Entity::getComponentsOfType() const {
   std::vector<std::reference_wrapper<TComponent>> comps;
-  for (auto iter = _components.begin(); iter != _components.end(); ++iter) {
-    TComponent* comp = dynamic_cast<TComponent*>((*iter).get());
-    if (comp != nullptr) {
-      comps.push_back(std::reference_wrapper<TComponent>(*comp));
+  if constexpr (Has_component_type<TComponent>::value) {
+    const auto typeId = TComponent::type();
+    for (auto pos = findFirstComponentByType(typeId);
+         pos < _componentsByType.size() && _componentsByType[pos].type == typeId; ++pos) {
+      comps.push_back(std::reference_wrapper<TComponent>(*static_cast<TComponent*>(_componentsByType[pos].component)));
+    }
+  } else {
+    for (auto iter = _components.begin(); iter != _components.end(); ++iter) {
+      TComponent* comp = dynamic_cast<TComponent*>((*iter).get());
+      if (comp != nullptr) {
+        comps.push_back(std::reference_wrapper<TComponent>(*comp));
+      }
     }
   }
   return comps;
 }
 
 template <typename TComponent> TComponent* Entity::getFirstComponentOfType() const {
-  for (auto iter = _components.begin(); iter != _components.end(); ++iter) {
-    const auto comp = dynamic_cast<TComponent*>((*iter).get());
-    if (comp != nullptr) {
-      return comp;
+  if constexpr (Has_component_type<TComponent>::value) {
+    return static_cast<TComponent*>(getFirstComponentOfTypeId(TComponent::type()));
+  } else {
+    for (auto iter = _components.begin(); iter != _components.end(); ++iter) {
+      const auto comp = dynamic_cast<TComponent*>((*iter).get());
+      if (comp != nullptr) {
+        return comp;
+      }
     }
+    return nullptr;
   }
-  return nullptr;
 }
 
 template <typename TComponent> TComponent& Entity::addComponent() {
-  return dynamic_cast<TComponent&>(_componentFactory.addComponentToEntity(TComponent::type(), *this));
+  return static_cast<TComponent&>(_componentFactory.addComponentToEntity(TComponent::type(), *this));
 }
 
 struct EntityRef {
@@ -219,6 +371,7 @@ struct EntityRef {
 
   EntityRef(IScene_graph_manager& sceneGraph, Entity::Id_type id) : sceneGraph(sceneGraph), id(id) {}
 
+  // Throws if the entity has been destroyed.
   Entity& get() const;
 
   Entity& operator*() const { return get(); }
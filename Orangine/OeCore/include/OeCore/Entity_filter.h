@@ -1,11 +1,21 @@
 #pragma once
 
+#include <OeCore/IJob_manager.h>
+
+#include <functional>
 #include <memory>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 namespace oe {
 class Entity;
 
+/**
+ * The set of entities in a scene that have a given combination of component types.
+ *
+ * Members are stored contiguously. Iteration order is deterministic: entities are appended as they start matching,
+ * and an entity that stops matching is replaced by the last member.
+ */
 class Entity_filter {
  public:
   struct Entity_filter_listener {
@@ -13,10 +23,28 @@ class Entity_filter {
     std::function<void(Entity*)> onRemove = [](Entity*) {};
   };
 
-  using Container = std::unordered_set<std::shared_ptr<Entity>>;
+  using Container = std::vector<std::shared_ptr<Entity>>;
   using Iterator = Container::iterator;
   using Const_iterator = Container::const_iterator;
 
+  // A contiguous range of filter members. Invalidated when the filter changes.
+  class Span {
+   public:
+    Span(const std::shared_ptr<Entity>* data, size_t size) : _data(data), _size(size) {}
+
+    const std::shared_ptr<Entity>* begin() const { return _data; }
+    const std::shared_ptr<Entity>* end() const { return _data + _size; }
+    const std::shared_ptr<Entity>& operator[](size_t index) const { return _data[index]; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    Span subspan(size_t offset, size_t count) const { return Span(_data + offset, count); }
+
+   private:
+    const std::shared_ptr<Entity>* _data;
+    size_t _size;
+  };
+
   Entity_filter() = default;
   virtual ~Entity_filter() = default;
   Entity_filter(const Entity_filter&) = default;
@@ -25,6 +53,7 @@ class Entity_filter {
   Entity_filter& operator=(Entity_filter&&) = default;
 
   bool empty() const { return _entities.empty(); }
+  size_t size() const { return _entities.size(); }
 
   Iterator begin() { return _entities.begin(); }
   Iterator end() { return _entities.end(); }
@@ -32,9 +61,57 @@ class Entity_filter {
   Const_iterator begin() const { return _entities.begin(); }
   Const_iterator end() const { return _entities.end(); }
 
+  const std::shared_ptr<Entity>& operator[](size_t index) const { return _entities[index]; }
+  Span span() const { return Span(_entities.data(), _entities.size()); }
+
+  bool contains(const Entity* entity) const { return _entityIndices.find(entity) != _entityIndices.end(); }
+
+  /**
+   * Splits the members into spans of at most grainSize entities, and calls fn(span) for each on the job manager's
+   * workers. Blocks until all spans have been processed. The filter must not change until this returns.
+   */
+  void parallelForEach(IJob_manager& jobManager, size_t grainSize, const std::function<void(const Span&)>& fn) const
+  {
+    const auto members = span();
+    jobManager.parallelFor(members.size(), grainSize, [&members, &fn](size_t begin, size_t end) {
+      fn(members.subspan(begin, end - begin));
+    });
+  }
+
   virtual void add_listener(std::weak_ptr<Entity_filter_listener> callback) = 0;
 
  protected:
+  // Returns false if the entity is already a member.
+  bool insertEntity(std::shared_ptr<Entity> entity)
+  {
+    const auto inserted = _entityIndices.emplace(entity.get(), _entities.size()).second;
+    if (inserted) {
+      _entities.push_back(std::move(entity));
+    }
+    return inserted;
+  }
+
+  // Returns false if the entity is not a member.
+  bool eraseEntity(const Entity* entity)
+  {
+    const auto pos = _entityIndices.find(entity);
+    if (pos == _entityIndices.end()) {
+      return false;
+    }
+
+    // Move the last member into the vacated slot.
+    const auto index = pos->second;
+    _entityIndices.erase(pos);
+    if (index != _entities.size() - 1) {
+      _entities[index] = std::move(_entities.back());
+      _entityIndices[_entities[index].get()] = index;
+    }
+    _entities.pop_back();
+    return true;
+  }
+
   Container _entities;
+  // Position of each member in _entities.
+  std::unordered_map<const Entity*, size_t> _entityIndices;
 };
 } // namespace oe
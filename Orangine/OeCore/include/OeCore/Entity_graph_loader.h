@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace DX {
@@ -31,5 +32,37 @@ class Entity_graph_loader {
   virtual std::vector<std::shared_ptr<Entity>> loadFile(
           std::string_view filename, IScene_graph_manager& sceneGraphManager, IEntity_repository& entityRepository,
           IComponent_factory& componentFactory, bool calculateBounds) const = 0;
+
+  // The output of prepareFile. Loaders derive from this to hold what they have read.
+  struct Prepared_file {
+    virtual ~Prepared_file() = default;
+
+    std::string filename;
+    bool calculateBounds = false;
+  };
+
+  /**
+   * Loading split in two, so that the slow part can happen on a background thread: prepareFile followed by
+   * instantiatePreparedFile gives the same entities as loadFile.
+   *
+   * prepareFile reads the file and builds whatever doesn't need entities or managers, such as mesh data. It may be
+   * called from any thread. The default implementation does no work, leaving it all to instantiatePreparedFile.
+   */
+  virtual std::unique_ptr<Prepared_file> prepareFile(std::string_view filename, bool calculateBounds) const
+  {
+    auto preparedFile = std::make_unique<Prepared_file>();
+    preparedFile->filename = filename;
+    preparedFile->calculateBounds = calculateBounds;
+    return preparedFile;
+  }
+
+  // Creates the entities of a file returned by this loader's prepareFile. Must be called from the main thread.
+  virtual std::vector<std::shared_ptr<Entity>> instantiatePreparedFile(
+          Prepared_file& preparedFile, IScene_graph_manager& sceneGraphManager, IEntity_repository& entityRepository,
+          IComponent_factory& componentFactory) const
+  {
+    return loadFile(
+            preparedFile.filename, sceneGraphManager, entityRepository, componentFactory, preparedFile.calculateBounds);
+  }
 };
 }// namespace oe
\ No newline at end of file
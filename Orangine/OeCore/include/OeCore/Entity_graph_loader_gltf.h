@@ -1,26 +1,89 @@
 ﻿#pragma once
 
 #include "OeCore/Entity_graph_loader.h"
+#include "OeCore/Mesh_quantizer.h"
+#include "OeCore/Mesh_simplifier.h"
 
 #include <wrl/client.h>
 
 struct IWICImagingFactory;
 
 namespace oe {
+class IJob_manager;
+class Mapped_file;
+class Mesh_buffer_pool;
+struct Mesh_buffer;
 
 class Entity_graph_loader_gltf : public Entity_graph_loader {
  public:
-  Entity_graph_loader_gltf(IMaterial_manager& materialManager, ITexture_manager& textureManager);
+  // Primitives are prepared in parallel on the job manager's workers.
+  Entity_graph_loader_gltf(
+      IMaterial_manager& materialManager,
+      ITexture_manager& textureManager,
+      IJob_manager& jobManager);
+
+  // Triangle list primitives are reordered for the vertex cache as they are prepared (see Mesh_optimizer). Disable to
+  // keep the triangle and vertex order of the file.
+  void setMeshOptimizationEnabled(bool enabled) { _meshOptimizationEnabled = enabled; }
+  bool meshOptimizationEnabled() const { return _meshOptimizationEnabled; }
+
+  // Triangle list primitives are given simplified levels of detail as they are prepared (see Mesh_simplifier). Disabled
+  // by default, since it lengthens loading.
+  void setLodGenerationEnabled(bool enabled) { _lodGenerationEnabled = enabled; }
+  bool lodGenerationEnabled() const { return _lodGenerationEnabled; }
+  void setLodOptions(const Mesh_simplifier_options& options) { _lodOptions = options; }
+  const Mesh_simplifier_options& lodOptions() const { return _lodOptions; }
+
+  // Float vertex attributes are quantized as they are prepared, before levels of detail are generated (see
+  // Mesh_quantizer). Disabled by default, since it needs a renderer whose input layouts use each accessor's encoding.
+  void setVertexQuantizationEnabled(bool enabled) { _vertexQuantizationEnabled = enabled; }
+  bool vertexQuantizationEnabled() const { return _vertexQuantizationEnabled; }
+  void setVertexQuantizationOptions(const Mesh_quantizer_options& options) { _vertexQuantizationOptions = options; }
+  const Mesh_quantizer_options& vertexQuantizationOptions() const { return _vertexQuantizationOptions; }
+
+  // Prepared primitives, and their levels of detail, take their index and vertex buffers from this pool, so that those
+  // identical to buffers already loaded, by this file or any other, are shared rather than held again. Null (the
+  // default) to give each file its own buffers.
+  void setMeshBufferPool(std::shared_ptr<Mesh_buffer_pool> pool) { _meshBufferPool = std::move(pool); }
+  const std::shared_ptr<Mesh_buffer_pool>& meshBufferPool() const { return _meshBufferPool; }
 
   void getSupportedFileExtensions(std::vector<std::string>& extensions) const override;
   std::vector<std::shared_ptr<Entity>> loadFile(
           std::string_view filename, IScene_graph_manager& sceneGraphManager, IEntity_repository& entityRepository,
           IComponent_factory& componentFactory, bool calculateBounds) const override;
 
+  // Parses the file and builds the mesh data of every primitive. Textures and materials are created by
+  // instantiatePreparedFile, since the texture manager isn't thread safe.
+  std::unique_ptr<Prepared_file> prepareFile(std::string_view filename, bool calculateBounds) const override;
+  std::vector<std::shared_ptr<Entity>> instantiatePreparedFile(
+          Prepared_file& preparedFile, IScene_graph_manager& sceneGraphManager, IEntity_repository& entityRepository,
+          IComponent_factory& componentFactory) const override;
+
  private:
   Microsoft::WRL::ComPtr<IWICImagingFactory> _imagingFactory = nullptr;
   IMaterial_manager& _materialManager;
   ITexture_manager& _textureManager;
+  IJob_manager& _jobManager;
+  bool _meshOptimizationEnabled = true;
+  bool _lodGenerationEnabled = false;
+  Mesh_simplifier_options _lodOptions;
+  bool _vertexQuantizationEnabled = false;
+  Mesh_quantizer_options _vertexQuantizationOptions;
+  std::shared_ptr<Mesh_buffer_pool> _meshBufferPool;
 };
 
+// Reading of binary glTF (.glb) files, as mapped by Entity_graph_loader_gltf.
+namespace gltf_utils {
+// True if the data starts with a .glb header.
+bool is_glb(const uint8_t* data, size_t size);
+
+// Finds the BIN chunk of a .glb file: a 12 byte header, followed by chunks that each have an 8 byte header (length,
+// type). Chunks must be padded to 4 bytes, so that data in them can be read in place. Returns false if there is no BIN
+// chunk, or if the chunk table is truncated or misaligned before one is found.
+bool find_glb_bin_chunk(const uint8_t* data, size_t size, size_t& binChunkOffset, size_t& binChunkSize);
+
+// A buffer that views the BIN chunk of a mapped .glb file without copying it, and keeps the mapping alive. Null if the
+// file isn't a .glb, or has no BIN chunk.
+std::shared_ptr<Mesh_buffer> map_glb_bin_chunk(const std::shared_ptr<Mapped_file>& mappedFile);
+} // namespace gltf_utils
 }// namespace oe
@@ -47,6 +47,33 @@ class Entity_cull_sorter : public Entity_sorter<Entity_cull_sorter_entry> {
       }
     //});
   }
+
+  /*
+   * Culls the entities of all visible renderable components in sceneGraph, streaming through the component pool. The
+   * pool holds the renderables of every scene graph, so those of others are skipped.
+   */
+  void beginSortRenderables(const IScene_graph_manager& sceneGraph, const BoundingFrustumRH& cullingFrustum)
+  {
+    _entities.clear();
+
+    Renderable_component::componentPool().forEachSpan<Renderable_component>(
+        [this, &sceneGraph, &cullingFrustum](const Component_span<Renderable_component>& renderables) {
+          for (auto& renderable : renderables) {
+            auto& entity = renderable.getEntity();
+            if (!entity.belongsTo(sceneGraph)) {
+              continue;
+            }
+            // Entities are rendered with their first renderable, so only consider that one.
+            if (!renderable.visible() || entity.getState() != Entity_state::Ready ||
+                entity.getFirstComponentOfType<Renderable_component>() != &renderable) {
+              continue;
+            }
+
+            if (cullingFrustum.Contains(entity.boundSphere()))
+              _entities.push_back({&entity});
+          }
+        });
+  }
 };
 
 struct Entity_alpha_sorter_entry {
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <OeCore/Collision.h>
+
+#include "vectormath.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace oe {
+class Entity;
+
+/**
+ * Flat, structure-of-arrays storage for entity transforms.
+ *
+ * Slots are ordered breadth first from the root entities, so a parent is always stored before its children and the
+ * children of any one entity occupy a contiguous range of slots. This allows world transforms to be computed in a
+ * single linear pass, and bound spheres to be merged in a single reverse pass, without recursing the entity graph.
+ *
+ * While an entity is attached to a store, its transform accessors (position(), worldTransform() etc) read and write
+ * the store's arrays rather than the entity's own members.
+ */
+class Entity_transform_store {
+ public:
+  static constexpr uint32_t invalid_index = std::numeric_limits<uint32_t>::max();
+
+  enum Transform_flags : uint8_t {
+    Transform_flag_active = 1 << 0,
+    Transform_flag_calculate_world_transform = 1 << 1,
+    Transform_flag_calculate_bound_sphere_from_children = 1 << 2,
+
+    // The local or parent transform has changed; the world transform of this entity and its descendants is stale.
+    Transform_flag_transform_dirty = 1 << 3,
+    // The bound sphere of this entity has changed; its parent must merge it again.
+    Transform_flag_bound_sphere_dirty = 1 << 4,
+    // The children of this entity have changed; its own bound sphere must be merged again.
+    Transform_flag_children_dirty = 1 << 5,
+    // A descendant has one of the above flags set. Only used when entities are not stored in a transform store, to
+    // avoid visiting clean subtrees.
+    Transform_flag_descendant_dirty = 1 << 6,
+
+    Transform_flags_dirty_mask = Transform_flag_transform_dirty | Transform_flag_bound_sphere_dirty |
+                                 Transform_flag_children_dirty | Transform_flag_descendant_dirty,
+  };
+
+  Entity_transform_store() = default;
+  ~Entity_transform_store();
+  Entity_transform_store(const Entity_transform_store&) = delete;
+  Entity_transform_store& operator=(const Entity_transform_store&) = delete;
+
+  size_t size() const { return entities.size(); }
+
+  // Returns false if the entity hierarchy has changed since the last call to rebuild.
+  bool hierarchyValid() const { return _hierarchyValid; }
+  void invalidateHierarchy() { _hierarchyValid = false; }
+
+  /**
+   * Detaches all currently stored entities, then re-attaches every entity reachable from the given roots in
+   * breadth-first order.
+   */
+  void rebuild(const std::vector<std::shared_ptr<Entity>>& rootEntities);
+
+  /**
+   * Copies the stored transform back into the entity and releases its slot. The hierarchy is invalidated, as the
+   * slot ordering no longer matches the entity graph.
+   */
+  void detach(Entity& entity);
+
+  // Detaches all entities.
+  void clear();
+
+  /**
+   * Computes world transforms for active slots whose transform, or an ancestor's transform, is dirty
+   * (root -> leaves). Then merges bound spheres for entities whose children's bound spheres changed
+   * (leaves -> root). The hierarchy must be valid.
+   *
+   * If boundsChangedEntities is given, entities whose bound sphere changed are appended to it.
+   * Returns the number of world transforms that were recomputed.
+   */
+  uint32_t update(std::vector<Entity*>* boundsChangedEntities = nullptr);
+
+  void setFlag(uint32_t index, Transform_flags flag, bool value) {
+    if (value)
+      flags[index] |= flag;
+    else
+      flags[index] &= ~flag;
+  }
+
+  // Computes world TRS for a node that has no parent.
+  static void computeWorldTransform(
+      const SSE::Vector3& localPosition,
+      const SSE::Quat& localRotation,
+      const SSE::Vector3& localScale,
+      SSE::Matrix4& worldTransform,
+      SSE::Quat& worldRotation,
+      SSE::Vector3& worldScale) {
+    worldRotation = localRotation;
+    worldScale = localScale;
+
+    worldTransform = SSE::Matrix4::translation(localPosition) * SSE::Matrix4::rotation(worldRotation) *
+                     SSE::Matrix4::scale(worldScale);
+  }
+
+  // Computes world TRS for a node, given the world TRS of its parent.
+  static void computeWorldTransform(
+      const SSE::Vector3& localPosition,
+      const SSE::Quat& localRotation,
+      const SSE::Vector3& localScale,
+      const SSE::Matrix4& parentWorldTransform,
+      const SSE::Quat& parentWorldRotation,
+      const SSE::Vector3& parentWorldScale,
+      SSE::Matrix4& worldTransform,
+      SSE::Quat& worldRotation,
+      SSE::Vector3& worldScale) {
+    worldScale = mulPerElem(parentWorldScale, localScale);
+    worldRotation = parentWorldRotation * localRotation;
+
+    const auto worldPosition = parentWorldTransform * SSE::Point3(localPosition);
+    worldTransform = SSE::Matrix4::translation(worldPosition.getXYZ()) * SSE::Matrix4::rotation(worldRotation) *
+                     SSE::Matrix4::scale(worldScale);
+  }
+
+  ////
+  // Per-slot data. All arrays have size() elements.
+  ////
+
+  // Local TRS
+  std::vector<SSE::Vector3> localPositions;
+  std::vector<SSE::Quat> localRotations;
+  std::vector<SSE::Vector3> localScales;
+
+  // World TRS, generated by update()
+  std::vector<SSE::Matrix4> worldTransforms;
+  std::vector<SSE::Quat> worldRotations;
+  std::vector<SSE::Vector3> worldScales;
+
+  std::vector<BoundingSphere> boundSpheres;
+
+  // Hierarchy. Parent index is invalid_index for root entities.
+  std::vector<uint32_t> parentIndices;
+  std::vector<uint32_t> firstChildIndices;
+  std::vector<uint32_t> childCounts;
+  std::vector<uint8_t> flags;
+
+  // Back-pointers to the owning entities; nullptr for slots that have been detached.
+  std::vector<Entity*> entities;
+
+ private:
+  void attach(Entity& entity, uint32_t parentIndex);
+  void detachSlot(uint32_t index);
+
+  bool _hierarchyValid = false;
+
+  // Scratch buffers used by update()
+  enum class Visit_state : uint8_t { Skipped, Visited, Transform_changed };
+  std::vector<Visit_state> _visitStates;
+  std::vector<uint8_t> _childBoundsChanged;
+};
+} // namespace oe
@@ -1,9 +1,35 @@
 ﻿#pragma once
 #include "Manager_base.h"
 
+#include <cstdint>
+
 namespace oe {
+struct BoundingFrustumRH;
+
 class IAnimation_manager {
  public:
+  // Counts for the most recent tick.
+  struct Animation_stats {
+    uint32_t sampledChannels = 0;
+    // Channels of controllers that were throttled or paused.
+    uint32_t skippedChannels = 0;
+    uint32_t fullRateControllers = 0;
+    uint32_t reducedRateControllers = 0;
+    uint32_t pausedControllers = 0;
+  };
+
   virtual ~IAnimation_manager() = default;
+
+  // The world space camera frustum, used to choose each controller's update rate. Until this is set, every controller
+  // is updated at the full rate.
+  virtual void setViewFrustum(const BoundingFrustumRH& frustum) = 0;
+
+  virtual const Animation_stats& animationStats() const = 0;
+
+  /**
+   * Computes the skinning palette of every skinned mesh from the current world transforms. Call once per frame, after
+   * the scene graph has updated and before any render pass reads the palettes.
+   */
+  virtual void updateSkinningPalettes() = 0;
 };
 }// namespace oe
\ No newline at end of file
@@ -2,10 +2,13 @@
 
 #include "Manager_base.h"
 
+#include <memory>
 #include <unordered_map>
 #include <string>
 
 namespace oe {
+class Mesh_buffer_pool;
+
 class IAsset_manager {
  public:
   virtual ~IAsset_manager() = default;
@@ -25,5 +28,8 @@ class IAsset_manager {
   virtual bool fallbackDataPathAllowed() const = 0;
 
   virtual std::string makeAbsoluteAssetPath(const std::string& path) const = 0;
+
+  // Mesh buffers shared by all loaded assets, so that identical meshes are held in memory once.
+  virtual const std::shared_ptr<Mesh_buffer_pool>& meshBufferPool() const = 0;
 };
 } // namespace oe
\ No newline at end of file
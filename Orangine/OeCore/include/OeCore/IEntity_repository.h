@@ -23,6 +23,11 @@ class IEntity_repository {
 		 */
   virtual std::shared_ptr<Entity> getEntityPtrById(Entity::Id_type id) = 0;
 
+  /**
+		 * Will return nullptr if no entity exists. Does not modify the entity's reference count.
+		 */
+  virtual Entity* findEntityById(Entity::Id_type id) = 0;
+
   /**
 		 * Will assert that entity with given ID exists.
 		 */
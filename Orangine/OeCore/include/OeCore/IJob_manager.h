@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Manager_base.h"
+
+#include <cstdint>
+#include <functional>
+
+namespace oe {
+
+/**
+ * Runs jobs on a pool of worker threads. Each worker owns a job deque; it pushes and pops jobs at the back of its own
+ * deque, and steals jobs from the front of other workers' deques when its own is empty.
+ *
+ * Threads that wait for jobs to complete will execute pending jobs of their own parallelFor while they wait, so it is
+ * safe to call these methods from within a job, and a thread never runs the jobs of another thread's parallelFor (such
+ * as a background load) while it waits.
+ */
+class IJob_manager {
+ public:
+  virtual ~IJob_manager() = default;
+
+  // Sets the number of threads that execute jobs, including the thread that calls parallelFor.
+  // Zero means one per hardware thread. Must be called before initialize(), otherwise an exception will be thrown.
+  virtual void preInit_setWorkerCount(uint32_t workerCount) = 0;
+
+  // Number of threads that execute jobs, including the thread that calls parallelFor.
+  virtual uint32_t workerCount() const = 0;
+
+  /**
+   * Calls fn(begin, end) for consecutive ranges covering [0, count), each no larger than grainSize. Blocks until all
+   * ranges are complete. Ranges may execute in any order, on any thread. If any invocation throws, the first exception
+   * is rethrown once all ranges have completed.
+   */
+  virtual void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn) = 0;
+};
+} // namespace oe
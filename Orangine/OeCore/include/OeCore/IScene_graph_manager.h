@@ -9,10 +9,13 @@
 
 #include <OeCore/Entity_graph_loader.h>
 
+#include <future>
 #include <unordered_set>
 #include <vector>
 
 namespace oe {
+struct BoundingFrustumRH;
+struct BoundingSphere;
 struct Ray;
 struct Ray_intersection;
 
@@ -31,12 +34,25 @@ class IScene_graph_manager
   virtual void loadFile(const std::string& filename) = 0;
   virtual void loadFile(const std::string& filename, Entity* parentEntity) = 0;
 
+  /**
+   * Reads the file and builds its mesh data on a background thread. Its entities are then created on the main thread,
+   * and added to the scene all at once, during the next tick. The future is ready once they have been added, or holds
+   * the exception that the load failed with. If the parent entity is destroyed first, the load fails.
+   */
+  virtual std::future<std::vector<std::shared_ptr<Entity>>> loadFileAsync(const std::string& filename) = 0;
+  virtual std::future<std::vector<std::shared_ptr<Entity>>> loadFileAsync(
+      const std::string& filename,
+      Entity* parentEntity) = 0;
+
   /**
    * Will do nothing if no entity exists with the given ID.
    */
   virtual void destroy(Entity::Id_type entityId) = 0;
 
   virtual std::shared_ptr<Entity> getEntityPtrById(Entity::Id_type id) const = 0;
+
+  // Returns nullptr if no entity exists with the given ID. Does not modify the entity's reference count.
+  virtual Entity* findEntityById(Entity::Id_type id) const = 0;
   virtual std::shared_ptr<Entity_filter> getEntityFilter(
       const Component_type_set& componentTypes,
       Entity_filter_mode mode = Entity_filter_mode::All) = 0;
@@ -45,16 +61,26 @@ class IScene_graph_manager
 
   /**
    * Collision
+   *
+   * Queries use a bounding volume hierarchy that is refit with entity bound spheres at the end of each tick. They must
+   * be called from the main thread.
    */
 
-  // Finds the first entity whose bounding sphere collides with the given ray. This might not be the
-  // entity whose center is the closest to the ray origin.
+  // Finds the entity whose bounding sphere is hit closest to the ray origin. Entities whose bound sphere is calculated
+  // from their children are not returned, since their children are tested instead. This might not be the entity whose
+  // center is the closest to the ray origin.
   virtual bool findCollidingEntity(
       const Ray& ray,
       Entity const*& foundEntity,
       Ray_intersection& foundIntersection,
       float maxDistance = FLT_MAX) = 0;
 
+  // Appends all entities whose bounding sphere intersects the given sphere.
+  virtual void findEntitiesIntersectingSphere(const BoundingSphere& sphere, std::vector<Entity*>& foundEntities) = 0;
+
+  // Appends all entities whose bounding sphere intersects, or is contained by, the given frustum.
+  virtual void findEntitiesInFrustum(const BoundingFrustumRH& frustum, std::vector<Entity*>& foundEntities) = 0;
+
   // Internal use only.
   virtual std::shared_ptr<Entity> removeFromRoot(std::shared_ptr<Entity> entity) = 0;
 
@@ -62,5 +88,9 @@ class IScene_graph_manager
   virtual void addToRoot(std::shared_ptr<Entity> entity) = 0;
 
   virtual Dispatcher<Entity&>& getEntityAddedDispatcher() = 0;
+
+  // Number of entity world transforms that were recomputed during the last tick. Entities whose local transform,
+  // and whose ancestors' transforms, did not change are not recomputed.
+  virtual uint32_t getRecomputedTransformCount() const = 0;
 };
 } // namespace oe
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "OeCore/WindowsDefines.h"
+
+#include <cstdint>
+#include <string>
+
+namespace oe {
+/**
+ * A whole file, mapped into memory. Pages are read from disk as they are first touched, rather than all up front.
+ *
+ * The mapping is copy on write: memory may be modified, but changes are private to this process and are never written
+ * back to the file.
+ */
+class Mapped_file {
+ public:
+  // Throws std::runtime_error if the file can't be opened or mapped.
+  explicit Mapped_file(const std::string& filename);
+  ~Mapped_file();
+
+  Mapped_file(const Mapped_file&) = delete;
+  Mapped_file& operator=(const Mapped_file&) = delete;
+
+  uint8_t* data() const { return _data; }
+  size_t size() const { return _size; }
+
+ private:
+  HANDLE _file = INVALID_HANDLE_VALUE;
+  HANDLE _mapping = nullptr;
+  uint8_t* _data = nullptr;
+  size_t _size = 0;
+};
+} // namespace oe
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace oe {
+struct Mesh_buffer;
+struct Mesh_buffer_accessor;
+class Mesh_data;
+
+struct Mesh_buffer_pool_statistics {
+  // Distinct buffers in the pool that are still in use, and their total size.
+  size_t bufferCount = 0;
+  size_t bufferBytes = 0;
+  // Requests that were resolved to an identical buffer already in the pool, and the bytes that didn't need storing.
+  size_t sharedCount = 0;
+  size_t sharedBytes = 0;
+};
+
+/**
+ * Deduplicates mesh buffers by content, so that identical vertex and index data, such as the same props loaded from
+ * many files, is held in memory once. Thread safe.
+ *
+ * Buffers are found by a hash of their contents, then compared byte for byte. The pool only holds weak references:
+ * a buffer is freed as soon as the last accessor using it is, and is then forgotten. Since pooled buffers are shared
+ * by meshes that know nothing of each other, they must not be written to; give an accessor a new buffer instead.
+ */
+class Mesh_buffer_pool {
+ public:
+  // Returns a pooled buffer holding a copy of size bytes of data, creating one if the pool has none.
+  std::shared_ptr<Mesh_buffer> findOrCreate(const uint8_t* data, size_t size);
+
+  /*
+   * Points accessor at a pooled buffer holding the bytes that it reads: count strides from its offset, or up to the end
+   * of its last element, which is elementSize bytes long, if the buffer ends sooner. If the pool has no such buffer,
+   * the accessor's buffer is added to it without copying, through a view of just those bytes if it holds anything else.
+   */
+  void share(Mesh_buffer_accessor& accessor, size_t elementSize);
+
+  // Shares the index, vertex and morph target accessors of meshData.
+  void share(Mesh_data& meshData);
+
+  Mesh_buffer_pool_statistics statistics() const;
+
+ private:
+  struct Entry {
+    std::weak_ptr<Mesh_buffer> buffer;
+    size_t size;
+  };
+
+  // Returns the live pooled buffer with these contents, or null. Requires _mutex.
+  std::shared_ptr<Mesh_buffer> find(uint64_t hash, const uint8_t* data, size_t size) const;
+  // Requires _mutex.
+  void add(uint64_t hash, const std::shared_ptr<Mesh_buffer>& buffer);
+  // Forgets buffers that have been freed. Requires _mutex.
+  void removeExpired();
+
+  mutable std::mutex _mutex;
+  std::unordered_multimap<uint64_t, Entry> _entries;
+  size_t _addsSinceRemoveExpired = 0;
+  size_t _sharedCount = 0;
+  size_t _sharedBytes = 0;
+};
+} // namespace oe
@@ -44,7 +44,10 @@ namespace oe
 
 	struct Mesh_buffer
 	{
+		// Allocates size bytes, owned by this buffer.
 		explicit Mesh_buffer(size_t size);
+		// References size bytes of memory owned by owner (such as a memory mapped file), without copying them.
+		Mesh_buffer(uint8_t* data, size_t size, std::shared_ptr<const void> owner);
 		~Mesh_buffer();
 
         const uint8_t* getIndexed(size_t index, size_t stride, size_t offset) const
@@ -62,6 +65,10 @@ namespace oe
 
 		uint8_t* data;
 		size_t dataSize;
+
+	private:
+		// Keeps referenced memory alive. Null if data was allocated by this buffer.
+		std::shared_ptr<const void> _owner;
 	};
 
 	struct Mesh_buffer_accessor
@@ -87,6 +94,11 @@ namespace oe
 		virtual ~Mesh_vertex_buffer_accessor() = default;
 
         const Vertex_attribute_element attributeElement;
+
+		// For Element_encoding::Normalized elements, the first three components are scaled then offset by these once
+		// normalized; such as to map positions quantized within their bounds back to model space.
+		SSE::Vector3 decodeScale = SSE::Vector3(1.0f);
+		SSE::Vector3 decodeOffset = SSE::Vector3(0.0f);
 	};
 
 	struct Mesh_index_buffer_accessor : Mesh_buffer_accessor
@@ -4,28 +4,54 @@
 
 #include "Mesh_data.h"
 
+#include <vector>
+
 /*
  * CPU side mesh vertex, index or animation buffer. Used to create a new mesh.
  */
 namespace oe {
 class Mesh_bind_context;
 
+// A simplified version of a mesh, drawn in its place when it is small enough on screen (see Mesh_simplifier).
+struct Mesh_lod {
+  std::shared_ptr<Mesh_data> meshData;
+  // How far the simplified surface may be from the original, relative to the radius of the mesh's bounds.
+  float error = 0.0f;
+};
+
 class Mesh_data_component : public Component {
   DECLARE_COMPONENT_TYPE;
 
  public:
-  explicit Mesh_data_component(Entity& entity) : Component(entity), _meshData(nullptr) {}
+  explicit Mesh_data_component(Entity& entity) : Component(entity) {}
 
   ~Mesh_data_component() = default;
 
   // TODO: Will eventually reference an asset ID here, rather than actual mesh data.
-  const std::shared_ptr<Mesh_data>& meshData() const { return _meshData; }
-  void setMeshData(const std::shared_ptr<Mesh_data>& meshData) { _meshData = meshData; }
+  // Clones of this component share its mesh data.
+  const std::shared_ptr<Mesh_data>& meshData() const { return _component_properties.meshData; }
+  void setMeshData(const std::shared_ptr<Mesh_data>& meshData) { _component_properties.meshData = meshData; }
+
+  // Simplified levels of detail of meshData, from finest to coarsest. May be empty.
+  const std::vector<Mesh_lod>& lods() const { return _component_properties.lods; }
+  void setLods(std::vector<Mesh_lod> lods) { _component_properties.lods = std::move(lods); }
+
+  // Level 0 is meshData; level n is lods()[n - 1].
+  size_t lodCount() const { return _component_properties.lods.size() + 1; }
+  const std::shared_ptr<Mesh_data>& lodMeshData(size_t lod) const {
+    return lod == 0 ? _component_properties.meshData : _component_properties.lods.at(lod - 1).meshData;
+  }
+
+  /*
+   * Returns the coarsest level whose error is no more than maxScreenError once projected. projectedRadius is the radius
+   * of the mesh's bounds on screen, in the same units as maxScreenError.
+   */
+  size_t selectLod(float projectedRadius, float maxScreenError) const;
 
  private:
   BEGIN_COMPONENT_PROPERTIES();
+  std::shared_ptr<Mesh_data> meshData;
+  std::vector<Mesh_lod> lods;
   END_COMPONENT_PROPERTIES();
-
-  std::shared_ptr<Mesh_data> _meshData;
 };
 } // namespace oe
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "OeCore/Collision.h"
+#include "OeCore/Renderer_types.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace oe {
+class Mesh_data;
+
+// Posed vertices of a mesh, written by Mesh_deformer::deform.
+struct Deformed_mesh {
+  std::vector<SSE::Vector3> positions;
+  // Empty if the mesh has no normals.
+  std::vector<SSE::Vector3> normals;
+};
+
+/**
+ * Applies morph targets and skinning on the CPU, the same way the vertex shader does, for code that needs posed
+ * geometry without a renderer (headless bounds computation, collision queries, picking, thumbnail baking).
+ *
+ * The constructor decodes the mesh's position, normal, joint, weight and morph target streams into flat arrays, so
+ * that deform can run over them without any per vertex format dispatch. Positions are morphed a block at a time, in
+ * structure of arrays form so the loops vectorize; skinning then blends the bone matrices with SSE.
+ */
+class Mesh_deformer {
+ public:
+  // Throws std::runtime_error if the mesh has no Vector3 positions, or a stream has an unsupported format.
+  explicit Mesh_deformer(const Mesh_data& meshData);
+
+  size_t vertexCount() const { return _vertexCount; }
+  size_t morphTargetCount() const { return _morphTargets.size(); }
+  bool hasNormals() const { return !_normals.x.empty(); }
+  bool skinned() const { return !_joints.empty(); }
+
+  /**
+   * Writes the posed vertices to out. morphWeights has one weight per morph target; missing weights are zero.
+   * If the mesh is skinned and boneTransforms isn't empty, vertices are then skinned by that palette (see
+   * Skinned_mesh_component::skinningPalette), putting them in the space of the skeleton transform root. Otherwise
+   * they stay in the mesh's local space.
+   */
+  void deform(
+      const float* morphWeights,
+      size_t morphWeightCount,
+      const std::vector<SSE::Matrix4>& boneTransforms,
+      Deformed_mesh& out) const;
+
+  // Bounds of posed vertices.
+  static BoundingSphere boundingSphere(const Deformed_mesh& deformedMesh);
+
+  // Finds the nearest triangle of the posed mesh hit by the ray. Returns false if there is none.
+  bool intersectRay(const Ray& ray, const Deformed_mesh& deformedMesh, Ray_intersection& intersection) const;
+
+ private:
+  struct Float3_stream {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+  };
+
+  struct Morph_target {
+    // Either may be empty, if the target doesn't move that attribute.
+    Float3_stream positionDeltas;
+    Float3_stream normalDeltas;
+  };
+
+  size_t _vertexCount = 0;
+  Float3_stream _positions;
+  Float3_stream _normals;
+  std::vector<Morph_target> _morphTargets;
+
+  std::vector<std::array<uint16_t, 4>> _joints;
+  std::vector<SSE::Vector4> _weights;
+  uint32_t _maxJointIndex = 0;
+
+  // Triangle list.
+  std::vector<uint32_t> _indices;
+};
+} // namespace oe
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vectormath.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace oe {
+class Mesh_data;
+
+// How well a triangle list uses a FIFO post transform vertex cache of a given size, as simulated on the CPU.
+struct Vertex_cache_statistics {
+  // Average cache miss ratio: vertex shader invocations per triangle. 3 is the worst case; regular grids approach 0.5.
+  float acmr = 0.0f;
+  // Average transform to vertex ratio: vertex shader invocations per referenced vertex. 1 is ideal.
+  float atvr = 0.0f;
+};
+
+struct Mesh_optimizer_options {
+  // Entries in the simulated FIFO vertex cache that triangles are ordered for.
+  uint32_t cacheSize = 16;
+  // Reorders the vertex buffers into the order that the indices first use them.
+  bool reorderVertices = true;
+  // Reorders clusters of triangles so that those facing out of the mesh are drawn first, so that they occlude the rest.
+  bool optimizeOverdraw = false;
+  // Clusters are split wherever their ACMR is within this factor of the mesh's; higher makes more, smaller clusters,
+  // trading vertex cache efficiency for less overdraw.
+  float overdrawThreshold = 1.05f;
+};
+
+struct Mesh_optimizer_report {
+  Vertex_cache_statistics before;
+  Vertex_cache_statistics after;
+};
+
+/**
+ * Reorders a mesh's triangles and vertices for the GPU, without changing what it looks like. Needs no device, so runs
+ * on loader threads, headless tools, or offline.
+ *
+ * Triangles are ordered for the vertex cache with Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for
+ * Vertex Locality and Reduced Overdraw"), whose clusters can then be sorted to reduce overdraw. Vertices are then
+ * reordered to the order that the triangles first use them, so that vertex fetch reads memory linearly.
+ */
+class Mesh_optimizer {
+ public:
+  /*
+   * Reorders the index buffer, and if options.reorderVertices, every vertex and morph target buffer of meshData. Each
+   * reordered accessor is given a new, tightly packed buffer, so buffers shared with other meshes are left alone.
+   * Meshes that aren't indexed triangle lists are left unchanged, and an empty report is returned.
+   * Throws std::runtime_error if an index is out of range.
+   */
+  static Mesh_optimizer_report optimize(Mesh_data& meshData, const Mesh_optimizer_options& options);
+
+  static Vertex_cache_statistics analyzeVertexCache(const Mesh_data& meshData, uint32_t cacheSize);
+  static Vertex_cache_statistics analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t cacheSize);
+
+  /*
+   * Returns the triangles of a triangle list in Tipsify order. If clusterStarts isn't null, it is set to the first
+   * triangle of each cluster, for optimizeOverdraw: a new cluster starts wherever Tipsify runs out of nearby triangles
+   * and restarts from an unvisited part of the mesh.
+   */
+  static std::vector<uint32_t> optimizeVertexCache(
+      const std::vector<uint32_t>& indices,
+      size_t vertexCount,
+      uint32_t cacheSize,
+      std::vector<uint32_t>* clusterStarts = nullptr);
+
+  /*
+   * Splits the clusters of a Tipsify ordered triangle list further, where that keeps their ACMR within threshold of the
+   * mesh's, then sorts them so that those facing away from the mesh's centroid are drawn first.
+   */
+  static std::vector<uint32_t> optimizeOverdraw(
+      const std::vector<uint32_t>& indices,
+      const std::vector<SSE::Vector3>& positions,
+      const std::vector<uint32_t>& clusterStarts,
+      uint32_t cacheSize,
+      float threshold);
+
+  // Returns the new index of each vertex: in the order the triangles first use them, followed by unused vertices.
+  static std::vector<uint32_t> optimizeVertexFetch(const std::vector<uint32_t>& indices, size_t vertexCount);
+};
+} // namespace oe
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+namespace oe {
+class Mesh_data;
+
+enum class Tex_coord_quantization {
+  // Left as 32 bit floats.
+  None,
+  // 16 bit floats; precise near zero, but coarser the further coordinates are from it, such as when they tile.
+  Half_float,
+  // 16 bit unsigned normalized integers within the bounds of the coordinates; even precision across that range.
+  Unorm16,
+};
+
+struct Mesh_quantizer_options {
+  // Stores positions as 16 bit unsigned normalized integers within the bounds of the mesh.
+  bool quantizePositions = true;
+  // Stores normals, tangents and bitangents as octahedral pairs of 16 bit signed normalized integers.
+  bool quantizeNormals = true;
+  Tex_coord_quantization texCoords = Tex_coord_quantization::Unorm16;
+};
+
+struct Mesh_quantizer_report {
+  // Size of the quantized vertex attributes, tightly packed, before and after.
+  size_t bytesBefore = 0;
+  size_t bytesAfter = 0;
+};
+
+/**
+ * Stores the float vertex attributes of a mesh in smaller encodings, that the input assembler and CPU side consumers
+ * decode (see Vertex_attribute_element::encoding). A vertex with a position, normal, tangent and texture coordinate
+ * shrinks from 48 bytes to 20.
+ *
+ * Positions are normalized within the bounds of the mesh, so their error is at most 1/131070 of its extent along each
+ * axis. Normals and tangents use the octahedral mapping of Cigolle et al, "A Survey of Efficient Representations for
+ * Independent Unit Vectors", whose error is well under 0.01 degrees at 16 bits per component; the handedness of
+ * tangents is kept in the lowest bit of the second component.
+ */
+class Mesh_quantizer {
+ public:
+  /*
+   * Quantizes the vertex attributes of meshData that options select, giving each a new, tightly packed buffer, so
+   * buffers shared with other meshes are left alone. Attributes that aren't float, or are already encoded, are left
+   * as they are, as are morph targets: their deltas are applied on the CPU, to decoded values.
+   */
+  static Mesh_quantizer_report quantize(Mesh_data& meshData, const Mesh_quantizer_options& options);
+};
+} // namespace oe
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vectormath.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace oe {
+class IJob_manager;
+class Mesh_data;
+struct Mesh_lod;
+
+struct Mesh_simplifier_options {
+  // Levels of detail to generate after the full resolution mesh.
+  size_t lodCount = 3;
+  // Each level aims for this fraction of the triangles of the level before it.
+  float reductionRatio = 0.5f;
+  // No level is generated with a larger error, relative to the radius of the mesh's bounds.
+  float maxError = 0.05f;
+};
+
+/**
+ * Builds simplified levels of detail of a mesh, by greedily collapsing the edges that move its surface the least, as
+ * measured by quadric error metrics (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics").
+ *
+ * Edges are only collapsed onto one of their vertices, so each level is a new index buffer over the original vertices:
+ * UVs, normals, skinning and morph targets all carry over, and every level can share the mesh's vertex buffers.
+ * Vertices whose position is shared with another vertex, such as either side of a UV or normal seam, never move, so
+ * seams stay closed. Vertices on the border of the mesh only move along it, and morph targets are simplified along with
+ * the base shape, so that the levels still match when they are applied.
+ */
+class Mesh_simplifier {
+ public:
+  /*
+   * Collapses edges of a triangle list until it has no more than targetIndexCount indices, or the next collapse would
+   * have an error over maxError. Returns the remaining triangles, which reference a subset of the same vertices.
+   * Each entry of morphedPositions is positions with one morph target fully applied. Errors are distances relative to
+   * the radius of the bounds of positions; if resultError isn't null, it is set to the largest error of a collapse.
+   */
+  static std::vector<uint32_t> simplify(
+      const std::vector<uint32_t>& indices,
+      const std::vector<SSE::Vector3>& positions,
+      const std::vector<std::vector<SSE::Vector3>>& morphedPositions,
+      size_t targetIndexCount,
+      float maxError,
+      float* resultError = nullptr);
+
+  /*
+   * Returns up to options.lodCount levels of detail of meshData, from finest to coarsest, each simplified from the one
+   * before. Each level shares meshData's vertex and morph target accessors, and has its own index buffer. Generation
+   * stops early once a level can't remove enough triangles within options.maxError. Meshes that aren't indexed
+   * triangle lists with Vector3 positions get no levels.
+   * Throws std::runtime_error if an index is out of range.
+   */
+  static std::vector<Mesh_lod> generateLods(const Mesh_data& meshData, const Mesh_simplifier_options& options);
+
+  // Generates the levels of detail of many meshes, in parallel across them.
+  static std::vector<std::vector<Mesh_lod>> generateLods(
+      const std::vector<std::shared_ptr<Mesh_data>>& meshes,
+      const Mesh_simplifier_options& options,
+      IJob_manager& jobManager);
+};
+} // namespace oe
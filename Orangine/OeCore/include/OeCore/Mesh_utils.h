@@ -15,6 +15,7 @@
 namespace oe {
 struct Mesh_buffer;
 struct Mesh_index_buffer_accessor;
+struct Mesh_vertex_buffer_accessor;
 class Entity_filter;
 class Entity;
 } // namespace oe
@@ -70,7 +71,29 @@ std::unique_ptr<Mesh_index_buffer_accessor> create_index_buffer(
     Element_component elementComponent,
     UINT sourceStride,
     UINT sourceOffset);
+// Writes indices into a new buffer of the given component, which must be wide enough to hold them.
+std::unique_ptr<Mesh_index_buffer_accessor> create_index_buffer(
+    const std::vector<uint32_t>& indices,
+    Element_component component);
 DXGI_FORMAT getDxgiFormat(Element_type type, Element_component component);
+// As above, but normalized and octahedral elements map to the UNORM/SNORM format that decodes their components.
+DXGI_FORMAT getDxgiFormat(const Vertex_attribute_element& element);
+// Size in bytes of one tightly packed element.
+size_t element_size(Element_type type, Element_component component);
+// Number of values an element holds once decoded; an octahedral pair decodes to a Vector3, or a Vector4 if signed.
+size_t decoded_component_count(const Vertex_attribute_element& element);
+
+/*
+ * Reads the element at idx of a vertex accessor of up to 4 components, decoding it by its component and encoding.
+ * Components that the element doesn't have are zero.
+ * Throws std::runtime_error for matrix elements, or encodings the element's type doesn't support.
+ */
+SSE::Vector4 read_vertex_element(const Mesh_vertex_buffer_accessor& accessor, size_t idx);
+// Encodes value into the element at idx of a vertex accessor, the inverse of read_vertex_element. Integer components
+// are rounded, and clamped to the range of the component or its normalized range.
+void write_vertex_element(Mesh_vertex_buffer_accessor& accessor, size_t idx, const SSE::Vector4& value);
+// Decodes the first three components of every element of a vertex accessor.
+std::vector<SSE::Vector3> read_vector3_elements(const Mesh_vertex_buffer_accessor& accessor);
 
 oe::BoundingOrientedBox aabbForEntities(
     const Entity_filter& entities,
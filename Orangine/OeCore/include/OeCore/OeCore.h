@@ -11,6 +11,7 @@
 #include <OeCore/IEntity_render_manager.h>
 #include <OeCore/IEntity_repository.h>
 #include <OeCore/IInput_manager.h>
+#include <OeCore/IJob_manager.h>
 #include <OeCore/ILighting_manager.h>
 #include <OeCore/IMaterial_manager.h>
 #include <OeCore/IRender_step_manager.h>
@@ -47,8 +48,9 @@ struct Manager_instances {
   using Managers_tuple = std::tuple<
           Manager_instance<IAnimation_manager>, Manager_instance<IAsset_manager>, Manager_instance<IBehavior_manager>,
           Manager_instance<IDev_tools_manager>, Manager_instance<IEntity_render_manager>,
-          Manager_instance<IInput_manager>, Manager_instance<ILighting_manager>, Manager_instance<IMaterial_manager>,
-          Manager_instance<IRender_step_manager>, Manager_instance<IScene_graph_manager>,
+          Manager_instance<IInput_manager>, Manager_instance<IJob_manager>, Manager_instance<ILighting_manager>,
+          Manager_instance<IMaterial_manager>, Manager_instance<IRender_step_manager>,
+          Manager_instance<IScene_graph_manager>,
           Manager_instance<IShadowmap_manager>, Manager_instance<ITexture_manager>,
           Manager_instance<ITime_step_manager>, Manager_instance<IUser_interface_manager>>;
   Managers_tuple managers;
@@ -4,6 +4,7 @@
 
 namespace oe {
 struct BoundingFrustumRH;
+class IJob_manager;
 class Mesh_data;
 struct Mesh_index_buffer_accessor;
 struct Mesh_vertex_buffer_accessor;
@@ -27,12 +28,17 @@ class Primitive_mesh_data_factory {
   static std::shared_ptr<Mesh_data> createAxisWidgetLines();
 
   /*
-   * Generates flat normals for the given triangles (ie, does not interpolate neighbours)
+   * Generates smooth normals for the given triangle list, writing one to each vertex of normalBufferAccessor. A vertex
+   * normal is the sum of the normals of the triangles that use it, each weighted by the triangle's area and by its
+   * interior angle at that vertex. Indices may be 8, 16 or 32 bit unsigned integers; positions and normals may be float
+   * or quantized, and are decoded and encoded by their Element_encoding. If a job manager is given, large meshes are
+   * processed in parallel; the result is the same either way.
    */
   static void generateNormals(
       const Mesh_index_buffer_accessor& indexBufferAccessor,
       const Mesh_vertex_buffer_accessor& positionBufferAccessor,
-      Mesh_vertex_buffer_accessor& normalBufferAccessor);
+      Mesh_vertex_buffer_accessor& normalBufferAccessor,
+      IJob_manager* jobManager = nullptr);
 
   /*
    * Generates tangents, in MikktSpace
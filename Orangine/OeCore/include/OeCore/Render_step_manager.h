@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <OeCore/Entity_sorter.h>
+#include <OeCore/IAnimation_manager.h>
 #include <OeCore/IRender_step_manager.h>
 #include <OeCore/IScene_graph_manager.h>
 #include <OeCore/IDev_tools_manager.h>
@@ -44,7 +45,8 @@ class Render_step_manager : public IRender_step_manager, public Manager_base, pu
   Render_step_manager(
           IScene_graph_manager& sceneGraphManager, IDev_tools_manager& devToolsManager,
           ITexture_manager& textureManager, IShadowmap_manager& shadowmapManager,
-          IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager);
+          IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager,
+          IAnimation_manager& animationManager);
 
   // pure virtual method interface
   virtual void clearRenderTargetView(const Color& color) = 0;
@@ -94,8 +96,7 @@ class Render_step_manager : public IRender_step_manager, public Manager_base, pu
   std::unique_ptr<Entity_alpha_sorter> _alphaSorter;
   std::unique_ptr<Entity_cull_sorter> _cullSorter;
 
-  // Entities
-  std::shared_ptr<Entity_filter> _renderableEntities;
+  // Entities. Renderables are found by streaming through the Renderable_component pool.
   std::shared_ptr<Entity_filter> _lightEntities;
   std::shared_ptr<Entity> _cameraEntity;
 
@@ -113,5 +114,6 @@ class Render_step_manager : public IRender_step_manager, public Manager_base, pu
   IShadowmap_manager& _shadowmapManager;
   IEntity_render_manager& _entityRenderManager;
   ILighting_manager& _lightingManager;
+  IAnimation_manager& _animationManager;
 };
 } // namespace oe
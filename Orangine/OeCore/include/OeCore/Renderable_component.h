@@ -5,6 +5,8 @@
 #include "Material_context.h"
 #include "Renderer_data.h"
 
+#include <vector>
+
 namespace oe {
 class Renderable_component : public Component {
   DECLARE_COMPONENT_TYPE;
@@ -26,9 +28,15 @@ class Renderable_component : public Component {
   const std::shared_ptr<Material>& material() const { return _material; }
   void setMaterial(std::shared_ptr<Material> material) { _material = material; }
 
-  const std::weak_ptr<Renderer_data>& rendererData() const { return _rendererData; }
-  void setRendererData(std::weak_ptr<Renderer_data>&& rendererData) {
-    _rendererData = std::move(rendererData);
+  // One per level of detail of the entity's Mesh_data_component, where 0 is the full resolution mesh.
+  std::weak_ptr<Renderer_data> rendererData(size_t lod = 0) const {
+    return lod < _rendererData.size() ? _rendererData[lod] : std::weak_ptr<Renderer_data>();
+  }
+  void setRendererData(std::weak_ptr<Renderer_data>&& rendererData, size_t lod = 0) {
+    if (lod >= _rendererData.size()) {
+      _rendererData.resize(lod + 1);
+    }
+    _rendererData[lod] = std::move(rendererData);
   }
 
   const std::weak_ptr<Material_context>& materialContext() const { return _materialContext; }
@@ -44,7 +52,7 @@ class Renderable_component : public Component {
   END_COMPONENT_PROPERTIES();
 
   // Runtime, non-serializable
-  std::weak_ptr<Renderer_data> _rendererData;
+  std::vector<std::weak_ptr<Renderer_data>> _rendererData;
   std::weak_ptr<Material_context> _materialContext;
   std::shared_ptr<Material> _material;
 };
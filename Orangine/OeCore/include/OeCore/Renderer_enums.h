@@ -168,12 +168,25 @@ enum class Element_component {
   Signed_int,
   Unsigned_int,
   Float,
+  Half_float,
 
-  Num_element_component = 7,
+  Num_element_component = 8,
 };
 const std::string& elementComponentToString(Element_component enumValue);
 Element_component stringToElementComponent(const std::string& str);
 
+// Element_encoding
+enum class Element_encoding {
+  None = 0,
+  Normalized,
+  Octahedral,
+  Octahedral_signed,
+
+  Num_element_encoding = 4,
+};
+const std::string& elementEncodingToString(Element_encoding enumValue);
+Element_encoding stringToElementEncoding(const std::string& str);
+
 // Debug_display_mode
 enum class Debug_display_mode {
   None = 0,
@@ -32,6 +32,10 @@ struct Vertex_attribute_element {
   Vertex_attribute_semantic semantic;
   Element_type type;
   Element_component component;
+  // How the stored components map to the attribute's values. Normalized integers map to [0, 1] or [-1, 1], then the
+  // accessor's decode scale and offset are applied. Octahedral elements are a pair of signed normalized components
+  // that map to a unit Vector3; signed ones keep the sign of a fourth component in the lowest bit of the second.
+  Element_encoding encoding = Element_encoding::None;
 };
 
 struct Sampler_descriptor {
@@ -4,6 +4,16 @@
 namespace oe {
 class Entity;
 
+/**
+ * Bone transforms for the skinning shader, one per joint: the joint's transform relative to the skeleton transform
+ * root, multiplied by its inverse bind matrix.
+ */
+struct Skinning_palette {
+  std::vector<SSE::Matrix4> boneTransforms;
+  // The pass that boneTransforms was last computed in. Used to compute shared palettes only once.
+  uint64_t updateIndex = UINT64_MAX;
+};
+
 class Skinned_mesh_component : public Component {
   DECLARE_COMPONENT_TYPE;
 
@@ -11,7 +21,7 @@ class Skinned_mesh_component : public Component {
   explicit Skinned_mesh_component(Entity& entity) : Component(entity) {}
 
   const std::shared_ptr<Entity>& skeletonTransformRoot() const { return _skeletonTransformRoot; }
-  void setSkeletonTransformRoot(std::shared_ptr<Entity> root) { _skeletonTransformRoot = root; }
+  void setSkeletonTransformRoot(std::shared_ptr<Entity> root);
 
   const std::vector<Entity*>& joints() const { return _jointsRaw; }
   void setJoints(std::vector<std::shared_ptr<Entity>>&& vector);
@@ -19,7 +29,22 @@ class Skinned_mesh_component : public Component {
   const std::vector<SSE::Matrix4>& inverseBindMatrices() const { return _inverseBindMatrices; }
   void setInverseBindMatrices(std::vector<SSE::Matrix4>&& matrices);
 
+  // Computed once per frame by IAnimation_manager::updateSkinningPalettes, and shared by every render pass.
+  const Skinning_palette& skinningPalette() const { return *_skinningPalette; }
+  Skinning_palette& skinningPalette() { return *_skinningPalette; }
+
+  /**
+   * Uses the palette of other, rather than computing one for this mesh. Both must have the same joints, inverse bind
+   * matrices and skeleton transform root. Changing any of those stops the palette being shared.
+   */
+  void shareSkinningPalette(const Skinned_mesh_component& other);
+
+  // Recomputes the palette from the current world transforms of the joints and skeleton transform root.
+  void updateSkinningPalette();
+
  private:
+  void unshareSkinningPalette();
+
   BEGIN_COMPONENT_PROPERTIES();
   END_COMPONENT_PROPERTIES();
 
@@ -33,5 +58,7 @@ class Skinned_mesh_component : public Component {
   std::vector<Entity*> _jointsRaw;
 
   std::vector<SSE::Matrix4> _inverseBindMatrices;
+
+  std::shared_ptr<Skinning_palette> _skinningPalette = std::make_shared<Skinning_palette>();
 };
 } // namespace oe
@@ -1,9 +1,129 @@
 #include "OeCore/Animation_controller_component.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 using namespace oe;
 
 DEFINE_COMPONENT_TYPE(Animation_controller_component);
 
+namespace {
+using Animation_channel = Animation_controller_component::Animation_channel;
+
+template <class TComponent> TComponent readComponent(const uint8_t* data)
+{
+  TComponent value;
+  std::memcpy(&value, data, sizeof(TComponent));
+  return value;
+}
+
+// Reads a single component of a keyframe value, converting normalized integers to float as described by the glTF
+// specification.
+float readKeyframeComponent(const uint8_t* data, Element_component component)
+{
+  switch (component) {
+  case Element_component::Float:
+    return readComponent<float>(data);
+  case Element_component::Signed_byte:
+    return std::max(static_cast<float>(readComponent<int8_t>(data)) / 127.0f, -1.0f);
+  case Element_component::Unsigned_byte:
+    return static_cast<float>(readComponent<uint8_t>(data)) / 255.0f;
+  case Element_component::Signed_short:
+    return std::max(static_cast<float>(readComponent<int16_t>(data)) / 32767.0f, -1.0f);
+  case Element_component::Unsigned_short:
+    return static_cast<float>(readComponent<uint16_t>(data)) / 65535.0f;
+  default:
+    OE_THROW(std::runtime_error(
+        "Unsupported animation keyframe value component: " + elementComponentToString(component)));
+  }
+}
+
+size_t keyframeComponentSize(Element_component component)
+{
+  switch (component) {
+  case Element_component::Signed_byte:
+  case Element_component::Unsigned_byte:
+    return 1;
+  case Element_component::Signed_short:
+  case Element_component::Unsigned_short:
+    return 2;
+  default:
+    return 4;
+  }
+}
+
+template <class TValue> TValue readKeyframeValue(const Animation_channel& channel, size_t index);
+
+template <> float readKeyframeValue(const Animation_channel& channel, size_t index)
+{
+  return readKeyframeComponent(channel.keyframeValues->getIndexed(index), channel.keyframeValueComponent);
+}
+
+template <> SSE::Vector3 readKeyframeValue(const Animation_channel& channel, size_t index)
+{
+  const auto data = channel.keyframeValues->getIndexed(index);
+  const auto component = channel.keyframeValueComponent;
+  const auto componentSize = keyframeComponentSize(component);
+  return SSE::Vector3(
+      readKeyframeComponent(data, component),
+      readKeyframeComponent(data + componentSize, component),
+      readKeyframeComponent(data + 2 * componentSize, component));
+}
+
+template <> SSE::Quat readKeyframeValue(const Animation_channel& channel, size_t index)
+{
+  const auto data = channel.keyframeValues->getIndexed(index);
+  const auto component = channel.keyframeValueComponent;
+  const auto componentSize = keyframeComponentSize(component);
+  return SSE::Quat(
+      readKeyframeComponent(data, component),
+      readKeyframeComponent(data + componentSize, component),
+      readKeyframeComponent(data + 2 * componentSize, component),
+      readKeyframeComponent(data + 3 * componentSize, component));
+}
+
+// valueCount is the number of values per keyframe; 1, except for morph weights.
+template <class TValue>
+void decodeKeyframes(
+    const Animation_channel& channel,
+    size_t valueCount,
+    Animation_controller_component::Keyframe_values<TValue>& keyframes)
+{
+  const auto& keyframeTimes = *channel.keyframeTimes;
+  const auto keyframeCount = keyframeTimes.size();
+  keyframes.values.resize(keyframeCount * valueCount);
+  keyframes.inTangents.clear();
+  keyframes.outTangents.clear();
+
+  if (channel.interpolationType != Animation_interpolation::Cubic_spline) {
+    for (size_t idx = 0; idx < keyframes.values.size(); ++idx) {
+      keyframes.values[idx] = readKeyframeValue<TValue>(channel, idx);
+    }
+    return;
+  }
+
+  // Each cubic spline keyframe is stored as valueCount in-tangents, then valueCount values, then valueCount
+  // out-tangents.
+  keyframes.inTangents.resize(keyframes.values.size());
+  keyframes.outTangents.resize(keyframes.values.size());
+  for (size_t keyframeIdx = 0; keyframeIdx < keyframeCount; ++keyframeIdx) {
+    const auto inDuration = keyframeIdx > 0 ? keyframeTimes[keyframeIdx] - keyframeTimes[keyframeIdx - 1] : 0.0f;
+    const auto outDuration =
+        keyframeIdx + 1 < keyframeCount ? keyframeTimes[keyframeIdx + 1] - keyframeTimes[keyframeIdx] : 0.0f;
+    const auto sourceIdx = keyframeIdx * valueCount * 3;
+
+    for (size_t valueIdx = 0; valueIdx < valueCount; ++valueIdx) {
+      const auto idx = keyframeIdx * valueCount + valueIdx;
+      keyframes.inTangents[idx] = inDuration * readKeyframeValue<TValue>(channel, sourceIdx + valueIdx);
+      keyframes.values[idx] = readKeyframeValue<TValue>(channel, sourceIdx + valueCount + valueIdx);
+      keyframes.outTangents[idx] =
+          outDuration * readKeyframeValue<TValue>(channel, sourceIdx + 2 * valueCount + valueIdx);
+    }
+  }
+}
+} // namespace
+
 void Animation_controller_component::addAnimation(
     const std::string& animationName,
     std::unique_ptr<Animation> animation) {
@@ -34,12 +154,79 @@ void Animation_controller_component::addAnimation(
           std::to_string(channel->keyframeValues->count / channel->keyframeTimes->size())));
     }
 
-    // TODO: Assert that the accessor format is as expected for the type?
+    decodeKeyframeValues(*channel);
   }
 
   _nameToAnimation[animationName] = std::move(animation);
 }
 
+void Animation_controller_component::decodeKeyframeValues(Animation_channel& channel)
+{
+  switch (channel.animationType) {
+  case Animation_type::Translation:
+  case Animation_type::Scale:
+    decodeKeyframes(channel, 1, channel.vector3Keyframes);
+    break;
+  case Animation_type::Rotation:
+    decodeKeyframes(channel, 1, channel.rotationKeyframes);
+    break;
+  case Animation_type::Morph: {
+    const auto valuesPerWeight = channel.interpolationType == Animation_interpolation::Cubic_spline ? 3 : 1;
+    if (channel.valuesPerKeyFrame % valuesPerWeight != 0) {
+      OE_THROW(std::runtime_error("Morph animation channel has an incomplete set of cubic spline values"));
+    }
+    channel.morphTargetCount = static_cast<uint8_t>(channel.valuesPerKeyFrame / valuesPerWeight);
+    decodeKeyframes(channel, channel.morphTargetCount, channel.morphWeightKeyframes);
+    break;
+  }
+  default:
+    OE_THROW(std::logic_error("Unsupported animation type"));
+  }
+}
+
+void Animation_controller_component::playAnimation(const std::string& animationName)
+{
+  const auto& animation = animationByName(animationName);
+  auto& states = activeAnimations[animationName];
+  if (states.size() != animation->channels.size()) {
+    states.assign(animation->channels.size(), {});
+  }
+}
+
+void Animation_controller_component::fadeAnimation(const std::string& animationName, float targetWeight, double duration)
+{
+  auto& blend = animationBlend(animationName);
+  blend.targetWeight = targetWeight;
+  if (duration > 0.0) {
+    blend.fadeRate = static_cast<float>(std::abs(targetWeight - blend.weight) / duration);
+  } else {
+    blend.weight = targetWeight;
+    blend.fadeRate = 0.0f;
+  }
+}
+
+void Animation_controller_component::crossFade(const std::string& animationName, double duration)
+{
+  const auto wasActive = activeAnimations.find(animationName) != activeAnimations.end();
+  playAnimation(animationName);
+
+  auto& blend = animationBlend(animationName);
+  if (!wasActive) {
+    blend.weight = 0.0f;
+  }
+  fadeAnimation(animationName, 1.0f, duration);
+
+  for (const auto& activeAnimation : activeAnimations) {
+    if (activeAnimation.first == animationName) {
+      continue;
+    }
+    const auto& otherBlend = animationBlend(activeAnimation.first);
+    if (otherBlend.layer == blend.layer && otherBlend.mode == blend.mode) {
+      fadeAnimation(activeAnimation.first, 0.0f, duration);
+    }
+  }
+}
+
 const std::unique_ptr<Animation_controller_component::Animation>&
 Animation_controller_component::animationByName(const std::string& animationName) {
   const auto pos = _nameToAnimation.find(animationName);
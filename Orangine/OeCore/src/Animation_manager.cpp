@@ -2,465 +2,665 @@
 
 #include "OeCore/Animation_controller_component.h"
 #include "OeCore/Morph_weights_component.h"
+#include "OeCore/Skinned_mesh_component.h"
 
 #include <algorithm>
+#include <cstring>
 
 using namespace oe;
 using namespace DirectX;
 
 std::string Animation_manager::_name = "Animation_manager";
 
+// Number of keyframes to step forward from a channel's cursor, before falling back to a binary search.
+constexpr uint32_t g_maxKeyframeCursorSteps = 4;
+
 template<>
-void oe::create_manager(Manager_instance<IAnimation_manager>& out, IScene_graph_manager& scene_graph_manager, ITime_step_manager& timeStepManager)
+void oe::create_manager(
+        Manager_instance<IAnimation_manager>& out, IScene_graph_manager& scene_graph_manager,
+        ITime_step_manager& timeStepManager, IJob_manager& jobManager)
 {
-  out = Manager_instance<IAnimation_manager>(std::make_unique<Animation_manager>(scene_graph_manager, timeStepManager));
+  out = Manager_instance<IAnimation_manager>(
+          std::make_unique<Animation_manager>(scene_graph_manager, timeStepManager, jobManager));
 }
 
-const std::array<
-    std::function<void(
-        Entity&,
-        const Animation_controller_component::Animation_channel& channel,
-        uint32_t lowerValueIndex,
-        uint32_t upperValueIndex,
-        double factor)>,
-    4>
-    g_lerp_animation_type_handlers = {
-        &Animation_manager::handleTranslationAnimationLerp,
-        &Animation_manager::handleRotationAnimationLerp,
-        &Animation_manager::handleScaleAnimationLerp,
-        &Animation_manager::handleMorphAnimationLerp,
-};
-
-const std::array<
-    std::function<void(
-        Entity&,
-        const Animation_controller_component::Animation_channel& channel,
-        uint32_t lowerValueIndex)>,
-    4>
-    g_step_animation_type_handlers = {
-        &Animation_manager::handleTranslationAnimationStep,
-        &Animation_manager::handleRotationAnimationStep,
-        &Animation_manager::handleScaleAnimationStep,
-        &Animation_manager::handleMorphAnimationStep,
-};
-
-const std::array<
-    std::function<void(
-        Entity&,
-        const Animation_controller_component::Animation_channel& channel,
-        uint32_t lowerValueIndex,
-        uint32_t upperValueIndex,
-        double factor)>,
-    4>
-    g_cubic_spline_animation_type_handlers = {
-        &Animation_manager::handleTranslationAnimationCubicSpline,
-        &Animation_manager::handleRotationAnimationCubicSpline,
-        &Animation_manager::handleScaleAnimationCubicSpline,
-        &Animation_manager::handleMorphAnimationCubicSpline,
-};
-
-void Animation_manager::initialize()
+void Animation_manager::initialize() {}
+
+void Animation_manager::shutdown()
 {
-  _animationControllers = _sceneGraphManager.getEntityFilter(
-      {Animation_controller_component::type()});
+  _controllerUpdates.clear();
+  _workspaces.clear();
+  _sampledPoseHistories.clear();
+  _skinnedMeshUpdates.clear();
 }
 
-void Animation_manager::shutdown() { _animationControllers = nullptr; }
-
 const std::string& Animation_manager::name() const { return _name; }
 
-void Animation_manager::tick()
+void Animation_manager::setViewFrustum(const BoundingFrustumRH& frustum)
 {
-  const auto deltaTime = _timeStepManager.getDeltaTime();
-  for (const auto entity : *_animationControllers) {
-    const auto animComponent = entity->getFirstComponentOfType<Animation_controller_component>();
-    assert(animComponent);
-
-    for (auto& activeAnimation : animComponent->activeAnimations) {
-      const auto& name = activeAnimation.first;
-      auto& channelStates = activeAnimation.second;
+  _viewFrustum = frustum;
+  _hasViewFrustum = true;
+}
 
-      const auto& animation = animComponent->animationByName(name);
-      if (!animation) {
-        LOG(WARNING) << "Missing animation with name: " << name;
-        continue;
-      }
+void Animation_manager::updateSkinningPalettes()
+{
+  ++_skinningUpdateIndex;
+  _skinnedMeshUpdates.clear();
+
+  // Meshes that share a skeleton share a palette; only the first of them computes it. The pool holds the meshes of
+  // every scene graph, so skip those of others.
+  Skinned_mesh_component::componentPool().forEachSpan<Skinned_mesh_component>(
+      [this](const Component_span<Skinned_mesh_component>& skinnedMeshComponents) {
+        for (auto& skinnedMeshComponent : skinnedMeshComponents) {
+          const auto& entity = skinnedMeshComponent.getEntity();
+          if (!entity.belongsTo(_sceneGraphManager) || entity.getState() != Entity_state::Ready) {
+            continue;
+          }
 
-      auto numComplete = 0u;
-      for (size_t channelIdx = 0; channelIdx < animation->channels.size(); ++channelIdx) {
-        const auto& animationChannel = animation->channels[channelIdx];
+          auto& palette = skinnedMeshComponent.skinningPalette();
+          if (palette.updateIndex != _skinningUpdateIndex) {
+            palette.updateIndex = _skinningUpdateIndex;
+            _skinnedMeshUpdates.push_back(&skinnedMeshComponent);
+          }
+        }
+      });
+
+  // Palettes only read world transforms, and each is written by a single mesh, so they can be computed concurrently.
+  const auto meshCount = _skinnedMeshUpdates.size();
+  const auto grainSize = std::max<size_t>(1, meshCount / (static_cast<size_t>(_jobManager.workerCount()) * 4));
+  _jobManager.parallelFor(meshCount, grainSize, [this](size_t begin, size_t end) {
+    for (auto meshIdx = begin; meshIdx < end; ++meshIdx) {
+      _skinnedMeshUpdates[meshIdx]->updateSkinningPalette();
+    }
+  });
+}
 
-        if (channelIdx >= channelStates.size())
-          continue;
+Animation_manager::Update_rate Animation_manager::controllerUpdateRate(
+    const Animation_controller_component& animComponent,
+    const BoundingFrustumRH& viewFrustum)
+{
+  const auto& entity = animComponent.getEntity();
+  const auto& policy = animComponent.updatePolicy;
+  // Entities without bounds transform to a point at their world position.
+  const auto bounds = entity.worldBoundSphere();
+  const auto& center = bounds.center;
+
+  if (policy.pauseWhenCulled) {
+    const auto cullSphere = BoundingSphere(center, std::max(bounds.radius, policy.minCullRadius));
+    if (viewFrustum.Contains(cullSphere) == DirectX::DISJOINT) {
+      return Update_rate::Paused;
+    }
+  }
 
-        auto& state = channelStates[channelIdx];
-        if (!state.playing)
-          continue;
+  const auto distanceSq = SSE::lengthSqr(center - viewFrustum.origin);
+  if (policy.reducedRateInterval > 1 && distanceSq > policy.fullRateDistance * policy.fullRateDistance) {
+    return Update_rate::Reduced;
+  }
+  return Update_rate::Full;
+}
 
-        const auto& keyframeTimes = *animationChannel->keyframeTimes;
-        // We can assert this, as the channels are validated upon adding to the component.
-        assert(!keyframeTimes.empty());
+void Animation_manager::tick()
+{
+  const auto deltaTime = _timeStepManager.getDeltaTime();
 
-        unsigned minIndex, maxIndex = 0;
-        // TODO: Looping over here is a pretty brute force way for working out which animation key
-        // to use. Could store last used minIndex somewhere? How to deal with someone else modifying
-        // currentTime?
-        for (; maxIndex < keyframeTimes.size(); ++maxIndex) {
-          if (keyframeTimes[maxIndex] > state.currentTime)
-            break;
-        }
+  _stats = {};
+  _controllerUpdates.clear();
+  ++_frameIndex;
+
+  // Decide which controllers to update. Stream through the packed controller components, rather than looking each one
+  // up from its entity. The pool holds the controllers of every scene graph, each advanced by its own time step.
+  Animation_controller_component::componentPool().forEachSpan<Animation_controller_component>(
+      [this, deltaTime](const Component_span<Animation_controller_component>& animComponents) {
+        for (auto& animComponent : animComponents) {
+          const auto& entity = animComponent.getEntity();
+          if (!entity.belongsTo(_sceneGraphManager) || entity.getState() != Entity_state::Ready) {
+            continue;
+          }
 
-        if (maxIndex == 0) {
-          // Will reach this point if currentTime has not yet reached the beginning of animation.
-          minIndex = 0;
-        } else if (maxIndex == keyframeTimes.size()) {
-          // Reach this point if current time is greater than the end of the animation
-          if (keyframeTimes.size() > 1) {
-            --maxIndex;
-            minIndex = maxIndex - 1;
+          animComponent.pendingTime += deltaTime;
+
+          auto update = true;
+          auto interpolationInterval = 0u;
+          if (_hasViewFrustum) {
+            switch (controllerUpdateRate(animComponent, _viewFrustum)) {
+            case Update_rate::Full:
+              ++_stats.fullRateControllers;
+              break;
+            case Update_rate::Reduced: {
+              ++_stats.reducedRateControllers;
+              // Offset by the entity ID, so that throttled controllers don't all update on the same frame.
+              const auto interval = animComponent.updatePolicy.reducedRateInterval;
+              update = (_frameIndex + entity.getId()) % interval == 0;
+              interpolationInterval = interval;
+              break;
+            }
+            case Update_rate::Paused:
+              ++_stats.pausedControllers;
+              update = false;
+              break;
+            }
           } else {
-            maxIndex = minIndex = 0;
+            ++_stats.fullRateControllers;
           }
-          ++numComplete;
-        } else {
-          // Normal case; at a valid point in an animation with >= 2 keyframes
-          assert(keyframeTimes.size() > 1);
-          minIndex = maxIndex - 1;
-        }
 
-        const auto duration = keyframeTimes[maxIndex] - keyframeTimes[minIndex];
-        const auto factor =
-            duration > 0 ? std::min(1.0, (state.currentTime - keyframeTimes[minIndex]) / duration)
-                         : 0.0;
-        auto animatedEntity = animationChannel->targetNode ? animationChannel->targetNode : entity;
-
-        switch (animationChannel->interpolationType) {
-        case Animation_interpolation::Linear: {
-          const auto& fn = g_lerp_animation_type_handlers[static_cast<unsigned>(
-              animationChannel->animationType)];
-          fn(*animatedEntity, *animationChannel, minIndex, maxIndex, factor);
-          break;
-        }
-        case Animation_interpolation::Step: {
-          const auto& fn = g_step_animation_type_handlers[static_cast<unsigned>(
-              animationChannel->animationType)];
-          fn(*animatedEntity, *animationChannel, minIndex);
-          break;
-        }
-        case Animation_interpolation::Cubic_spline: {
-          const auto& fn = g_cubic_spline_animation_type_handlers[static_cast<unsigned>(
-              animationChannel->animationType)];
-          fn(*animatedEntity, *animationChannel, minIndex, maxIndex, factor);
-          break;
-        }
-        default:
-          OE_THROW(std::logic_error("Unsupported animation interpolation type"));
+          if (update) {
+            // Advance by all the time since the last update, so playback stays in step with the full rate.
+            _controllerUpdates.push_back({&animComponent, animComponent.pendingTime, interpolationInterval});
+            animComponent.pendingTime = 0.0;
+          } else {
+            for (const auto& activeAnimation : animComponent.activeAnimations) {
+              _stats.skippedChannels += static_cast<uint32_t>(activeAnimation.second.size());
+            }
+          }
         }
+      });
 
-        state.currentTime += deltaTime * state.speed;
+  // Controllers are independent of each other, so chunks of them can be sampled and blended concurrently.
+  const auto workspaceCount = (_controllerUpdates.size() + controllers_per_workspace - 1) / controllers_per_workspace;
+  if (_workspaces.size() < workspaceCount) {
+    _workspaces.resize(workspaceCount);
+  }
+  _jobManager.parallelFor(workspaceCount, 1, [this](size_t begin, size_t end) {
+    for (auto workspaceIdx = begin; workspaceIdx < end; ++workspaceIdx) {
+      auto& workspace = _workspaces[workspaceIdx];
+      for (auto& samples : workspace.sampleBatches) {
+        samples.clear();
       }
 
-      if (numComplete == animation->channels.size()) {
-        for (size_t channelIdx = 0; channelIdx < channelStates.size(); ++channelIdx)
-          channelStates[channelIdx].currentTime = 0;
+      const auto firstUpdate = workspaceIdx * controllers_per_workspace;
+      const auto lastUpdate = std::min(firstUpdate + controllers_per_workspace, _controllerUpdates.size());
+      for (auto updateIdx = firstUpdate; updateIdx < lastUpdate; ++updateIdx) {
+        tickAnimationController(workspace, _controllerUpdates[updateIdx]);
       }
+
+      sampleBatches(workspace);
+      blendLocalPoses(workspace);
+    }
+  });
+
+  // Merge, in controller order, so that the result is the same for any number of workers. Where two controllers animate
+  // the same entity, the later one wins.
+  for (size_t workspaceIdx = 0; workspaceIdx < workspaceCount; ++workspaceIdx) {
+    const auto& workspace = _workspaces[workspaceIdx];
+    for (const auto& samples : workspace.sampleBatches) {
+      _stats.sampledChannels += static_cast<uint32_t>(samples.size());
     }
+    writeLocalPoses(workspace);
   }
+  writeInterpolatedPoses();
 }
 
-template <class TTypeIn, class TTypeOut> void convertSplineElement(const TTypeIn& in, TTypeOut& out)
+void Animation_manager::tickAnimationController(Animation_workspace& workspace, const Controller_update& controllerUpdate)
 {
-}
+  auto& animComponent = *controllerUpdate.animComponent;
+  const auto deltaTime = controllerUpdate.deltaTime;
+  auto& entity = animComponent.getEntity();
+  for (auto& activeAnimation : animComponent.activeAnimations) {
+    const auto& name = activeAnimation.first;
+    auto& channelStates = activeAnimation.second;
+
+    const auto& animation = animComponent.animationByName(name);
+    if (!animation) {
+      LOG(WARNING) << "Missing animation with name: " << name;
+      continue;
+    }
 
-template <> void convertSplineElement(const Float3& in, SSE::Vector3& out)
-{
-  out = SSE::Vector3(in.x, in.y, in.z);
-}
-template <> void convertSplineElement(const Float4& in, SSE::Vector4& out)
-{
-  out = SSE::Vector4(in.x, in.y, in.z, in.w);
-}
-template <> void convertSplineElement(const Float4& in, SSE::Quat& out)
-{
-  out = SSE::Quat(in.x, in.y, in.z, in.w);
-}
+    auto blend = Animation_controller_component::Animation_blend();
+    const auto blendPos = animComponent.animationBlends.find(name);
+    if (blendPos != animComponent.animationBlends.end()) {
+      // Advance any fade in progress.
+      auto& fadingBlend = blendPos->second;
+      if (fadingBlend.weight != fadingBlend.targetWeight) {
+        const auto step = static_cast<float>(fadingBlend.fadeRate * deltaTime);
+        fadingBlend.weight = fadingBlend.weight < fadingBlend.targetWeight
+                                 ? std::min(fadingBlend.weight + step, fadingBlend.targetWeight)
+                                 : std::max(fadingBlend.weight - step, fadingBlend.targetWeight);
+      }
+      blend = fadingBlend;
+    }
+    // Animations that have faded out still advance, but aren't sampled.
+    const auto sampled = blend.weight > 0.0f;
+    const auto additive = blend.mode == Animation_controller_component::Blend_mode::Additive;
 
-template <class TTypeIn, class TTypeOut>
-const TTypeOut getKeyframeValue(
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t index)
-{
-  auto val = reinterpret_cast<const TTypeIn*>(channel.keyframeValues->getIndexed(index))[0];
-  TTypeOut outVal;
-  convertSplineElement(val, outVal);
-  return outVal;
-}
+    auto numComplete = 0u;
+    for (size_t channelIdx = 0; channelIdx < animation->channels.size(); ++channelIdx) {
+      const auto& animationChannel = animation->channels[channelIdx];
 
-const float getKeyframeValueFloat(
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t index)
-{
-  return reinterpret_cast<const float*>(channel.keyframeValues->getIndexed(index))[0];
-}
+      if (channelIdx >= channelStates.size())
+        continue;
 
-void Animation_manager::handleTranslationAnimationStep(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex)
-{
-  entity.setPosition(getKeyframeValue<Float3, SSE::Vector3>(channel, lowerValueIndex));
+      auto& state = channelStates[channelIdx];
+      if (!state.playing)
+        continue;
+
+      const auto& keyframeTimes = *animationChannel->keyframeTimes;
+      // We can assert this, as the channels are validated upon adding to the component.
+      assert(!keyframeTimes.empty());
+
+      unsigned minIndex, maxIndex = findNextKeyframe(keyframeTimes, state.currentTime, state.keyframeCursor);
+      state.keyframeCursor = maxIndex;
+
+      if (maxIndex == 0) {
+        // Will reach this point if currentTime has not yet reached the beginning of animation.
+        minIndex = 0;
+      } else if (maxIndex == keyframeTimes.size()) {
+        // Reach this point if current time is greater than the end of the animation
+        if (keyframeTimes.size() > 1) {
+          --maxIndex;
+          minIndex = maxIndex - 1;
+        } else {
+          maxIndex = minIndex = 0;
+        }
+        ++numComplete;
+      } else {
+        // Normal case; at a valid point in an animation with >= 2 keyframes
+        assert(keyframeTimes.size() > 1);
+        minIndex = maxIndex - 1;
+      }
+
+      const auto duration = keyframeTimes[maxIndex] - keyframeTimes[minIndex];
+      const auto factor =
+          duration > 0 ? std::min(1.0, (state.currentTime - keyframeTimes[minIndex]) / duration)
+                       : 0.0;
+      auto& animatedEntity = animationChannel->targetNode ? *animationChannel->targetNode : entity;
+
+      if (sampled) {
+        const auto batchIdx =
+            static_cast<size_t>(animationChannel->animationType) *
+                static_cast<size_t>(Animation_interpolation::Num_animation_interpolation) +
+            static_cast<size_t>(animationChannel->interpolationType);
+        assert(batchIdx < workspace.sampleBatches.size());
+        workspace.sampleBatches[batchIdx].push_back(
+            {animationChannel.get(),
+             &animatedEntity,
+             minIndex,
+             maxIndex,
+             static_cast<float>(factor),
+             blend.weight,
+             blend.layer,
+             additive,
+             controllerUpdate.interpolationInterval});
+      }
+
+      state.currentTime += deltaTime * state.speed;
+    }
+
+    if (numComplete == animation->channels.size()) {
+      for (size_t channelIdx = 0; channelIdx < channelStates.size(); ++channelIdx)
+        channelStates[channelIdx].currentTime = 0;
+    }
+  }
 }
 
-void Animation_manager::handleScaleAnimationStep(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex)
+uint32_t Animation_manager::findNextKeyframe(const std::vector<float>& keyframeTimes, double time, uint32_t cursor)
 {
-  entity.setScale(getKeyframeValue<Float3, SSE::Vector3>(channel, lowerValueIndex));
+  const auto keyframeCount = static_cast<uint32_t>(keyframeTimes.size());
+  cursor = std::min(cursor, keyframeCount);
+
+  // The cursor is only a valid starting point if time hasn't moved backwards past the previous keyframe.
+  if (cursor == 0 || keyframeTimes[cursor - 1] <= time) {
+    const auto stepEnd = std::min(cursor + g_maxKeyframeCursorSteps, keyframeCount);
+    for (; cursor < stepEnd; ++cursor) {
+      if (keyframeTimes[cursor] > time) {
+        return cursor;
+      }
+    }
+    if (cursor == keyframeCount) {
+      return cursor;
+    }
+
+    const auto pos = std::upper_bound(keyframeTimes.begin() + cursor, keyframeTimes.end(), time);
+    return static_cast<uint32_t>(pos - keyframeTimes.begin());
+  }
+
+  const auto pos = std::upper_bound(keyframeTimes.begin(), keyframeTimes.begin() + cursor, time);
+  return static_cast<uint32_t>(pos - keyframeTimes.begin());
 }
 
-void Animation_manager::handleRotationAnimationStep(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex)
+void Animation_manager::sampleBatches(Animation_workspace& workspace)
 {
-  entity.setRotation(getKeyframeValue<Float4, SSE::Quat>(channel, lowerValueIndex));
+  constexpr auto interpolationCount = static_cast<size_t>(Animation_interpolation::Num_animation_interpolation);
+  for (size_t batchIdx = 0; batchIdx < workspace.sampleBatches.size(); ++batchIdx) {
+    const auto& samples = workspace.sampleBatches[batchIdx];
+    if (samples.empty()) {
+      continue;
+    }
+
+    const auto animationType = static_cast<Animation_type>(batchIdx / interpolationCount);
+    const auto interpolation = static_cast<Animation_interpolation>(batchIdx % interpolationCount);
+    switch (animationType) {
+    case Animation_type::Translation:
+    case Animation_type::Scale:
+      sampleVector3Batch(samples, interpolation, workspace.vector3Results[batchIdx]);
+      break;
+    case Animation_type::Rotation:
+      sampleRotationBatch(samples, interpolation, workspace.rotationResults[batchIdx]);
+      break;
+    case Animation_type::Morph:
+      sampleMorphWeightBatch(samples, interpolation, workspace.morphWeightResults[batchIdx]);
+      break;
+    default:
+      OE_THROW(std::logic_error("Unsupported animation type"));
+    }
+  }
 }
 
-void Animation_manager::handleMorphAnimationStep(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex)
+Local_pose& Animation_manager::localPose(Animation_workspace& workspace, Entity& entity)
 {
-  handleMorphAnimationLerp(entity, channel, lowerValueIndex, lowerValueIndex, 0.0f);
+  const auto inserted = workspace.localPoseIndices.emplace(&entity, workspace.localPoses.size());
+  if (inserted.second) {
+    workspace.localPoses.emplace_back(&entity);
+  }
+  return workspace.localPoses[inserted.first->second];
 }
 
-void Animation_manager::handleTranslationAnimationLerp(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+namespace {
+template <class TValue>
+void addPoseSample(
+    Pose_property<TValue>& property,
+    const TValue& value,
+    const TValue& reference,
+    const Animation_manager::Channel_sample& sample)
 {
-  entity.setPosition(SSE::lerp(
-      static_cast<float>(factor),
-      getKeyframeValue<Float3, SSE::Vector3>(channel, lowerValueIndex),
-      getKeyframeValue<Float3, SSE::Vector3>(channel, upperValueIndex)));
+  if (sample.additive) {
+    property.addAdditive(value, reference, sample.weight);
+  } else {
+    property.addOverride(value, sample.weight);
+  }
 }
 
-void Animation_manager::handleScaleAnimationLerp(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+Morph_weights readMorphWeights(const float* weights)
 {
-  entity.setScale(SSE::lerp(
-      static_cast<float>(factor),
-      getKeyframeValue<Float3, SSE::Vector3>(channel, lowerValueIndex),
-      getKeyframeValue<Float3, SSE::Vector3>(channel, upperValueIndex)));
+  Morph_weights result;
+  std::memcpy(result.data(), weights, sizeof(Morph_weights));
+  return result;
 }
 
-void Animation_manager::handleRotationAnimationLerp(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+template <class TValue>
+TValue blendedValue(const Pose_property<TValue>& from, const Pose_property<TValue>& to, float factor)
 {
-  entity.setRotation(SSE::slerp(
-      static_cast<float>(factor),
-      getKeyframeValue<Float4, SSE::Quat>(channel, lowerValueIndex),
-      getKeyframeValue<Float4, SSE::Quat>(channel, upperValueIndex)));
+  return factor < 1.0f && from.animated() ? pose_blend::blend(from.value(), to.value(), factor) : to.value();
 }
+} // namespace
 
-std::array<
-    std::function<
-        void(std::array<double, 8>& meshWeights, size_t meshWeightsOffset, const Float4& weights)>,
-    5>
-    g_applyWeights = {[](auto& meshWeights, auto meshWeightsOffset, const auto& weights) {},
-                      [](auto& meshWeights, auto meshWeightsOffset, const auto& weights) {
-                        meshWeights[meshWeightsOffset] = weights.x;
-                      },
-                      [](auto& meshWeights, auto meshWeightsOffset, const auto& weights) {
-                        meshWeights[meshWeightsOffset] = weights.x;
-                        meshWeights[meshWeightsOffset + 1] = weights.y;
-                      },
-                      [](auto& meshWeights, auto meshWeightsOffset, const auto& weights) {
-                        meshWeights[meshWeightsOffset] = weights.x;
-                        meshWeights[meshWeightsOffset + 1] = weights.y;
-                        meshWeights[meshWeightsOffset + 2] = weights.z;
-                      },
-                      [](auto& meshWeights, auto meshWeightsOffset, const auto& weights) {
-                        meshWeights[meshWeightsOffset] = weights.x;
-                        meshWeights[meshWeightsOffset + 1] = weights.y;
-                        meshWeights[meshWeightsOffset + 2] = weights.z;
-                        meshWeights[meshWeightsOffset + 3] = weights.w;
-                      }};
-
-void Animation_manager::handleMorphAnimationLerp(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+void Animation_manager::blendLocalPoses(Animation_workspace& workspace)
 {
-  const auto morphWeightsComponent = entity.getFirstComponentOfType<Morph_weights_component>();
-  if (morphWeightsComponent) {
-    const auto morphTargetCount = static_cast<uint32_t>(morphWeightsComponent->morphTargetCount());
-    lowerValueIndex *= channel.valuesPerKeyFrame;
-    upperValueIndex *= channel.valuesPerKeyFrame;
-
-    auto lowerWeights = SSE::Vector4();
-    auto upperWeights = SSE::Vector4();
-    if (morphTargetCount <= 4) {
-      for (uint8_t targetIdx = 0u; targetIdx < morphTargetCount; ++targetIdx) {
-        lowerWeights.setElem(
-            targetIdx, getKeyframeValueFloat(channel, lowerValueIndex + targetIdx));
-        upperWeights.setElem(
-            targetIdx, getKeyframeValueFloat(channel, upperValueIndex + targetIdx));
-      }
+  workspace.localPoses.clear();
+  workspace.localPoseIndices.clear();
+
+  // Blend the layers from the lowest up.
+  auto& activeLayers = workspace.activeLayers;
+  activeLayers.reset();
+  for (const auto& samples : workspace.sampleBatches) {
+    for (const auto& sample : samples) {
+      activeLayers.set(sample.layer);
+    }
+  }
 
-      const auto weights = SSE::lerp(static_cast<float>(factor), lowerWeights, upperWeights);
-      const auto numToApply = std::min(4u, morphTargetCount);
-      g_applyWeights.at(
-          numToApply)(morphWeightsComponent->morphWeights(), 0, static_cast<Float4>(weights));
-    } else {
-      assert(morphTargetCount <= 8);
-      lowerWeights = getKeyframeValue<Float4, SSE::Vector4>(channel, lowerValueIndex);
-      upperWeights = getKeyframeValue<Float4, SSE::Vector4>(channel, upperValueIndex);
-
-      auto weights = SSE::lerp(static_cast<float>(factor), lowerWeights, upperWeights);
-      g_applyWeights.at(4)(morphWeightsComponent->morphWeights(), 0, static_cast<Float4>(weights));
-
-      for (uint8_t targetIdx = 4u; targetIdx < morphTargetCount; ++targetIdx) {
-        lowerWeights.setElem(
-            targetIdx, getKeyframeValueFloat(channel, lowerValueIndex + targetIdx));
-        upperWeights.setElem(
-            targetIdx, getKeyframeValueFloat(channel, upperValueIndex + targetIdx));
+  constexpr auto interpolationCount = static_cast<size_t>(Animation_interpolation::Num_animation_interpolation);
+  for (size_t layer = 0; layer < activeLayers.size(); ++layer) {
+    if (!activeLayers.test(layer)) {
+      continue;
+    }
+
+    // Override samples, then additive samples that build on the layer's result.
+    for (const auto additive : {false, true}) {
+      for (size_t batchIdx = 0; batchIdx < workspace.sampleBatches.size(); ++batchIdx) {
+        const auto& samples = workspace.sampleBatches[batchIdx];
+        const auto animationType = static_cast<Animation_type>(batchIdx / interpolationCount);
+
+        for (size_t idx = 0; idx < samples.size(); ++idx) {
+          const auto& sample = samples[idx];
+          if (sample.layer != layer || sample.additive != additive) {
+            continue;
+          }
+
+          auto& pose = localPose(workspace, *sample.target);
+          pose.interpolationInterval = sample.interpolationInterval;
+          switch (animationType) {
+          case Animation_type::Translation:
+            addPoseSample(
+                pose.translation,
+                workspace.vector3Results[batchIdx][idx],
+                sample.channel->vector3Keyframes.values.front(),
+                sample);
+            break;
+          case Animation_type::Scale:
+            addPoseSample(
+                pose.scale,
+                workspace.vector3Results[batchIdx][idx],
+                sample.channel->vector3Keyframes.values.front(),
+                sample);
+            break;
+          case Animation_type::Rotation:
+            addPoseSample(
+                pose.rotation,
+                workspace.rotationResults[batchIdx][idx],
+                sample.channel->rotationKeyframes.values.front(),
+                sample);
+            break;
+          case Animation_type::Morph: {
+            // The reference for additive morph weights is the first keyframe.
+            Morph_weights reference = {};
+            const auto& keyframeWeights = sample.channel->morphWeightKeyframes.values;
+            std::copy_n(
+                keyframeWeights.begin(),
+                std::min<size_t>(sample.channel->morphTargetCount, g_maxAnimatedMorphTargets),
+                reference.begin());
+            addPoseSample(
+                pose.morphWeights,
+                readMorphWeights(workspace.morphWeightResults[batchIdx].data() + idx * g_maxAnimatedMorphTargets),
+                reference,
+                sample);
+            break;
+          }
+          default:
+            break;
+          }
+        }
       }
 
-      weights = SSE::lerp(static_cast<float>(factor), lowerWeights, upperWeights);
-      const auto numToApply = std::min(4u, morphTargetCount - 4u);
-      g_applyWeights.at(
-          numToApply)(morphWeightsComponent->morphWeights(), 4, static_cast<Float4>(weights));
+      if (!additive) {
+        for (auto& pose : workspace.localPoses) {
+          pose.endOverrideLayer();
+        }
+      }
     }
   }
 }
 
-template <class TType> struct Cubic_spline_value {
-  TType inTangent;
-  TType value;
-  TType outTangent;
-};
-
-template <class TTypeIn, class TTypeOut>
-TTypeOut Animation_manager::calculateCubicSpline(
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+void Animation_manager::writeLocalPoses(const Animation_workspace& workspace)
 {
-  const auto& lower = reinterpret_cast<const Cubic_spline_value<TTypeIn>*>(
-      channel.keyframeValues->getIndexed(lowerValueIndex * channel.valuesPerKeyFrame))[0];
-  const auto& upper = reinterpret_cast<const Cubic_spline_value<TTypeIn>*>(
-      channel.keyframeValues->getIndexed(upperValueIndex * channel.valuesPerKeyFrame))[0];
+  for (const auto& pose : workspace.localPoses) {
+    auto& entity = *pose.target;
+    if (pose.interpolationInterval == 0) {
+      if (!_sampledPoseHistories.empty()) {
+        _sampledPoseHistories.erase(entity.getId());
+      }
+      writeLocalPose(entity, pose, pose, 1.0f);
+      continue;
+    }
 
-  const auto factor2 = factor * factor;
-  const auto factor3 = factor2 * factor;
+    // The first sample has nothing to blend from, so is held until the next.
+    auto [pos, inserted] = _sampledPoseHistories.try_emplace(entity.getId(), Sampled_pose_history{pose, pose, 0});
+    auto& history = pos->second;
+    if (!inserted) {
+      history.previous = std::move(history.current);
+      history.current = pose;
+    }
+    history.sampleFrame = _frameIndex;
+    writeLocalPose(entity, history.previous, history.current, 0.0f);
+  }
+}
 
-  // TODO: The splines should be pre-converted when loading the glTF
-  TTypeOut lowerValue, outTangent, upperValue, inTangent;
-  convertSplineElement(lower.value, lowerValue);
-  convertSplineElement(lower.outTangent, outTangent);
-  convertSplineElement(upper.value, upperValue);
-  convertSplineElement(upper.inTangent, inTangent);
+void Animation_manager::writeInterpolatedPoses()
+{
+  for (auto pos = _sampledPoseHistories.begin(); pos != _sampledPoseHistories.end();) {
+    const auto& history = pos->second;
+    const auto interval = history.current.interpolationInterval;
+    const auto framesSinceSample = _frameIndex - history.sampleFrame;
+    if (framesSinceSample == 0) {
+      ++pos;
+      continue;
+    }
 
-  // p(t) = (2t3 - 3t2 + 1)p0 + (t3 - 2t2 + t)m0 + (-2t3 + 3t2)p1 + (t3 - t2)m1
-  const auto p0 = static_cast<float>((2.0 * factor3 - 3.0 * factor2 + 1.0)) * lowerValue;
-  const auto m0 = static_cast<float>((factor3 - 2.0 * factor2 + factor)) * outTangent;
-  const auto p1 = static_cast<float>((-2.0 * factor3 + 3.0 * factor2)) * upperValue;
-  const auto m1 = static_cast<float>((factor3 - factor2)) * inTangent;
+    // Once the blend reaches the latest sample without a new one arriving, the controller was paused or destroyed;
+    // leave the entity at the latest sample.
+    auto* entity = _sceneGraphManager.findEntityById(pos->first);
+    const auto factor = std::min(1.0f, static_cast<float>(framesSinceSample) / static_cast<float>(interval));
+    if (entity) {
+      writeLocalPose(*entity, history.previous, history.current, factor);
+    }
+    if (!entity || factor >= 1.0f) {
+      pos = _sampledPoseHistories.erase(pos);
+    } else {
+      ++pos;
+    }
+  }
+}
 
-  auto result = p0 + m0 + p1 + m1;
-  return result;
+void Animation_manager::writeLocalPose(Entity& entity, const Local_pose& from, const Local_pose& to, float factor)
+{
+  if (to.translation.animated()) {
+    entity.setPosition(blendedValue(from.translation, to.translation, factor));
+  }
+  if (to.rotation.animated()) {
+    entity.setRotation(blendedValue(from.rotation, to.rotation, factor));
+  }
+  if (to.scale.animated()) {
+    entity.setScale(blendedValue(from.scale, to.scale, factor));
+  }
+  if (to.morphWeights.animated()) {
+    const auto morphWeightsComponent = entity.getFirstComponentOfType<Morph_weights_component>();
+    if (morphWeightsComponent) {
+      auto& morphWeights = morphWeightsComponent->morphWeights();
+      const auto targetCount = std::min<size_t>(morphWeightsComponent->morphTargetCount(), g_maxAnimatedMorphTargets);
+      assert(targetCount <= morphWeights.size());
+      const auto weights = blendedValue(from.morphWeights, to.morphWeights, factor);
+      for (size_t targetIdx = 0; targetIdx < targetCount; ++targetIdx) {
+        morphWeights[targetIdx] = weights[targetIdx];
+      }
+    }
+  }
 }
 
-void Animation_manager::handleTranslationAnimationCubicSpline(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+template <class TValue>
+TValue Animation_manager::calculateCubicSpline(
+    const Animation_controller_component::Keyframe_values<TValue>& keyframes,
+    size_t lowerValueIndex,
+    size_t upperValueIndex,
+    float factor)
 {
-  entity.setPosition(calculateCubicSpline<Float3, SSE::Vector3>(
-      channel, lowerValueIndex, upperValueIndex, factor));
+  const auto t2 = factor * factor;
+  const auto t3 = t2 * factor;
+
+  // The tangents were scaled by the keyframe interval when decoded.
+  // p(t) = (2t3 - 3t2 + 1)p0 + (t3 - 2t2 + t)m0 + (-2t3 + 3t2)p1 + (t3 - t2)m1
+  return (2.0f * t3 - 3.0f * t2 + 1.0f) * keyframes.values[lowerValueIndex] +
+         (t3 - 2.0f * t2 + factor) * keyframes.outTangents[lowerValueIndex] +
+         (-2.0f * t3 + 3.0f * t2) * keyframes.values[upperValueIndex] +
+         (t3 - t2) * keyframes.inTangents[upperValueIndex];
 }
 
-void Animation_manager::handleScaleAnimationCubicSpline(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+void Animation_manager::sampleVector3Batch(
+    const std::vector<Channel_sample>& samples,
+    Animation_interpolation interpolation,
+    std::vector<SSE::Vector3>& results)
 {
-  entity.setScale(calculateCubicSpline<Float3, SSE::Vector3>(
-      channel, lowerValueIndex, upperValueIndex, factor));
+  results.resize(samples.size());
+  switch (interpolation) {
+  case Animation_interpolation::Step:
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      const auto& sample = samples[idx];
+      results[idx] = sample.channel->vector3Keyframes.values[sample.lowerIndex];
+    }
+    break;
+  case Animation_interpolation::Linear:
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      const auto& sample = samples[idx];
+      const auto& values = sample.channel->vector3Keyframes.values;
+      results[idx] = SSE::lerp(sample.factor, values[sample.lowerIndex], values[sample.upperIndex]);
+    }
+    break;
+  case Animation_interpolation::Cubic_spline:
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      const auto& sample = samples[idx];
+      results[idx] =
+          calculateCubicSpline(sample.channel->vector3Keyframes, sample.lowerIndex, sample.upperIndex, sample.factor);
+    }
+    break;
+  default:
+    OE_THROW(std::logic_error("Unsupported animation interpolation type"));
+  }
 }
 
-void Animation_manager::handleRotationAnimationCubicSpline(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+void Animation_manager::sampleRotationBatch(
+    const std::vector<Channel_sample>& samples,
+    Animation_interpolation interpolation,
+    std::vector<SSE::Quat>& results)
 {
-  auto result =
-      calculateCubicSpline<Float4, SSE::Quat>(channel, lowerValueIndex, upperValueIndex, factor);
-  entity.setRotation(SSE::normalize(result));
+  results.resize(samples.size());
+  switch (interpolation) {
+  case Animation_interpolation::Step:
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      const auto& sample = samples[idx];
+      results[idx] = sample.channel->rotationKeyframes.values[sample.lowerIndex];
+    }
+    break;
+  case Animation_interpolation::Linear:
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      const auto& sample = samples[idx];
+      const auto& values = sample.channel->rotationKeyframes.values;
+      results[idx] = SSE::slerp(sample.factor, values[sample.lowerIndex], values[sample.upperIndex]);
+    }
+    break;
+  case Animation_interpolation::Cubic_spline:
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      const auto& sample = samples[idx];
+      results[idx] = SSE::normalize(
+          calculateCubicSpline(sample.channel->rotationKeyframes, sample.lowerIndex, sample.upperIndex, sample.factor));
+    }
+    break;
+  default:
+    OE_THROW(std::logic_error("Unsupported animation interpolation type"));
+  }
 }
 
-void Animation_manager::handleMorphAnimationCubicSpline(
-    Entity& entity,
-    const Animation_controller_component::Animation_channel& channel,
-    uint32_t lowerValueIndex,
-    uint32_t upperValueIndex,
-    double factor)
+void Animation_manager::sampleMorphWeightBatch(
+    const std::vector<Channel_sample>& samples,
+    Animation_interpolation interpolation,
+    std::vector<float>& results)
 {
-  // The one frame in the value stream is packed as such:
-  // [ in-tangent-0 ... in-tangent-N, morph-value-0 ... morph-value-N, out-tangent-0 ...
-  // out-tangent-N ]
-
-  const auto morphWeightsComponent = entity.getFirstComponentOfType<Morph_weights_component>();
-  if (morphWeightsComponent) {
-    const auto morphTargetCount = static_cast<uint32_t>(morphWeightsComponent->morphTargetCount());
-    lowerValueIndex *= channel.valuesPerKeyFrame;
-    upperValueIndex *= channel.valuesPerKeyFrame;
-
-    const auto weightsIdxOffset = morphTargetCount * 1;
-    const auto inTangentIdxOffset = morphTargetCount * 2;
-    const auto factor2 = factor * factor;
-    const auto factor3 = factor2 * factor;
-    assert(morphWeightsComponent->morphWeights().size() >= morphTargetCount);
-    for (uint8_t targetIdx = 0u; targetIdx < morphTargetCount; ++targetIdx) {
-
-      const auto lowerInTangent = reinterpret_cast<const float*>(
-          channel.keyframeValues->getIndexed(lowerValueIndex))[targetIdx];
-      const auto lowerValue = reinterpret_cast<const float*>(
-          channel.keyframeValues->getIndexed(lowerValueIndex))[weightsIdxOffset + targetIdx];
-      const auto upperValue = reinterpret_cast<const float*>(
-          channel.keyframeValues->getIndexed(upperValueIndex))[weightsIdxOffset + targetIdx];
-      const auto upperOutTangent = reinterpret_cast<const float*>(
-          channel.keyframeValues->getIndexed(upperValueIndex))[inTangentIdxOffset + targetIdx];
-
-      // p(t) = (2t3 - 3t2 + 1)p0 + (t3 - 2t2 + t)m0 + (-2t3 + 3t2)p1 + (t3 - t2)m1
-      const auto p0 = static_cast<float>((2.0 * factor3 - 3.0 * factor2 + 1.0)) * lowerValue;
-      const auto m0 = static_cast<float>((factor3 - 2.0 * factor2 + factor)) * lowerInTangent;
-      const auto p1 = static_cast<float>((-2.0 * factor3 + 3.0 * factor2)) * upperValue;
-      const auto m1 = static_cast<float>((factor3 - factor2)) * upperOutTangent;
-
-      const auto result = p0 + m0 + p1 + m1;
-      morphWeightsComponent->morphWeights()[targetIdx] = result;
+  results.assign(samples.size() * g_maxAnimatedMorphTargets, 0.0f);
+  for (size_t sampleIdx = 0; sampleIdx < samples.size(); ++sampleIdx) {
+    const auto& sample = samples[sampleIdx];
+    const auto& channel = *sample.channel;
+    const auto targetCount = std::min<size_t>(channel.morphTargetCount, g_maxAnimatedMorphTargets);
+    const auto lowerOffset = static_cast<size_t>(sample.lowerIndex) * channel.morphTargetCount;
+    const auto upperOffset = static_cast<size_t>(sample.upperIndex) * channel.morphTargetCount;
+    const auto& values = channel.morphWeightKeyframes.values;
+    const auto sampleResults = results.data() + sampleIdx * g_maxAnimatedMorphTargets;
+
+    switch (interpolation) {
+    case Animation_interpolation::Step:
+      for (size_t targetIdx = 0; targetIdx < targetCount; ++targetIdx) {
+        sampleResults[targetIdx] = values[lowerOffset + targetIdx];
+      }
+      break;
+    case Animation_interpolation::Linear:
+      for (size_t targetIdx = 0; targetIdx < targetCount; ++targetIdx) {
+        const auto lower = values[lowerOffset + targetIdx];
+        sampleResults[targetIdx] = lower + sample.factor * (values[upperOffset + targetIdx] - lower);
+      }
+      break;
+    case Animation_interpolation::Cubic_spline:
+      for (size_t targetIdx = 0; targetIdx < targetCount; ++targetIdx) {
+        sampleResults[targetIdx] = calculateCubicSpline(
+            channel.morphWeightKeyframes, lowerOffset + targetIdx, upperOffset + targetIdx, sample.factor);
+      }
+      break;
+    default:
+      OE_THROW(std::logic_error("Unsupported animation interpolation type"));
     }
   }
 }
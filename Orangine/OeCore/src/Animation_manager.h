@@ -1,18 +1,31 @@
 #pragma once
+#include "Animation_pose.h"
+
 #include "OeCore/Animation_controller_component.h"
+#include "OeCore/Collision.h"
 #include "OeCore/IAnimation_manager.h"
+#include "OeCore/IJob_manager.h"
 #include "OeCore/IScene_graph_manager.h"
 #include "OeCore/ITime_step_manager.h"
 
+#include <array>
+#include <bitset>
+#include <unordered_map>
+#include <vector>
+
 namespace oe {
+class Skinned_mesh_component;
+
 class Animation_manager : public Manager_base, public Manager_tickable, public IAnimation_manager {
  public:
-  Animation_manager(IScene_graph_manager& sceneGraphManager, ITime_step_manager& timeStepManager)
+  Animation_manager(
+          IScene_graph_manager& sceneGraphManager, ITime_step_manager& timeStepManager, IJob_manager& jobManager)
       : Manager_base()
       , Manager_tickable()
       , IAnimation_manager()
       , _sceneGraphManager(sceneGraphManager)
       , _timeStepManager(timeStepManager)
+      , _jobManager(jobManager)
   {}
 
   ~Animation_manager() override = default;
@@ -29,51 +42,141 @@ class Animation_manager : public Manager_base, public Manager_tickable, public I
   // Manager_tickable implementation
   void tick() override;
 
-  static void handleTranslationAnimationStep(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex);
-  static void handleRotationAnimationStep(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex);
-  static void handleScaleAnimationStep(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex);
-  static void handleMorphAnimationStep(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex);
-
-  static void handleTranslationAnimationLerp(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-  static void handleRotationAnimationLerp(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-  static void handleScaleAnimationLerp(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-  static void handleMorphAnimationLerp(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-
-  template<class TTypeIn, class TTypeOut>
-  static TTypeOut calculateCubicSpline(
-          const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-
-  static void handleTranslationAnimationCubicSpline(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-  static void handleRotationAnimationCubicSpline(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-  static void handleScaleAnimationCubicSpline(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
-  static void handleMorphAnimationCubicSpline(
-          Entity& entity, const Animation_controller_component::Animation_channel& channel, uint32_t lowerValueIndex,
-          uint32_t upperValueIndex, double factor);
+  // IAnimation_manager implementation
+  void setViewFrustum(const BoundingFrustumRH& frustum) override;
+  const Animation_stats& animationStats() const override { return _stats; }
+  void updateSkinningPalettes() override;
+
+  enum class Update_rate { Full, Reduced, Paused };
+
+  // Chooses the controller's update rate from its update policy and the view frustum.
+  static Update_rate controllerUpdateRate(
+          const Animation_controller_component& animComponent, const BoundingFrustumRH& viewFrustum);
+
+  /**
+   * Returns the index of the first keyframe whose time is greater than the given time, or keyframeTimes.size() if
+   * there is none. The cursor is the result of the previous call for this channel; when time has moved forward by a
+   * few keyframes or less, the result is found by stepping forward from it. Otherwise (on seeks, rewinds or large time
+   * steps) it falls back to a binary search.
+   */
+  static uint32_t findNextKeyframe(const std::vector<float>& keyframeTimes, double time, uint32_t cursor);
+
+  // A sample of one channel at the current time, queued by tick and evaluated in a batch with the other samples of
+  // the same animation type and interpolation.
+  struct Channel_sample {
+    const Animation_controller_component::Animation_channel* channel;
+    Entity* target;
+    uint32_t lowerIndex;
+    uint32_t upperIndex;
+    float factor;
+
+    // From the animation's Animation_blend.
+    float weight = 1.0f;
+    uint8_t layer = 0;
+    bool additive = false;
+
+    // From the controller's update; see Local_pose::interpolationInterval.
+    uint32_t interpolationInterval = 0;
+  };
+
+  /**
+   * Batch kernels. Each evaluates all samples, which must share the given interpolation, into results (one per sample).
+   * The loops are specialized per interpolation type, so there is no per-sample dispatch.
+   */
+  static void sampleVector3Batch(
+          const std::vector<Channel_sample>& samples, Animation_interpolation interpolation,
+          std::vector<SSE::Vector3>& results);
+  static void sampleRotationBatch(
+          const std::vector<Channel_sample>& samples, Animation_interpolation interpolation,
+          std::vector<SSE::Quat>& results);
+  // Results has g_maxAnimatedMorphTargets weights per sample.
+  static void sampleMorphWeightBatch(
+          const std::vector<Channel_sample>& samples, Animation_interpolation interpolation, std::vector<float>& results);
+
+  // Evaluates the spline segment between two decoded values. The indices are into keyframes.values, not keyframe
+  // indices; for morph weights they are offset by the morph target.
+  template<class TValue>
+  static TValue calculateCubicSpline(
+          const Animation_controller_component::Keyframe_values<TValue>& keyframes, size_t lowerValueIndex,
+          size_t upperValueIndex, float factor);
 
  private:
+  static constexpr size_t sample_batch_count = static_cast<size_t>(Animation_type::Num_animation_type) *
+                                               static_cast<size_t>(Animation_interpolation::Num_animation_interpolation);
+
+  // Maximum number of controllers evaluated by one job. Chunks are a fixed size, rather than one per worker, so that the
+  // result doesn't depend on the number of workers.
+  static constexpr size_t controllers_per_workspace = 16;
+
+  /**
+   * The working state for one chunk of controllers. Each chunk is evaluated by a single job, which only writes to its
+   * own workspace and the chunk's controllers; entities are written afterwards, on the calling thread.
+   * Reused between ticks to avoid reallocating.
+   */
+  struct Animation_workspace {
+    // Indexed by animation type, then interpolation.
+    std::array<std::vector<Channel_sample>, sample_batch_count> sampleBatches;
+    std::array<std::vector<SSE::Vector3>, sample_batch_count> vector3Results;
+    std::array<std::vector<SSE::Quat>, sample_batch_count> rotationResults;
+    std::array<std::vector<float>, sample_batch_count> morphWeightResults;
+
+    std::bitset<256> activeLayers;
+    std::vector<Local_pose> localPoses;
+    std::unordered_map<const Entity*, size_t> localPoseIndices;
+  };
+
+  struct Controller_update {
+    Animation_controller_component* animComponent;
+    double deltaTime;
+    uint32_t interpolationInterval;
+  };
+
+  /**
+   * The last two poses sampled for an entity by a throttled controller. Until the next sample, each frame writes a
+   * blend from the earlier pose to the later one, so the entity keeps moving while trailing its animation by one
+   * interval.
+   */
+  struct Sampled_pose_history {
+    Local_pose previous;
+    Local_pose current;
+    uint64_t sampleFrame;
+  };
+
+  // Advances the controller's active animations, and queues a sample of each playing channel.
+  static void tickAnimationController(
+          Animation_workspace& workspace, const Controller_update& controllerUpdate);
+  // Evaluates the queued samples of each batch.
+  static void sampleBatches(Animation_workspace& workspace);
+  // Blends the sample results into a local pose per target entity.
+  static void blendLocalPoses(Animation_workspace& workspace);
+  // Writes each local pose to its entity, once. Poses of throttled controllers are recorded, and their previous sample is
+  // written instead.
+  void writeLocalPoses(const Animation_workspace& workspace);
+  // Writes the interpolated pose of each entity that a throttled controller didn't sample this frame.
+  void writeInterpolatedPoses();
+  // Writes the animated properties of to, blended from those of from by factor.
+  static void writeLocalPose(Entity& entity, const Local_pose& from, const Local_pose& to, float factor);
+  static Local_pose& localPose(Animation_workspace& workspace, Entity& entity);
+
   static std::string _name;
 
   IScene_graph_manager& _sceneGraphManager;
   ITime_step_manager& _timeStepManager;
-  std::shared_ptr<Entity_filter> _animationControllers;
+  IJob_manager& _jobManager;
+
+  bool _hasViewFrustum = false;
+  BoundingFrustumRH _viewFrustum;
+  uint64_t _frameIndex = 0;
+  Animation_stats _stats;
+
+  // Controllers to evaluate this tick, in component pool order.
+  std::vector<Controller_update> _controllerUpdates;
+  std::vector<Animation_workspace> _workspaces;
+  // Keyed by the ID of the animated entity, which may be destroyed along with its controller between samples.
+  std::unordered_map<Entity::Id_type, Sampled_pose_history> _sampledPoseHistories;
+
+  uint64_t _skinningUpdateIndex = 0;
+  // One mesh per distinct palette, updated by the current skinning pass.
+  std::vector<Skinned_mesh_component*> _skinnedMeshUpdates;
 };
 }// namespace oe
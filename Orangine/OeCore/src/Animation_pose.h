@@ -0,0 +1,160 @@
+#pragma once
+
+#include <OeCore/Renderer_types.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace oe {
+class Entity;
+
+constexpr size_t g_maxAnimatedMorphTargets = 8;
+using Morph_weights = std::array<float, g_maxAnimatedMorphTargets>;
+
+/*
+ * Blend operations for each animated value type.
+ */
+namespace pose_blend {
+inline SSE::Vector3 zero(const SSE::Vector3&) { return SSE::Vector3(0.0f); }
+inline SSE::Quat zero(const SSE::Quat&) { return SSE::Quat(0.0f, 0.0f, 0.0f, 0.0f); }
+inline Morph_weights zero(const Morph_weights&) { return {}; }
+
+inline void addWeighted(SSE::Vector3& sum, const SSE::Vector3& value, float weight) { sum += weight * value; }
+inline void addWeighted(SSE::Quat& sum, const SSE::Quat& value, float weight)
+{
+  // q and -q are the same rotation; keep everything in the same hemisphere so they don't cancel out.
+  sum += (SSE::dot(sum, value) < 0.0f ? -weight : weight) * value;
+}
+inline void addWeighted(Morph_weights& sum, const Morph_weights& value, float weight)
+{
+  for (size_t idx = 0; idx < sum.size(); ++idx) {
+    sum[idx] += weight * value[idx];
+  }
+}
+
+inline SSE::Vector3 average(const SSE::Vector3& sum, float totalWeight) { return sum / totalWeight; }
+inline SSE::Quat average(const SSE::Quat& sum, float) { return SSE::normalize(sum); }
+inline Morph_weights average(const Morph_weights& sum, float totalWeight)
+{
+  Morph_weights result;
+  for (size_t idx = 0; idx < sum.size(); ++idx) {
+    result[idx] = sum[idx] / totalWeight;
+  }
+  return result;
+}
+
+inline SSE::Vector3 blend(const SSE::Vector3& from, const SSE::Vector3& to, float factor)
+{
+  return SSE::lerp(factor, from, to);
+}
+inline SSE::Quat blend(const SSE::Quat& from, const SSE::Quat& to, float factor) { return SSE::slerp(factor, from, to); }
+inline Morph_weights blend(const Morph_weights& from, const Morph_weights& to, float factor)
+{
+  Morph_weights result;
+  for (size_t idx = 0; idx < from.size(); ++idx) {
+    result[idx] = from[idx] + factor * (to[idx] - from[idx]);
+  }
+  return result;
+}
+
+// The offset of value from reference, for additive blending.
+inline SSE::Vector3 difference(const SSE::Vector3& value, const SSE::Vector3& reference) { return value - reference; }
+inline SSE::Quat difference(const SSE::Quat& value, const SSE::Quat& reference)
+{
+  return SSE::conj(reference) * value;
+}
+inline Morph_weights difference(const Morph_weights& value, const Morph_weights& reference)
+{
+  Morph_weights result;
+  for (size_t idx = 0; idx < value.size(); ++idx) {
+    result[idx] = value[idx] - reference[idx];
+  }
+  return result;
+}
+
+inline void addDifference(SSE::Vector3& value, const SSE::Vector3& difference, float weight)
+{
+  value += weight * difference;
+}
+inline void addDifference(SSE::Quat& value, const SSE::Quat& difference, float weight)
+{
+  value = SSE::normalize(value * SSE::slerp(weight, SSE::Quat::identity(), difference));
+}
+inline void addDifference(Morph_weights& value, const Morph_weights& difference, float weight)
+{
+  addWeighted(value, difference, weight);
+}
+} // namespace pose_blend
+
+/**
+ * Accumulates the samples of one property (translation, rotation, scale or morph weights) of an animated entity.
+ *
+ * Samples are added a layer at a time. The override samples of a layer are averaged by weight. The lowest layer to
+ * animate the property sets its value; a higher layer is blended over it by the layer's total weight, capped at 1.
+ * Additive samples then add their difference from a reference value, scaled by weight.
+ */
+template <class TValue> class Pose_property {
+ public:
+  bool animated() const { return _animated; }
+  const TValue& value() const { return _value; }
+
+  void addOverride(const TValue& value, float weight)
+  {
+    if (_layerWeight == 0.0f) {
+      _layerSum = pose_blend::zero(value);
+    }
+    pose_blend::addWeighted(_layerSum, value, weight);
+    _layerWeight += weight;
+  }
+
+  // Call after all override samples of a layer have been added, and before its additive samples.
+  void endOverrideLayer()
+  {
+    if (_layerWeight <= 0.0f) {
+      return;
+    }
+
+    const auto layerValue = pose_blend::average(_layerSum, _layerWeight);
+    _value = _animated ? pose_blend::blend(_value, layerValue, std::min(1.0f, _layerWeight)) : layerValue;
+    _animated = true;
+    _layerWeight = 0.0f;
+  }
+
+  // Additive samples only apply over a property that an override layer has animated.
+  void addAdditive(const TValue& value, const TValue& reference, float weight)
+  {
+    if (_animated) {
+      pose_blend::addDifference(_value, pose_blend::difference(value, reference), weight);
+    }
+  }
+
+ private:
+  TValue _value;
+  TValue _layerSum;
+  float _layerWeight = 0.0f;
+  bool _animated = false;
+};
+
+// The accumulated animation output for one entity, written to the entity once per tick.
+struct Local_pose {
+  explicit Local_pose(Entity* target) : target(target) {}
+
+  Entity* target;
+  // Frames between samples of the controller that animated this pose, if it is throttled; zero if it is sampled every
+  // frame.
+  uint32_t interpolationInterval = 0;
+  Pose_property<SSE::Vector3> translation;
+  Pose_property<SSE::Quat> rotation;
+  Pose_property<SSE::Vector3> scale;
+  Pose_property<Morph_weights> morphWeights;
+
+  void endOverrideLayer()
+  {
+    translation.endOverrideLayer();
+    rotation.endOverrideLayer();
+    scale.endOverrideLayer();
+    morphWeights.endOverrideLayer();
+  }
+};
+} // namespace oe
@@ -2,6 +2,7 @@
 
 #include <OeCore/EngineUtils.h>
 #include <OeCore/IConfigReader.h>
+#include <OeCore/Mesh_buffer_pool.h>
 
 using namespace oe;
 using namespace internal;
@@ -16,6 +17,7 @@ template<> void oe::create_manager(Manager_instance<IAsset_manager>& out)
 Asset_manager::Asset_manager()
     : IAsset_manager()
     , Manager_base()
+    , _meshBufferPool(std::make_shared<Mesh_buffer_pool>())
 {}
 
 void Asset_manager::initialize()
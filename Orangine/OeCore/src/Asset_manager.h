@@ -22,6 +22,8 @@ class Asset_manager : public IAsset_manager, public Manager_base {
 
   std::string makeAbsoluteAssetPath(const std::string& path) const override;
 
+  const std::shared_ptr<Mesh_buffer_pool>& meshBufferPool() const override { return _meshBufferPool; }
+
   // Manager_base implementation
   void loadConfig(const IConfigReader&) override;
   void initialize() override;
@@ -33,6 +35,7 @@ class Asset_manager : public IAsset_manager, public Manager_base {
   std::string _dataPath = "./data";
   std::unordered_map<std::string, std::string> _dataPathOverrides;
   bool _fallbackDataPathAllowed = true;
+  std::shared_ptr<Mesh_buffer_pool> _meshBufferPool;
 
   bool _initialized = false;
 };
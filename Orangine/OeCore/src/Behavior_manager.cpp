@@ -37,11 +37,29 @@ void Behavior_manager::tick() {
 
   for (auto& efb : _entityFilterBehaviors) {
     const auto behavior = efb.behavior.get();
+    if (efb.componentPool) {
+      efb.componentPool->forEachComponent([behavior, componentType = efb.componentType](Component& component) {
+        // Entities with more than one component of the type are only handled once.
+        auto& entity = component.getEntity();
+        if (entity.getState() == Entity_state::Ready && entity.getFirstComponentOfTypeId(componentType) == &component) {
+          behavior->handleEntity(entity);
+        }
+      });
+      continue;
+    }
+
     // TODO: When cpp20 is here, we can call handleEntity with a range of entities, to avoid
     // repeatedly making this virtual function call!
-    for (auto& entity : *efb.entityFilter) {
-      behavior->handleEntity(*entity);
+    // Iterate over a copy of the members: a behavior may add or remove components, and removing a member moves the
+    // last one into its place. Entities that stop matching before their turn are skipped.
+    const auto& entityFilter = *efb.entityFilter;
+    _filterMembers.assign(entityFilter.begin(), entityFilter.end());
+    for (const auto& entity : _filterMembers) {
+      if (entityFilter.contains(entity.get())) {
+        behavior->handleEntity(*entity);
+      }
     }
+    _filterMembers.clear();
   }
 }
 
@@ -61,8 +79,15 @@ void Behavior_manager::addForComponentTypes(
   }
   _nameToEntityBehaviorMap[behavior->name()] = behavior.get();
 
+  Component_pool* componentPool = nullptr;
+  Component::Component_type componentType = 0;
+  if (componentTypes.size() == 1) {
+    componentType = *componentTypes.begin();
+    componentPool = Component_factory::componentPool(componentType);
+  }
+
   const auto filter = _sceneGraphManager.getEntityFilter(componentTypes, mode);
-  _entityFilterBehaviors.push_back({filter, std::move(behavior)});
+  _entityFilterBehaviors.push_back({filter, std::move(behavior), componentPool, componentType});
 }
 
 void Behavior_manager::addForScene(std::unique_ptr<Scene_behavior> behavior) {
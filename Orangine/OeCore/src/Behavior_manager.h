@@ -39,8 +39,15 @@ class Behavior_manager : public IBehavior_manager, public Manager_base
   struct Entity_filter_behavior {
     std::shared_ptr<Entity_filter> entityFilter;
     std::unique_ptr<Entity_behavior> behavior;
+
+    // Set for behaviors on a single pooled component type, whose entities are found by streaming through the pool
+    // rather than the filter.
+    Component_pool* componentPool;
+    Component::Component_type componentType;
   };
   std::vector<Entity_filter_behavior> _entityFilterBehaviors;
+  // Members of the filter being iterated by tick, kept to reuse its capacity.
+  std::vector<std::shared_ptr<Entity>> _filterMembers;
   std::unordered_map<std::string, Entity_behavior*> _nameToEntityBehaviorMap = {};
 
   std::vector<std::unique_ptr<Scene_behavior>> _newSceneBehaviors;
@@ -0,0 +1,304 @@
+#include "OeCore/Bounding_volume_hierarchy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+using namespace oe;
+
+float Bounding_volume_hierarchy::Aabb::intersect(
+    const Ray& ray,
+    const SSE::Vector3& inverseDirection,
+    float maxDistance) const
+{
+  // Slab test. Ref: Real-time collision detection, Christer Ericson
+  const auto origin = SSE::Vector3(ray.origin);
+  const float origins[] = {origin.getX(), origin.getY(), origin.getZ()};
+  const float directions[] = {ray.directionNormal.getX(), ray.directionNormal.getY(), ray.directionNormal.getZ()};
+  const float inverseDirections[] = {inverseDirection.getX(), inverseDirection.getY(), inverseDirection.getZ()};
+  const float mins[] = {min.getX(), min.getY(), min.getZ()};
+  const float maxs[] = {max.getX(), max.getY(), max.getZ()};
+
+  auto tMin = 0.0f;
+  auto tMax = maxDistance;
+  for (int axis = 0; axis < 3; ++axis) {
+    if (directions[axis] == 0.0f) {
+      // Parallel to the slab, where the distances would be 0 * inf (NaN) for a ray starting on one of its planes.
+      if (origins[axis] < mins[axis] || origins[axis] > maxs[axis]) {
+        return -1.0f;
+      }
+      continue;
+    }
+
+    auto t1 = (mins[axis] - origins[axis]) * inverseDirections[axis];
+    auto t2 = (maxs[axis] - origins[axis]) * inverseDirections[axis];
+    if (t1 > t2) {
+      std::swap(t1, t2);
+    }
+    tMin = std::max(tMin, t1);
+    tMax = std::min(tMax, t2);
+    if (tMin > tMax) {
+      return -1.0f;
+    }
+  }
+  return tMin;
+}
+
+Bounding_volume_hierarchy::Bounding_volume_hierarchy(float margin)
+    : _margin(margin)
+{}
+
+uint32_t Bounding_volume_hierarchy::createProxy(const BoundingSphere& sphere, Entity* entity)
+{
+  assert(entity != nullptr);
+
+  const auto proxyId = allocateNode();
+  auto& node = _nodes[proxyId];
+  node.box = Aabb::createFromSphere(sphere, _margin);
+  node.entity = entity;
+  node.height = 0;
+
+  insertLeaf(proxyId);
+  ++_proxyCount;
+  return proxyId;
+}
+
+void Bounding_volume_hierarchy::destroyProxy(uint32_t proxyId)
+{
+  assert(proxyId < _nodes.size() && _nodes[proxyId].isLeaf() && _nodes[proxyId].height == 0);
+
+  removeLeaf(proxyId);
+  freeNode(proxyId);
+  --_proxyCount;
+}
+
+bool Bounding_volume_hierarchy::moveProxy(uint32_t proxyId, const BoundingSphere& sphere)
+{
+  assert(proxyId < _nodes.size() && _nodes[proxyId].isLeaf() && _nodes[proxyId].height == 0);
+
+  const auto tightBox = Aabb::createFromSphere(sphere, 0.0f);
+  if (_nodes[proxyId].box.contains(tightBox)) {
+    return false;
+  }
+
+  removeLeaf(proxyId);
+  _nodes[proxyId].box = Aabb::createFromSphere(sphere, _margin);
+  insertLeaf(proxyId);
+  return true;
+}
+
+void Bounding_volume_hierarchy::clear()
+{
+  _nodes.clear();
+  _root = invalid_proxy;
+  _freeList = invalid_proxy;
+  _proxyCount = 0;
+}
+
+uint32_t Bounding_volume_hierarchy::allocateNode()
+{
+  if (_freeList == invalid_proxy) {
+    _nodes.emplace_back();
+    return static_cast<uint32_t>(_nodes.size() - 1);
+  }
+
+  const auto nodeId = _freeList;
+  _freeList = _nodes[nodeId].parent;
+  _nodes[nodeId] = Node();
+  return nodeId;
+}
+
+void Bounding_volume_hierarchy::freeNode(uint32_t nodeId)
+{
+  auto& node = _nodes[nodeId];
+  node = Node();
+  node.parent = _freeList;
+  _freeList = nodeId;
+}
+
+void Bounding_volume_hierarchy::insertLeaf(uint32_t leafId)
+{
+  if (_root == invalid_proxy) {
+    _root = leafId;
+    _nodes[leafId].parent = invalid_proxy;
+    return;
+  }
+
+  // Descend the tree, choosing the child that results in the smallest increase in surface area.
+  const auto leafBox = _nodes[leafId].box;
+  auto siblingId = _root;
+  while (!_nodes[siblingId].isLeaf()) {
+    const auto& node = _nodes[siblingId];
+    const auto area = node.box.surfaceArea();
+    const auto combinedArea = Aabb::createMerged(node.box, leafBox).surfaceArea();
+
+    // Cost of creating a new parent for this node and the new leaf
+    const auto cost = 2.0f * combinedArea;
+    // Minimum cost of pushing the leaf further down the tree
+    const auto inheritanceCost = 2.0f * (combinedArea - area);
+
+    const auto childCost = [&](uint32_t childId) {
+      const auto& child = _nodes[childId];
+      const auto mergedArea = Aabb::createMerged(child.box, leafBox).surfaceArea();
+      return child.isLeaf() ? mergedArea + inheritanceCost
+                            : mergedArea - child.box.surfaceArea() + inheritanceCost;
+    };
+    const auto cost1 = childCost(node.child1);
+    const auto cost2 = childCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    siblingId = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  // Create a new parent for the sibling and the leaf.
+  const auto oldParentId = _nodes[siblingId].parent;
+  const auto newParentId = allocateNode();
+  {
+    auto& newParent = _nodes[newParentId];
+    newParent.parent = oldParentId;
+    newParent.box = Aabb::createMerged(leafBox, _nodes[siblingId].box);
+    newParent.height = _nodes[siblingId].height + 1;
+    newParent.child1 = siblingId;
+    newParent.child2 = leafId;
+  }
+
+  if (oldParentId != invalid_proxy) {
+    auto& oldParent = _nodes[oldParentId];
+    if (oldParent.child1 == siblingId) {
+      oldParent.child1 = newParentId;
+    } else {
+      oldParent.child2 = newParentId;
+    }
+  } else {
+    _root = newParentId;
+  }
+  _nodes[siblingId].parent = newParentId;
+  _nodes[leafId].parent = newParentId;
+
+  // Walk back up the tree, fixing heights and boxes.
+  auto nodeId = _nodes[leafId].parent;
+  while (nodeId != invalid_proxy) {
+    nodeId = balance(nodeId);
+
+    auto& node = _nodes[nodeId];
+    const auto& child1 = _nodes[node.child1];
+    const auto& child2 = _nodes[node.child2];
+    node.height = 1 + std::max(child1.height, child2.height);
+    node.box = Aabb::createMerged(child1.box, child2.box);
+
+    nodeId = node.parent;
+  }
+}
+
+void Bounding_volume_hierarchy::removeLeaf(uint32_t leafId)
+{
+  if (leafId == _root) {
+    _root = invalid_proxy;
+    return;
+  }
+
+  const auto parentId = _nodes[leafId].parent;
+  const auto grandParentId = _nodes[parentId].parent;
+  const auto siblingId = _nodes[parentId].child1 == leafId ? _nodes[parentId].child2 : _nodes[parentId].child1;
+
+  if (grandParentId == invalid_proxy) {
+    _root = siblingId;
+    _nodes[siblingId].parent = invalid_proxy;
+    freeNode(parentId);
+    return;
+  }
+
+  // Replace the parent with the sibling.
+  auto& grandParent = _nodes[grandParentId];
+  if (grandParent.child1 == parentId) {
+    grandParent.child1 = siblingId;
+  } else {
+    grandParent.child2 = siblingId;
+  }
+  _nodes[siblingId].parent = grandParentId;
+  freeNode(parentId);
+
+  auto nodeId = grandParentId;
+  while (nodeId != invalid_proxy) {
+    nodeId = balance(nodeId);
+
+    auto& node = _nodes[nodeId];
+    const auto& child1 = _nodes[node.child1];
+    const auto& child2 = _nodes[node.child2];
+    node.box = Aabb::createMerged(child1.box, child2.box);
+    node.height = 1 + std::max(child1.height, child2.height);
+
+    nodeId = node.parent;
+  }
+}
+
+uint32_t Bounding_volume_hierarchy::balance(uint32_t aId)
+{
+  auto& a = _nodes[aId];
+  if (a.isLeaf() || a.height < 2) {
+    return aId;
+  }
+
+  const auto bId = a.child1;
+  const auto cId = a.child2;
+  const auto heightDelta = _nodes[cId].height - _nodes[bId].height;
+
+  // Promotes child (c or b) of node a, whose children are f and g. The shorter of f and g is moved under a.
+  const auto rotateUp = [this, aId](uint32_t promotedId, uint32_t otherId) {
+    auto& a = _nodes[aId];
+    auto& promoted = _nodes[promotedId];
+    auto& other = _nodes[otherId];
+    const auto fId = promoted.child1;
+    const auto gId = promoted.child2;
+    auto& f = _nodes[fId];
+    auto& g = _nodes[gId];
+
+    // Swap a and promoted
+    promoted.child1 = aId;
+    promoted.parent = a.parent;
+    a.parent = promotedId;
+
+    if (promoted.parent != invalid_proxy) {
+      auto& promotedParent = _nodes[promoted.parent];
+      if (promotedParent.child1 == aId) {
+        promotedParent.child1 = promotedId;
+      } else {
+        assert(promotedParent.child2 == aId);
+        promotedParent.child2 = promotedId;
+      }
+    } else {
+      _root = promotedId;
+    }
+
+    // Keep the taller of f and g under the promoted node.
+    const auto keepId = f.height > g.height ? fId : gId;
+    const auto moveId = f.height > g.height ? gId : fId;
+    auto& keep = _nodes[keepId];
+    auto& move = _nodes[moveId];
+
+    promoted.child2 = keepId;
+    if (a.child1 == promotedId) {
+      a.child1 = moveId;
+    } else {
+      a.child2 = moveId;
+    }
+    move.parent = aId;
+
+    a.box = Aabb::createMerged(other.box, move.box);
+    a.height = 1 + std::max(other.height, move.height);
+    promoted.box = Aabb::createMerged(a.box, keep.box);
+    promoted.height = 1 + std::max(a.height, keep.height);
+  };
+
+  if (heightDelta > 1) {
+    rotateUp(cId, bId);
+    return cId;
+  }
+  if (heightDelta < -1) {
+    rotateUp(bId, cId);
+    return bId;
+  }
+  return aId;
+}
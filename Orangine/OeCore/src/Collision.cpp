@@ -48,4 +48,45 @@ bool oe::test_ray_sphere(const oe::Ray& ray, const oe::BoundingSphere& sphere) {
     return false;
   }
   return true;
-}
\ No newline at end of file
+}
+
+bool oe::intersect_ray_triangle(
+    const oe::Ray& ray,
+    const SSE::Vector3& v0,
+    const SSE::Vector3& v1,
+    const SSE::Vector3& v2,
+    Ray_intersection& intersection) {
+  constexpr float epsilon = 1e-7f;
+
+  const auto edge1 = v1 - v0;
+  const auto edge2 = v2 - v0;
+  const auto p = SSE::cross(ray.directionNormal, edge2);
+  const float det = SSE::dot(edge1, p);
+  if (fabsf(det) < epsilon) {
+    // Ray is parallel to the triangle.
+    return false;
+  }
+
+  const float invDet = 1.0f / det;
+  const auto s = ray.origin - SSE::Point3(v0);
+  const float u = SSE::dot(s, p) * invDet;
+  if (u < 0.0f || u > 1.0f) {
+    return false;
+  }
+
+  const auto q = SSE::cross(s, edge1);
+  const float v = SSE::dot(ray.directionNormal, q) * invDet;
+  if (v < 0.0f || u + v > 1.0f) {
+    return false;
+  }
+
+  const float t = SSE::dot(edge2, q) * invDet;
+  if (t < 0.0f) {
+    // Triangle is behind the ray.
+    return false;
+  }
+
+  intersection.position = ray.origin + ray.directionNormal * t;
+  intersection.distance = t;
+  return true;
+}
@@ -4,25 +4,35 @@ using namespace oe;
 
 bool Component_factory::_staticsInitialized = false; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 std::vector<std::unique_ptr<oe::Component>(*)(Entity&)> Component_factory::_factories {}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+std::vector<Component_pool*> Component_factory::_pools {}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 Component_factory::Component_type Component_factory::_maxComponentId = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
 void Component_factory::initStatics() {
   _maxComponentId = 0;
   _factories = {};
+  _pools = {};
   _staticsInitialized = true;
 }
 
 void Component_factory::destroyStatics() {
   _factories = {};
+  _pools = {};
   _staticsInitialized = false;
 }
 
-oe::Component::Component_type oe::Component_factory::createComponentTypeId(std::unique_ptr<oe::Component>(*createInstance)(Entity&)) {
+oe::Component::Component_type oe::Component_factory::createComponentTypeId(
+    std::unique_ptr<oe::Component>(*createInstance)(Entity&),
+    Component_pool* pool) {
   assert(_staticsInitialized);
   _factories.push_back(createInstance);
+  _pools.push_back(pool);
   return _maxComponentId++;
 }
 
 std::unique_ptr<oe::Component> oe::Component_factory::createComponent(Component_type typeId, Entity& entity) {
   return _factories.at(typeId)(entity);
+}
+
+oe::Component_pool* oe::Component_factory::componentPool(Component_type typeId) {
+  return _pools.at(typeId);
 }
\ No newline at end of file
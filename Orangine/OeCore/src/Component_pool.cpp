@@ -0,0 +1,92 @@
+#include "OeCore/Component_pool.h"
+
+#include <algorithm>
+#include <new>
+
+using namespace oe;
+
+Component_pool::Component_pool(size_t componentSize, size_t componentAlignment, Component* (*toComponent)(void*))
+    : _componentSize(componentSize)
+    , _componentAlignment(componentAlignment)
+    , _toComponent(toComponent)
+{
+  assert(componentSize % componentAlignment == 0);
+}
+
+Component_pool::~Component_pool()
+{
+  // Components must be destroyed before their pool; there is no way to run their destructors from here.
+  assert(_size == 0);
+  for (const auto& chunk : _chunks) {
+    ::operator delete(chunk.storage, std::align_val_t(_componentAlignment));
+  }
+}
+
+void* Component_pool::allocate()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  while (_firstFreeChunk < _chunks.size() && _chunks[_firstFreeChunk].occupied == ~uint64_t(0)) {
+    ++_firstFreeChunk;
+  }
+
+  if (_firstFreeChunk == _chunks.size()) {
+    const auto storage = static_cast<std::byte*>(
+        ::operator new(_componentSize * chunk_capacity, std::align_val_t(_componentAlignment)));
+    _chunks.push_back({storage, 0});
+
+    const auto pos = std::upper_bound(
+        _chunksByAddress.begin(), _chunksByAddress.end(), storage,
+        [this](const std::byte* address, size_t chunkIdx) { return address < _chunks[chunkIdx].storage; });
+    _chunksByAddress.insert(pos, _chunks.size() - 1);
+  }
+
+  auto& chunk = _chunks[_firstFreeChunk];
+  size_t slot = 0;
+  while (chunk.occupied & (uint64_t(1) << slot)) {
+    ++slot;
+  }
+  chunk.occupied |= uint64_t(1) << slot;
+  ++_size;
+
+  return chunk.storage + slot * _componentSize;
+}
+
+void Component_pool::deallocate(void* ptr)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  const auto chunkIdx = findChunk(ptr);
+  assert(chunkIdx < _chunks.size());
+
+  auto& chunk = _chunks[chunkIdx];
+  const auto slot = static_cast<size_t>(static_cast<std::byte*>(ptr) - chunk.storage) / _componentSize;
+  assert(chunk.occupied & (uint64_t(1) << slot));
+  chunk.occupied &= ~(uint64_t(1) << slot);
+  --_size;
+
+  _firstFreeChunk = std::min(_firstFreeChunk, chunkIdx);
+}
+
+bool Component_pool::owns(const void* ptr) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return findChunk(ptr) < _chunks.size();
+}
+
+size_t Component_pool::findChunk(const void* ptr) const
+{
+  const auto address = static_cast<const std::byte*>(ptr);
+  auto pos = std::upper_bound(
+      _chunksByAddress.begin(), _chunksByAddress.end(), address,
+      [this](const std::byte* lhs, size_t chunkIdx) { return lhs < _chunks[chunkIdx].storage; });
+  if (pos == _chunksByAddress.begin()) {
+    return _chunks.size();
+  }
+
+  const auto chunkIdx = *--pos;
+  if (address >= _chunks[chunkIdx].storage + _componentSize * chunk_capacity) {
+    return _chunks.size();
+  }
+  return chunkIdx;
+}
@@ -10,19 +10,22 @@ template<>
 void oe::create_manager(
         Manager_instance<IRender_step_manager>& out, IScene_graph_manager& sceneGraphManager,
         IDev_tools_manager& devToolsManager, ITexture_manager& textureManager, IShadowmap_manager& shadowmapManager,
-        IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager)
+        IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager,
+        IAnimation_manager& animationManager)
 {
   out = Manager_instance<IRender_step_manager>(std::make_unique<D3D12_render_step_manager>(
-          sceneGraphManager, devToolsManager, textureManager, shadowmapManager, entityRenderManager, lightingManager));
+          sceneGraphManager, devToolsManager, textureManager, shadowmapManager, entityRenderManager, lightingManager,
+          animationManager));
 }
 
 D3D12_render_step_manager::D3D12_render_step_manager(
         IScene_graph_manager& sceneGraphManager, IDev_tools_manager& devToolsManager,
         ITexture_manager& textureManager, IShadowmap_manager& shadowmapManager,
-        IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager)
+        IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager,
+        IAnimation_manager& animationManager)
     : Render_step_manager(
               sceneGraphManager, devToolsManager, textureManager, shadowmapManager, entityRenderManager,
-              lightingManager) {}
+              lightingManager, animationManager) {}
 
 // Base class overrides
 void D3D12_render_step_manager::initialize() {
@@ -14,7 +14,8 @@ class D3D12_render_step_manager final : public Render_step_manager {
   D3D12_render_step_manager(
           IScene_graph_manager& sceneGraphManager, IDev_tools_manager& devToolsManager,
           ITexture_manager& textureManager, IShadowmap_manager& shadowmapManager,
-          IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager);
+          IEntity_render_manager& entityRenderManager, ILighting_manager& lightingManager,
+          IAnimation_manager& animationManager);
 
   // Base class overrides
   void initialize() override;
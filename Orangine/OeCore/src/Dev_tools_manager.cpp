@@ -25,10 +25,10 @@ std::string Dev_tools_manager::_name = "Dev_tools_manager";
 template<>
 void oe::create_manager(Manager_instance<IDev_tools_manager>& out,
         IScene_graph_manager& sceneGraphManager, IEntity_render_manager& entityRenderManager,
-        IMaterial_manager& materialManager)
+        IMaterial_manager& materialManager, IAnimation_manager& animationManager)
 {
   out = Manager_instance<IDev_tools_manager>(std::make_unique<Dev_tools_manager>(
-          sceneGraphManager, entityRenderManager, materialManager));
+          sceneGraphManager, entityRenderManager, materialManager, animationManager));
 }
 
 void Dev_tools_manager::loadConfig(const IConfigReader& configReader)
@@ -252,6 +252,15 @@ void Dev_tools_manager::renderImGui() {
   if (ImGui::Begin("Animation")) {
     ImGui::Checkbox("Render Skeletons", &_renderSkeletons);
 
+    const auto& animationStats = _animationManager.animationStats();
+    ImGui::Text(
+        "Channels: %u sampled, %u skipped", animationStats.sampledChannels, animationStats.skippedChannels);
+    ImGui::Text(
+        "Controllers: %u full rate, %u reduced rate, %u paused",
+        animationStats.fullRateControllers,
+        animationStats.reducedRateControllers,
+        animationStats.pausedControllers);
+
     for (const auto entity : *_animationControllers) {
       const auto animComponent = entity->getFirstComponentOfType<Animation_controller_component>();
       assert(animComponent);
@@ -423,6 +432,7 @@ void Dev_tools_manager::renderImGui() {
   if (ImGui::Begin("Debug Statistics")) {
     ImGui::TextColored(ImVec4(1, 0, 1, 1), "Frame Time (s): %.4f", _fpsCounter->avgFrameTime());
     ImGui::TextColored(ImVec4(1, 0, 1, 1), "FPS: %.2f", _fpsCounter->avgFps());
+    ImGui::Text("Transforms recomputed: %u", _sceneGraphManager.getRecomputedTransformCount());
     if (_guiDebugText.size()) {
       ImGui::Text(_guiDebugText.c_str());
     }
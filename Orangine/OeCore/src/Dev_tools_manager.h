@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "OeCore/Collision.h"
 #include "OeCore/Fps_counter.h"
+#include "OeCore/IAnimation_manager.h"
 #include "OeCore/IDev_tools_manager.h"
 #include "OeCore/IScene_graph_manager.h"
 #include <OeCore/IEntity_render_manager.h>
@@ -17,11 +18,12 @@ class Dev_tools_manager : public IDev_tools_manager, public Manager_base, public
  public:
   Dev_tools_manager(
           IScene_graph_manager& sceneGraphManager, IEntity_render_manager& entityRenderManager,
-          IMaterial_manager& materialManager)
+          IMaterial_manager& materialManager, IAnimation_manager& animationManager)
       : IDev_tools_manager(), Manager_base(), Manager_tickable(), Manager_deviceDependent(), _unlitMaterial(nullptr)
       , _sceneGraphManager(sceneGraphManager)
       , _entityRenderManager(entityRenderManager)
       , _materialManager(materialManager)
+      , _animationManager(animationManager)
   {}
 
   // Manager_base implementation
@@ -106,6 +108,7 @@ class Dev_tools_manager : public IDev_tools_manager, public Manager_base, public
   IScene_graph_manager& _sceneGraphManager;
   IEntity_render_manager& _entityRenderManager;
   IMaterial_manager& _materialManager;
+  IAnimation_manager& _animationManager;
 
   Invokable_dispatcher<std::string> _commandAutocompleteRequestedDispatcher;
 
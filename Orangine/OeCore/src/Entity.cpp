@@ -4,6 +4,8 @@
 #include "OeCore/Math_constants.h"
 #include "Scene_graph_manager.h"
 
+#include <algorithm>
+
 using namespace oe;
 using namespace DirectX;
 
@@ -23,40 +25,95 @@ Entity::Entity(IScene_graph_manager& sceneGraph, IComponent_factory& componentFa
     , _worldRotation(SSE::Quat::identity())
     , _worldScale(Vector3(1.0f, 1.0f, 1.0f))
     , _componentFactory(componentFactory)
+    , _transformStore(nullptr)
+    , _transformIndex(Entity_transform_store::invalid_index)
+    , _dirtyFlags(
+              Entity_transform_store::Transform_flag_transform_dirty |
+              Entity_transform_store::Transform_flag_bound_sphere_dirty)
+    , _boundingVolumeProxy(Bounding_volume_hierarchy::invalid_proxy)
 {}
 
 void Entity::computeWorldTransform() {
-  SSE::Matrix4 t;
-  if (hasParent()) {
-    _worldScale = mulPerElem(_parent->_worldScale, _localScale);
-    _worldRotation = _parent->worldRotation() * _localRotation;
+  auto& worldTransform = isTransformStored() ? _transformStore->worldTransforms[_transformIndex] : _worldTransform;
+  auto& worldRotation = isTransformStored() ? _transformStore->worldRotations[_transformIndex] : _worldRotation;
+  auto& worldScale = isTransformStored() ? _transformStore->worldScales[_transformIndex] : _worldScale;
 
-    const auto worldPosition = _parent->_worldTransform * SSE::Point3(_localPosition);
-    t = SSE::Matrix4::translation(worldPosition.getXYZ());
+  if (hasParent()) {
+    Entity_transform_store::computeWorldTransform(
+        position(), rotation(), scale(), _parent->worldTransform(), _parent->worldRotation(), _parent->worldScale(),
+        worldTransform, worldRotation, worldScale);
   } else {
-    _worldRotation = _localRotation;
-    _worldScale = _localScale;
+    Entity_transform_store::computeWorldTransform(
+        position(), rotation(), scale(), worldTransform, worldRotation, worldScale);
+  }
+}
+
+Component& Entity::getComponent(size_t index) const { return *_components[index]; }
 
-    t = SSE::Matrix4::translation(_localPosition);
+Component& Entity::attachComponent(std::unique_ptr<Component> component) {
+  auto& componentRef = *component;
+  const auto typeId = component->getType();
+  _components.push_back(std::move(component));
+
+  // Insert after any existing components of the same type, so that they stay in the order they were added.
+  const auto pos = std::upper_bound(
+      _componentsByType.begin(), _componentsByType.end(), typeId,
+      [](Component::Component_type type, const Component_type_entry& entry) { return type < entry.type; });
+  _componentsByType.insert(pos, {typeId, &componentRef});
+
+  if (typeId < max_indexed_component_type) {
+    const auto typeBit = uint64_t(1) << typeId;
+    if (_componentTypeMask & typeBit) {
+      _repeatedComponentTypeMask |= typeBit;
+    }
+    _componentTypeMask |= typeBit;
   }
 
-  const auto r = SSE::Matrix4::rotation(_worldRotation);
-  const auto s = SSE::Matrix4::scale(_worldScale);
+  return componentRef;
+}
 
-  _worldTransform = t * r * s;
+void Entity::eraseComponent(Component& component) {
+  for (auto pos = _components.begin(); pos != _components.end(); ++pos) {
+    if (pos->get() == &component) {
+      _components.erase(pos);
+      break;
+    }
+  }
+  rebuildComponentIndex();
 }
 
-Component& Entity::getComponent(size_t index) const { return *_components[index]; }
+void Entity::rebuildComponentIndex() {
+  _componentsByType.clear();
+  _componentTypeMask = 0;
+  _repeatedComponentTypeMask = 0;
+
+  for (const auto& component : _components) {
+    const auto typeId = component->getType();
+    _componentsByType.push_back({typeId, component.get()});
+
+    if (typeId < max_indexed_component_type) {
+      const auto typeBit = uint64_t(1) << typeId;
+      if (_componentTypeMask & typeBit) {
+        _repeatedComponentTypeMask |= typeBit;
+      }
+      _componentTypeMask |= typeBit;
+    }
+  }
+
+  std::stable_sort(
+      _componentsByType.begin(), _componentsByType.end(),
+      [](const Component_type_entry& lhs, const Component_type_entry& rhs) { return lhs.type < rhs.type; });
+}
 
 void Entity::lookAt(const Entity& other) { lookAt(other.position(), math::up); }
 
 void Entity::lookAt(const SSE::Vector3& position, const SSE::Vector3& worldUp) {
   SSE::Vector3 forward;
   if (hasParent()) {
-    const auto parentWorldInv = SSE::inverse(_parent->_worldTransform);
-    forward = (parentWorldInv * position).getXYZ() - _localPosition;
+    const auto parentWorldInv = SSE::inverse(_parent->worldTransform());
+    forward = (parentWorldInv * position).getXYZ() - this->position();
   } else {
-    forward = position - _localPosition;
+    forward = position - this->position();
   }
 
   if (SSE::lengthSqr(forward) == 0) {
@@ -75,7 +132,7 @@ void Entity::lookAt(const SSE::Vector3& position, const SSE::Vector3& worldUp) {
 
   auto camToWorld = SSE::Matrix3(right, up, -forward);
 
-  _localRotation = SSE::Quat(camToWorld);
+  setRotation(SSE::Quat(camToWorld));
 
   computeWorldTransform();
 }
@@ -84,7 +141,59 @@ Component& Entity::addCloneOfComponent(const Component& srcComponent) {
   return _componentFactory.cloneComponentToEntity(srcComponent, *this);
 }
 
-void Entity::setActive(bool bActive) { _active = bActive; }
+void Entity::setActive(bool bActive) {
+  _active = bActive;
+  if (isTransformStored()) {
+    _transformStore->setFlag(_transformIndex, Entity_transform_store::Transform_flag_active, bActive);
+  }
+
+  // Inactive entities are not updated, so our world transform may be stale.
+  if (bActive) {
+    markTransformDirty();
+  }
+}
+
+void Entity::setCalculateBoundSphereFromChildren(bool calculateBoundSphereFromChildren) {
+  _calculateBoundSphereFromChildren = calculateBoundSphereFromChildren;
+  if (isTransformStored()) {
+    _transformStore->setFlag(
+        _transformIndex,
+        Entity_transform_store::Transform_flag_calculate_bound_sphere_from_children,
+        calculateBoundSphereFromChildren);
+  }
+
+  if (calculateBoundSphereFromChildren) {
+    markDirty(Entity_transform_store::Transform_flag_children_dirty);
+  }
+}
+
+void Entity::setCalculateWorldTransform(bool calculateWorldTransform) {
+  _calculateWorldTransform = calculateWorldTransform;
+  if (isTransformStored()) {
+    _transformStore->setFlag(
+        _transformIndex, Entity_transform_store::Transform_flag_calculate_world_transform, calculateWorldTransform);
+  }
+
+  if (calculateWorldTransform) {
+    markTransformDirty();
+  }
+}
+
+void Entity::markDirty(uint8_t dirtyFlags) {
+  if (isTransformStored()) {
+    // The store visits every slot in a linear pass, so there is no need to flag ancestors.
+    _transformStore->flags[_transformIndex] |= dirtyFlags;
+    return;
+  }
+
+  _dirtyFlags |= dirtyFlags;
+  for (auto ancestor = _parent; ancestor != nullptr; ancestor = ancestor->_parent) {
+    if (ancestor->_dirtyFlags & Entity_transform_store::Transform_flag_descendant_dirty) {
+      break;
+    }
+    ancestor->_dirtyFlags |= Entity_transform_store::Transform_flag_descendant_dirty;
+  }
+}
 
 void Entity::setParent(Entity& newParent) {
   // TODO: Check that we don't create a cycle?
@@ -99,6 +208,11 @@ void Entity::setParent(Entity& newParent) {
   newParentPtr->_children.push_back(thisPtr);
 
   _parent = newParentPtr.get();
+
+  // Our world transform is now relative to the new parent, which must also merge our bound sphere.
+  markDirty(
+      Entity_transform_store::Transform_flag_transform_dirty |
+      Entity_transform_store::Transform_flag_bound_sphere_dirty);
 }
 
 void Entity::removeParent() {
@@ -106,6 +220,9 @@ void Entity::removeParent() {
     return;
   }
 
+  // The old parent must re-merge its bound sphere without us.
+  _parent->markDirty(Entity_transform_store::Transform_flag_children_dirty);
+
   Entity_ptr_vec& children = _parent->_children;
   for (auto it = children.begin(); it != children.end(); ++it) {
     const auto child = (*it).get();
@@ -118,30 +235,49 @@ void Entity::removeParent() {
   const auto thisPtr = _sceneGraph.getEntityPtrById(getId());
   _sceneGraph.addToRoot(thisPtr);
   _parent = nullptr;
+
+  markTransformDirty();
 }
 
-SSE::Vector3 Entity::worldPosition() const { return _worldTransform.getTranslation(); }
+SSE::Vector3 Entity::worldPosition() const { return worldTransform().getTranslation(); }
 
-const SSE::Vector3& Entity::worldScale() const { return _worldScale; }
+BoundingSphere Entity::worldBoundSphere() const {
+  const auto& transform = worldTransform();
+  const auto& localBounds = boundSphere();
+  const auto scale = transform.getUpper3x3();
+  const auto maxScale =
+      std::max({SSE::length(scale.getCol0()), SSE::length(scale.getCol1()), SSE::length(scale.getCol2())});
+  return BoundingSphere(SSE::Vector3(transform * SSE::Point3(localBounds.center)), localBounds.radius * maxScale);
+}
+
+const SSE::Vector3& Entity::worldScale() const {
+  return isTransformStored() ? _transformStore->worldScales[_transformIndex] : _worldScale;
+}
 
-const SSE::Quat& Entity::worldRotation() const { return _worldRotation; }
+const SSE::Quat& Entity::worldRotation() const {
+  return isTransformStored() ? _transformStore->worldRotations[_transformIndex] : _worldRotation;
+}
 void Entity::setTransform(const SSE::Matrix4& transform) {
-  decompose_matrix(transform, _localPosition, _localRotation, _localScale);
+  SSE::Vector3 localPosition, localScale;
+  SSE::Quat localRotation;
+  decompose_matrix(transform, localPosition, localRotation, localScale);
+  setPosition(localPosition);
+  setRotation(localRotation);
+  setScale(localScale);
 }
 
 std::shared_ptr<Entity> Entity::verifyEntityPtr() const {
-  const auto thisPtr = _sceneGraph.getEntityPtrById(getId());
-  if (!thisPtr) {
+  if (_sceneGraph.findEntityById(getId()) != this) {
     OE_THROW(std::runtime_error("Attempting to access deleted Entity (id=" + std::to_string(getId()) + ")"));
   }
 
-  return thisPtr;
+  return std::const_pointer_cast<Entity>(shared_from_this());
 }
 
 Entity& EntityRef::get() const {
-  const auto ptr = sceneGraph.getEntityPtrById(id);
+  const auto ptr = sceneGraph.findEntityById(id);
   if (!ptr)
     OE_THROW(
         std::runtime_error("Attempting to access deleted Entity (id=" + std::to_string(id) + ")"));
-  return *ptr.get();
+  return *ptr;
 }
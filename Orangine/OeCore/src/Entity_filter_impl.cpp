@@ -2,6 +2,8 @@
 
 #include <OeCore/Entity.h>
 
+#include <algorithm>
+
 using namespace oe;
 
 Entity_filter_impl::Entity_filter_impl(const Component_type_set::const_iterator& begin,
@@ -10,68 +12,67 @@ Entity_filter_impl::Entity_filter_impl(const Component_type_set::const_iterator&
     : mode(mode)
 {
   componentTypes = std::unordered_set<Component::Component_type>(begin, end);
+
+  for (const auto componentType : componentTypes) {
+    if (componentType < Entity::max_indexed_component_type) {
+      _componentTypeMask |= uint64_t(1) << componentType;
+    } else {
+      _unindexedComponentTypes.push_back(componentType);
+    }
+  }
 }
 
-void Entity_filter_impl::handleEntityAdd(std::shared_ptr<Entity> entity)
+bool Entity_filter_impl::hasComponentType(Component::Component_type componentType) const
 {
-  // Add it to the filter if all of the components we look for is present.
-  const auto componentCount = entity->getComponentCount();
+  if (componentType < Entity::max_indexed_component_type) {
+    return (_componentTypeMask & (uint64_t(1) << componentType)) != 0;
+  }
+  return std::find(_unindexedComponentTypes.begin(), _unindexedComponentTypes.end(), componentType) !=
+         _unindexedComponentTypes.end();
+}
 
-  if (mode == Entity_filter_mode::All) {
-    // An entity can contain multiple instances of a single component type.
-    Component_type_set foundComponents;
-    for (size_t i = 0; i < componentCount; i++) {
-      const auto& component = entity->getComponent(i);
+bool Entity_filter_impl::matches(const Entity& entity) const
+{
+  const auto foundMask = entity.componentTypeMask() & _componentTypeMask;
+  const auto hasComponent = [&entity](Component::Component_type componentType) {
+    return entity.getFirstComponentOfTypeId(componentType) != nullptr;
+  };
 
-      const auto pos = componentTypes.find(component.getType());
-      if (pos == componentTypes.end())
-        continue;
+  if (mode == Entity_filter_mode::All) {
+    return foundMask == _componentTypeMask &&
+           std::all_of(_unindexedComponentTypes.begin(), _unindexedComponentTypes.end(), hasComponent);
+  }
 
-      foundComponents.insert(component.getType());
-    }
+  assert(mode == Entity_filter_mode::Any);
+  return foundMask != 0 ||
+         std::any_of(_unindexedComponentTypes.begin(), _unindexedComponentTypes.end(), hasComponent);
+}
 
-    if (foundComponents.size() == componentTypes.size()) {
-      _entities.insert(entity);
-      publishEntityAdd(entity.get());
-    }
-  }
-  else {
-    assert(mode == Entity_filter_mode::Any);
-    for (size_t i = 0; i < componentCount; i++) {
-      const auto& component = entity->getComponent(i);
-
-      const auto pos = componentTypes.find(component.getType());
-      if (pos != componentTypes.end()) {
-        _entities.insert(entity);
-        publishEntityAdd(entity.get());
-        return;
-      }
-    }
+void Entity_filter_impl::handleEntityAdd(std::shared_ptr<Entity> entity)
+{
+  // Add it to the filter if the components we look for are present.
+  if (matches(*entity) && insertEntity(entity)) {
+    publishEntityAdd(entity.get());
   }
 }
 
 void Entity_filter_impl::handleEntityRemove(std::shared_ptr<Entity> entity)
 {
-  // Remove it from the filter if any one of the components we look for is present (early exit).
-  const auto componentCount = entity->getComponentCount();
-  for (size_t i = 0; i < componentCount; i++) {
-    const auto& component = entity->getComponent(i);
-
-    const auto pos = componentTypes.find(component.getType());
-    if (pos == componentTypes.end())
-      continue;
-
-    _entities.erase(entity);
+  if (eraseEntity(entity.get())) {
     publishEntityRemove(entity.get());
-    break;
   }
 }
 
 void Entity_filter_impl::handleEntityComponentsUpdated(std::shared_ptr<Entity> entity)
 {
-  // TODO: Optimize.
-  handleEntityRemove(entity);
-  handleEntityAdd(entity);
+  // Listeners are only notified if membership actually changes.
+  if (matches(*entity)) {
+    if (insertEntity(entity)) {
+      publishEntityAdd(entity.get());
+    }
+  } else if (eraseEntity(entity.get())) {
+    publishEntityRemove(entity.get());
+  }
 }
 
 void Entity_filter_impl::add_listener(std::weak_ptr<Entity_filter_listener> callback)
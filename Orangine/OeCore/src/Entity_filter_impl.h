@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 namespace oe {
 class Entity;
@@ -22,6 +23,12 @@ class Entity_filter_impl : public Entity_filter {
 
   void add_listener(std::weak_ptr<Entity_filter_listener> callback) override;
 
+  // Returns true if adding or removing a component of the given type may change which entities match this filter.
+  bool hasComponentType(Component::Component_type componentType) const;
+
+  // Returns true if the entity has the component types required by this filter.
+  bool matches(const Entity& entity) const;
+
   void handleEntityAdd(std::shared_ptr<Entity> entity);
   void handleEntityRemove(std::shared_ptr<Entity> entity);
   void handleEntityComponentsUpdated(std::shared_ptr<Entity> entity);
@@ -30,6 +37,11 @@ class Entity_filter_impl : public Entity_filter {
   void publishEntityAdd(Entity* entity);
   void publishEntityRemove(Entity* entity);
 
+  // Component types below Entity::max_indexed_component_type are matched against Entity::componentTypeMask(), the
+  // rest are looked up individually.
+  uint64_t _componentTypeMask = 0;
+  std::vector<Component::Component_type> _unindexedComponentTypes;
+
   std::vector<std::weak_ptr<Entity_filter_listener>> _listeners;
 };
 } // namespace oe
\ No newline at end of file
@@ -2,12 +2,17 @@
 #include "OeCore/Collision.h"
 #include "OeCore/Entity_graph_loader_gltf.h"
 #include "OeCore/IEntity_repository.h"
-#include "OeCore/FileUtils.h"
+#include "OeCore/IJob_manager.h"
+#include "OeCore/Mapped_file.h"
 #include "OeCore/Material.h"
+#include "OeCore/Mesh_buffer_pool.h"
 #include "OeCore/Mesh_data.h"
+#include "OeCore/Mesh_data_component.h"
+#include "OeCore/Mesh_optimizer.h"
 #include "OeCore/Mesh_utils.h"
 #include "OeCore/Morph_weights_component.h"
 #include "OeCore/PBR_material.h"
+#include "OeCore/Primitive_mesh_data_factory.h"
 #include "OeCore/Renderable_component.h"
 #include "OeCore/Skinned_mesh_component.h"
 #include "OeCore/Texture.h"
@@ -16,7 +21,11 @@
 #include "OeCore/IMaterial_manager.h"
 #include "OeCore/IScene_graph_manager.h"
 
+#include <algorithm>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <set>
 #include <wincodec.h>
 
 #define TINYGLTF_IMPLEMENTATION
@@ -159,8 +168,9 @@ std::function<std::unique_ptr<Mesh_vertex_buffer_accessor>(
     size_t count,
     size_t stride,
     size_t offset)>
-vertexAccessorFactory(Vertex_attribute_semantic vertexAttribute) {
-  return [vertexAttribute](
+vertexAccessorFactory(Vertex_attribute_semantic vertexAttribute, bool normalized = false) {
+  const auto encoding = normalized ? Element_encoding::Normalized : Element_encoding::None;
+  return [vertexAttribute, encoding](
              shared_ptr<Mesh_buffer> meshBuffer,
              Element_type type,
              Element_component component,
@@ -169,46 +179,78 @@ vertexAccessorFactory(Vertex_attribute_semantic vertexAttribute) {
              size_t offset) {
     return make_unique<Mesh_vertex_buffer_accessor>(
         meshBuffer,
-        Vertex_attribute_element{vertexAttribute, type, component},
+        Vertex_attribute_element{vertexAttribute, type, component, encoding},
         static_cast<uint32_t>(count),
         static_cast<uint32_t>(stride),
         static_cast<uint32_t>(offset));
   };
 }
 
+// The mesh data of a glTF mesh primitive. It doesn't depend on the nodes that use the mesh, so is built once, by
+// prepareFile, and shared by their entities.
+struct Prepared_primitive {
+  shared_ptr<Mesh_data> meshData;
+  vector<Mesh_lod> lods;
+  BoundingSphere boundSphere;
+};
+
+// Everything that prepareFile reads from the file. Contains no entities, so may be built on any thread.
+struct Gltf_file : Entity_graph_loader::Prepared_file {
+  Model model;
+  string baseDir;
+  string rootEntityName;
+  map<size_t, shared_ptr<Mesh_buffer>> accessorIdxToMeshBuffers;
+  mutex accessorIdxToMeshBuffersMutex;
+  // For .glb files, a view of the BIN chunk in the mapped file. Accessors into it reference it rather than copying.
+  shared_ptr<Mesh_buffer> binChunkBuffer;
+  // Indexed by mesh, then by primitive.
+  vector<vector<Prepared_primitive>> meshPrimitives;
+  bool optimizeMeshes = false;
+  bool generateLods = false;
+  Mesh_simplifier_options lodOptions;
+  bool quantizeVertices = false;
+  Mesh_quantizer_options quantizationOptions;
+  // Null if buffers aren't pooled.
+  shared_ptr<Mesh_buffer_pool> meshBufferPool;
+  // Vertex and morph target accessors used by more than one primitive.
+  set<int> sharedVertexAccessors;
+};
+
+// State for creating the entities of a prepared file.
 struct Loader_data {
   Loader_data(
-          Model& model, string&& baseDir, IWICImagingFactory* imagingFactory,
+          Gltf_file& file, IWICImagingFactory* imagingFactory,
           IScene_graph_manager& sceneGraphManager, IEntity_repository& entityRepository,
-          IMaterial_manager& materialManager, ITexture_manager& textureManager, IComponent_factory& componentFactory,
-          bool calculateBounds)
-      : model(model)
-      , baseDir(std::move(baseDir))
+          IMaterial_manager& materialManager, ITexture_manager& textureManager, IComponent_factory& componentFactory)
+      : file(file)
+      , model(file.model)
+      , baseDir(file.baseDir)
+      , calculateBounds(file.calculateBounds)
       , imagingFactory(imagingFactory)
       , sceneGraphManager(sceneGraphManager)
-      , calculateBounds(calculateBounds)
       , entityRepository(entityRepository)
       , materialManager(materialManager)
       , textureManager(textureManager)
       , componentFactory(componentFactory)
   {}
 
+  Gltf_file& file;
   Model& model;
-  string baseDir;
+  const string& baseDir;
+  bool calculateBounds;
   IWICImagingFactory* imagingFactory;
   IScene_graph_manager& sceneGraphManager;
   IEntity_repository& entityRepository;
   IMaterial_manager& materialManager;
   ITexture_manager& textureManager;
   IComponent_factory& componentFactory;
-  map<size_t, shared_ptr<Mesh_buffer>> accessorIdxToMeshBuffers;
   vector<shared_ptr<Entity>> nodeIdxToEntity;
-  bool calculateBounds;
   shared_ptr<Entity> rootEntity;
 };
 
+Prepared_primitive prepare_primitive(const Primitive& prim, Gltf_file& loaderData);
 shared_ptr<Entity> create_entity(vector<Node>::size_type nodeIdx, Loader_data& loaderData);
-void create_animation(int animIdx, Loader_data loaderData);
+void create_animation(int animIdx, Loader_data& loaderData);
 
 const char* g_pbrPropertyName_baseColorFactor = "baseColorFactor";
 const char* g_pbrPropertyName_baseColorTexture = "baseColorTexture";
@@ -223,9 +265,13 @@ const char* g_pbrPropertyValue_alphaMode_opaque = "OPAQUE";
 const char* g_pbrPropertyValue_alphaMode_mask = "MASK";
 const char* g_pbrPropertyValue_alphaMode_blend = "BLEND";
 
-Entity_graph_loader_gltf::Entity_graph_loader_gltf(IMaterial_manager& materialManager, ITexture_manager& textureManager)
+Entity_graph_loader_gltf::Entity_graph_loader_gltf(
+    IMaterial_manager& materialManager,
+    ITexture_manager& textureManager,
+    IJob_manager& jobManager)
     : _materialManager(materialManager)
     , _textureManager(textureManager)
+    , _jobManager(jobManager)
 {
   // Create the COM imaging factory
   ThrowIfFailed(CoCreateInstance(
@@ -234,12 +280,52 @@ Entity_graph_loader_gltf::Entity_graph_loader_gltf(IMaterial_manager& materialMa
 
 void Entity_graph_loader_gltf::getSupportedFileExtensions(vector<string>& extensions) const {
   extensions.emplace_back("gltf");
+  extensions.emplace_back("glb");
+}
+
+bool gltf_utils::is_glb(const uint8_t* data, size_t size) { return size >= 12 && memcmp(data, "glTF", 4) == 0; }
+
+bool gltf_utils::find_glb_bin_chunk(const uint8_t* data, size_t size, size_t& binChunkOffset, size_t& binChunkSize) {
+  constexpr size_t headerSize = 12;
+  constexpr size_t chunkHeaderSize = 8;
+  constexpr size_t chunkAlignment = 4;
+  constexpr uint32_t chunkTypeBin = 0x004E4942;
+
+  auto offset = headerSize;
+  while (offset + chunkHeaderSize <= size) {
+    uint32_t chunkLength;
+    uint32_t chunkType;
+    memcpy(&chunkLength, data + offset, sizeof(chunkLength));
+    memcpy(&chunkType, data + offset + sizeof(chunkLength), sizeof(chunkType));
+
+    const auto chunkStart = offset + chunkHeaderSize;
+    if (chunkLength > size - chunkStart || chunkLength % chunkAlignment != 0)
+      return false;
+
+    if (chunkType == chunkTypeBin) {
+      binChunkOffset = chunkStart;
+      binChunkSize = chunkLength;
+      return true;
+    }
+    offset = chunkStart + chunkLength;
+  }
+  return false;
+}
+
+shared_ptr<Mesh_buffer> gltf_utils::map_glb_bin_chunk(const shared_ptr<Mapped_file>& mappedFile) {
+  size_t binChunkOffset = 0;
+  size_t binChunkSize = 0;
+  if (!is_glb(mappedFile->data(), mappedFile->size()) ||
+      !find_glb_bin_chunk(mappedFile->data(), mappedFile->size(), binChunkOffset, binChunkSize)) {
+    return nullptr;
+  }
+  return make_shared<Mesh_buffer>(mappedFile->data() + binChunkOffset, binChunkSize, mappedFile);
 }
 
 template <class TMesh_buffer_accessor>
 unique_ptr<TMesh_buffer_accessor> useOrCreateBufferForAccessor(
     size_t accessorIndex,
-    Loader_data& loaderData,
+    Gltf_file& loaderData,
     const std::map<int, std::set<int>> allowedAccessorTypes,
     int expectedBufferViewTarget,
     std::function<unique_ptr<TMesh_buffer_accessor>(
@@ -314,39 +400,60 @@ unique_ptr<TMesh_buffer_accessor> useOrCreateBufferForAccessor(
         "BufferView " + to_string(accessor.bufferView) + " exceeds maximum size of buffer " +
         to_string(bufferView.buffer)));
 
-  // Does the mesh buffer exist in the cache?
-  const auto pos = loaderData.accessorIdxToMeshBuffers.find(accessorIndex);
-  shared_ptr<Mesh_buffer> meshBuffer;
   const auto elementType = g_gltfType_elementType.at(accessor.type);
-  auto elementComponent = g_gltfComponent_elementComponent.at(accessor.componentType);
-  if (pos == loaderData.accessorIdxToMeshBuffers.end()) {
-
-    // Convert index buffers from 8-bit to 32 bit.
-    if (elementType == Element_type::Scalar &&
-        expectedBufferViewTarget == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER &&
-        (elementComponent == Element_component::Unsigned_byte ||
-         elementComponent == Element_component::Signed_byte)) {
-      // Transform the data to a known format
-      const auto convertedIndexAccessor = mesh_utils::create_index_buffer(
-          buffer.data,
-          static_cast<uint32_t>(accessor.count),
-          elementComponent,
-          static_cast<uint32_t>(sourceStride),
-          static_cast<uint32_t>(bufferOffset));
-      meshBuffer = convertedIndexAccessor->buffer;
-      elementComponent = convertedIndexAccessor->component;
-    } else {
-      // Copy the data.
-      meshBuffer = mesh_utils::create_buffer(
-          static_cast<uint32_t>(sourceElementSize),
-          static_cast<uint32_t>(accessor.count),
-          buffer.data,
-          static_cast<uint32_t>(sourceStride),
-          static_cast<uint32_t>(bufferOffset));
+  const auto elementComponent = g_gltfComponent_elementComponent.at(accessor.componentType);
+
+  // Index buffers are converted from 8-bit to 32 bit.
+  const auto convertIndices = elementType == Element_type::Scalar &&
+                              expectedBufferViewTarget == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER &&
+                              (elementComponent == Element_component::Unsigned_byte ||
+                               elementComponent == Element_component::Signed_byte);
+
+  // The BIN chunk of a .glb is always buffer 0. Data in it is used in place, with the glTF accessor's stride and offset.
+  if (loaderData.binChunkBuffer && bufferView.buffer == 0 && buffer.uri.empty() && !convertIndices) {
+    return accessorFactory(
+        loaderData.binChunkBuffer, elementType, elementComponent, accessor.count, sourceStride, bufferOffset);
+  }
+
+  if (convertIndices) {
+    // Transform the data to a known format. These aren't cached, as their element format differs from the accessor's.
+    const auto convertedIndexAccessor = mesh_utils::create_index_buffer(
+        buffer.data,
+        static_cast<uint32_t>(accessor.count),
+        elementComponent,
+        static_cast<uint32_t>(sourceStride),
+        static_cast<uint32_t>(bufferOffset));
+    return accessorFactory(
+        convertedIndexAccessor->buffer,
+        elementType,
+        convertedIndexAccessor->component,
+        accessor.count,
+        convertedIndexAccessor->stride,
+        0);
+  }
+
+  // Does the mesh buffer exist in the cache? Primitives are prepared in parallel, so two of them may copy the same
+  // accessor at once; the first copy to be cached is used by both.
+  shared_ptr<Mesh_buffer> meshBuffer;
+  {
+    std::lock_guard<std::mutex> lock(loaderData.accessorIdxToMeshBuffersMutex);
+    const auto pos = loaderData.accessorIdxToMeshBuffers.find(accessorIndex);
+    if (pos != loaderData.accessorIdxToMeshBuffers.end()) {
+      meshBuffer = pos->second;
     }
-    loaderData.accessorIdxToMeshBuffers[accessorIndex] = meshBuffer;
-  } else {
-    meshBuffer = pos->second;
+  }
+
+  if (!meshBuffer) {
+    // Copy the data.
+    auto copiedBuffer = mesh_utils::create_buffer(
+        static_cast<uint32_t>(sourceElementSize),
+        static_cast<uint32_t>(accessor.count),
+        buffer.data,
+        static_cast<uint32_t>(sourceStride),
+        static_cast<uint32_t>(bufferOffset));
+
+    std::lock_guard<std::mutex> lock(loaderData.accessorIdxToMeshBuffersMutex);
+    meshBuffer = loaderData.accessorIdxToMeshBuffers.emplace(accessorIndex, move(copiedBuffer)).first->second;
   }
 
   // Note that the buffer we created above contains ONLY this element, thus has offset of zero, and
@@ -404,7 +511,7 @@ SSE::Matrix4 createMatrix4FromGltfArray(const vector<double>& m) {
 }
 
 std::vector<SSE::Matrix4> createMatrix4ArrayFromAccessor(
-    Loader_data& loaderData,
+    Gltf_file& loaderData,
     int accessorIndex) {
   // Inverse bind matrices
   const auto matricesAccessor = useOrCreateBufferForAccessor<Mesh_buffer_accessor>(
@@ -435,8 +542,15 @@ vector<shared_ptr<Entity>> Entity_graph_loader_gltf::loadFile(
     IEntity_repository& entityRepository,
     IComponent_factory& componentFactory,
     bool calculateBounds) const {
-  vector<shared_ptr<Entity>> entities;
-  Model model;
+  return instantiatePreparedFile(
+      *prepareFile(filePath, calculateBounds), sceneGraphManager, entityRepository, componentFactory);
+}
+
+unique_ptr<Entity_graph_loader::Prepared_file> Entity_graph_loader_gltf::prepareFile(
+    string_view filePath,
+    bool calculateBounds) const {
+  auto gltfFile = make_unique<Gltf_file>();
+  auto& model = gltfFile->model;
   TinyGLTF loader;
   string err;
   string warn;
@@ -444,7 +558,9 @@ vector<shared_ptr<Entity>> Entity_graph_loader_gltf::loadFile(
   const auto filePathStr = string(filePath);
   LOG(INFO) << "Loading entity graph (glTF): " << filePathStr;
 
-  auto gltfAscii = get_file_contents(filePathStr.c_str());
+  // Map the file, rather than reading it all, so that a .glb's BIN chunk can be used without copying.
+  const auto mappedFile = make_shared<Mapped_file>(filePathStr);
+  const auto binary = gltf_utils::is_glb(mappedFile->data(), mappedFile->size());
 
   std::string baseDir;
   {
@@ -455,13 +571,20 @@ vector<shared_ptr<Entity>> Entity_graph_loader_gltf::loadFile(
   }
 
   const auto filename = filePathStr.substr(baseDir.size());
-  const auto ret = loader.LoadASCIIFromString(
-      &model,
-      &err,
-      &warn,
-      gltfAscii.c_str(),
-      static_cast<unsigned>(gltfAscii.length()),
-      baseDir);
+  const auto ret = binary ? loader.LoadBinaryFromMemory(
+                                &model,
+                                &err,
+                                &warn,
+                                mappedFile->data(),
+                                static_cast<unsigned>(mappedFile->size()),
+                                baseDir)
+                          : loader.LoadASCIIFromString(
+                                &model,
+                                &err,
+                                &warn,
+                                reinterpret_cast<const char*>(mappedFile->data()),
+                                static_cast<unsigned>(mappedFile->size()),
+                                baseDir);
   if (!err.empty()) {
     OE_THROW(domain_error(err));
   }
@@ -476,15 +599,95 @@ vector<shared_ptr<Entity>> Entity_graph_loader_gltf::loadFile(
   if (model.defaultScene >= static_cast<int>(model.scenes.size()) || model.defaultScene < 0)
     OE_THROW(domain_error("Failed to parse glTF: defaultScene points to an invalid scene index"));
 
-  const auto& scene = model.scenes[model.defaultScene];
   if (baseDir.empty())
     baseDir = ".";
+  gltfFile->filename = filePathStr;
+  gltfFile->calculateBounds = calculateBounds;
+  gltfFile->baseDir = move(baseDir);
+  gltfFile->rootEntityName = filename;
+
+  gltfFile->binChunkBuffer = gltf_utils::map_glb_bin_chunk(mappedFile);
+
+  // Reordering the vertices of a primitive copies its vertex buffers, so primitives that share vertex accessors are
+  // only reordered for the vertex cache; otherwise each would get its own copy of the shared vertices.
+  gltfFile->optimizeMeshes = _meshOptimizationEnabled;
+  gltfFile->generateLods = _lodGenerationEnabled;
+  gltfFile->lodOptions = _lodOptions;
+  gltfFile->quantizeVertices = _vertexQuantizationEnabled;
+  gltfFile->quantizationOptions = _vertexQuantizationOptions;
+  gltfFile->meshBufferPool = _meshBufferPool;
+  {
+    map<int, int> vertexAccessorUseCounts;
+    for (const auto& mesh : model.meshes) {
+      for (const auto& prim : mesh.primitives) {
+        for (const auto& attr : prim.attributes) {
+          ++vertexAccessorUseCounts[attr.second];
+        }
+        for (const auto& target : prim.targets) {
+          for (const auto& targetAttr : target) {
+            ++vertexAccessorUseCounts[targetAttr.second];
+          }
+        }
+      }
+    }
+    for (const auto& [accessorIdx, useCount] : vertexAccessorUseCounts) {
+      if (useCount > 1) {
+        gltfFile->sharedVertexAccessors.insert(accessorIdx);
+      }
+    }
+  }
+
+  // Build the mesh data of every primitive. Primitives are independent of each other, so are built in parallel.
+  vector<pair<size_t, size_t>> meshPrimitiveIndices;
+  gltfFile->meshPrimitives.resize(model.meshes.size());
+  for (size_t meshIdx = 0; meshIdx < model.meshes.size(); ++meshIdx) {
+    const auto primitiveCount = model.meshes[meshIdx].primitives.size();
+    gltfFile->meshPrimitives[meshIdx].resize(primitiveCount);
+    for (size_t primIdx = 0; primIdx < primitiveCount; ++primIdx) {
+      meshPrimitiveIndices.emplace_back(meshIdx, primIdx);
+    }
+  }
+
+  const auto grainSize = std::max<size_t>(
+      1, meshPrimitiveIndices.size() / (static_cast<size_t>(_jobManager.workerCount()) * 4));
+  _jobManager.parallelFor(
+      meshPrimitiveIndices.size(), grainSize, [&gltfFile, &meshPrimitiveIndices](size_t begin, size_t end) {
+        for (auto idx = begin; idx < end; ++idx) {
+          const auto [meshIdx, primIdx] = meshPrimitiveIndices[idx];
+          try {
+            gltfFile->meshPrimitives[meshIdx][primIdx] =
+                prepare_primitive(gltfFile->model.meshes[meshIdx].primitives[primIdx], *gltfFile);
+          } catch (const exception& e) {
+            OE_THROW(std::domain_error(
+                "Mesh[" + to_string(meshIdx) + "] primitive[" + to_string(primIdx) + "] is malformed. (" +
+                e.what() + ")"));
+          }
+        }
+      });
+
+  return gltfFile;
+}
+
+vector<shared_ptr<Entity>> Entity_graph_loader_gltf::instantiatePreparedFile(
+    Prepared_file& preparedFile,
+    IScene_graph_manager& sceneGraphManager,
+    IEntity_repository& entityRepository,
+    IComponent_factory& componentFactory) const {
+  auto gltfFile = dynamic_cast<Gltf_file*>(&preparedFile);
+  if (!gltfFile) {
+    OE_THROW(std::logic_error("Prepared file was not created by Entity_graph_loader_gltf"));
+  }
+
+  vector<shared_ptr<Entity>> entities;
   Loader_data loaderData(
-          model, move(baseDir), _imagingFactory.Get(), sceneGraphManager, entityRepository, _materialManager,
-          _textureManager, componentFactory, calculateBounds);
+          *gltfFile, _imagingFactory.Get(), sceneGraphManager, entityRepository, _materialManager,
+          _textureManager, componentFactory);
+  const auto& model = loaderData.model;
+  const auto& scene = model.scenes[model.defaultScene];
 
   // Load Entities
-  loaderData.rootEntity = entityRepository.instantiate(filename, loaderData.sceneGraphManager, componentFactory);
+  loaderData.rootEntity =
+      entityRepository.instantiate(loaderData.file.rootEntityName, loaderData.sceneGraphManager, componentFactory);
   for (auto nodeIdx : scene.nodes) {
     auto entity = create_entity(nodeIdx, loaderData);
     entity->setParent(*loaderData.rootEntity);
@@ -493,6 +696,8 @@ vector<shared_ptr<Entity>> Entity_graph_loader_gltf::loadFile(
 
   // Load Skins
   const auto numSkins = static_cast<int>(model.skins.size());
+  // Meshes with the same skin and skeleton root share a skinning palette; this is the first mesh of each skin.
+  std::vector<Skinned_mesh_component*> skinPaletteOwners(model.skins.size(), nullptr);
   for (size_t idx = 0; idx < loaderData.nodeIdxToEntity.size(); ++idx) {
     const auto entity = loaderData.nodeIdxToEntity[idx];
     const auto skinIdx = model.nodes[idx].skin;
@@ -516,7 +721,7 @@ vector<shared_ptr<Entity>> Entity_graph_loader_gltf::loadFile(
 
         {
           std::vector<SSE::Matrix4> inverseBindMatrices =
-              createMatrix4ArrayFromAccessor(loaderData, skin.inverseBindMatrices);
+              createMatrix4ArrayFromAccessor(loaderData.file, skin.inverseBindMatrices);
 
           // Nodes that form the skeleton hierarchy.
           std::vector<std::shared_ptr<Entity>> joints;
@@ -539,6 +744,12 @@ vector<shared_ptr<Entity>> Entity_graph_loader_gltf::loadFile(
 
           skinnedMeshComponent.setSkeletonTransformRoot(
               loaderData.nodeIdxToEntity.at(skin.skeleton));
+
+          auto& paletteOwner = skinPaletteOwners[skinIdx];
+          if (paletteOwner)
+            skinnedMeshComponent.shareSkinningPalette(*paletteOwner);
+          else
+            paletteOwner = &skinnedMeshComponent;
         }
       }
     } catch (std::exception& ex) {
@@ -832,7 +1043,7 @@ void setEntityTransform(Entity& entity, const Node& node) {
 bool loadJointsWeights(
     int index,
     const Primitive& prim,
-    Loader_data& loaderData,
+    Gltf_file& loaderData,
     Mesh_data& meshData) {
   const auto jointsAttrName = s_primAttrName_joints + to_string(index);
   const auto weightsAttrName = s_primAttrName_weights + to_string(index);
@@ -848,7 +1059,11 @@ bool loadJointsWeights(
       try {
         // Animation Joints
         auto accessor = useOrCreateBufferForAccessor<Mesh_vertex_buffer_accessor>(
-            pos->second, loaderData, allowedTypes, 0, vertexAccessorFactory(vertexAttribute));
+            pos->second,
+            loaderData,
+            allowedTypes,
+            0,
+            vertexAccessorFactory(vertexAttribute, loaderData.model.accessors.at(pos->second).normalized));
         meshData.vertexBufferAccessors[vertexAttribute] = move(accessor);
       } catch (const exception& e) {
         OE_THROW(domain_error("Error in attribute " + attrName + ": " + e.what()));
@@ -875,6 +1090,252 @@ bool loadJointsWeights(
   return false;
 }
 
+// PBR_material needs tangents if it has a normal texture.
+bool material_requires_tangents(const Primitive& prim, const Model& model) {
+  if (prim.material < 0 || prim.material >= static_cast<int>(model.materials.size())) {
+    return false;
+  }
+
+  const auto& gltfMaterial = model.materials[prim.material];
+  return gltfMaterial.values.find("normalTexture") != gltfMaterial.values.end() ||
+         gltfMaterial.additionalValues.find("normalTexture") != gltfMaterial.additionalValues.end();
+}
+
+Prepared_primitive prepare_primitive(const Primitive& prim, Gltf_file& loaderData) {
+  // Determine the vertex layout
+  vector<Vertex_attribute_element> meshLayoutAttributes;
+  const auto numAccessors = static_cast<int>(loaderData.model.accessors.size());
+  for (const auto& attr : prim.attributes) {
+    const auto vaPos = g_gltfAttributeToVertexAttributeMap.find(attr.first);
+    if (vaPos == g_gltfAttributeToVertexAttributeMap.end()) {
+      LOG(WARNING) << "Skipping unsupported attribute: " << attr.first;
+      continue;
+    }
+
+    if (attr.second >= numAccessors) {
+      OE_THROW(std::domain_error("Invalid attribute accessor index: " + attr.first));
+    }
+    const auto& accessor = loaderData.model.accessors[attr.second];
+
+    const auto accessorTypePos = g_gltfType_elementType.find(accessor.type);
+    const auto accessorComponentTypePos =
+        g_gltfComponent_elementComponent.find(accessor.componentType);
+
+    if (accessorTypePos == g_gltfType_elementType.end()) {
+      OE_THROW(std::domain_error(std::string("Unsupported gltf accessor type: ") + to_string(accessor.type)));
+    }
+    if (accessorComponentTypePos == g_gltfComponent_elementComponent.end()) {
+      OE_THROW(std::domain_error(std::string("Unsupported gltf accessor component type: ") + to_string(accessor.componentType)));
+    }
+
+    meshLayoutAttributes.push_back(Vertex_attribute_element{
+        vaPos->second, accessorTypePos->second, accessorComponentTypePos->second});
+  }
+
+  vector<Vertex_attribute_semantic> morphTargetLayout;
+  if (!prim.targets.empty()) {
+    for (const auto& morphTargetEntry : prim.targets[0]) {
+      const auto attrPos = g_gltfMorphAttributeMapping.find(morphTargetEntry.first);
+      if (attrPos == g_gltfMorphAttributeMapping.end()) {
+        OE_THROW(std::domain_error("Unknown morph attribute: " + morphTargetEntry.first));
+      }
+      morphTargetLayout.push_back(attrPos->second);
+    }
+  }
+
+  if (prim.targets.size() > UINT8_MAX) {
+    OE_THROW(std::domain_error("Too many morph targets"));
+  }
+
+  // Generate missing tangents now, rather than on the render thread when the mesh is first drawn (see
+  // Entity_render_manager::createMissingVertexAttributes).
+  const auto hasAttribute = [&meshLayoutAttributes](Vertex_attribute attribute) {
+    return std::any_of(meshLayoutAttributes.begin(), meshLayoutAttributes.end(), [attribute](const auto& element) {
+      return element.semantic == Vertex_attribute_semantic{attribute, 0} &&
+             element.component == Element_component::Float;
+    });
+  };
+  const auto generateTangents = material_requires_tangents(prim, loaderData.model) &&
+                                !hasAttribute(Vertex_attribute::Tangent) && hasAttribute(Vertex_attribute::Normal) &&
+                                hasAttribute(Vertex_attribute::Tex_coord);
+  if (generateTangents) {
+    meshLayoutAttributes.push_back(Vertex_attribute_element{
+        {Vertex_attribute::Tangent, 0}, Element_type::Vector4, Element_component::Float});
+  }
+
+  Prepared_primitive preparedPrimitive;
+  auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout(
+      meshLayoutAttributes, morphTargetLayout, static_cast<uint8_t>(prim.targets.size())));
+  preparedPrimitive.meshData = meshData;
+
+  // Read Index
+  try {
+    // Index
+    auto indexBufferAccessor = useOrCreateBufferForAccessor<Mesh_index_buffer_accessor>(
+        prim.indices,
+        loaderData,
+        g_index_allowedAccessorTypes,
+        TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER,
+        [](shared_ptr<Mesh_buffer> meshBuffer,
+           Element_type,
+           Element_component component,
+           size_t count,
+           size_t stride,
+           size_t offset) {
+          return make_unique<Mesh_index_buffer_accessor>(
+              meshBuffer,
+              component,
+              static_cast<uint32_t>(count),
+              static_cast<uint32_t>(stride),
+              static_cast<uint32_t>(offset));
+        });
+    meshData->indexBufferAccessor = move(indexBufferAccessor);
+  } catch (const exception& e) {
+    OE_THROW(std::domain_error(string("Error in index buffer: ") + e.what()));
+  }
+
+  for (const auto& attr : prim.attributes) {
+    const auto vaPos = g_gltfAttributeToVertexAttributeMap.find(attr.first);
+    if (vaPos == g_gltfAttributeToVertexAttributeMap.end()) {
+      OE_THROW(std::domain_error("Unexpected attribute: " + attr.first));
+    }
+
+    const auto& vertexAttribute = vaPos->second;
+    try {
+
+      // Vertex
+      auto vertexBufferAccessor = useOrCreateBufferForAccessor<Mesh_vertex_buffer_accessor>(
+          attr.second,
+          loaderData,
+          g_vertex_allowedAccessorTypes,
+          TINYGLTF_TARGET_ARRAY_BUFFER,
+          vertexAccessorFactory(vertexAttribute, loaderData.model.accessors.at(attr.second).normalized));
+
+      meshData->vertexBufferAccessors[vertexAttribute] = move(vertexBufferAccessor);
+    } catch (const exception& e) {
+      OE_THROW(std::domain_error(
+          "Error in attribute " + Vertex_attribute_meta::vsInputName(vertexAttribute) + ": " +
+          e.what()));
+    }
+  }
+
+  // Animation data
+  if (loadJointsWeights(0, prim, loaderData, *meshData)) {
+    if (loadJointsWeights(1, prim, loaderData, *meshData)) {
+      OE_THROW(std::exception("loader does not support more than one weights stream"));
+    }
+  }
+
+  if (generateTangents) {
+    const auto vertexCount = meshData->getVertexCount();
+    const auto elementStride = sizeof(float) * 4;
+    meshData->vertexBufferAccessors[{Vertex_attribute::Tangent, 0}] = make_unique<Mesh_vertex_buffer_accessor>(
+        make_shared<Mesh_buffer>(elementStride * vertexCount),
+        Vertex_attribute_element{{Vertex_attribute::Tangent, 0}, Element_type::Vector4, Element_component::Float},
+        static_cast<uint32_t>(vertexCount),
+        static_cast<uint32_t>(elementStride),
+        0);
+    Primitive_mesh_data_factory::generateTangents(meshData);
+  }
+
+  // Calculate bounds?
+  if (loaderData.calculateBounds) {
+    const auto& vertexBufferAccessor =
+        meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0});
+    const auto& positionElement = vertexBufferAccessor->attributeElement;
+    if (positionElement.component == Element_component::Float &&
+        positionElement.encoding == Element_encoding::None) {
+      assert(vertexBufferAccessor->stride >= sizeof(Float3));
+      preparedPrimitive.boundSphere = oe::BoundingSphere::createFromPoints(
+          reinterpret_cast<Float3*>(vertexBufferAccessor->buffer->data + vertexBufferAccessor->offset),
+          vertexBufferAccessor->count,
+          vertexBufferAccessor->stride);
+    } else {
+      // Normalized integer positions, such as from KHR_mesh_quantization, are bound by their decoded values.
+      vector<Float3> positions;
+      positions.reserve(vertexBufferAccessor->count);
+      for (const auto& position : mesh_utils::read_vector3_elements(*vertexBufferAccessor)) {
+        positions.emplace_back(position);
+      }
+      preparedPrimitive.boundSphere = oe::BoundingSphere::createFromPoints(
+          positions.data(), static_cast<int>(positions.size()), sizeof(Float3));
+    }
+  }
+
+  // Morph Targets
+  if (!prim.targets.empty()) {
+    // Check the morph targets length
+    const auto targetSize = prim.targets[0].size();
+    for (const auto& target : prim.targets) {
+      if (targetSize != target.size())
+        OE_THROW(std::domain_error("Size of each target must be the same."));
+
+      std::vector<std::unique_ptr<Mesh_vertex_buffer_accessor>> morphBufferAccessors;
+      for (const auto& targetAttributeAccessor : target) {
+        const auto vertexAttribute =
+            g_gltfMorphAttributeMapping.at(targetAttributeAccessor.first);
+        auto accessor = useOrCreateBufferForAccessor<Mesh_vertex_buffer_accessor>(
+            targetAttributeAccessor.second,
+            loaderData,
+            g_morphTarget_allowedAccessorTypes,
+            0,
+            vertexAccessorFactory(vertexAttribute));
+        morphBufferAccessors.push_back(move(accessor));
+      }
+
+      meshData->attributeMorphBufferAccessors.push_back(move(morphBufferAccessors));
+    }
+  }
+
+  if (loaderData.optimizeMeshes && (prim.mode == TINYGLTF_MODE_TRIANGLES || prim.mode == -1)) {
+    const auto isShared = [&loaderData](int accessorIdx) {
+      return loaderData.sharedVertexAccessors.find(accessorIdx) != loaderData.sharedVertexAccessors.end();
+    };
+    auto sharesVertices = any_of(prim.attributes.begin(), prim.attributes.end(), [&isShared](const auto& attr) {
+      return isShared(attr.second);
+    });
+    for (const auto& target : prim.targets) {
+      sharesVertices = sharesVertices || any_of(target.begin(), target.end(), [&isShared](const auto& targetAttr) {
+                         return isShared(targetAttr.second);
+                       });
+    }
+
+    Mesh_optimizer_options options;
+    options.reorderVertices = !sharesVertices;
+    Mesh_optimizer::optimize(*meshData, options);
+  }
+
+  // Quantizing gives each attribute its own buffer, as reordering does, so shares nothing with the levels of detail
+  // generated below.
+  if (loaderData.quantizeVertices) {
+    Mesh_quantizer::quantize(*meshData, loaderData.quantizationOptions);
+  }
+
+  // Levels of detail are simplified from the optimized mesh. They share its vertices, so only their triangles are
+  // reordered. Primitives are prepared in parallel, so this is too.
+  if (loaderData.generateLods && (prim.mode == TINYGLTF_MODE_TRIANGLES || prim.mode == -1)) {
+    preparedPrimitive.lods = Mesh_simplifier::generateLods(*meshData, loaderData.lodOptions);
+    if (loaderData.optimizeMeshes) {
+      Mesh_optimizer_options options;
+      options.reorderVertices = false;
+      for (const auto& lod : preparedPrimitive.lods) {
+        Mesh_optimizer::optimize(*lod.meshData, options);
+      }
+    }
+  }
+
+  // Pooled last, once the buffers are final. Levels of detail share the vertices of the primitive, so resolve to the
+  // same pooled buffers.
+  if (loaderData.meshBufferPool) {
+    loaderData.meshBufferPool->share(*meshData);
+    for (const auto& lod : preparedPrimitive.lods) {
+      loaderData.meshBufferPool->share(*lod.meshData);
+    }
+  }
+
+  return preparedPrimitive;
+}
+
 shared_ptr<Entity> create_entity(
     vector<Node>::size_type nodeIdx,
     Loader_data& loaderData) {
@@ -890,144 +1351,32 @@ shared_ptr<Entity> create_entity(
   // Transform
   setEntityTransform(*rootEntity, node);
 
-  // Create MeshData
+  // Attach the MeshData that prepareFile built
   if (node.mesh > -1) {
     const auto& mesh = loaderData.model.meshes.at(node.mesh);
+    const auto& preparedPrimitives = loaderData.file.meshPrimitives.at(node.mesh);
     const auto primitiveCount = mesh.primitives.size();
     for (size_t primIdx = 0; primIdx < primitiveCount; ++primIdx) {
       const auto& prim = mesh.primitives.at(primIdx);
+      const auto& preparedPrimitive = preparedPrimitives.at(primIdx);
       const auto primitiveName = mesh.name + " primitive " + to_string(primIdx);
       LOG(G3LOG_DEBUG) << "Creating entity for glTF mesh " << primitiveName;
       auto primitiveEntity = loaderData.entityRepository.instantiate(primitiveName, loaderData.sceneGraphManager, loaderData.componentFactory);
 
       primitiveEntity->setParent(*rootEntity.get());
       auto& meshDataComponent = primitiveEntity->addComponent<Mesh_data_component>();
-
-      // Determine the vertex layout
-      vector<Vertex_attribute_element> meshLayoutAttributes;
-      const auto numAccessors = static_cast<int>(loaderData.model.accessors.size());
-      for (const auto& attr : prim.attributes) {
-        const auto vaPos = g_gltfAttributeToVertexAttributeMap.find(attr.first);
-        if (vaPos == g_gltfAttributeToVertexAttributeMap.end()) {
-          LOG(WARNING) << "Skipping unsupported attribute: " << attr.first;
-          continue;
-        }
-
-        if (attr.second >= numAccessors) {
-          OE_THROW(std::domain_error("Invalid attribute accessor index: " + attr.first));
-        }
-        const auto& accessor = loaderData.model.accessors[attr.second];
-
-        const auto accessorTypePos = g_gltfType_elementType.find(accessor.type);
-        const auto accessorComponentTypePos =
-            g_gltfComponent_elementComponent.find(accessor.componentType);
-
-        if (accessorTypePos == g_gltfType_elementType.end()) {
-          OE_THROW(std::domain_error(std::string("Unsupported gltf accessor type: ") + to_string(accessor.type)));
-        }
-        if (accessorComponentTypePos == g_gltfComponent_elementComponent.end()) {
-          OE_THROW(std::domain_error(std::string("Unsupported gltf accessor component type: ") + to_string(accessor.componentType)));
-        }
-
-        meshLayoutAttributes.push_back(Vertex_attribute_element{
-            vaPos->second, accessorTypePos->second, accessorComponentTypePos->second});
-      }
-
-      vector<Vertex_attribute_semantic> morphTargetLayout;
-      if (!prim.targets.empty()) {
-        for (const auto& morphTargetEntry : prim.targets[0]) {
-          const auto attrPos = g_gltfMorphAttributeMapping.find(morphTargetEntry.first);
-          if (attrPos == g_gltfMorphAttributeMapping.end()) {
-            OE_THROW(std::domain_error("Unknown morph attribute: " + morphTargetEntry.first));
-          }
-          morphTargetLayout.push_back(attrPos->second);
-        }
-      }
-
-      if (prim.targets.size() > UINT8_MAX) {
-        OE_THROW(std::domain_error("Too many morph targets"));
-      }
-      auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout(
-          meshLayoutAttributes, morphTargetLayout, static_cast<uint8_t>(prim.targets.size())));
-      meshDataComponent.setMeshData(meshData);
+      meshDataComponent.setMeshData(preparedPrimitive.meshData);
+      meshDataComponent.setLods(preparedPrimitive.lods);
 
       try {
         const auto material = create_material(prim, loaderData);
 
-        // Read Index
-        try {
-          // Index
-          auto indexBufferAccessor = useOrCreateBufferForAccessor<Mesh_index_buffer_accessor>(
-              prim.indices,
-              loaderData,
-              g_index_allowedAccessorTypes,
-              TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER,
-              [](shared_ptr<Mesh_buffer> meshBuffer,
-                 Element_type,
-                 Element_component component,
-                 size_t count,
-                 size_t stride,
-                 size_t offset) {
-                return make_unique<Mesh_index_buffer_accessor>(
-                    meshBuffer,
-                    component,
-                    static_cast<uint32_t>(count),
-                    static_cast<uint32_t>(stride),
-                    static_cast<uint32_t>(offset));
-              });
-          meshData->indexBufferAccessor = move(indexBufferAccessor);
-        } catch (const exception& e) {
-          OE_THROW(std::domain_error(string("Error in index buffer: ") + e.what()));
-        }
-
-        auto generateNormals = false, generateTangents = false, generateBiTangents = false;
-        for (const auto& attr : prim.attributes) {
-          const auto vaPos = g_gltfAttributeToVertexAttributeMap.find(attr.first);
-          if (vaPos == g_gltfAttributeToVertexAttributeMap.end()) {
-            OE_THROW(std::domain_error("Unexpected attribute: " + attr.first));
-          }
-
-          const auto& vertexAttribute = vaPos->second;
-          try {
-
-            // Vertex
-            auto vertexBufferAccessor = useOrCreateBufferForAccessor<Mesh_vertex_buffer_accessor>(
-                attr.second,
-                loaderData,
-                g_vertex_allowedAccessorTypes,
-                TINYGLTF_TARGET_ARRAY_BUFFER,
-                vertexAccessorFactory(vertexAttribute));
-
-            meshData->vertexBufferAccessors[vertexAttribute] = move(vertexBufferAccessor);
-          } catch (const exception& e) {
-            OE_THROW(std::domain_error(
-                "Error in attribute " + Vertex_attribute_meta::vsInputName(vertexAttribute) + ": " +
-                e.what()));
-          }
-        }
-
-        // Animation data
-        if (loadJointsWeights(0, prim, loaderData, *meshData)) {
-          if (loadJointsWeights(1, prim, loaderData, *meshData)) {
-            OE_THROW(std::exception("loader does not support more than one weights stream"));
-          }
-        }
-
         // Add this component last, to make sure there wasn't an error loading!
         auto& renderableComponent = primitiveEntity->addComponent<Renderable_component>();
         renderableComponent.setMaterial(material);
 
-        // Calculate bounds?
         if (loaderData.calculateBounds) {
-          const auto& vertexBufferAccessor =
-              meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0});
-          assert(vertexBufferAccessor->stride >= sizeof(Float3));
-          auto boundingSphere = oe::BoundingSphere::createFromPoints(
-              reinterpret_cast<Float3*>(vertexBufferAccessor->buffer->data),
-              vertexBufferAccessor->count,
-              vertexBufferAccessor->stride);
-
-          primitiveEntity->setBoundSphere(boundingSphere);
+          primitiveEntity->setBoundSphere(preparedPrimitive.boundSphere);
         }
 
         // Morph Targets
@@ -1041,28 +1390,6 @@ shared_ptr<Entity> create_entity(
           if (morphWeights.size() != prim.targets.size())
             OE_THROW(std::domain_error("Size of weights must equal size of targets, or be unset."));
 
-          // Check the morph targets length
-          const auto targetSize = prim.targets[0].size();
-          for (const auto& target : prim.targets) {
-            if (targetSize != target.size())
-              OE_THROW(std::domain_error("Size of each target must be the same."));
-
-            std::vector<std::unique_ptr<Mesh_vertex_buffer_accessor>> morphBufferAccessors;
-            for (const auto& targetAttributeAccessor : target) {
-              const auto vertexAttribute =
-                  g_gltfMorphAttributeMapping.at(targetAttributeAccessor.first);
-              auto accessor = useOrCreateBufferForAccessor<Mesh_vertex_buffer_accessor>(
-                  targetAttributeAccessor.second,
-                  loaderData,
-                  g_morphTarget_allowedAccessorTypes,
-                  0,
-                  vertexAccessorFactory(vertexAttribute));
-              morphBufferAccessors.push_back(move(accessor));
-            }
-
-            meshData->attributeMorphBufferAccessors.push_back(move(morphBufferAccessors));
-          }
-
           auto& morphWeightsComponent = primitiveEntity->addComponent<Morph_weights_component>();
           assert(prim.targets.size() <= Morph_weights_component::maxMorphTargetCount());
 
@@ -1087,7 +1414,7 @@ shared_ptr<Entity> create_entity(
   return rootEntity;
 }
 
-void create_animation(int animIdx, Loader_data loaderData) {
+void create_animation(int animIdx, Loader_data& loaderData) {
   const auto& gltfAnimation = loaderData.model.animations[animIdx];
   auto animationController =
       loaderData.rootEntity->getFirstComponentOfType<Animation_controller_component>();
@@ -1101,7 +1428,7 @@ void create_animation(int animIdx, Loader_data loaderData) {
         // Animation sampler
         const auto accessor = useOrCreateBufferForAccessor<Mesh_buffer_accessor>(
             accessorIdx,
-            loaderData,
+            loaderData.file,
             {{TINYGLTF_TYPE_SCALAR, {TINYGLTF_COMPONENT_TYPE_FLOAT}}},
             0,
             g_createSimpleMeshAccessor);
@@ -1182,12 +1509,15 @@ void create_animation(int animIdx, Loader_data loaderData) {
     std::unique_ptr<Mesh_buffer_accessor> keyframeValues;
     try {
       keyframeValues = useOrCreateBufferForAccessor<Mesh_buffer_accessor>(
-          sampler.output, loaderData, *allowedAccessorTypes, 0, g_createSimpleMeshAccessor);
+          sampler.output, loaderData.file, *allowedAccessorTypes, 0, g_createSimpleMeshAccessor);
     } catch (std::exception& ex) {
       OE_THROW(
           std::domain_error("Failed to create animation keyframe values accessor: "s + ex.what()));
     }
 
+    const auto keyframeValueComponent =
+        g_gltfComponent_elementComponent.at(loaderData.model.accessors[sampler.output].componentType);
+
     uint8_t valuesPerKeyFrame = 1;
     if (interpolationType == Animation_interpolation::Cubic_spline)
       valuesPerKeyFrame *= 3;
@@ -1220,7 +1550,9 @@ void create_animation(int animIdx, Loader_data loaderData) {
       animationChannel->valuesPerKeyFrame = valuesPerKeyFrame;
       animationChannel->targetNode = channelTargetEntity;
       animationChannel->keyframeTimes = keyframeTimes;
-      animationChannel->keyframeValues = move(keyframeValues);
+      // Each morph target entity gets its own channel; they all share the keyframe buffer.
+      animationChannel->keyframeValues = std::make_unique<Mesh_buffer_accessor>(*keyframeValues);
+      animationChannel->keyframeValueComponent = keyframeValueComponent;
       animation->channels.push_back(move(animationChannel));
       states.push_back({});
     }
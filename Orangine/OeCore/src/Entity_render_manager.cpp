@@ -3,14 +3,18 @@
 
 #include "OeCore/Camera_component.h"
 #include "OeCore/Entity_sorter.h"
+#include "OeCore/IJob_manager.h"
 #include "OeCore/IMaterial_manager.h"
 #include "OeCore/ILighting_manager.h"
 #include "OeCore/Light_component.h"
+#include "OeCore/Mesh_quantizer.h"
 #include "OeCore/Mesh_utils.h"
 #include "OeCore/Morph_weights_component.h"
 #include "OeCore/Skinned_mesh_component.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <cmath>
 #include <functional>
 #include <optional>
 
@@ -28,13 +32,42 @@ Renderer_animation_data g_emptyRenderableAnimationData = []() {
   return rad;
 }();
 
+namespace {
+// How much of the screen the error of a level of detail may cover, as a fraction of half the screen's height; about a
+// pixel at 1080p.
+constexpr float g_lodMaxScreenError = 1.0f / 540.0f;
+
+// Picks the coarsest level of detail of an entity's mesh whose error is too small to see from the camera.
+size_t select_lod(const Mesh_data_component& meshDataComponent, const Entity& entity, const Camera_data& cameraData) {
+  // Cameras without a field of view, such as for full screen passes, draw the full resolution mesh.
+  if (meshDataComponent.lods().empty() || cameraData.fov <= 0.0f) {
+    return 0;
+  }
+
+  const auto bounds = entity.worldBoundSphere();
+  const auto viewCenter = cameraData.viewMatrix * SSE::Point3(bounds.center);
+  const auto distance = SSE::length(viewCenter.getXYZ());
+  const auto radius = bounds.radius;
+  if (distance <= radius) {
+    return 0;
+  }
+
+  const auto projectedRadius = radius / (distance * std::tan(cameraData.fov * 0.5f));
+  return meshDataComponent.selectLod(projectedRadius, g_lodMaxScreenError);
+}
+} // namespace
+
 Entity_render_manager::Entity_render_manager(
-        ITexture_manager& textureManager, IMaterial_manager& materialManager, ILighting_manager& lightingManager)
+        ITexture_manager& textureManager,
+        IMaterial_manager& materialManager,
+        ILighting_manager& lightingManager,
+        IJob_manager& jobManager)
     : Manager_base()
     , Manager_deviceDependent()
     , _textureManager(textureManager)
     , _materialManager(materialManager)
     , _lightingManager(lightingManager)
+    , _jobManager(jobManager)
 {}
 
 void Entity_render_manager::initialize() {}
@@ -143,13 +176,25 @@ void Entity_render_manager::createMissingVertexAttributes(
     Primitive_mesh_data_factory::generateNormals(
         *meshData->indexBufferAccessor,
         *meshData->vertexBufferAccessors[{Vertex_attribute::Position, 0}],
-        *meshData->vertexBufferAccessors[{Vertex_attribute::Normal, 0}]);
+        *meshData->vertexBufferAccessors[{Vertex_attribute::Normal, 0}],
+        &_jobManager);
   }
 
   if (generateTangents || generateBiTangents) {
     LOG(WARNING) << "Generating missing Tangents and/or Bi-tangents";
     Primitive_mesh_data_factory::generateTangents(meshData);
   }
+
+  // Attributes generated for a mesh whose vertices were quantized when it was loaded are quantized to match.
+  const auto positionPos = meshData->vertexBufferAccessors.find({Vertex_attribute::Position, 0});
+  if ((generateNormals || generateTangents || generateBiTangents) &&
+      positionPos != meshData->vertexBufferAccessors.end() &&
+      positionPos->second->attributeElement.encoding != Element_encoding::None) {
+    Mesh_quantizer_options options;
+    options.quantizePositions = false;
+    options.texCoords = Tex_coord_quantization::None;
+    Mesh_quantizer::quantize(*meshData, options);
+  }
 }
 
 void Entity_render_manager::renderEntity(
@@ -175,12 +220,13 @@ void Entity_render_manager::renderEntity(
       return;
     }
 
-    const auto& meshData = meshDataComponent->meshData();
+    const auto lod = select_lod(*meshDataComponent, entity, cameraData);
+    const auto& meshData = meshDataComponent->lodMeshData(lod);
 
-    auto rendererData = renderableComponent.rendererData().lock();
+    auto rendererData = renderableComponent.rendererData(lod).lock();
     if (rendererData == nullptr) {
       LOG(INFO) << "Creating renderer data for entity " << entity.getName() << " (ID "
-                << entity.getId() << ")";
+                << entity.getId() << "), level of detail " << lod;
 
       // Note we get the flags for the case where all features are enabled, to make sure we load all
       // the data streams.
@@ -190,7 +236,7 @@ void Entity_render_manager::renderEntity(
       const auto vertexSettings = material->vertexShaderSettings(flags);
 
       rendererData = createRendererData(meshData, vertexInputs, vertexSettings.morphAttributes);
-      renderableComponent.setRendererData(std::weak_ptr(rendererData));
+      renderableComponent.setRendererData(std::weak_ptr(rendererData), lod);
     }
 
     auto materialContext = renderableComponent.materialContext().lock();
@@ -258,35 +304,33 @@ void Entity_render_manager::renderEntity(
         _materialManager.rendererFeatureEnabled().skinnedAnimation;
     if (skinningEnabled && skinnedMeshComponent != nullptr) {
 
-      // Don't need the transform root here, just read the world transforms.
       const auto& joints = skinnedMeshComponent->joints();
-      const auto& inverseBindMatrices = skinnedMeshComponent->inverseBindMatrices();
-      if (joints.size() != inverseBindMatrices.size())
+      if (joints.size() != skinnedMeshComponent->inverseBindMatrices().size())
         OE_THROW(
             std::runtime_error("Size of joints and inverse bone transform arrays must match."));
 
-      if (inverseBindMatrices.size() > _rendererAnimationData.boneTransformConstants.size()) {
+      if (joints.size() > _rendererAnimationData.boneTransformConstants.size()) {
         OE_THROW(std::runtime_error(
             "Maximum number of bone transforms exceeded: " +
-            std::to_string(inverseBindMatrices.size()) + " > " +
+            std::to_string(joints.size()) + " > " +
             std::to_string(_rendererAnimationData.boneTransformConstants.size())));
       }
 
+      // The palette was computed once for this frame, before any render pass.
+      const auto& boneTransforms = skinnedMeshComponent->skinningPalette().boneTransforms;
+      if (boneTransforms.size() != joints.size())
+        OE_THROW(std::logic_error("Skinning palette has not been computed"));
+
       if (skinnedMeshComponent->skeletonTransformRoot())
         worldTransform = &skinnedMeshComponent->skeletonTransformRoot()->worldTransform();
       else
         worldTransform = &entity.worldTransform();
 
-      auto invWorld = SSE::inverse(*worldTransform);
-      for (size_t i = 0; i < joints.size(); ++i) {
-        auto* const joint = joints[i];
-        const auto& jointWorldTransform = joint->worldTransform();
-        auto jointToRoot = invWorld * jointWorldTransform;
-        const auto inverseBoneTransform = inverseBindMatrices[i];
-
-        _rendererAnimationData.boneTransformConstants[i] = jointToRoot * inverseBoneTransform;
-      }
-      _rendererAnimationData.numBoneTransforms = static_cast<uint32_t>(joints.size());
+      std::copy(
+          boneTransforms.begin(),
+          boneTransforms.end(),
+          _rendererAnimationData.boneTransformConstants.begin());
+      _rendererAnimationData.numBoneTransforms = static_cast<uint32_t>(boneTransforms.size());
     } else {
       _rendererAnimationData.numBoneTransforms = 0;
       worldTransform = &entity.worldTransform();
@@ -16,13 +16,17 @@ class Material_context;
 class ITexture_manager;
 class IMaterial_manager;
 class ILighting_manager;
+class IJob_manager;
 }
 
 namespace oe::internal {
 class Entity_render_manager : public IEntity_render_manager, public Manager_base, public Manager_deviceDependent {
  public:
   Entity_render_manager(
-          ITexture_manager& textureManager, IMaterial_manager& materialManager, ILighting_manager& lightingManager);
+          ITexture_manager& textureManager,
+          IMaterial_manager& materialManager,
+          ILighting_manager& lightingManager,
+          IJob_manager& jobManager);
 
   // Manager_base implementation
   void initialize() override;
@@ -104,6 +108,7 @@ class Entity_render_manager : public IEntity_render_manager, public Manager_base
   ITexture_manager& _textureManager;
   IMaterial_manager& _materialManager;
   ILighting_manager& _lightingManager;
+  IJob_manager& _jobManager;
 
   static std::string _name;
 };
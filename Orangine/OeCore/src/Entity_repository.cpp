@@ -1,39 +1,125 @@
 ﻿#include "Entity_repository.h"
 
+#include <OeCore/EngineUtils.h>
+
 using namespace oe;
 
+namespace {
+// Generation zero is never used by an id, so that Entity::invalid_id is never a valid id. It marks retired slots.
+constexpr uint32_t g_retiredGeneration = 0;
+}// namespace
+
+void Entity_repository::Entity_deleter::operator()(Entity* entity) const
+{
+	entity->~Entity();
+	if (pool->generations[index] != g_retiredGeneration) {
+		pool->freeSlots.push_back(index);
+	}
+}
+
 Entity_repository::Entity_repository()
-	: _lastEntityId(0)
+	: _pool(std::make_shared<Entity_pool>())
 {
 }
 
+Entity_repository::~Entity_repository()
+{
+	// Entity deleters hold a reference to the pool, so release our references to the entities to break the cycle.
+	// Entities that are still referenced elsewhere will be destroyed when those references are released.
+	auto entities = std::move(_pool->entities);
+	_pool->size = 0;
+	entities.clear();
+}
+
 std::shared_ptr<Entity> Entity_repository::instantiate(std::string_view name, IScene_graph_manager& sceneGraph, IComponent_factory& componentFactory)
 {
-	const auto entity = new Entity(sceneGraph, componentFactory, std::string(name), ++_lastEntityId);
-	auto entityPtr = std::shared_ptr<Entity>(entity);
-	_entities[_lastEntityId] = entityPtr;
+	auto& pool = *_pool;
+
+	uint32_t index;
+	if (!pool.freeSlots.empty()) {
+		index = pool.freeSlots.back();
+		pool.freeSlots.pop_back();
+	}
+	else {
+		index = static_cast<uint32_t>(pool.entities.size());
+		if (index >= Entity::id_index_mask) {
+			OE_THROW(std::runtime_error("Failed to instantiate entity; too many entities."));
+		}
+		if (index % chunk_size == 0) {
+			pool.chunks.push_back(std::make_unique<Entity_pool::Entity_storage[]>(chunk_size));
+		}
+		pool.entities.emplace_back();
+		pool.generations.push_back(1);
+	}
+
+	const auto id = Entity::makeId(index, pool.generations[index]);
+	Entity* entity;
+	try {
+		entity = new (pool.slotStorage(index)) Entity(sceneGraph, componentFactory, std::string(name), id);
+	}
+	catch (...) {
+		pool.freeSlots.push_back(index);
+		throw;
+	}
+
+	auto entityPtr = std::shared_ptr<Entity>(entity, Entity_deleter{_pool, index});
+	pool.entities[index] = entityPtr;
+	++pool.size;
 	return entityPtr;
 }
 
 void Entity_repository::remove(const Entity::Id_type id)
 {
-	const auto pos = _entities.find(id);
-	if (pos != _entities.end()) {
-		_entities.erase(pos);
+	const auto index = findSlot(id);
+	if (index == Entity::id_index_mask) {
+		return;
 	}
+
+	// Invalidate the id before releasing our reference, as this may destroy the entity and free its slot. A slot whose
+	// generation can't be incremented without wrapping is retired rather than reused, as wrapping would make the ids of
+	// entities it held long ago valid again.
+	auto& pool = *_pool;
+	auto& generation = pool.generations[index];
+	generation = generation == Entity::id_generation_mask ? g_retiredGeneration : generation + 1;
+	--pool.size;
+	auto entityPtr = std::move(pool.entities[index]);
 }
 
 std::shared_ptr<Entity> Entity_repository::getEntityPtrById(const Entity::Id_type id)
 {
-	const auto pos = _entities.find(id);
-	if (pos == _entities.end())
+	const auto index = findSlot(id);
+	if (index == Entity::id_index_mask)
 		return nullptr;
-	return pos->second;
+	return _pool->entities[index];
+}
+
+Entity* Entity_repository::findEntityById(const Entity::Id_type id)
+{
+	const auto index = findSlot(id);
+	if (index == Entity::id_index_mask)
+		return nullptr;
+	return _pool->entities[index].get();
 }
 
 Entity &Entity_repository::getEntityById(const Entity::Id_type id)
 {
-	const auto pos = _entities.find(id);
-	assert(pos != _entities.end() && "Invalid Entity ID provided");
-	return *pos->second.get();
-}
\ No newline at end of file
+	const auto entity = findEntityById(id);
+	assert(entity != nullptr && "Invalid Entity ID provided");
+	return *entity;
+}
+
+size_t Entity_repository::size() const
+{
+	return _pool->size;
+}
+
+uint32_t Entity_repository::findSlot(const Entity::Id_type id) const
+{
+	const auto index = Entity::idIndex(id);
+	const auto& pool = *_pool;
+	if (index >= pool.entities.size() || pool.generations[index] != Entity::idGeneration(id) ||
+		pool.entities[index] == nullptr) {
+		return Entity::id_index_mask;
+	}
+	return index;
+}
@@ -1,20 +1,75 @@
-#pragma once
-
-#include <OeCore/IEntity_repository.h>
-
-namespace oe {
-class Entity_repository : public IEntity_repository {
-  Entity::Entity_ptr_map _entities;
-  int _lastEntityId;
-
- public:
-  Entity_repository();
-
-  // IEntity_repository implementation
-  std::shared_ptr<Entity>
-  instantiate(std::string_view name, IScene_graph_manager& sceneGraph, IComponent_factory& componentFactory) override;
-  void remove(Entity::Id_type id) override;
-  std::shared_ptr<Entity> getEntityPtrById(Entity::Id_type id) override;
-  Entity& getEntityById(Entity::Id_type id) override;
-};
-}// namespace oe
\ No newline at end of file
+#pragma once
+
+#include <OeCore/IEntity_repository.h>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace oe {
+/**
+ * Stores entities in a generational slot map.
+ *
+ * Entities are constructed in place in fixed size chunks of storage, which are never freed while any entity is alive;
+ * a slot is reused once the entity that occupied it has been destroyed. The index of an entity's slot is encoded in
+ * its id along with the slot's generation, so lookups are a bounds check, an array index and a generation compare.
+ *
+ * Once a slot's generation reaches Entity::id_generation_mask it is retired, and never used again, so a stale id never
+ * resolves to another entity. Each slot costs sizeof(Entity), and can be reused thousands of times before it retires.
+ */
+class Entity_repository : public IEntity_repository {
+ public:
+  // Number of entities in each chunk of storage.
+  static constexpr uint32_t chunk_size = 256;
+
+  Entity_repository();
+  ~Entity_repository();
+  Entity_repository(const Entity_repository&) = delete;
+  Entity_repository& operator=(const Entity_repository&) = delete;
+
+  // IEntity_repository implementation
+  std::shared_ptr<Entity>
+  instantiate(std::string_view name, IScene_graph_manager& sceneGraph, IComponent_factory& componentFactory) override;
+  void remove(Entity::Id_type id) override;
+  std::shared_ptr<Entity> getEntityPtrById(Entity::Id_type id) override;
+  Entity* findEntityById(Entity::Id_type id) override;
+  Entity& getEntityById(Entity::Id_type id) override;
+
+  // Number of entities that have been instantiated and not yet removed.
+  size_t size() const;
+
+ private:
+  // Storage is shared with the deleter of each entity, so that the last reference to an entity (which may outlive the
+  // repository) can destroy it and release its slot.
+  struct Entity_pool {
+    using Entity_storage = std::aligned_storage_t<sizeof(Entity), alignof(Entity)>;
+
+    Entity* slotStorage(uint32_t index)
+    {
+      return reinterpret_cast<Entity*>(&chunks[index / chunk_size][index % chunk_size]);
+    }
+
+    std::vector<std::unique_ptr<Entity_storage[]>> chunks;
+
+    // Per slot. The repository's reference to the entity in each slot is null once it has been removed.
+    std::vector<std::shared_ptr<Entity>> entities;
+    std::vector<uint32_t> generations;
+
+    // Slots whose entity has been destroyed, and so may be reused. Retired slots are never added.
+    std::vector<uint32_t> freeSlots;
+    size_t size = 0;
+  };
+
+  struct Entity_deleter {
+    std::shared_ptr<Entity_pool> pool;
+    uint32_t index;
+
+    void operator()(Entity* entity) const;
+  };
+
+  // Returns the slot index for the given id, or Entity::id_index_mask if the id is not valid.
+  uint32_t findSlot(Entity::Id_type id) const;
+
+  std::shared_ptr<Entity_pool> _pool;
+};
+}// namespace oe
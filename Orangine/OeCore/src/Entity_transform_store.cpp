@@ -0,0 +1,196 @@
+#include "OeCore/Entity_transform_store.h"
+
+#include "OeCore/Entity.h"
+
+using namespace oe;
+
+Entity_transform_store::~Entity_transform_store() { clear(); }
+
+void Entity_transform_store::rebuild(const std::vector<std::shared_ptr<Entity>>& rootEntities) {
+  clear();
+
+  for (const auto& rootEntity : rootEntities) {
+    if (rootEntity == nullptr) {
+      assert(false);
+      continue;
+    }
+    attach(*rootEntity, invalid_index);
+  }
+
+  // Slots are appended in breadth first order; the children of each slot are appended contiguously as it is visited.
+  for (uint32_t index = 0; index < entities.size(); ++index) {
+    const auto& children = entities[index]->children();
+    firstChildIndices[index] = static_cast<uint32_t>(entities.size());
+    childCounts[index] = static_cast<uint32_t>(children.size());
+
+    for (const auto& child : children) {
+      attach(*child, index);
+    }
+  }
+
+  _hierarchyValid = true;
+}
+
+void Entity_transform_store::attach(Entity& entity, uint32_t parentIndex) {
+  assert(!entity.isTransformStored());
+
+  const auto index = static_cast<uint32_t>(entities.size());
+
+  localPositions.push_back(entity._localPosition);
+  localRotations.push_back(entity._localRotation);
+  localScales.push_back(entity._localScale);
+  worldTransforms.push_back(entity._worldTransform);
+  worldRotations.push_back(entity._worldRotation);
+  worldScales.push_back(entity._worldScale);
+  boundSpheres.push_back(entity._boundSphere);
+  parentIndices.push_back(parentIndex);
+  firstChildIndices.push_back(invalid_index);
+  childCounts.push_back(0);
+  flags.push_back(
+      (entity._active ? Transform_flag_active : 0) |
+      (entity._calculateWorldTransform ? Transform_flag_calculate_world_transform : 0) |
+      (entity._calculateBoundSphereFromChildren ? Transform_flag_calculate_bound_sphere_from_children : 0) |
+      (entity._dirtyFlags & Transform_flags_dirty_mask & ~Transform_flag_descendant_dirty));
+  entities.push_back(&entity);
+
+  entity._transformStore = this;
+  entity._transformIndex = index;
+}
+
+void Entity_transform_store::detach(Entity& entity) {
+  if (entity._transformStore != this) {
+    return;
+  }
+
+  detachSlot(entity._transformIndex);
+  _hierarchyValid = false;
+}
+
+void Entity_transform_store::detachSlot(uint32_t index) {
+  const auto entity = entities[index];
+  if (entity == nullptr) {
+    return;
+  }
+
+  entity->_localPosition = localPositions[index];
+  entity->_localRotation = localRotations[index];
+  entity->_localScale = localScales[index];
+  entity->_worldTransform = worldTransforms[index];
+  entity->_worldRotation = worldRotations[index];
+  entity->_worldScale = worldScales[index];
+  entity->_boundSphere = boundSpheres[index];
+  entity->_dirtyFlags = flags[index] & Transform_flags_dirty_mask;
+
+  entity->_transformStore = nullptr;
+  entity->_transformIndex = invalid_index;
+  entities[index] = nullptr;
+  flags[index] = 0;
+}
+
+void Entity_transform_store::clear() {
+  for (uint32_t index = 0; index < entities.size(); ++index) {
+    detachSlot(index);
+  }
+
+  localPositions.clear();
+  localRotations.clear();
+  localScales.clear();
+  worldTransforms.clear();
+  worldRotations.clear();
+  worldScales.clear();
+  boundSpheres.clear();
+  parentIndices.clear();
+  firstChildIndices.clear();
+  childCounts.clear();
+  flags.clear();
+  entities.clear();
+
+  _hierarchyValid = false;
+}
+
+uint32_t Entity_transform_store::update(std::vector<Entity*>* boundsChangedEntities) {
+  assert(_hierarchyValid);
+
+  const auto count = static_cast<uint32_t>(entities.size());
+  _visitStates.assign(count, Visit_state::Skipped);
+  uint32_t recomputedCount = 0;
+
+  // Root -> leaves. Parents always precede their children, so the parent world transform is already up to date.
+  for (uint32_t index = 0; index < count; ++index) {
+    const auto slotFlags = flags[index];
+    const auto parentIndex = parentIndices[index];
+    if (!(slotFlags & Transform_flag_active) ||
+        (parentIndex != invalid_index && _visitStates[parentIndex] == Visit_state::Skipped)) {
+      continue;
+    }
+
+    const auto parentChanged =
+        parentIndex != invalid_index && _visitStates[parentIndex] == Visit_state::Transform_changed;
+    if (!parentChanged && !(slotFlags & Transform_flag_transform_dirty)) {
+      _visitStates[index] = Visit_state::Visited;
+      continue;
+    }
+    _visitStates[index] = Visit_state::Transform_changed;
+
+    if (!(slotFlags & Transform_flag_calculate_world_transform)) {
+      continue;
+    }
+
+    ++recomputedCount;
+    if (parentIndex == invalid_index) {
+      computeWorldTransform(
+          localPositions[index], localRotations[index], localScales[index],
+          worldTransforms[index], worldRotations[index], worldScales[index]);
+    } else {
+      computeWorldTransform(
+          localPositions[index], localRotations[index], localScales[index],
+          worldTransforms[parentIndex], worldRotations[parentIndex], worldScales[parentIndex],
+          worldTransforms[index], worldRotations[index], worldScales[index]);
+    }
+  }
+
+  // Leaves -> root. Children always follow their parents, so their bound spheres have already been merged.
+  _childBoundsChanged.assign(count, 0);
+  for (auto index = count; index-- > 0;) {
+    const auto slotFlags = flags[index];
+    const auto parentIndex = parentIndices[index];
+    auto boundsChanged = (slotFlags & Transform_flag_bound_sphere_dirty) != 0;
+
+    if (_visitStates[index] == Visit_state::Skipped) {
+      // Inactive slots keep their dirty flags until they are next visited; however a changed bound sphere is still
+      // merged into a visited parent.
+      if (boundsChanged && parentIndex != invalid_index && _visitStates[parentIndex] != Visit_state::Skipped) {
+        _childBoundsChanged[parentIndex] = 1;
+        flags[index] &= ~Transform_flag_bound_sphere_dirty;
+        if (boundsChangedEntities) {
+          boundsChangedEntities->push_back(entities[index]);
+        }
+      }
+      continue;
+    }
+
+    const auto childCount = childCounts[index];
+    if (childCount > 0 && (slotFlags & Transform_flag_calculate_bound_sphere_from_children) &&
+        (_childBoundsChanged[index] || (slotFlags & Transform_flag_children_dirty))) {
+      const auto firstChild = firstChildIndices[index];
+      auto accumulatedBounds = boundSpheres[firstChild];
+      for (auto childIndex = firstChild + 1; childIndex < firstChild + childCount; ++childIndex) {
+        BoundingSphere::createMerged(accumulatedBounds, accumulatedBounds, boundSpheres[childIndex]);
+      }
+      boundSpheres[index] = accumulatedBounds;
+      boundsChanged = true;
+    }
+
+    if (boundsChanged) {
+      if (parentIndex != invalid_index) {
+        _childBoundsChanged[parentIndex] = 1;
+      }
+      if (boundsChangedEntities) {
+        boundsChangedEntities->push_back(entities[index]);
+      }
+    }
+    flags[index] &= ~Transform_flags_dirty_mask;
+  }
+
+  return recomputedCount;
+}
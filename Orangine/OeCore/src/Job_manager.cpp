@@ -0,0 +1,238 @@
+#include "Job_manager.h"
+
+#include <OeCore/EngineUtils.h>
+#include <OeCore/IConfigReader.h>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace oe;
+using namespace internal;
+
+std::string Job_manager::_name = "Job_manager";
+
+namespace {
+// The job manager that owns the current thread, and the index of that thread's queue. Null for threads that are not
+// workers (such as the main thread).
+thread_local const Job_manager* t_owningJobManager = nullptr;
+thread_local uint32_t t_queueIndex = 0;
+} // namespace
+
+template<> void oe::create_manager(Manager_instance<IJob_manager>& out)
+{
+  out = Manager_instance<IJob_manager>(std::make_unique<Job_manager>());
+}
+
+Job_manager::Job_manager()
+    : IJob_manager()
+    , Manager_base()
+{}
+
+Job_manager::~Job_manager() { shutdown(); }
+
+void Job_manager::loadConfig(const IConfigReader& configReader)
+{
+  Manager_base::loadConfig(configReader);
+
+  const auto workerCount = configReader.readInt("OeCore.job_worker_count");
+  if (workerCount < 0) {
+    OE_THROW(std::invalid_argument("OeCore.job_worker_count must not be negative."));
+  }
+  preInit_setWorkerCount(static_cast<uint32_t>(workerCount));
+}
+
+void Job_manager::initialize()
+{
+  auto workerCount = _configuredWorkerCount;
+  if (workerCount == 0) {
+    workerCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Queue 0 belongs to the threads that call into the job manager; every other queue has a dedicated thread.
+  _queues.resize(workerCount);
+  for (auto& queue : _queues) {
+    queue = std::make_unique<Job_queue>();
+  }
+
+  _running = true;
+  for (uint32_t queueIndex = 1; queueIndex < workerCount; ++queueIndex) {
+    _threads.emplace_back(&Job_manager::workerMain, this, queueIndex);
+  }
+
+  LOG(INFO) << "Job_manager started with " << workerCount << " workers.";
+  _initialized = true;
+}
+
+void Job_manager::shutdown()
+{
+  {
+    std::lock_guard<std::mutex> lock(_wakeMutex);
+    _running = false;
+  }
+  _wakeCondition.notify_all();
+
+  for (auto& thread : _threads) {
+    thread.join();
+  }
+  _threads.clear();
+  _queues.clear();
+}
+
+const std::string& Job_manager::name() const { return _name; }
+
+void Job_manager::preInit_setWorkerCount(uint32_t workerCount)
+{
+  if (_initialized) {
+    OE_THROW(std::logic_error("Cannot change worker count after Job_manager is initialized."));
+  }
+  _configuredWorkerCount = workerCount;
+}
+
+uint32_t Job_manager::workerCount() const { return std::max(1u, static_cast<uint32_t>(_queues.size())); }
+
+void Job_manager::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn)
+{
+  if (count == 0) {
+    return;
+  }
+
+  grainSize = std::max<size_t>(grainSize, 1);
+  if (_queues.size() <= 1 || count <= grainSize) {
+    fn(0, count);
+    return;
+  }
+
+  const auto jobCount = (count + grainSize - 1) / grainSize;
+  Job_batch batch(fn, jobCount);
+
+  // Counted before the jobs are published, so that a worker that runs one can't decrement the count below zero.
+  {
+    std::lock_guard<std::mutex> lock(_wakeMutex);
+    _queuedJobCount += static_cast<uint32_t>(jobCount - 1);
+  }
+
+  // Push in reverse, so that this thread pops the ranges in ascending order while other workers steal from the end.
+  const auto queueIndex = currentQueueIndex();
+  {
+    auto& queue = *_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (auto jobIdx = jobCount; jobIdx-- > 1;) {
+      const auto begin = jobIdx * grainSize;
+      queue.jobs.push_back({&batch, begin, std::min(count, begin + grainSize)});
+    }
+  }
+  _wakeCondition.notify_all();
+
+  runJob({&batch, 0, grainSize});
+
+  // Help out with the rest of this batch until every range is complete. Jobs of other batches are left to the
+  // workers: queue 0 is shared by every thread that isn't a worker, so they may be long running jobs of another thread
+  // (such as a background load) that would stall this one.
+  while (batch.remaining.load(std::memory_order_acquire) > 0) {
+    if (!tryRunBatchJob(queueIndex, batch)) {
+      std::this_thread::yield();
+    }
+  }
+
+  if (batch.exception) {
+    std::rethrow_exception(batch.exception);
+  }
+}
+
+void Job_manager::workerMain(uint32_t queueIndex)
+{
+  t_owningJobManager = this;
+  t_queueIndex = queueIndex;
+
+  while (_running) {
+    if (tryRunJob(queueIndex)) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_wakeMutex);
+    _wakeCondition.wait(lock, [this]() { return !_running || _queuedJobCount > 0; });
+  }
+}
+
+uint32_t Job_manager::currentQueueIndex() const { return t_owningJobManager == this ? t_queueIndex : 0; }
+
+bool Job_manager::tryRunJob(uint32_t queueIndex)
+{
+  Job job;
+  if (!tryPop(queueIndex, job) && !trySteal(queueIndex, job)) {
+    return false;
+  }
+
+  --_queuedJobCount;
+  runJob(job);
+  return true;
+}
+
+bool Job_manager::tryRunBatchJob(uint32_t queueIndex, const Job_batch& batch)
+{
+  Job job;
+  {
+    // Jobs of a batch are only pushed to the queue of the thread that created it; the rest have been stolen.
+    auto& queue = *_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    const auto pos = std::find_if(
+        queue.jobs.rbegin(), queue.jobs.rend(), [&batch](const Job& queued) { return queued.batch == &batch; });
+    if (pos == queue.jobs.rend()) {
+      return false;
+    }
+
+    job = *pos;
+    queue.jobs.erase(std::next(pos).base());
+  }
+
+  --_queuedJobCount;
+  runJob(job);
+  return true;
+}
+
+bool Job_manager::tryPop(uint32_t queueIndex, Job& job)
+{
+  auto& queue = *_queues[queueIndex];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.jobs.empty()) {
+    return false;
+  }
+
+  job = queue.jobs.back();
+  queue.jobs.pop_back();
+  return true;
+}
+
+bool Job_manager::trySteal(uint32_t thiefQueueIndex, Job& job)
+{
+  const auto queueCount = static_cast<uint32_t>(_queues.size());
+  for (uint32_t offset = 1; offset < queueCount; ++offset) {
+    auto& queue = *_queues[(thiefQueueIndex + offset) % queueCount];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+      continue;
+    }
+
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+    return true;
+  }
+  return false;
+}
+
+void Job_manager::runJob(const Job& job)
+{
+  auto& batch = *job.batch;
+  try {
+    batch.fn(job.begin, job.end);
+  }
+  catch (...) {
+    std::lock_guard<std::mutex> lock(batch.exceptionMutex);
+    if (!batch.exception) {
+      batch.exception = std::current_exception();
+    }
+  }
+
+  // Must be the last access to the batch; the thread that owns it may return as soon as this reaches zero.
+  batch.remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
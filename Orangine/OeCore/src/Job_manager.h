@@ -0,0 +1,83 @@
+#pragma once
+
+#include <OeCore/IJob_manager.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oe::internal {
+class Job_manager : public IJob_manager, public Manager_base {
+ public:
+  Job_manager();
+  ~Job_manager() override;
+
+  // Manager_base implementation
+  void loadConfig(const IConfigReader&) override;
+  void initialize() override;
+  void shutdown() override;
+  const std::string& name() const override;
+
+  // IJob_manager implementation
+  void preInit_setWorkerCount(uint32_t workerCount) override;
+  uint32_t workerCount() const override;
+  void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn) override;
+
+ private:
+  // Shared state for all of the jobs created by a single call to parallelFor.
+  struct Job_batch {
+    Job_batch(const std::function<void(size_t, size_t)>& fn, size_t jobCount)
+        : fn(fn)
+        , remaining(jobCount)
+    {}
+
+    const std::function<void(size_t, size_t)>& fn;
+    std::atomic<size_t> remaining;
+    std::mutex exceptionMutex;
+    std::exception_ptr exception;
+  };
+
+  struct Job {
+    Job_batch* batch;
+    size_t begin;
+    size_t end;
+  };
+
+  struct Job_queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  void workerMain(uint32_t queueIndex);
+
+  // Index of the queue owned by the calling thread. Threads that are not workers share queue 0.
+  uint32_t currentQueueIndex() const;
+
+  // Pops a job from the back of the given queue, or failing that steals one from the front of another queue, then
+  // runs it. Returns false if there were no jobs.
+  bool tryRunJob(uint32_t queueIndex);
+  // Pops the newest job of batch from the given queue, and runs it. Returns false if there were none.
+  bool tryRunBatchJob(uint32_t queueIndex, const Job_batch& batch);
+  bool tryPop(uint32_t queueIndex, Job& job);
+  bool trySteal(uint32_t thiefQueueIndex, Job& job);
+  static void runJob(const Job& job);
+
+  static std::string _name;
+
+  bool _initialized = false;
+  uint32_t _configuredWorkerCount = 0;
+
+  std::vector<std::unique_ptr<Job_queue>> _queues;
+  std::vector<std::thread> _threads;
+
+  std::atomic<bool> _running = false;
+  std::atomic<uint32_t> _queuedJobCount = 0;
+  std::mutex _wakeMutex;
+  std::condition_variable _wakeCondition;
+};
+} // namespace oe::internal
@@ -0,0 +1,59 @@
+#include "OeCore/Mapped_file.h"
+
+#include "OeCore/EngineUtils.h"
+
+using namespace oe;
+
+Mapped_file::Mapped_file(const std::string& filename)
+{
+  _file = CreateFileW(
+      utf8_decode(filename).c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr);
+  if (_file == INVALID_HANDLE_VALUE) {
+    OE_THROW(std::runtime_error("Failed to open file " + filename + ": " + getlasterror_to_str()));
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(_file, &fileSize)) {
+    const auto error = getlasterror_to_str();
+    CloseHandle(_file);
+    OE_THROW(std::runtime_error("Failed to get size of file " + filename + ": " + error));
+  }
+
+  // Empty files can't be mapped; leave data null.
+  _size = static_cast<size_t>(fileSize.QuadPart);
+  if (_size == 0) {
+    return;
+  }
+
+  _mapping = CreateFileMappingW(_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  if (_mapping) {
+    _data = static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_COPY, 0, 0, 0));
+  }
+  if (!_data) {
+    const auto error = getlasterror_to_str();
+    if (_mapping) {
+      CloseHandle(_mapping);
+    }
+    CloseHandle(_file);
+    OE_THROW(std::runtime_error("Failed to map file " + filename + ": " + error));
+  }
+}
+
+Mapped_file::~Mapped_file()
+{
+  if (_data) {
+    UnmapViewOfFile(_data);
+  }
+  if (_mapping) {
+    CloseHandle(_mapping);
+  }
+  if (_file != INVALID_HANDLE_VALUE) {
+    CloseHandle(_file);
+  }
+}
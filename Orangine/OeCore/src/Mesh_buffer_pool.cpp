@@ -0,0 +1,183 @@
+#include "OeCore/Mesh_buffer_pool.h"
+
+#include "OeCore/Mesh_data.h"
+#include "OeCore/Mesh_utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace oe;
+
+namespace {
+// Remove the entries of freed buffers after this many adds, so that the pool doesn't grow as levels come and go.
+constexpr size_t g_addsPerRemoveExpired = 256;
+
+// MurmurHash64A, by Austin Appleby (public domain).
+uint64_t hash_bytes(const uint8_t* data, size_t size)
+{
+  constexpr uint64_t m = 0xc6a4a7935bd1e995ull;
+  constexpr int r = 47;
+  uint64_t h = 0x9e3779b97f4a7c15ull ^ (size * m);
+
+  const auto* end = data + (size & ~static_cast<size_t>(7));
+  for (auto* pos = data; pos != end; pos += 8) {
+    uint64_t k;
+    std::memcpy(&k, pos, sizeof(k));
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+
+  const auto remaining = size & 7;
+  if (remaining) {
+    uint64_t k = 0;
+    std::memcpy(&k, end, remaining);
+    h ^= k;
+    h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+} // namespace
+
+std::shared_ptr<Mesh_buffer> Mesh_buffer_pool::findOrCreate(const uint8_t* data, size_t size)
+{
+  const auto hash = hash_bytes(data, size);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (auto buffer = find(hash, data, size)) {
+      ++_sharedCount;
+      _sharedBytes += size;
+      return buffer;
+    }
+  }
+
+  // Copy outside of the lock; another thread may add the same contents meanwhile, so look again before adding.
+  auto created = std::make_shared<Mesh_buffer>(size);
+  std::memcpy(created->data, data, size);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (auto buffer = find(hash, data, size)) {
+    ++_sharedCount;
+    _sharedBytes += size;
+    return buffer;
+  }
+  add(hash, created);
+  return created;
+}
+
+void Mesh_buffer_pool::share(Mesh_buffer_accessor& accessor, size_t elementSize)
+{
+  if (!accessor.buffer || accessor.count == 0) {
+    return;
+  }
+
+  // Includes the padding after the last element where the buffer has it, since Mesh_buffer::getIndexed reads whole
+  // strides.
+  const auto minSize = static_cast<size_t>(accessor.count - 1) * accessor.stride + elementSize;
+  if (accessor.offset + minSize > accessor.buffer->dataSize) {
+    OE_THROW(std::runtime_error(
+        "Mesh buffer accessor reads past the end of its buffer. offset=" + std::to_string(accessor.offset) +
+        ", size=" + std::to_string(minSize) + ", dataSize=" + std::to_string(accessor.buffer->dataSize)));
+  }
+  const auto available = accessor.buffer->dataSize - accessor.offset;
+  const auto size = std::max(minSize, std::min(static_cast<size_t>(accessor.count) * accessor.stride, available));
+
+  auto* data = accessor.buffer->data + accessor.offset;
+  const auto hash = hash_bytes(data, size);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (auto buffer = find(hash, data, size)) {
+    if (buffer != accessor.buffer) {
+      ++_sharedCount;
+      _sharedBytes += size;
+    }
+    accessor.buffer = std::move(buffer);
+    accessor.offset = 0;
+    return;
+  }
+
+  if (accessor.offset != 0 || size != accessor.buffer->dataSize) {
+    // Only pool the bytes this accessor reads, so that it matches others reading the same bytes from other buffers.
+    accessor.buffer = std::make_shared<Mesh_buffer>(data, size, accessor.buffer);
+    accessor.offset = 0;
+  }
+  add(hash, accessor.buffer);
+}
+
+void Mesh_buffer_pool::share(Mesh_data& meshData)
+{
+  if (meshData.indexBufferAccessor) {
+    share(*meshData.indexBufferAccessor, meshData.indexBufferAccessor->stride);
+  }
+
+  const auto shareVertexAccessor = [this](Mesh_vertex_buffer_accessor& accessor) {
+    const auto& element = accessor.attributeElement;
+    share(accessor, mesh_utils::element_size(element.type, element.component));
+  };
+  for (auto& [semantic, accessor] : meshData.vertexBufferAccessors) {
+    shareVertexAccessor(*accessor);
+  }
+  for (auto& morphTarget : meshData.attributeMorphBufferAccessors) {
+    for (auto& accessor : morphTarget) {
+      if (accessor) {
+        shareVertexAccessor(*accessor);
+      }
+    }
+  }
+}
+
+Mesh_buffer_pool_statistics Mesh_buffer_pool::statistics() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  Mesh_buffer_pool_statistics statistics;
+  for (const auto& [hash, entry] : _entries) {
+    if (!entry.buffer.expired()) {
+      ++statistics.bufferCount;
+      statistics.bufferBytes += entry.size;
+    }
+  }
+  statistics.sharedCount = _sharedCount;
+  statistics.sharedBytes = _sharedBytes;
+  return statistics;
+}
+
+std::shared_ptr<Mesh_buffer> Mesh_buffer_pool::find(uint64_t hash, const uint8_t* data, size_t size) const
+{
+  const auto [begin, end] = _entries.equal_range(hash);
+  for (auto pos = begin; pos != end; ++pos) {
+    if (pos->second.size != size) {
+      continue;
+    }
+    auto buffer = pos->second.buffer.lock();
+    if (buffer && (buffer->data == data || std::memcmp(buffer->data, data, size) == 0)) {
+      return buffer;
+    }
+  }
+  return nullptr;
+}
+
+void Mesh_buffer_pool::add(uint64_t hash, const std::shared_ptr<Mesh_buffer>& buffer)
+{
+  if (++_addsSinceRemoveExpired >= g_addsPerRemoveExpired) {
+    removeExpired();
+  }
+  _entries.emplace(hash, Entry{buffer, buffer->dataSize});
+}
+
+void Mesh_buffer_pool::removeExpired()
+{
+  for (auto pos = _entries.begin(); pos != _entries.end();) {
+    if (pos->second.buffer.expired()) {
+      pos = _entries.erase(pos);
+    } else {
+      ++pos;
+    }
+  }
+  _addsSinceRemoveExpired = 0;
+}
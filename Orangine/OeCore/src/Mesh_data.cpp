@@ -1,6 +1,7 @@
 ﻿#include "OeCore/Mesh_data.h"
 #include "OeCore/EngineUtils.h"
 
+#include <cassert>
 #include <utility>
 
 using namespace oe;
@@ -96,8 +97,14 @@ Mesh_buffer::Mesh_buffer(size_t size) : data(nullptr), dataSize(size) {
   data = new std::uint8_t[size];
 }
 
+Mesh_buffer::Mesh_buffer(uint8_t* data, size_t size, std::shared_ptr<const void> owner)
+    : data(data), dataSize(size), _owner(std::move(owner)) {
+  assert(_owner);
+}
+
 Mesh_buffer::~Mesh_buffer() {
-  delete[] data;
+  if (!_owner)
+    delete[] data;
   data = nullptr;
   dataSize = 0;
 }
@@ -3,3 +3,13 @@
 using namespace oe;
 
 DEFINE_COMPONENT_TYPE(Mesh_data_component);
+
+size_t Mesh_data_component::selectLod(float projectedRadius, float maxScreenError) const {
+  // Levels are ordered by increasing error, so take the last that is still precise enough.
+  size_t lod = 0;
+  const auto& lods = _component_properties.lods;
+  while (lod < lods.size() && lods[lod].error * projectedRadius <= maxScreenError) {
+    ++lod;
+  }
+  return lod;
+}
@@ -0,0 +1,331 @@
+#include "OeCore/Mesh_deformer.h"
+
+#include "OeCore/EngineUtils.h"
+#include "OeCore/Mesh_data.h"
+#include "OeCore/Mesh_utils.h"
+#include "OeCore/Renderer_data.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+using namespace oe;
+
+// Vertices morphed per pass of the morph loops; sized so a block of positions and normals stays in L1.
+constexpr size_t g_deformBlockSize = 64;
+
+namespace {
+const Mesh_vertex_buffer_accessor* findVertexAccessor(const Mesh_data& meshData, Vertex_attribute attribute)
+{
+  const auto pos = meshData.vertexBufferAccessors.find({attribute, 0});
+  return pos == meshData.vertexBufferAccessors.end() ? nullptr : pos->second.get();
+}
+
+template <class TStream> void readFloat3Stream(const Mesh_vertex_buffer_accessor& accessor, size_t count, TStream& out)
+{
+  const auto& element = accessor.attributeElement;
+  if (element.type != Element_type::Vector3 && element.type != Element_type::Vector4 &&
+      element.encoding != Element_encoding::Octahedral && element.encoding != Element_encoding::Octahedral_signed) {
+    OE_THROW(std::runtime_error(
+        "Mesh_deformer requires Vector3 " + vertexAttributeToString(element.semantic.attribute) + " elements"));
+  }
+  if (accessor.count < count) {
+    OE_THROW(std::runtime_error("Vertex stream " + vertexAttributeToString(element.semantic.attribute) +
+                                " has fewer elements than the mesh has vertices"));
+  }
+
+  out.x.resize(count);
+  out.y.resize(count);
+  out.z.resize(count);
+  if (element.component != Element_component::Float || element.encoding != Element_encoding::None) {
+    // Quantized streams are decoded once here, so that deforming them costs the same as float ones.
+    for (size_t idx = 0; idx < count; ++idx) {
+      const auto value = mesh_utils::read_vertex_element(accessor, idx);
+      out.x[idx] = value.getX();
+      out.y[idx] = value.getY();
+      out.z[idx] = value.getZ();
+    }
+    return;
+  }
+
+  for (size_t idx = 0; idx < count; ++idx) {
+    float value[3];
+    std::memcpy(value, accessor.getIndexed(idx), sizeof(value));
+    out.x[idx] = value[0];
+    out.y[idx] = value[1];
+    out.z[idx] = value[2];
+  }
+}
+
+// Reads a 4 component unsigned integer element, optionally normalizing it to [0, 1].
+template <class TComponent> std::array<float, 4> readUnsignedVector4(const uint8_t* data, bool normalized)
+{
+  TComponent value[4];
+  std::memcpy(value, data, sizeof(value));
+  const auto scale = normalized ? 1.0f / static_cast<float>(std::numeric_limits<TComponent>::max()) : 1.0f;
+  return {value[0] * scale, value[1] * scale, value[2] * scale, value[3] * scale};
+}
+
+std::array<float, 4> readVector4(const Mesh_vertex_buffer_accessor& accessor, size_t idx, bool normalized)
+{
+  const auto& element = accessor.attributeElement;
+  if (element.type != Element_type::Vector4) {
+    OE_THROW(std::runtime_error(
+        "Mesh_deformer requires 4 component " + vertexAttributeToString(element.semantic.attribute) + " elements"));
+  }
+
+  const auto* data = accessor.getIndexed(idx);
+  switch (element.component) {
+  case Element_component::Unsigned_byte:
+    return readUnsignedVector4<uint8_t>(data, normalized);
+  case Element_component::Unsigned_short:
+    return readUnsignedVector4<uint16_t>(data, normalized);
+  case Element_component::Float: {
+    std::array<float, 4> value;
+    std::memcpy(value.data(), data, sizeof(value));
+    return value;
+  }
+  default:
+    OE_THROW(std::runtime_error(
+        "Unsupported " + vertexAttributeToString(element.semantic.attribute) +
+        " component: " + elementComponentToString(element.component)));
+  }
+}
+
+/*
+ * Transforms a normal by the inverse transpose of m, without inverting it: the cofactor matrix is the inverse transpose
+ * scaled by the determinant, which normalizing removes. Keeps the sign of the determinant, so mirroring transforms
+ * don't flip normals. A singular m gives a zero vector, rather than NaN.
+ */
+SSE::Vector3 transformNormal(const SSE::Matrix3& m, const SSE::Vector3& normal)
+{
+  const auto cofactor0 = SSE::cross(m.getCol1(), m.getCol2());
+  const auto cofactor1 = SSE::cross(m.getCol2(), m.getCol0());
+  const auto cofactor2 = SSE::cross(m.getCol0(), m.getCol1());
+  const auto transformed = SSE::Matrix3(cofactor0, cofactor1, cofactor2) * normal;
+  return SSE::dot(m.getCol0(), cofactor0) < 0.0f ? -transformed : transformed;
+}
+
+SSE::Vector3 normalizeOrZero(const SSE::Vector3& vector)
+{
+  const float lengthSquared = SSE::lengthSqr(vector);
+  return lengthSquared > 0.0f ? vector / std::sqrt(lengthSquared) : SSE::Vector3(0.0f);
+}
+} // namespace
+
+Mesh_deformer::Mesh_deformer(const Mesh_data& meshData)
+{
+  const auto* positionAccessor = findVertexAccessor(meshData, Vertex_attribute::Position);
+  if (!positionAccessor) {
+    OE_THROW(std::runtime_error("Mesh_deformer requires a mesh with positions"));
+  }
+  _vertexCount = positionAccessor->count;
+  readFloat3Stream(*positionAccessor, _vertexCount, _positions);
+
+  if (const auto* normalAccessor = findVertexAccessor(meshData, Vertex_attribute::Normal)) {
+    readFloat3Stream(*normalAccessor, _vertexCount, _normals);
+  }
+
+  const auto* jointsAccessor = findVertexAccessor(meshData, Vertex_attribute::Joints);
+  const auto* weightsAccessor = findVertexAccessor(meshData, Vertex_attribute::Weights);
+  if (jointsAccessor && weightsAccessor) {
+    _joints.resize(_vertexCount);
+    _weights.resize(_vertexCount);
+    for (size_t idx = 0; idx < _vertexCount; ++idx) {
+      const auto joints = readVector4(*jointsAccessor, idx, false);
+      for (size_t influence = 0; influence < 4; ++influence) {
+        _joints[idx][influence] = static_cast<uint16_t>(joints[influence]);
+        _maxJointIndex = std::max<uint32_t>(_maxJointIndex, _joints[idx][influence]);
+      }
+
+      const auto weights = readVector4(*weightsAccessor, idx, true);
+      _weights[idx] = {weights[0], weights[1], weights[2], weights[3]};
+    }
+  }
+
+  // Only position and normal deltas affect the result; tangents aren't deformed.
+  for (const auto& morphTargetAccessors : meshData.attributeMorphBufferAccessors) {
+    Morph_target morphTarget;
+    for (const auto& accessor : morphTargetAccessors) {
+      switch (accessor->attributeElement.semantic.attribute) {
+      case Vertex_attribute::Position:
+        readFloat3Stream(*accessor, _vertexCount, morphTarget.positionDeltas);
+        break;
+      case Vertex_attribute::Normal:
+        if (hasNormals()) {
+          readFloat3Stream(*accessor, _vertexCount, morphTarget.normalDeltas);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+    _morphTargets.push_back(std::move(morphTarget));
+  }
+
+  if (meshData.m_meshIndexType == Mesh_index_type::Triangles) {
+    if (const auto& indexAccessor = meshData.indexBufferAccessor) {
+      _indices.resize(indexAccessor->count);
+      for (size_t idx = 0; idx < _indices.size(); ++idx) {
+        _indices[idx] = mesh_utils::convert_index_value(indexAccessor->component, indexAccessor->getIndexed(idx));
+        if (_indices[idx] >= _vertexCount) {
+          OE_THROW(std::runtime_error("Index " + std::to_string(_indices[idx]) + " is out of range"));
+        }
+      }
+    } else {
+      _indices.resize(_vertexCount - _vertexCount % 3);
+      for (size_t idx = 0; idx < _indices.size(); ++idx) {
+        _indices[idx] = static_cast<uint32_t>(idx);
+      }
+    }
+  }
+}
+
+void Mesh_deformer::deform(
+    const float* morphWeights,
+    size_t morphWeightCount,
+    const std::vector<SSE::Matrix4>& boneTransforms,
+    Deformed_mesh& out) const
+{
+  const auto skin = skinned() && !boneTransforms.empty();
+  if (skin && boneTransforms.size() <= _maxJointIndex) {
+    OE_THROW(std::runtime_error(
+        "Mesh uses joint " + std::to_string(_maxJointIndex) + ", but only " + std::to_string(boneTransforms.size()) +
+        " bone transforms were given"));
+  }
+
+  std::array<std::pair<const Morph_target*, float>, Renderer_animation_data::morphWeightsSize> activeMorphTargets;
+  size_t activeMorphTargetCount = 0;
+  for (size_t targetIdx = 0; targetIdx < std::min(morphWeightCount, _morphTargets.size()); ++targetIdx) {
+    if (morphWeights[targetIdx] != 0.0f && activeMorphTargetCount < activeMorphTargets.size()) {
+      activeMorphTargets[activeMorphTargetCount++] = {&_morphTargets[targetIdx], morphWeights[targetIdx]};
+    }
+  }
+
+  // base + sum(weight * delta), for one block of one attribute.
+  const auto morphBlock = [&activeMorphTargets, activeMorphTargetCount](
+                              const Float3_stream& base,
+                              Float3_stream Morph_target::*deltasMember,
+                              size_t blockStart,
+                              size_t blockSize,
+                              float* x,
+                              float* y,
+                              float* z) {
+    std::copy_n(base.x.data() + blockStart, blockSize, x);
+    std::copy_n(base.y.data() + blockStart, blockSize, y);
+    std::copy_n(base.z.data() + blockStart, blockSize, z);
+    for (size_t targetIdx = 0; targetIdx < activeMorphTargetCount; ++targetIdx) {
+      const auto& deltas = activeMorphTargets[targetIdx].first->*deltasMember;
+      if (deltas.x.empty()) {
+        continue;
+      }
+
+      const auto weight = activeMorphTargets[targetIdx].second;
+      const auto* dx = deltas.x.data() + blockStart;
+      const auto* dy = deltas.y.data() + blockStart;
+      const auto* dz = deltas.z.data() + blockStart;
+      for (size_t idx = 0; idx < blockSize; ++idx) {
+        x[idx] += weight * dx[idx];
+        y[idx] += weight * dy[idx];
+        z[idx] += weight * dz[idx];
+      }
+    }
+  };
+
+  const auto normals = hasNormals();
+  out.positions.resize(_vertexCount);
+  out.normals.resize(normals ? _vertexCount : 0);
+
+  alignas(16) float positionX[g_deformBlockSize], positionY[g_deformBlockSize], positionZ[g_deformBlockSize];
+  alignas(16) float normalX[g_deformBlockSize], normalY[g_deformBlockSize], normalZ[g_deformBlockSize];
+  for (size_t blockStart = 0; blockStart < _vertexCount; blockStart += g_deformBlockSize) {
+    const auto blockSize = std::min(g_deformBlockSize, _vertexCount - blockStart);
+    morphBlock(_positions, &Morph_target::positionDeltas, blockStart, blockSize, positionX, positionY, positionZ);
+    if (normals) {
+      morphBlock(_normals, &Morph_target::normalDeltas, blockStart, blockSize, normalX, normalY, normalZ);
+    }
+
+    for (size_t idx = 0; idx < blockSize; ++idx) {
+      const auto vertexIdx = blockStart + idx;
+      const auto position = SSE::Point3(positionX[idx], positionY[idx], positionZ[idx]);
+
+      // Same as the vertex shader: a weighted sum of the bone matrices. Vertices without any weight would collapse to
+      // the origin, so are left unskinned.
+      auto skinVertex = false;
+      SSE::Matrix4 skinInfluence;
+      if (skin) {
+        const auto& joints = _joints[vertexIdx];
+        const auto& weights = _weights[vertexIdx];
+        skinVertex = weights.getX() + weights.getY() + weights.getZ() + weights.getW() > 0.0f;
+        if (skinVertex) {
+          skinInfluence = boneTransforms[joints[0]] * weights.getX() + boneTransforms[joints[1]] * weights.getY() +
+                          boneTransforms[joints[2]] * weights.getZ() + boneTransforms[joints[3]] * weights.getW();
+        }
+      }
+      out.positions[vertexIdx] = skinVertex ? (skinInfluence * position).getXYZ() : SSE::Vector3(position);
+
+      if (normals) {
+        auto normal = SSE::Vector3(normalX[idx], normalY[idx], normalZ[idx]);
+        if (skinVertex) {
+          // Bones that scale to nothing leave the normal unskinned.
+          const auto skinnedNormal = transformNormal(skinInfluence.getUpper3x3(), normal);
+          if (SSE::lengthSqr(skinnedNormal) > 0.0f) {
+            normal = skinnedNormal;
+          }
+        }
+        out.normals[vertexIdx] = normalizeOrZero(normal);
+      }
+    }
+  }
+}
+
+BoundingSphere Mesh_deformer::boundingSphere(const Deformed_mesh& deformedMesh)
+{
+  const auto& positions = deformedMesh.positions;
+  if (positions.empty()) {
+    return {};
+  }
+
+  auto min = positions.front();
+  auto max = positions.front();
+  for (const auto& position : positions) {
+    min = SSE::minPerElem(min, position);
+    max = SSE::maxPerElem(max, position);
+  }
+
+  const auto center = (min + max) * 0.5f;
+  float radiusSquared = 0.0f;
+  for (const auto& position : positions) {
+    radiusSquared = std::max(radiusSquared, SSE::lengthSqr(position - center));
+  }
+  return {center, std::sqrt(radiusSquared)};
+}
+
+bool Mesh_deformer::intersectRay(
+    const Ray& ray,
+    const Deformed_mesh& deformedMesh,
+    Ray_intersection& intersection) const
+{
+  const auto& positions = deformedMesh.positions;
+  if (positions.size() != _vertexCount) {
+    OE_THROW(std::logic_error("Deformed mesh was not written by this Mesh_deformer"));
+  }
+
+  auto hit = false;
+  Ray_intersection triangleIntersection;
+  for (size_t idx = 0; idx + 2 < _indices.size(); idx += 3) {
+    if (intersect_ray_triangle(
+            ray,
+            positions[_indices[idx]],
+            positions[_indices[idx + 1]],
+            positions[_indices[idx + 2]],
+            triangleIntersection) &&
+        (!hit || triangleIntersection.distance < intersection.distance)) {
+      intersection = triangleIntersection;
+      hit = true;
+    }
+  }
+  return hit;
+}
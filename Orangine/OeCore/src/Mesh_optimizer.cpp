@@ -0,0 +1,412 @@
+#include "OeCore/Mesh_optimizer.h"
+
+#include "OeCore/EngineUtils.h"
+#include "OeCore/Mesh_data.h"
+#include "OeCore/Mesh_utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <string>
+
+using namespace oe;
+
+constexpr uint32_t g_noVertex = std::numeric_limits<uint32_t>::max();
+
+namespace {
+// A FIFO post transform cache, as a timestamp per vertex of when it was last transformed. A vertex is in the cache if
+// fewer than cacheSize other vertices have been transformed since.
+class Vertex_cache_simulator {
+ public:
+  Vertex_cache_simulator(size_t vertexCount, uint32_t cacheSize)
+      : _timestamps(vertexCount, 0), _cacheSize(cacheSize), _time(static_cast<size_t>(cacheSize) + 1)
+  {}
+
+  size_t age(uint32_t vertex) const { return _time - _timestamps[vertex]; }
+  bool cached(uint32_t vertex) const { return age(vertex) <= _cacheSize; }
+
+  // Returns true if the vertex had to be transformed.
+  bool use(uint32_t vertex)
+  {
+    if (cached(vertex)) {
+      return false;
+    }
+    _timestamps[vertex] = _time++;
+    return true;
+  }
+
+  void flush() { _time += static_cast<size_t>(_cacheSize) + 1; }
+
+ private:
+  std::vector<size_t> _timestamps;
+  size_t _cacheSize;
+  size_t _time;
+};
+
+// Reads a triangle list, checking each index against vertexCount.
+std::vector<uint32_t> read_indices(const Mesh_index_buffer_accessor& accessor, size_t vertexCount)
+{
+  if (accessor.count % 3 != 0) {
+    OE_THROW(std::runtime_error("Expected index buffer to have a count that is a multiple of 3"));
+  }
+
+  std::vector<uint32_t> indices(accessor.count);
+  for (size_t idx = 0; idx < indices.size(); ++idx) {
+    indices[idx] = mesh_utils::convert_index_value(accessor.component, accessor.getIndexed(idx));
+    if (indices[idx] >= vertexCount) {
+      OE_THROW(std::runtime_error(
+          "Index " + std::to_string(idx) + " (" + std::to_string(indices[idx]) + ") is out of range of " +
+          std::to_string(vertexCount) + " vertices"));
+    }
+  }
+  return indices;
+}
+
+// Copies the elements of accessor into a new, tightly packed buffer, moving element idx to remap[idx].
+std::unique_ptr<Mesh_vertex_buffer_accessor> remap_vertex_accessor(
+    const Mesh_vertex_buffer_accessor& accessor,
+    const std::vector<uint32_t>& remap)
+{
+  const auto& element = accessor.attributeElement;
+  if (accessor.count != remap.size()) {
+    OE_THROW(std::runtime_error(
+        "Vertex stream " + vertexAttributeToString(element.semantic.attribute) + " has " +
+        std::to_string(accessor.count) + " elements, but the mesh has " + std::to_string(remap.size()) +
+        " vertices"));
+  }
+
+  const auto elementSize = mesh_utils::element_size(element.type, element.component);
+  if (accessor.count > 0 &&
+      (accessor.stride < elementSize ||
+       accessor.offset + static_cast<size_t>(accessor.count - 1) * accessor.stride + elementSize >
+           accessor.buffer->dataSize)) {
+    OE_THROW(std::runtime_error(
+        "Vertex stream " + vertexAttributeToString(element.semantic.attribute) + " reads past the end of its buffer"));
+  }
+
+  // Vertex buffer elements must be 4 byte aligned.
+  const auto stride = (elementSize + 3) & ~static_cast<size_t>(3);
+  auto buffer = std::make_shared<Mesh_buffer>(stride * accessor.count);
+  std::memset(buffer->data, 0, buffer->dataSize);
+  const auto* src = accessor.buffer->data + accessor.offset;
+  for (size_t idx = 0; idx < remap.size(); ++idx) {
+    std::memcpy(buffer->data + remap[idx] * stride, src + idx * accessor.stride, elementSize);
+  }
+  auto remapped = std::make_unique<Mesh_vertex_buffer_accessor>(
+      buffer, element, accessor.count, static_cast<uint32_t>(stride), 0);
+  remapped->decodeScale = accessor.decodeScale;
+  remapped->decodeOffset = accessor.decodeOffset;
+  return remapped;
+}
+
+std::vector<SSE::Vector3> read_positions(const Mesh_data& meshData)
+{
+  const auto pos = meshData.vertexBufferAccessors.find({Vertex_attribute::Position, 0});
+  if (pos == meshData.vertexBufferAccessors.end() ||
+      (pos->second->attributeElement.type != Element_type::Vector3 &&
+       pos->second->attributeElement.type != Element_type::Vector4)) {
+    OE_THROW(std::runtime_error("Optimizing overdraw requires a mesh with Vector3 positions"));
+  }
+  return mesh_utils::read_vector3_elements(*pos->second);
+}
+} // namespace
+
+Mesh_optimizer_report Mesh_optimizer::optimize(Mesh_data& meshData, const Mesh_optimizer_options& options)
+{
+  if (meshData.m_meshIndexType != Mesh_index_type::Triangles || !meshData.indexBufferAccessor) {
+    return {};
+  }
+
+  const size_t vertexCount = meshData.getVertexCount();
+  auto indices = read_indices(*meshData.indexBufferAccessor, vertexCount);
+
+  Mesh_optimizer_report report;
+  report.before = analyzeVertexCache(indices, options.cacheSize);
+
+  std::vector<uint32_t> clusterStarts;
+  indices = optimizeVertexCache(indices, vertexCount, options.cacheSize, &clusterStarts);
+  if (options.optimizeOverdraw) {
+    indices = optimizeOverdraw(
+        indices, read_positions(meshData), clusterStarts, options.cacheSize, options.overdrawThreshold);
+  }
+
+  if (options.reorderVertices) {
+    const auto remap = optimizeVertexFetch(indices, vertexCount);
+    for (auto& index : indices) {
+      index = remap[index];
+    }
+    for (auto& [semantic, accessor] : meshData.vertexBufferAccessors) {
+      accessor = remap_vertex_accessor(*accessor, remap);
+    }
+    for (auto& morphTargetAccessors : meshData.attributeMorphBufferAccessors) {
+      for (auto& accessor : morphTargetAccessors) {
+        accessor = remap_vertex_accessor(*accessor, remap);
+      }
+    }
+  }
+
+  meshData.indexBufferAccessor = mesh_utils::create_index_buffer(indices, meshData.indexBufferAccessor->component);
+  report.after = analyzeVertexCache(indices, options.cacheSize);
+  return report;
+}
+
+Vertex_cache_statistics Mesh_optimizer::analyzeVertexCache(const Mesh_data& meshData, uint32_t cacheSize)
+{
+  if (meshData.m_meshIndexType != Mesh_index_type::Triangles || !meshData.indexBufferAccessor) {
+    return {};
+  }
+  return analyzeVertexCache(read_indices(*meshData.indexBufferAccessor, meshData.getVertexCount()), cacheSize);
+}
+
+Vertex_cache_statistics Mesh_optimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t cacheSize)
+{
+  const auto triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return {};
+  }
+
+  const size_t vertexCount = *std::max_element(indices.begin(), indices.end()) + 1;
+  Vertex_cache_simulator cache(vertexCount, cacheSize);
+  std::vector<bool> referenced(vertexCount, false);
+  size_t misses = 0;
+  size_t referencedCount = 0;
+  for (size_t idx = 0; idx < triangleCount * 3; ++idx) {
+    const auto vertex = indices[idx];
+    if (cache.use(vertex)) {
+      ++misses;
+    }
+    if (!referenced[vertex]) {
+      referenced[vertex] = true;
+      ++referencedCount;
+    }
+  }
+
+  return {static_cast<float>(misses) / triangleCount, static_cast<float>(misses) / referencedCount};
+}
+
+std::vector<uint32_t> Mesh_optimizer::optimizeVertexCache(
+    const std::vector<uint32_t>& indices,
+    size_t vertexCount,
+    uint32_t cacheSize,
+    std::vector<uint32_t>* clusterStarts)
+{
+  const auto triangleCount = indices.size() / 3;
+  if (clusterStarts) {
+    clusterStarts->clear();
+  }
+
+  // The triangles that use each vertex.
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+  for (size_t idx = 0; idx < triangleCount * 3; ++idx) {
+    ++adjacencyOffsets[indices[idx] + 1];
+  }
+  std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  {
+    auto nextAdjacency = adjacencyOffsets;
+    for (size_t idx = 0; idx < adjacency.size(); ++idx) {
+      adjacency[nextAdjacency[indices[idx]]++] = static_cast<uint32_t>(idx / 3);
+    }
+  }
+
+  // Triangles not yet emitted, per vertex.
+  std::vector<uint32_t> liveTriangles(vertexCount);
+  for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+    liveTriangles[vertex] = adjacencyOffsets[vertex + 1] - adjacencyOffsets[vertex];
+  }
+
+  Vertex_cache_simulator cache(vertexCount, cacheSize);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> result;
+  result.reserve(triangleCount * 3);
+
+  // When the fan runs out of candidates, go back to a recently used vertex that still has triangles, or failing that,
+  // the next vertex in input order that does; the latter starts a new cluster.
+  size_t cursor = 0;
+  auto newCluster = true;
+  const auto skipDeadEnd = [&]() {
+    while (!deadEnds.empty()) {
+      const auto vertex = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveTriangles[vertex] > 0) {
+        return vertex;
+      }
+    }
+    for (; cursor < vertexCount; ++cursor) {
+      if (liveTriangles[cursor] > 0) {
+        newCluster = true;
+        return static_cast<uint32_t>(cursor);
+      }
+    }
+    return g_noVertex;
+  };
+
+  auto fanningVertex = skipDeadEnd();
+  while (fanningVertex != g_noVertex) {
+    if (newCluster && clusterStarts) {
+      clusterStarts->push_back(static_cast<uint32_t>(result.size() / 3));
+    }
+    newCluster = false;
+
+    // Emit every remaining triangle around the fanning vertex.
+    candidates.clear();
+    for (auto adjacencyIdx = adjacencyOffsets[fanningVertex]; adjacencyIdx < adjacencyOffsets[fanningVertex + 1];
+         ++adjacencyIdx) {
+      const auto triangle = adjacency[adjacencyIdx];
+      if (emitted[triangle]) {
+        continue;
+      }
+      emitted[triangle] = true;
+
+      for (size_t corner = 0; corner < 3; ++corner) {
+        const auto vertex = indices[triangle * 3 + corner];
+        result.push_back(vertex);
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        --liveTriangles[vertex];
+        cache.use(vertex);
+      }
+    }
+
+    // Fan next around the oldest candidate that would still be in the cache after fanning around it.
+    auto nextVertex = g_noVertex;
+    size_t bestPriority = 0;
+    for (const auto vertex : candidates) {
+      if (liveTriangles[vertex] == 0) {
+        continue;
+      }
+
+      const auto age = cache.age(vertex);
+      const size_t priority = age + 2 * liveTriangles[vertex] <= cacheSize ? age : 0;
+      if (nextVertex == g_noVertex || priority > bestPriority) {
+        nextVertex = vertex;
+        bestPriority = priority;
+      }
+    }
+    fanningVertex = nextVertex != g_noVertex ? nextVertex : skipDeadEnd();
+  }
+
+  return result;
+}
+
+std::vector<uint32_t> Mesh_optimizer::optimizeOverdraw(
+    const std::vector<uint32_t>& indices,
+    const std::vector<SSE::Vector3>& positions,
+    const std::vector<uint32_t>& clusterStarts,
+    uint32_t cacheSize,
+    float threshold)
+{
+  const auto triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return indices;
+  }
+  if (*std::max_element(indices.begin(), indices.end()) >= positions.size()) {
+    OE_THROW(std::runtime_error("Index is out of range of the given positions"));
+  }
+
+  // Split the hard clusters wherever the cluster so far is within threshold of the mesh's ACMR. The cache is flushed
+  // at the start of each cluster, since after sorting, its neighbours will be different.
+  const auto meshAcmr = analyzeVertexCache(indices, cacheSize).acmr;
+  std::vector<bool> hardClusterStart(triangleCount, false);
+  hardClusterStart[0] = true;
+  for (const auto triangle : clusterStarts) {
+    if (triangle < triangleCount) {
+      hardClusterStart[triangle] = true;
+    }
+  }
+
+  std::vector<size_t> softClusterStarts;
+  Vertex_cache_simulator cache(positions.size(), cacheSize);
+  size_t clusterMisses = 0;
+  size_t clusterTriangles = 0;
+  for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+    if (hardClusterStart[triangle] ||
+        static_cast<float>(clusterMisses) <= threshold * meshAcmr * static_cast<float>(clusterTriangles)) {
+      softClusterStarts.push_back(triangle);
+      cache.flush();
+      clusterMisses = 0;
+      clusterTriangles = 0;
+    }
+
+    for (size_t corner = 0; corner < 3; ++corner) {
+      if (cache.use(indices[triangle * 3 + corner])) {
+        ++clusterMisses;
+      }
+    }
+    ++clusterTriangles;
+  }
+  softClusterStarts.push_back(triangleCount);
+
+  // Area weighted centroid and normal of each cluster, and of the whole mesh.
+  const auto clusterCount = softClusterStarts.size() - 1;
+  std::vector<SSE::Vector3> clusterCentroids(clusterCount, SSE::Vector3(0.0f));
+  std::vector<SSE::Vector3> clusterNormals(clusterCount, SSE::Vector3(0.0f));
+  auto meshCentroid = SSE::Vector3(0.0f);
+  auto meshArea = 0.0f;
+  for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+    auto clusterArea = 0.0f;
+    for (auto triangle = softClusterStarts[cluster]; triangle < softClusterStarts[cluster + 1]; ++triangle) {
+      const auto& p0 = positions[indices[triangle * 3]];
+      const auto& p1 = positions[indices[triangle * 3 + 1]];
+      const auto& p2 = positions[indices[triangle * 3 + 2]];
+      const auto normal = SSE::cross(p1 - p0, p2 - p0);
+      const auto area = SSE::length(normal);
+      clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+      clusterNormals[cluster] += normal;
+      clusterArea += area;
+    }
+
+    meshCentroid += clusterCentroids[cluster];
+    meshArea += clusterArea;
+    if (clusterArea > 0.0f) {
+      clusterCentroids[cluster] /= clusterArea;
+    }
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid /= meshArea;
+  }
+
+  // Clusters that face away from the centre of the mesh are on its outside, so are likely to occlude the others.
+  std::vector<float> sortKeys(clusterCount, 0.0f);
+  for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+    const auto normalLength = SSE::length(clusterNormals[cluster]);
+    if (normalLength > 0.0f) {
+      sortKeys[cluster] = SSE::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster]) / normalLength;
+    }
+  }
+  std::vector<size_t> clusterOrder(clusterCount);
+  std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+  std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](size_t lhs, size_t rhs) {
+    return sortKeys[lhs] > sortKeys[rhs];
+  });
+
+  std::vector<uint32_t> result;
+  result.reserve(triangleCount * 3);
+  for (const auto cluster : clusterOrder) {
+    result.insert(
+        result.end(),
+        indices.begin() + softClusterStarts[cluster] * 3,
+        indices.begin() + softClusterStarts[cluster + 1] * 3);
+  }
+  return result;
+}
+
+std::vector<uint32_t> Mesh_optimizer::optimizeVertexFetch(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+  std::vector<uint32_t> remap(vertexCount, g_noVertex);
+  uint32_t nextVertex = 0;
+  for (const auto vertex : indices) {
+    if (remap[vertex] == g_noVertex) {
+      remap[vertex] = nextVertex++;
+    }
+  }
+  for (auto& newVertex : remap) {
+    if (newVertex == g_noVertex) {
+      newVertex = nextVertex++;
+    }
+  }
+  return remap;
+}
@@ -0,0 +1,125 @@
+#include "OeCore/Mesh_quantizer.h"
+
+#include "OeCore/EngineUtils.h"
+#include "OeCore/Mesh_data.h"
+#include "OeCore/Mesh_utils.h"
+
+#include <cstring>
+#include <optional>
+
+using namespace oe;
+
+namespace {
+struct Quantized_format {
+  Element_type type;
+  Element_component component;
+  Element_encoding encoding;
+};
+
+std::optional<Quantized_format> quantized_format(
+    const Vertex_attribute_element& element,
+    const Mesh_quantizer_options& options)
+{
+  if (element.component != Element_component::Float || element.encoding != Element_encoding::None) {
+    return std::nullopt;
+  }
+
+  switch (element.semantic.attribute) {
+  case Vertex_attribute::Position:
+    // Vertex buffer elements must be 4 byte aligned, so the fourth component is free; it is set to 1.
+    if (options.quantizePositions && element.type == Element_type::Vector3) {
+      return Quantized_format{Element_type::Vector4, Element_component::Unsigned_short, Element_encoding::Normalized};
+    }
+    break;
+  case Vertex_attribute::Normal:
+  case Vertex_attribute::Tangent:
+  case Vertex_attribute::Bi_tangent:
+    if (options.quantizeNormals && element.type == Element_type::Vector3) {
+      return Quantized_format{Element_type::Vector2, Element_component::Signed_short, Element_encoding::Octahedral};
+    }
+    if (options.quantizeNormals && element.type == Element_type::Vector4) {
+      return Quantized_format{
+          Element_type::Vector2, Element_component::Signed_short, Element_encoding::Octahedral_signed};
+    }
+    break;
+  case Vertex_attribute::Tex_coord:
+    if (element.type != Element_type::Vector2) {
+      break;
+    }
+    if (options.texCoords == Tex_coord_quantization::Half_float) {
+      return Quantized_format{Element_type::Vector2, Element_component::Half_float, Element_encoding::None};
+    }
+    if (options.texCoords == Tex_coord_quantization::Unorm16) {
+      return Quantized_format{Element_type::Vector2, Element_component::Unsigned_short, Element_encoding::Normalized};
+    }
+    break;
+  default:
+    break;
+  }
+  return std::nullopt;
+}
+
+std::unique_ptr<Mesh_vertex_buffer_accessor> quantize_accessor(
+    const Mesh_vertex_buffer_accessor& accessor,
+    const Quantized_format& format)
+{
+  const auto& element = accessor.attributeElement;
+  const auto elementSize = mesh_utils::element_size(format.type, format.component);
+  // Vertex buffer elements must be 4 byte aligned.
+  const auto stride = (elementSize + 3) & ~static_cast<size_t>(3);
+  auto buffer = std::make_shared<Mesh_buffer>(stride * accessor.count);
+  std::memset(buffer->data, 0, buffer->dataSize);
+
+  auto quantized = std::make_unique<Mesh_vertex_buffer_accessor>(
+      buffer,
+      Vertex_attribute_element{element.semantic, format.type, format.component, format.encoding},
+      accessor.count,
+      static_cast<uint32_t>(stride),
+      0);
+
+  // Elements gaining a fourth component, such as positions, get a w of 1.
+  const auto setW = mesh_utils::decoded_component_count(element) < 4 &&
+                    mesh_utils::decoded_component_count(quantized->attributeElement) == 4;
+  std::vector<SSE::Vector4> values(accessor.count);
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    values[idx] = mesh_utils::read_vertex_element(accessor, idx);
+    if (setW) {
+      values[idx].setW(1.0f);
+    }
+  }
+
+  if (format.encoding == Element_encoding::Normalized && !values.empty()) {
+    // Normalize within the bounds of the values, so that they use the full range of the integers.
+    auto minValue = values.front().getXYZ();
+    auto maxValue = minValue;
+    for (const auto& value : values) {
+      minValue = SSE::minPerElem(minValue, value.getXYZ());
+      maxValue = SSE::maxPerElem(maxValue, value.getXYZ());
+    }
+    quantized->decodeScale = maxValue - minValue;
+    quantized->decodeOffset = minValue;
+  }
+
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    mesh_utils::write_vertex_element(*quantized, idx, values[idx]);
+  }
+  return quantized;
+}
+} // namespace
+
+Mesh_quantizer_report Mesh_quantizer::quantize(Mesh_data& meshData, const Mesh_quantizer_options& options)
+{
+  Mesh_quantizer_report report;
+  for (auto& [semantic, accessor] : meshData.vertexBufferAccessors) {
+    const auto& element = accessor->attributeElement;
+    const auto format = quantized_format(element, options);
+    if (!format) {
+      continue;
+    }
+
+    report.bytesBefore += mesh_utils::element_size(element.type, element.component) * accessor->count;
+    report.bytesAfter += mesh_utils::element_size(format->type, format->component) * accessor->count;
+    accessor = quantize_accessor(*accessor, *format);
+  }
+  return report;
+}
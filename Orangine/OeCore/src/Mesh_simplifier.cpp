@@ -0,0 +1,529 @@
+#include "OeCore/Mesh_simplifier.h"
+
+#include "OeCore/EngineUtils.h"
+#include "OeCore/IJob_manager.h"
+#include "OeCore/Mesh_data.h"
+#include "OeCore/Mesh_data_component.h"
+#include "OeCore/Mesh_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <tuple>
+
+using namespace oe;
+
+namespace {
+// Planes that hold border vertices on the border are weighted above the surface's, so that borders don't shrink.
+constexpr double g_borderWeight = 10.0;
+// A level that removes less than this fraction of the triangles of the level before it isn't worth drawing.
+constexpr float g_minLodReduction = 0.1f;
+
+// The sum of the squared distances from a point to a set of planes, weighted by area, as a symmetric 4x4 matrix.
+struct Quadric {
+  double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+  double b2 = 0.0, bc = 0.0, bd = 0.0;
+  double c2 = 0.0, cd = 0.0;
+  double d2 = 0.0;
+  double weight = 0.0;
+
+  // normal must be of unit length.
+  static Quadric fromPlane(const SSE::Vector3& normal, const SSE::Vector3& point, double weight)
+  {
+    const double a = normal.getX(), b = normal.getY(), c = normal.getZ();
+    const double d = -(a * point.getX() + b * point.getY() + c * point.getZ());
+
+    Quadric quadric;
+    quadric.a2 = a * a * weight;
+    quadric.ab = a * b * weight;
+    quadric.ac = a * c * weight;
+    quadric.ad = a * d * weight;
+    quadric.b2 = b * b * weight;
+    quadric.bc = b * c * weight;
+    quadric.bd = b * d * weight;
+    quadric.c2 = c * c * weight;
+    quadric.cd = c * d * weight;
+    quadric.d2 = d * d * weight;
+    quadric.weight = weight;
+    return quadric;
+  }
+
+  Quadric& operator+=(const Quadric& other)
+  {
+    a2 += other.a2;
+    ab += other.ab;
+    ac += other.ac;
+    ad += other.ad;
+    b2 += other.b2;
+    bc += other.bc;
+    bd += other.bd;
+    c2 += other.c2;
+    cd += other.cd;
+    d2 += other.d2;
+    weight += other.weight;
+    return *this;
+  }
+
+  double error(const SSE::Vector3& point) const
+  {
+    const double x = point.getX(), y = point.getY(), z = point.getZ();
+    return a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+           2.0 * (ad * x + bd * y + cd * z) + d2;
+  }
+};
+
+uint64_t edge_key(uint32_t from, uint32_t to) { return (static_cast<uint64_t>(from) << 32) | to; }
+
+// The directed edges of a triangle list, between canonical vertices, sorted.
+std::vector<uint64_t> directed_edges(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& canonical)
+{
+  std::vector<uint64_t> edges;
+  edges.reserve(indices.size());
+  for (size_t idx = 0; idx < indices.size(); idx += 3) {
+    for (size_t corner = 0; corner < 3; ++corner) {
+      edges.push_back(edge_key(canonical[indices[idx + corner]], canonical[indices[idx + (corner + 1) % 3]]));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  return edges;
+}
+
+// An edge is on the border if no triangle uses it in the opposite direction.
+bool is_border_edge(const std::vector<uint64_t>& edges, uint32_t from, uint32_t to)
+{
+  return !std::binary_search(edges.begin(), edges.end(), edge_key(to, from));
+}
+
+// Maps each vertex to the first vertex with the same position, so that topology can be followed across seams.
+std::vector<uint32_t> canonical_vertices(const std::vector<SSE::Vector3>& positions)
+{
+  const auto key = [&positions](uint32_t vertex) {
+    return std::make_tuple(positions[vertex].getX(), positions[vertex].getY(), positions[vertex].getZ(), vertex);
+  };
+  std::vector<uint32_t> order(positions.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&key](uint32_t lhs, uint32_t rhs) { return key(lhs) < key(rhs); });
+
+  std::vector<uint32_t> canonical(positions.size());
+  for (size_t idx = 0; idx < order.size(); ++idx) {
+    const auto vertex = order[idx];
+    const auto previous = idx > 0 ? order[idx - 1] : vertex;
+    const auto samePosition = idx > 0 && positions[vertex].getX() == positions[previous].getX() &&
+                              positions[vertex].getY() == positions[previous].getY() &&
+                              positions[vertex].getZ() == positions[previous].getZ();
+    canonical[vertex] = samePosition ? canonical[previous] : vertex;
+  }
+  return canonical;
+}
+
+// Triangles that use each vertex, in compressed sparse row form.
+struct Vertex_triangles {
+  Vertex_triangles(const std::vector<uint32_t>& indices, size_t vertexCount) : offsets(vertexCount + 1, 0)
+  {
+    for (const auto vertex : indices) {
+      ++offsets[vertex + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    triangles.resize(indices.size());
+    auto next = offsets;
+    for (size_t idx = 0; idx < indices.size(); ++idx) {
+      triangles[next[indices[idx]]++] = static_cast<uint32_t>(idx / 3);
+    }
+  }
+
+  const uint32_t* begin(uint32_t vertex) const { return triangles.data() + offsets[vertex]; }
+  const uint32_t* end(uint32_t vertex) const { return triangles.data() + offsets[vertex + 1]; }
+
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> triangles;
+};
+
+struct Collapse {
+  uint32_t from;
+  uint32_t to;
+  float error;
+};
+
+std::vector<uint32_t> remove_degenerate_triangles(const std::vector<uint32_t>& indices)
+{
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+  for (size_t idx = 0; idx < indices.size(); idx += 3) {
+    const auto i0 = indices[idx], i1 = indices[idx + 1], i2 = indices[idx + 2];
+    if (i0 != i1 && i1 != i2 && i2 != i0) {
+      result.insert(result.end(), {i0, i1, i2});
+    }
+  }
+  return result;
+}
+
+bool is_vector3_element(const Vertex_attribute_element& element)
+{
+  return element.type == Element_type::Vector3 || element.type == Element_type::Vector4;
+}
+
+// A copy of meshData that shares its vertex and morph target buffers, drawn with different indices.
+std::shared_ptr<Mesh_data> create_lod_mesh_data(const Mesh_data& meshData, const std::vector<uint32_t>& indices)
+{
+  const auto copy_accessor = [](const Mesh_vertex_buffer_accessor& accessor) {
+    auto copy = std::make_unique<Mesh_vertex_buffer_accessor>(
+        accessor.buffer, accessor.attributeElement, accessor.count, accessor.stride, accessor.offset);
+    copy->decodeScale = accessor.decodeScale;
+    copy->decodeOffset = accessor.decodeOffset;
+    return copy;
+  };
+
+  auto lodMeshData = std::make_shared<Mesh_data>(meshData.vertexLayout);
+  for (const auto& [semantic, accessor] : meshData.vertexBufferAccessors) {
+    lodMeshData->vertexBufferAccessors[semantic] = copy_accessor(*accessor);
+  }
+  for (const auto& morphTarget : meshData.attributeMorphBufferAccessors) {
+    std::vector<std::unique_ptr<Mesh_vertex_buffer_accessor>> lodMorphTarget;
+    for (const auto& accessor : morphTarget) {
+      lodMorphTarget.push_back(copy_accessor(*accessor));
+    }
+    lodMeshData->attributeMorphBufferAccessors.push_back(std::move(lodMorphTarget));
+  }
+  lodMeshData->indexBufferAccessor = mesh_utils::create_index_buffer(indices, meshData.indexBufferAccessor->component);
+  lodMeshData->m_meshIndexType = meshData.m_meshIndexType;
+  return lodMeshData;
+}
+} // namespace
+
+std::vector<uint32_t> Mesh_simplifier::simplify(
+    const std::vector<uint32_t>& indices,
+    const std::vector<SSE::Vector3>& positions,
+    const std::vector<std::vector<SSE::Vector3>>& morphedPositions,
+    size_t targetIndexCount,
+    float maxError,
+    float* resultError)
+{
+  if (indices.size() % 3 != 0) {
+    OE_THROW(std::runtime_error("Expected index buffer to have a count that is a multiple of 3"));
+  }
+  for (const auto& morphed : morphedPositions) {
+    if (morphed.size() != positions.size()) {
+      OE_THROW(std::runtime_error(
+          "Morph target has " + std::to_string(morphed.size()) + " positions, but the mesh has " +
+          std::to_string(positions.size())));
+    }
+  }
+  for (size_t idx = 0; idx < indices.size(); ++idx) {
+    if (indices[idx] >= positions.size()) {
+      OE_THROW(std::runtime_error(
+          "Index " + std::to_string(idx) + " (" + std::to_string(indices[idx]) + ") is out of range of " +
+          std::to_string(positions.size()) + " vertices"));
+    }
+  }
+
+  const auto vertexCount = static_cast<uint32_t>(positions.size());
+  if (resultError) {
+    *resultError = 0.0f;
+  }
+
+  // Work in a space where the mesh's bounds have a radius of 1, so that errors are relative to its size. Each pose (the
+  // base shape, then each morph target) is scaled the same way.
+  auto boundsMin = SSE::Vector3(0.0f), boundsMax = SSE::Vector3(0.0f);
+  if (!positions.empty()) {
+    boundsMin = boundsMax = positions.front();
+  }
+  for (const auto& position : positions) {
+    boundsMin = SSE::minPerElem(boundsMin, position);
+    boundsMax = SSE::maxPerElem(boundsMax, position);
+  }
+  const auto center = (boundsMin + boundsMax) * 0.5f;
+  auto radius = 0.0f;
+  for (const auto& position : positions) {
+    radius = std::max(radius, SSE::length(position - center));
+  }
+  const auto scale = radius > 0.0f ? 1.0f / radius : 1.0f;
+
+  const auto poseCount = morphedPositions.size() + 1;
+  std::vector<std::vector<SSE::Vector3>> poses(poseCount);
+  for (size_t pose = 0; pose < poseCount; ++pose) {
+    const auto& source = pose == 0 ? positions : morphedPositions[pose - 1];
+    poses[pose].resize(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+      poses[pose][vertex] = (source[vertex] - center) * scale;
+    }
+  }
+  const auto& basePose = poses.front();
+
+  auto result = remove_degenerate_triangles(indices);
+
+  // Vertices at a seam share their position with another vertex, and vertices on a non-manifold edge have no
+  // well defined surface around them; neither may move.
+  const auto canonical = canonical_vertices(positions);
+  std::vector<bool> locked(vertexCount, false);
+  {
+    std::vector<uint32_t> positionUses(vertexCount, 0);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+      ++positionUses[canonical[vertex]];
+    }
+    std::vector<bool> lockedPositions(vertexCount, false);
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+      lockedPositions[canonical[vertex]] = positionUses[canonical[vertex]] > 1;
+    }
+    const auto edges = directed_edges(result, canonical);
+    for (size_t idx = 1; idx < edges.size(); ++idx) {
+      if (edges[idx] == edges[idx - 1]) {
+        lockedPositions[static_cast<uint32_t>(edges[idx] >> 32)] = true;
+        lockedPositions[static_cast<uint32_t>(edges[idx])] = true;
+      }
+    }
+    for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+      locked[vertex] = lockedPositions[canonical[vertex]];
+    }
+  }
+
+  // Each vertex starts with the planes of its triangles in every pose, and the planes through its border edges that
+  // are perpendicular to the surface.
+  std::vector<Quadric> quadrics(static_cast<size_t>(vertexCount) * poseCount);
+  {
+    const auto edges = directed_edges(result, canonical);
+    for (size_t idx = 0; idx < result.size(); idx += 3) {
+      for (size_t pose = 0; pose < poseCount; ++pose) {
+        const auto& p0 = poses[pose][result[idx]];
+        const auto& p1 = poses[pose][result[idx + 1]];
+        const auto& p2 = poses[pose][result[idx + 2]];
+        const auto normal = SSE::cross(p1 - p0, p2 - p0);
+        const auto normalLength = SSE::length(normal);
+        if (normalLength == 0.0f) {
+          continue;
+        }
+        const auto unitNormal = normal / normalLength;
+        const auto plane = Quadric::fromPlane(unitNormal, p0, normalLength * 0.5);
+        for (size_t corner = 0; corner < 3; ++corner) {
+          quadrics[result[idx + corner] * poseCount + pose] += plane;
+        }
+
+        for (size_t corner = 0; corner < 3; ++corner) {
+          const auto from = result[idx + corner];
+          const auto to = result[idx + (corner + 1) % 3];
+          if (!is_border_edge(edges, canonical[from], canonical[to])) {
+            continue;
+          }
+          const auto edge = poses[pose][to] - poses[pose][from];
+          const auto edgeNormal = SSE::cross(edge, unitNormal);
+          const auto edgeNormalLength = SSE::length(edgeNormal);
+          if (edgeNormalLength == 0.0f) {
+            continue;
+          }
+          const auto borderPlane = Quadric::fromPlane(
+              edgeNormal / edgeNormalLength, poses[pose][from], SSE::lengthSqr(edge) * g_borderWeight);
+          quadrics[from * poseCount + pose] += borderPlane;
+          quadrics[to * poseCount + pose] += borderPlane;
+        }
+      }
+    }
+  }
+
+  const auto collapseError = [&](uint32_t from, uint32_t to) {
+    auto error = 0.0;
+    auto weight = 0.0;
+    for (size_t pose = 0; pose < poseCount; ++pose) {
+      auto quadric = quadrics[from * poseCount + pose];
+      quadric += quadrics[to * poseCount + pose];
+      error += quadric.error(poses[pose][to]);
+      weight += quadric.weight;
+    }
+    return weight > 0.0 ? static_cast<float>(std::sqrt(std::max(0.0, error / weight))) : 0.0f;
+  };
+
+  std::vector<bool> border(vertexCount);
+  std::vector<bool> touched(vertexCount);
+  std::vector<uint32_t> remap(vertexCount);
+  std::vector<Collapse> bestCollapses(vertexCount);
+
+  // Each pass collapses the cheapest edges that don't share triangles with each other, so the adjacency built at the
+  // start of the pass stays valid for all of them.
+  while (result.size() > targetIndexCount) {
+    const auto edges = directed_edges(result, canonical);
+    const Vertex_triangles vertexTriangles(result, vertexCount);
+
+    std::fill(border.begin(), border.end(), false);
+    for (size_t idx = 0; idx < result.size(); idx += 3) {
+      for (size_t corner = 0; corner < 3; ++corner) {
+        const auto from = result[idx + corner];
+        const auto to = result[idx + (corner + 1) % 3];
+        if (is_border_edge(edges, canonical[from], canonical[to])) {
+          border[from] = border[to] = true;
+        }
+      }
+    }
+
+    // Vertices on the border may only slide along it, onto another border vertex.
+    const auto canCollapse = [&](uint32_t from, uint32_t to) {
+      if (locked[from]) {
+        return false;
+      }
+      if (!border[from]) {
+        return true;
+      }
+      return (border[to] || locked[to]) && (is_border_edge(edges, canonical[from], canonical[to]) ||
+                                            is_border_edge(edges, canonical[to], canonical[from]));
+    };
+
+    std::fill(bestCollapses.begin(), bestCollapses.end(), Collapse{0, 0, std::numeric_limits<float>::max()});
+    for (size_t idx = 0; idx < result.size(); idx += 3) {
+      for (size_t corner = 0; corner < 3; ++corner) {
+        const auto v0 = result[idx + corner];
+        const auto v1 = result[idx + (corner + 1) % 3];
+        for (const auto& [from, to] : {std::make_pair(v0, v1), std::make_pair(v1, v0)}) {
+          if (!canCollapse(from, to)) {
+            continue;
+          }
+          const auto error = collapseError(from, to);
+          if (error < bestCollapses[from].error) {
+            bestCollapses[from] = {from, to, error};
+          }
+        }
+      }
+    }
+
+    std::vector<Collapse> collapses;
+    for (const auto& collapse : bestCollapses) {
+      if (collapse.error <= maxError) {
+        collapses.push_back(collapse);
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+      return std::tie(lhs.error, lhs.from) < std::tie(rhs.error, rhs.from);
+    });
+
+    std::fill(touched.begin(), touched.end(), false);
+    std::iota(remap.begin(), remap.end(), 0);
+    const auto trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+    size_t trianglesRemoved = 0;
+    size_t collapseCount = 0;
+    for (const auto& collapse : collapses) {
+      if (trianglesRemoved >= trianglesToRemove) {
+        break;
+      }
+      if (touched[collapse.from] || touched[collapse.to]) {
+        continue;
+      }
+
+      // Reject collapses that would turn a remaining triangle over.
+      auto flips = false;
+      size_t collapsedTriangles = 0;
+      for (auto triangle = vertexTriangles.begin(collapse.from); triangle != vertexTriangles.end(collapse.from);
+           ++triangle) {
+        const auto* corners = result.data() + *triangle * 3;
+        if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) {
+          ++collapsedTriangles;
+          continue;
+        }
+        const auto& p0 = basePose[corners[0]];
+        const auto& p1 = basePose[corners[1]];
+        const auto& p2 = basePose[corners[2]];
+        const auto moved = [&](uint32_t vertex, const SSE::Vector3& position) {
+          return vertex == collapse.from ? basePose[collapse.to] : position;
+        };
+        const auto normalBefore = SSE::cross(p1 - p0, p2 - p0);
+        const auto normalAfter =
+            SSE::cross(moved(corners[1], p1) - moved(corners[0], p0), moved(corners[2], p2) - moved(corners[0], p0));
+        if (SSE::dot(normalBefore, normalAfter) <= 0.0f) {
+          flips = true;
+          break;
+        }
+      }
+      if (flips) {
+        continue;
+      }
+
+      remap[collapse.from] = collapse.to;
+      for (size_t pose = 0; pose < poseCount; ++pose) {
+        quadrics[collapse.to * poseCount + pose] += quadrics[collapse.from * poseCount + pose];
+      }
+      for (auto triangle = vertexTriangles.begin(collapse.from); triangle != vertexTriangles.end(collapse.from);
+           ++triangle) {
+        for (size_t corner = 0; corner < 3; ++corner) {
+          touched[result[*triangle * 3 + corner]] = true;
+        }
+      }
+      trianglesRemoved += collapsedTriangles;
+      ++collapseCount;
+      if (resultError) {
+        *resultError = std::max(*resultError, collapse.error);
+      }
+    }
+
+    if (collapseCount == 0) {
+      break;
+    }
+    for (auto& vertex : result) {
+      vertex = remap[vertex];
+    }
+    result = remove_degenerate_triangles(result);
+  }
+
+  return result;
+}
+
+std::vector<Mesh_lod> Mesh_simplifier::generateLods(
+    const Mesh_data& meshData,
+    const Mesh_simplifier_options& options)
+{
+  std::vector<Mesh_lod> lods;
+  const auto pos = meshData.vertexBufferAccessors.find({Vertex_attribute::Position, 0});
+  if (!meshData.indexBufferAccessor || meshData.m_meshIndexType != Mesh_index_type::Triangles ||
+      pos == meshData.vertexBufferAccessors.end() || !is_vector3_element(pos->second->attributeElement)) {
+    return lods;
+  }
+
+  const auto positions = mesh_utils::read_vector3_elements(*pos->second);
+  std::vector<std::vector<SSE::Vector3>> morphedPositions;
+  for (const auto& morphTarget : meshData.attributeMorphBufferAccessors) {
+    for (const auto& accessor : morphTarget) {
+      if (accessor->attributeElement.semantic.attribute != Vertex_attribute::Position ||
+          !is_vector3_element(accessor->attributeElement) || accessor->count != positions.size()) {
+        continue;
+      }
+      auto morphed = mesh_utils::read_vector3_elements(*accessor);
+      for (size_t idx = 0; idx < morphed.size(); ++idx) {
+        morphed[idx] += positions[idx];
+      }
+      morphedPositions.push_back(std::move(morphed));
+    }
+  }
+
+  const auto& indexAccessor = *meshData.indexBufferAccessor;
+  std::vector<uint32_t> indices(indexAccessor.count);
+  for (size_t idx = 0; idx < indices.size(); ++idx) {
+    indices[idx] = mesh_utils::convert_index_value(indexAccessor.component, indexAccessor.getIndexed(idx));
+  }
+
+  // Each level is simplified from the one before, so its error is bounded by the sum of the errors so far.
+  auto error = 0.0f;
+  while (lods.size() < options.lodCount && error < options.maxError) {
+    const auto targetIndexCount = static_cast<size_t>(indices.size() / 3 * options.reductionRatio) * 3;
+    auto levelError = 0.0f;
+    auto lodIndices =
+        simplify(indices, positions, morphedPositions, targetIndexCount, options.maxError - error, &levelError);
+    if (lodIndices.empty() || lodIndices.size() > indices.size() * (1.0f - g_minLodReduction)) {
+      break;
+    }
+
+    error += levelError;
+    lods.push_back({create_lod_mesh_data(meshData, lodIndices), error});
+    indices = std::move(lodIndices);
+  }
+  return lods;
+}
+
+std::vector<std::vector<Mesh_lod>> Mesh_simplifier::generateLods(
+    const std::vector<std::shared_ptr<Mesh_data>>& meshes,
+    const Mesh_simplifier_options& options,
+    IJob_manager& jobManager)
+{
+  std::vector<std::vector<Mesh_lod>> lods(meshes.size());
+  jobManager.parallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+    for (auto idx = begin; idx < end; ++idx) {
+      lods[idx] = generateLods(*meshes[idx], options);
+    }
+  });
+  return lods;
+}
@@ -4,7 +4,222 @@
 #include "OeCore/Entity.h"
 #include "OeCore/EngineUtils.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 namespace oe::mesh_utils {
+	namespace {
+		// IEEE 754 binary16, rounding to nearest even. Values too large for it become infinities.
+		uint16_t float_to_half(float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			const auto sign = (bits >> 16) & 0x8000u;
+			const auto exponent = static_cast<int32_t>((bits >> 23) & 0xff);
+			auto mantissa = bits & 0x7fffffu;
+
+			if (exponent == 0xff)
+				return static_cast<uint16_t>(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+
+			const auto halfExponent = exponent - 127 + 15;
+			if (halfExponent >= 0x1f)
+				return static_cast<uint16_t>(sign | 0x7c00u);
+
+			uint32_t shift;
+			uint32_t half;
+			if (halfExponent <= 0) {
+				// Denormal, with the implicit leading bit made explicit.
+				if (halfExponent < -10)
+					return static_cast<uint16_t>(sign);
+				mantissa |= 0x800000u;
+				shift = static_cast<uint32_t>(14 - halfExponent);
+				half = sign | (mantissa >> shift);
+			}
+			else {
+				shift = 13;
+				half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> shift);
+			}
+
+			// A carry out of the mantissa correctly moves on to the next exponent (or infinity).
+			const auto remainder = mantissa & ((1u << shift) - 1);
+			const auto halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (half & 1u)))
+				++half;
+			return static_cast<uint16_t>(half);
+		}
+
+		float half_to_float(uint16_t half)
+		{
+			const auto sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+			const auto exponent = static_cast<uint32_t>(half >> 10) & 0x1fu;
+			auto mantissa = static_cast<uint32_t>(half) & 0x3ffu;
+
+			uint32_t bits;
+			if (exponent == 0x1f) {
+				bits = sign | 0x7f800000u | (mantissa << 13);
+			}
+			else if (exponent != 0) {
+				bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+			}
+			else if (mantissa == 0) {
+				bits = sign;
+			}
+			else {
+				// Denormal; shift it up until it has a leading bit, as floats have the range to store it normalized.
+				uint32_t floatExponent = 127 - 14;
+				while (!(mantissa & 0x400u)) {
+					mantissa <<= 1;
+					--floatExponent;
+				}
+				bits = sign | (floatExponent << 23) | ((mantissa & 0x3ffu) << 13);
+			}
+
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		size_t component_count(Element_type type)
+		{
+			switch (type) {
+			case Element_type::Scalar: return 1;
+			case Element_type::Vector2: return 2;
+			case Element_type::Vector3: return 3;
+			case Element_type::Vector4: return 4;
+			case Element_type::Matrix2: return 4;
+			case Element_type::Matrix3: return 9;
+			case Element_type::Matrix4: return 16;
+			default:
+				OE_THROW(std::runtime_error("Unsupported element type: " + elementTypeToString(type)));
+			}
+		}
+
+		bool is_signed(Element_component component)
+		{
+			return component == Element_component::Signed_byte || component == Element_component::Signed_short ||
+				component == Element_component::Signed_int;
+		}
+
+		// The value of the largest integer of a component, which normalizes to 1.
+		double normalized_range(Element_component component)
+		{
+			switch (component) {
+			case Element_component::Signed_byte: return std::numeric_limits<int8_t>::max();
+			case Element_component::Unsigned_byte: return std::numeric_limits<uint8_t>::max();
+			case Element_component::Signed_short: return std::numeric_limits<int16_t>::max();
+			case Element_component::Unsigned_short: return std::numeric_limits<uint16_t>::max();
+			case Element_component::Signed_int: return std::numeric_limits<int32_t>::max();
+			case Element_component::Unsigned_int: return std::numeric_limits<uint32_t>::max();
+			default:
+				OE_THROW(std::runtime_error("Cannot normalize " + elementComponentToString(component) + " components"));
+			}
+		}
+
+		template <class TComponent>
+		float read_as(const uint8_t* data)
+		{
+			TComponent value;
+			std::memcpy(&value, data, sizeof(value));
+			return static_cast<float>(value);
+		}
+
+		template <class TComponent>
+		void write_integer(uint8_t* data, double value)
+		{
+			value = std::round(value);
+			value = std::min(std::max(value, static_cast<double>(std::numeric_limits<TComponent>::lowest())),
+				static_cast<double>(std::numeric_limits<TComponent>::max()));
+			const auto component = static_cast<TComponent>(value);
+			std::memcpy(data, &component, sizeof(component));
+		}
+
+		float read_component(Element_component component, const uint8_t* element, size_t idx)
+		{
+			switch (component) {
+			case Element_component::Signed_byte: return read_as<int8_t>(element + idx);
+			case Element_component::Unsigned_byte: return read_as<uint8_t>(element + idx);
+			case Element_component::Signed_short: return read_as<int16_t>(element + idx * 2);
+			case Element_component::Unsigned_short: return read_as<uint16_t>(element + idx * 2);
+			case Element_component::Signed_int: return read_as<int32_t>(element + idx * 4);
+			case Element_component::Unsigned_int: return read_as<uint32_t>(element + idx * 4);
+			case Element_component::Float: return read_as<float>(element + idx * 4);
+			case Element_component::Half_float: {
+				uint16_t half;
+				std::memcpy(&half, element + idx * 2, sizeof(half));
+				return half_to_float(half);
+			}
+			default:
+				OE_THROW(std::runtime_error("Unsupported element component: " + elementComponentToString(component)));
+			}
+		}
+
+		void write_component(Element_component component, uint8_t* element, size_t idx, double value)
+		{
+			switch (component) {
+			case Element_component::Signed_byte: write_integer<int8_t>(element + idx, value); break;
+			case Element_component::Unsigned_byte: write_integer<uint8_t>(element + idx, value); break;
+			case Element_component::Signed_short: write_integer<int16_t>(element + idx * 2, value); break;
+			case Element_component::Unsigned_short: write_integer<uint16_t>(element + idx * 2, value); break;
+			case Element_component::Signed_int: write_integer<int32_t>(element + idx * 4, value); break;
+			case Element_component::Unsigned_int: write_integer<uint32_t>(element + idx * 4, value); break;
+			case Element_component::Float: {
+				const auto floatValue = static_cast<float>(value);
+				std::memcpy(element + idx * 4, &floatValue, sizeof(floatValue));
+				break;
+			}
+			case Element_component::Half_float: {
+				const auto half = float_to_half(static_cast<float>(value));
+				std::memcpy(element + idx * 2, &half, sizeof(half));
+				break;
+			}
+			default:
+				OE_THROW(std::runtime_error("Unsupported element component: " + elementComponentToString(component)));
+			}
+		}
+
+		// Folds the lower half of the octahedron back out of the corners of the square.
+		SSE::Vector3 decode_octahedral(float x, float y)
+		{
+			const auto z = 1.0f - std::abs(x) - std::abs(y);
+			const auto fold = std::max(-z, 0.0f);
+			x += x >= 0.0f ? -fold : fold;
+			y += y >= 0.0f ? -fold : fold;
+			return SSE::normalize(SSE::Vector3(x, y, z));
+		}
+
+		// Projects a direction onto the octahedron |x| + |y| + |z| = 1, then unfolds its lower half into the corners of
+		// the square [-1, 1]^2 (Cigolle et al, "A Survey of Efficient Representations for Independent Unit Vectors").
+		std::array<float, 2> encode_octahedral(const SSE::Vector3& direction)
+		{
+			const auto l1Norm = std::abs(direction.getX()) + std::abs(direction.getY()) + std::abs(direction.getZ());
+			if (l1Norm == 0.0f)
+				return { 0.0f, 0.0f };
+
+			const auto x = direction.getX() / l1Norm;
+			const auto y = direction.getY() / l1Norm;
+			if (direction.getZ() >= 0.0f)
+				return { x, y };
+			return {
+				(1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f)
+			};
+		}
+
+		size_t checked_component_count(const Vertex_attribute_element& element)
+		{
+			const auto componentCount = component_count(element.type);
+			if (componentCount > 4)
+				OE_THROW(std::runtime_error("Cannot decode " + elementTypeToString(element.type) + " vertex elements"));
+			if ((element.encoding == Element_encoding::Octahedral || element.encoding == Element_encoding::Octahedral_signed) &&
+				(componentCount != 2 || !is_signed(element.component)))
+				OE_THROW(std::runtime_error("Octahedral vertex elements must be signed Vector2s, not " +
+					elementTypeToString(element.type) + "/" + elementComponentToString(element.component)));
+			return componentCount;
+		}
+	}
 
 	std::shared_ptr<Mesh_buffer> create_buffer(UINT elementSize, UINT elementCount, const std::vector<uint8_t>& sourceData, UINT sourceStride, UINT sourceOffset)
 	{
@@ -78,6 +293,33 @@ namespace oe::mesh_utils {
             0);
 	}
 
+	std::unique_ptr<Mesh_index_buffer_accessor> create_index_buffer(const std::vector<uint32_t>& indices, Element_component component)
+	{
+		const auto indexSize = element_size(Element_type::Scalar, component);
+		auto meshBuffer = std::make_shared<Mesh_buffer>(indices.size() * indexSize);
+		for (size_t idx = 0; idx < indices.size(); ++idx) {
+			auto *dest = meshBuffer->data + idx * indexSize;
+			switch (indexSize) {
+			case 1: {
+				const auto value = static_cast<uint8_t>(indices[idx]);
+				std::memcpy(dest, &value, sizeof(value));
+				break;
+			}
+			case 2: {
+				const auto value = static_cast<uint16_t>(indices[idx]);
+				std::memcpy(dest, &value, sizeof(value));
+				break;
+			}
+			default:
+				std::memcpy(dest, &indices[idx], sizeof(uint32_t));
+				break;
+			}
+		}
+
+		return std::make_unique<Mesh_index_buffer_accessor>(
+			meshBuffer, component, static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(indexSize), 0);
+	}
+
     const std::map<Element_type, std::map<Element_component, DXGI_FORMAT>> g_elementTypeComponent_dxgiFormat = {
         { Element_type::Scalar, {
             { Element_component::Unsigned_short, DXGI_FORMAT_R16_UINT },
@@ -85,6 +327,7 @@ namespace oe::mesh_utils {
             { Element_component::Unsigned_int, DXGI_FORMAT_R32_UINT },
             { Element_component::Signed_int, DXGI_FORMAT_R32_SINT },
             { Element_component::Float, DXGI_FORMAT_R32_FLOAT },
+            { Element_component::Half_float, DXGI_FORMAT_R16_FLOAT },
             }
         },
         { Element_type::Vector2, {
@@ -93,6 +336,7 @@ namespace oe::mesh_utils {
             { Element_component::Unsigned_int, DXGI_FORMAT_R32G32_UINT },
             { Element_component::Signed_int, DXGI_FORMAT_R32G32_SINT },
             { Element_component::Float, DXGI_FORMAT_R32G32_FLOAT },
+            { Element_component::Half_float, DXGI_FORMAT_R16G16_FLOAT },
             }
         },
         { Element_type::Vector3, {
@@ -107,6 +351,32 @@ namespace oe::mesh_utils {
             { Element_component::Unsigned_int, DXGI_FORMAT_R32G32B32A32_UINT },
             { Element_component::Signed_int, DXGI_FORMAT_R32G32B32A32_SINT },
             { Element_component::Float, DXGI_FORMAT_R32G32B32A32_FLOAT },
+            { Element_component::Half_float, DXGI_FORMAT_R16G16B16A16_FLOAT },
+            }
+        }
+    };
+
+    // Formats that the input assembler normalizes as it reads them.
+    const std::map<Element_type, std::map<Element_component, DXGI_FORMAT>> g_elementTypeComponent_dxgiNormalizedFormat = {
+        { Element_type::Scalar, {
+            { Element_component::Unsigned_byte, DXGI_FORMAT_R8_UNORM },
+            { Element_component::Signed_byte, DXGI_FORMAT_R8_SNORM },
+            { Element_component::Unsigned_short, DXGI_FORMAT_R16_UNORM },
+            { Element_component::Signed_short, DXGI_FORMAT_R16_SNORM },
+            }
+        },
+        { Element_type::Vector2, {
+            { Element_component::Unsigned_byte, DXGI_FORMAT_R8G8_UNORM },
+            { Element_component::Signed_byte, DXGI_FORMAT_R8G8_SNORM },
+            { Element_component::Unsigned_short, DXGI_FORMAT_R16G16_UNORM },
+            { Element_component::Signed_short, DXGI_FORMAT_R16G16_SNORM },
+            }
+        },
+        { Element_type::Vector4, {
+            { Element_component::Unsigned_byte, DXGI_FORMAT_R8G8B8A8_UNORM },
+            { Element_component::Signed_byte, DXGI_FORMAT_R8G8B8A8_SNORM },
+            { Element_component::Unsigned_short, DXGI_FORMAT_R16G16B16A16_UNORM },
+            { Element_component::Signed_short, DXGI_FORMAT_R16G16B16A16_SNORM },
             }
         }
     };
@@ -125,6 +395,157 @@ namespace oe::mesh_utils {
         return componentPos->second;
     }
 
+    DXGI_FORMAT getDxgiFormat(const Vertex_attribute_element& element)
+    {
+        if (element.encoding == Element_encoding::None)
+            return getDxgiFormat(element.type, element.component);
+
+        const auto typePos = g_elementTypeComponent_dxgiNormalizedFormat.find(element.type);
+        if (typePos != g_elementTypeComponent_dxgiNormalizedFormat.end()) {
+            const auto componentPos = typePos->second.find(element.component);
+            if (componentPos != typePos->second.end())
+                return componentPos->second;
+        }
+        OE_THROW(std::runtime_error("Cannot convert normalized " + elementTypeToString(element.type) + "/" +
+            elementComponentToString(element.component) + " to DXGI"));
+    }
+
+    size_t element_size(Element_type type, Element_component component)
+    {
+        const auto componentCount = component_count(type);
+
+        switch (component) {
+        case Element_component::Signed_byte:
+        case Element_component::Unsigned_byte:
+            return componentCount;
+        case Element_component::Signed_short:
+        case Element_component::Unsigned_short:
+        case Element_component::Half_float:
+            return componentCount * 2;
+        case Element_component::Signed_int:
+        case Element_component::Unsigned_int:
+        case Element_component::Float:
+            return componentCount * 4;
+        default:
+            OE_THROW(std::runtime_error("Unsupported element component: " + elementComponentToString(component)));
+        }
+    }
+
+	size_t decoded_component_count(const Vertex_attribute_element& element)
+	{
+		switch (element.encoding) {
+		case Element_encoding::Octahedral: return 3;
+		case Element_encoding::Octahedral_signed: return 4;
+		default: return component_count(element.type);
+		}
+	}
+
+	SSE::Vector4 read_vertex_element(const Mesh_vertex_buffer_accessor& accessor, size_t idx)
+	{
+		const auto& element = accessor.attributeElement;
+		const auto componentCount = checked_component_count(element);
+		const auto* data = accessor.getIndexed(idx);
+
+		float values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t component = 0; component < componentCount; ++component)
+			values[component] = read_component(element.component, data, component);
+
+		switch (element.encoding) {
+		case Element_encoding::None:
+			return { values[0], values[1], values[2], values[3] };
+
+		case Element_encoding::Normalized: {
+			// The most negative signed integer is clamped, so that zero is exact and the range is symmetric.
+			const auto scale = static_cast<float>(1.0 / normalized_range(element.component));
+			const auto minValue = is_signed(element.component) ? -1.0f : 0.0f;
+			for (auto& value : values)
+				value = std::max(value * scale, minValue);
+			const auto decoded = SSE::mulPerElem(SSE::Vector3(values[0], values[1], values[2]), accessor.decodeScale) +
+				accessor.decodeOffset;
+			return { decoded, componentCount == 4 ? values[3] : 0.0f };
+		}
+
+		case Element_encoding::Octahedral:
+		case Element_encoding::Octahedral_signed: {
+			const auto scale = static_cast<float>(1.0 / normalized_range(element.component));
+			const auto direction = decode_octahedral(std::max(values[0] * scale, -1.0f), std::max(values[1] * scale, -1.0f));
+			if (element.encoding == Element_encoding::Octahedral)
+				return { direction, 0.0f };
+			return { direction, (static_cast<int64_t>(values[1]) & 1) ? -1.0f : 1.0f };
+		}
+
+		default:
+			OE_THROW(std::runtime_error("Unsupported element encoding: " + elementEncodingToString(element.encoding)));
+		}
+	}
+
+	void write_vertex_element(Mesh_vertex_buffer_accessor& accessor, size_t idx, const SSE::Vector4& value)
+	{
+		const auto& element = accessor.attributeElement;
+		const auto componentCount = checked_component_count(element);
+		// getIndexed bounds checks; the accessor's buffer itself is writable.
+		auto* data = const_cast<uint8_t*>(accessor.getIndexed(idx));
+
+		double values[4] = { value.getX(), value.getY(), value.getZ(), value.getW() };
+		switch (element.encoding) {
+		case Element_encoding::None:
+			break;
+
+		case Element_encoding::Normalized: {
+			const auto range = normalized_range(element.component);
+			const auto minValue = is_signed(element.component) ? -1.0 : 0.0;
+			const double scales[3] = { accessor.decodeScale.getX(), accessor.decodeScale.getY(), accessor.decodeScale.getZ() };
+			const double offsets[3] = { accessor.decodeOffset.getX(), accessor.decodeOffset.getY(), accessor.decodeOffset.getZ() };
+			for (size_t component = 0; component < componentCount; ++component) {
+				auto& encoded = values[component];
+				if (component < 3)
+					encoded = scales[component] != 0.0 ? (encoded - offsets[component]) / scales[component] : 0.0;
+				encoded = std::min(std::max(encoded, minValue), 1.0) * range;
+			}
+			break;
+		}
+
+		case Element_encoding::Octahedral:
+		case Element_encoding::Octahedral_signed: {
+			const auto range = normalized_range(element.component);
+			const auto encoded = encode_octahedral(value.getXYZ());
+			values[0] = std::round(std::min(std::max(static_cast<double>(encoded[0]), -1.0), 1.0) * range);
+			values[1] = std::round(std::min(std::max(static_cast<double>(encoded[1]), -1.0), 1.0) * range);
+			if (element.encoding == Element_encoding::Octahedral_signed) {
+				// Costs the lowest bit of precision of y; the clamp on decode keeps -range - 1 in range.
+				const auto y = (static_cast<int64_t>(values[1]) & ~int64_t(1)) | (value.getW() < 0.0f ? 1 : 0);
+				values[1] = static_cast<double>(y);
+			}
+			break;
+		}
+
+		default:
+			OE_THROW(std::runtime_error("Unsupported element encoding: " + elementEncodingToString(element.encoding)));
+		}
+
+		for (size_t component = 0; component < componentCount; ++component)
+			write_component(element.component, data, component, values[component]);
+	}
+
+	std::vector<SSE::Vector3> read_vector3_elements(const Mesh_vertex_buffer_accessor& accessor)
+	{
+		const auto& element = accessor.attributeElement;
+		std::vector<SSE::Vector3> values(accessor.count);
+		if (element.component == Element_component::Float && element.encoding == Element_encoding::None &&
+			(element.type == Element_type::Vector3 || element.type == Element_type::Vector4)) {
+			for (size_t idx = 0; idx < values.size(); ++idx) {
+				float value[3];
+				std::memcpy(value, accessor.getIndexed(idx), sizeof(value));
+				values[idx] = SSE::Vector3(value[0], value[1], value[2]);
+			}
+			return values;
+		}
+
+		for (size_t idx = 0; idx < values.size(); ++idx)
+			values[idx] = read_vertex_element(accessor, idx).getXYZ();
+		return values;
+	}
+
     oe::BoundingOrientedBox aabbForEntities(const Entity_filter& entities,
         const SSE::Quat& orientation,
         std::function<bool(const Entity&)> predicate)
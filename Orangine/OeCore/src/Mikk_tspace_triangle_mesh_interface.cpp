@@ -79,10 +79,24 @@ int Mikk_tspace_triangle_mesh_interface::getNumVerticesOfFace(const SMikkTSpaceC
   return 3;
 }
 
+// Quantized vertex elements are decoded (or encoded) through mesh_utils; floats are accessed directly.
+bool is_float_element(const Mesh_vertex_buffer_accessor* const vertexAccessor)
+{
+  return vertexAccessor->attributeElement.component == Element_component::Float &&
+         vertexAccessor->attributeElement.encoding == Element_encoding::None;
+}
+
 void readVector3Accessor(float* fvPosOut, const Mesh_vertex_buffer_accessor* const vertexAccessor,
                          const uint32_t indexValue)
 {
   assert(indexValue <= vertexAccessor->count);
+  if (!is_float_element(vertexAccessor)) {
+    const auto value = mesh_utils::read_vertex_element(*vertexAccessor, indexValue);
+    fvPosOut[0] = value.getX();
+    fvPosOut[1] = value.getY();
+    fvPosOut[2] = value.getZ();
+    return;
+  }
   assert(sizeof(Float3) <= vertexAccessor->stride);
   const auto* pos =
       vertexAccessor->buffer->data + vertexAccessor->offset + indexValue * vertexAccessor->stride;
@@ -97,6 +111,10 @@ void writeVector4Accessor(SSE::Vector4 src, Mesh_vertex_buffer_accessor* vertexA
                           const uint32_t indexValue)
 {
   assert(indexValue <= vertexAccessor->count);
+  if (!is_float_element(vertexAccessor)) {
+    mesh_utils::write_vertex_element(*vertexAccessor, indexValue, src);
+    return;
+  }
   assert(sizeof(Float4) <= vertexAccessor->stride);
   auto* pos =
       vertexAccessor->buffer->data + vertexAccessor->offset + indexValue * vertexAccessor->stride;
@@ -109,6 +127,12 @@ void readVector2Accessor(float* fvPosOut, const Mesh_vertex_buffer_accessor* con
                          const uint32_t indexValue)
 {
   assert(indexValue <= vertexAccessor->count);
+  if (!is_float_element(vertexAccessor)) {
+    const auto value = mesh_utils::read_vertex_element(*vertexAccessor, indexValue);
+    fvPosOut[0] = value.getX();
+    fvPosOut[1] = value.getY();
+    return;
+  }
   assert(sizeof(Float2) <= vertexAccessor->stride);
   const auto* pos =
       vertexAccessor->buffer->data + vertexAccessor->offset + indexValue * vertexAccessor->stride;
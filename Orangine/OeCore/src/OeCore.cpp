@@ -15,8 +15,9 @@ void create(Manager_instances& managerInstances, IDevice_resources& deviceResour
   managerInstances.entityRepository = entityRepository.get();
 
   auto timeStepManager = create_manager_instance<ITime_step_manager>();
+  auto jobManager = create_manager_instance<IJob_manager>();
 
-  auto sceneGraphManagerImpl = std::make_unique<internal::Scene_graph_manager>(entityRepository);
+  auto sceneGraphManagerImpl = std::make_unique<internal::Scene_graph_manager>(entityRepository, *jobManager.instance);
   managerInstances.componentFactory = sceneGraphManagerImpl.get();
 
   auto sceneGraphManager = Manager_instance<IScene_graph_manager>(std::move(sceneGraphManagerImpl));
@@ -32,17 +33,20 @@ void create(Manager_instances& managerInstances, IDevice_resources& deviceResour
   auto shadowmapManager = create_manager_instance<IShadowmap_manager>(*textureManager.instance);
   auto inputManager = create_manager_instance<IInput_manager>(*userInterfaceManager.instance);
 
-  auto animationManager = create_manager_instance<IAnimation_manager>(*sceneGraphManager.instance, *timeStepManager.instance);
+  auto animationManager = create_manager_instance<IAnimation_manager>(
+          *sceneGraphManager.instance, *timeStepManager.instance, *jobManager.instance);
   auto entityRenderManager = create_manager_instance<IEntity_render_manager>(
-          *textureManager.instance, *materialManager.instance, *lightingManager.instance);
+          *textureManager.instance, *materialManager.instance, *lightingManager.instance, *jobManager.instance);
 
   auto devToolsManager = create_manager_instance<IDev_tools_manager>(
-          *sceneGraphManager.instance, *entityRenderManager.instance, *materialManager.instance);
+          *sceneGraphManager.instance, *entityRenderManager.instance, *materialManager.instance,
+          *animationManager.instance);
 
   // Pulls everything together and draws pixels
   auto renderStepManager = create_manager_instance<IRender_step_manager>(*sceneGraphManager.instance, *devToolsManager.instance,
                                                                          *textureManager.instance, *shadowmapManager.instance,
-                                                                         *entityRenderManager.instance, *lightingManager.instance);
+                                                                         *entityRenderManager.instance, *lightingManager.instance,
+                                                                         *animationManager.instance);
 
   std::get<Manager_instance<IAnimation_manager>>(managerInstances.managers) = std::move(animationManager);
   std::get<Manager_instance<IAsset_manager>>(managerInstances.managers) = std::move(assetManager);
@@ -50,6 +54,7 @@ void create(Manager_instances& managerInstances, IDevice_resources& deviceResour
   std::get<Manager_instance<IDev_tools_manager>>(managerInstances.managers) = std::move(devToolsManager);
   std::get<Manager_instance<IEntity_render_manager>>(managerInstances.managers) = std::move(entityRenderManager);
   std::get<Manager_instance<IInput_manager>>(managerInstances.managers) = std::move(inputManager);
+  std::get<Manager_instance<IJob_manager>>(managerInstances.managers) = std::move(jobManager);
   std::get<Manager_instance<ILighting_manager>>(managerInstances.managers) = std::move(lightingManager);
   std::get<Manager_instance<IMaterial_manager>>(managerInstances.managers) = std::move(materialManager);
   std::get<Manager_instance<IRender_step_manager>>(managerInstances.managers) = std::move(renderStepManager);
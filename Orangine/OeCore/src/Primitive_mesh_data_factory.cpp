@@ -1,12 +1,18 @@
 #include "OeCore/Primitive_mesh_data_factory.h"
 #include "OeCore/Mesh_data.h"
+#include "OeCore/Mesh_utils.h"
 #include "OeCore/Mikk_tspace_triangle_mesh_interface.h"
 #include "OeCore/Collision.h"
 #include "OeCore/Color.h"
 #include "OeCore/Math_constants.h"
+#include "OeCore/IJob_manager.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
+#include <functional>
 
 #include "D3D12/D3D12_vendor.h"
 #include <GeometricPrimitive.h>
@@ -323,10 +329,81 @@ std::shared_ptr<Mesh_data> Primitive_mesh_data_factory::createAxisWidgetLines()
     return md;
 }
 
+namespace {
+// Triangles or vertices per job when generating normals; below this, splitting costs more than it saves.
+constexpr size_t g_normalGenerationMinGrainSize = 4096;
+
+void for_each_range(IJob_manager* jobManager, size_t count, const std::function<void(size_t, size_t)>& fn)
+{
+	if (!jobManager || count <= g_normalGenerationMinGrainSize) {
+		fn(0, count);
+		return;
+	}
+	const auto grainSize = std::max(g_normalGenerationMinGrainSize, count / (jobManager->workerCount() * 4));
+	jobManager->parallelFor(count, grainSize, fn);
+}
+
+// Throws if the last element of the accessor would read past the end of its buffer.
+void check_accessor_range(const Mesh_buffer_accessor& accessor, size_t elementSize, const std::string& name)
+{
+	if (accessor.count == 0)
+		return;
+
+	const auto endPos = accessor.offset + static_cast<size_t>(accessor.count - 1) * accessor.stride + elementSize;
+	if (accessor.stride < elementSize || endPos > accessor.buffer->dataSize) {
+		OE_THROW(std::runtime_error(name + " accessor reads past the end of its buffer"));
+	}
+}
+
+template <class TIndex>
+void read_indices(const Mesh_index_buffer_accessor& accessor, size_t begin, size_t end, uint32_t vertexCount, uint32_t* out)
+{
+	const auto* data = accessor.buffer->data + accessor.offset;
+	for (auto idx = begin; idx < end; ++idx) {
+		TIndex value;
+		std::memcpy(&value, data + idx * accessor.stride, sizeof(TIndex));
+		if (value >= vertexCount) {
+			OE_THROW(std::logic_error("IndexBuffer index " + std::to_string(idx) + " (" + std::to_string(value) +
+				") out of range of given vertexBuffer (numVertices=" + std::to_string(vertexCount) + ")"));
+		}
+		out[idx] = value;
+	}
+}
+
+bool is_float_element(const Vertex_attribute_element& element)
+{
+	return element.component == Element_component::Float && element.encoding == Element_encoding::None;
+}
+
+void read_vector3_elements(const Mesh_vertex_buffer_accessor& accessor, size_t begin, size_t end, SSE::Vector3* out)
+{
+	if (!is_float_element(accessor.attributeElement)) {
+		for (auto idx = begin; idx < end; ++idx)
+			out[idx] = mesh_utils::read_vertex_element(accessor, idx).getXYZ();
+		return;
+	}
+
+	const auto* data = accessor.buffer->data + accessor.offset;
+	for (auto idx = begin; idx < end; ++idx) {
+		float value[3];
+		std::memcpy(value, data + idx * accessor.stride, sizeof(value));
+		out[idx] = SSE::Vector3(value[0], value[1], value[2]);
+	}
+}
+
+// Elements that hold, or decode to, at least three components.
+bool is_vector3_element(const Vertex_attribute_element& element)
+{
+	return element.type == Element_type::Vector3 || element.type == Element_type::Vector4 ||
+		element.encoding == Element_encoding::Octahedral || element.encoding == Element_encoding::Octahedral_signed;
+}
+} // namespace
+
 void Primitive_mesh_data_factory::generateNormals(
 	const Mesh_index_buffer_accessor &indexBufferAccessor, 
 	const Mesh_vertex_buffer_accessor &positionBufferAccessor,
-	Mesh_vertex_buffer_accessor &normalBufferAccessor)
+	Mesh_vertex_buffer_accessor &normalBufferAccessor,
+	IJob_manager* jobManager)
 {
 	if (indexBufferAccessor.count % 3 != 0)
 		OE_THROW(std::logic_error("Expected index buffer to have a count that is a multiple of 3."));
@@ -339,65 +416,117 @@ void Primitive_mesh_data_factory::generateNormals(
 
 	if (normalBufferAccessor.count != positionBufferAccessor.count)
 		OE_THROW(std::runtime_error("Given position and normal buffer accessors must have the same count"));
-	
-	const auto indexBufferStart = indexBufferAccessor.buffer->data + indexBufferAccessor.offset;
-	const auto positionBufferStart = positionBufferAccessor.buffer->data + positionBufferAccessor.offset;
-	const auto normalBufferStart = normalBufferAccessor.buffer->data + normalBufferAccessor.offset;
-
-	assert(normalBufferAccessor.stride >= sizeof(XMFLOAT3));
-	const auto normalBufferEnd = normalBufferStart + normalBufferAccessor.count * normalBufferAccessor.stride + sizeof(XMFLOAT3);
-		
-	// Iterate over each triangle, creating a flat normal.
-	if (indexBufferAccessor.component == Element_component::Unsigned_short)
-	{		
-		assert(sizeof(uint16_t) <= indexBufferAccessor.stride);
-		const uint16_t numVertices = positionBufferAccessor.count;
-
-		for (uint32_t idx = 0; idx < indexBufferAccessor.count;)
-		{
-			const auto& i0 = *reinterpret_cast<const uint16_t*>(indexBufferStart + idx * indexBufferAccessor.stride);
-			const auto& i1 = *reinterpret_cast<const uint16_t*>(indexBufferStart + ++idx * indexBufferAccessor.stride);
-			const auto& i2 = *reinterpret_cast<const uint16_t*>(indexBufferStart + ++idx * indexBufferAccessor.stride);
-			++idx;
-
-			if (i0 > numVertices || i1 > numVertices || i2 > numVertices) {
-				OE_THROW(std::logic_error("IndexBuffer index near " + std::to_string(idx - 3) +
-					" out of range of given vertexBuffer (numVertices=" + std::to_string(numVertices) + ")"));
+
+	if (!is_vector3_element(positionBufferAccessor.attributeElement) || !is_vector3_element(normalBufferAccessor.attributeElement))
+		OE_THROW(std::runtime_error("Given position and normal buffer accessors must have Vector3 elements"));
+
+	const auto vertexCount = positionBufferAccessor.count;
+	const size_t indexCount = indexBufferAccessor.count;
+	const auto& positionElement = positionBufferAccessor.attributeElement;
+	const auto& normalElement = normalBufferAccessor.attributeElement;
+	check_accessor_range(positionBufferAccessor, mesh_utils::element_size(positionElement.type, positionElement.component), "Position");
+	check_accessor_range(normalBufferAccessor, mesh_utils::element_size(normalElement.type, normalElement.component), "Normal");
+
+	// Widen the indices, checking them as we go.
+	std::vector<uint32_t> indices(indexCount);
+	std::function<void(size_t, size_t)> readIndices;
+	size_t indexSize = 0;
+	switch (indexBufferAccessor.component) {
+	case Element_component::Unsigned_byte:
+		readIndices = [&](size_t begin, size_t end) { read_indices<uint8_t>(indexBufferAccessor, begin, end, vertexCount, indices.data()); };
+		indexSize = sizeof(uint8_t);
+		break;
+	case Element_component::Unsigned_short:
+		readIndices = [&](size_t begin, size_t end) { read_indices<uint16_t>(indexBufferAccessor, begin, end, vertexCount, indices.data()); };
+		indexSize = sizeof(uint16_t);
+		break;
+	case Element_component::Unsigned_int:
+		readIndices = [&](size_t begin, size_t end) { read_indices<uint32_t>(indexBufferAccessor, begin, end, vertexCount, indices.data()); };
+		indexSize = sizeof(uint32_t);
+		break;
+	default:
+		OE_THROW(std::runtime_error("Unsupported index component: " + elementComponentToString(indexBufferAccessor.component)));
+	}
+	check_accessor_range(indexBufferAccessor, indexSize, "Index");
+	for_each_range(jobManager, indexCount, readIndices);
+
+	std::vector<SSE::Vector3> positions(vertexCount);
+	for_each_range(jobManager, vertexCount, [&](size_t begin, size_t end) {
+		read_vector3_elements(positionBufferAccessor, begin, end, positions.data());
+	});
+
+	// Weighted normal that each triangle contributes to each of its corners. The unnormalized cross product of two
+	// edges has a length of twice the triangle's area, which gives the area weighting; scaling it by the interior angle
+	// at the corner gives the angle weighting. Triangles are independent, so this runs in parallel over index ranges.
+	std::vector<SSE::Vector3> cornerNormals(indexCount);
+	for_each_range(jobManager, indexCount / 3, [&](size_t begin, size_t end) {
+		for (auto triangleIdx = begin; triangleIdx < end; ++triangleIdx) {
+			const auto cornerIdx = triangleIdx * 3;
+			const auto& p0 = positions[indices[cornerIdx]];
+			const auto& p1 = positions[indices[cornerIdx + 1]];
+			const auto& p2 = positions[indices[cornerIdx + 2]];
+			const auto e01 = p1 - p0;
+			const auto e02 = p2 - p0;
+			const auto e12 = p2 - p1;
+
+			// Counter clockwise winding order
+			const auto faceNormal = SSE::cross(e01, e02);
+			const auto faceLength = SSE::length(faceNormal);
+			if (faceLength == 0.0f) {
+				cornerNormals[cornerIdx] = cornerNormals[cornerIdx + 1] = cornerNormals[cornerIdx + 2] = SSE::Vector3(0.0f);
+				continue;
 			}
 
-			const auto& p0 = LoadVector3(*reinterpret_cast<const XMFLOAT3*>(positionBufferStart + i0 * positionBufferAccessor.stride));
-			const auto& p1 = LoadVector3(*reinterpret_cast<const XMFLOAT3*>(positionBufferStart + i1 * positionBufferAccessor.stride));
-			const auto& p2 = LoadVector3(*reinterpret_cast<const XMFLOAT3*>(positionBufferStart + i2 * positionBufferAccessor.stride));
-
-			auto normalBufferPos = normalBufferStart + i0 * normalBufferAccessor.stride;
-			assert(normalBufferPos >= normalBufferStart && normalBufferPos < normalBufferEnd);
-			auto n0 = LoadVector3(*reinterpret_cast<XMFLOAT3*>(normalBufferPos));
-			normalBufferPos = normalBufferStart + i1 * normalBufferAccessor.stride;
-			assert(normalBufferPos >= normalBufferStart && normalBufferPos < normalBufferEnd);
-			auto n1 = LoadVector3(*reinterpret_cast<XMFLOAT3*>(normalBufferPos));
-			normalBufferPos = normalBufferStart + i2 * normalBufferAccessor.stride;
-			assert(normalBufferPos >= normalBufferStart && normalBufferPos < normalBufferEnd);
-			auto n2 = LoadVector3(*reinterpret_cast<XMFLOAT3*>(normalBufferPos));
-			
-			// Create two vectors from which we calculate the normal
-			const auto v0 = p1 - p0;
-			const auto v1 = p2 - p0;
-			
-			// Calculate flat normal. (Counter clockwise winding order)
-			n0 = SSE::normalize(SSE::cross(v0, v1));
-			n1 = n2 = n0;
-
-			/*
-			 * Test values:
-			 * p0 = 0, 0, 0
-			 * p1 = 1, 0, 0
-			 * p2 = 0, 0, -1
-			 * v0 = 1, 0, 0
-			 * v1 = 0, 0, -1
-			 * n  = 0, 1, 0
-			 */
+			// Every pair of edges of the triangle has a cross product of the same length, so only the dot products
+			// differ between corners.
+			const auto angle0 = std::atan2(faceLength, SSE::dot(e01, e02));
+			const auto angle1 = std::atan2(faceLength, -SSE::dot(e01, e12));
+			const auto angle2 = std::max(0.0f, math::pi - angle0 - angle1);
+			cornerNormals[cornerIdx] = faceNormal * angle0;
+			cornerNormals[cornerIdx + 1] = faceNormal * angle1;
+			cornerNormals[cornerIdx + 2] = faceNormal * angle2;
 		}
+	});
+
+	// Group corners by vertex, in index order, so that each vertex can be summed by a single job without any atomics,
+	// and the result doesn't depend on how the work was split.
+	std::vector<uint32_t> vertexCornerOffsets(static_cast<size_t>(vertexCount) + 1, 0);
+	for (const auto index : indices) {
+		++vertexCornerOffsets[index + 1];
 	}
+	for (size_t vertexIdx = 0; vertexIdx < vertexCount; ++vertexIdx) {
+		vertexCornerOffsets[vertexIdx + 1] += vertexCornerOffsets[vertexIdx];
+	}
+	std::vector<uint32_t> vertexCorners(indexCount);
+	{
+		auto nextCorner = vertexCornerOffsets;
+		for (size_t cornerIdx = 0; cornerIdx < indexCount; ++cornerIdx) {
+			vertexCorners[nextCorner[indices[cornerIdx]]++] = static_cast<uint32_t>(cornerIdx);
+		}
+	}
+
+	// Accumulate in SSE registers, then normalize and store. Vertices that aren't used by any non degenerate triangle
+	// are given an up normal, so that shaders never see a zero length normal.
+	auto* normalBufferStart = normalBufferAccessor.buffer->data + normalBufferAccessor.offset;
+	const auto floatNormals = is_float_element(normalElement);
+	for_each_range(jobManager, vertexCount, [&](size_t begin, size_t end) {
+		for (auto vertexIdx = begin; vertexIdx < end; ++vertexIdx) {
+			auto normal = SSE::Vector3(0.0f);
+			for (auto corner = vertexCornerOffsets[vertexIdx]; corner < vertexCornerOffsets[vertexIdx + 1]; ++corner) {
+				normal += cornerNormals[vertexCorners[corner]];
+			}
+
+			const auto lengthSqr = SSE::lengthSqr(normal);
+			normal = lengthSqr > 0.0f ? normal / std::sqrt(lengthSqr) : math::up;
+
+			if (!floatNormals) {
+				mesh_utils::write_vertex_element(normalBufferAccessor, vertexIdx, SSE::Vector4(normal, 0.0f));
+				continue;
+			}
+			const float value[3] = {normal.getX(), normal.getY(), normal.getZ()};
+			std::memcpy(normalBufferStart + vertexIdx * normalBufferAccessor.stride, value, sizeof(value));
+		}
+	});
 }
 
 void Primitive_mesh_data_factory::generateTangents(std::shared_ptr<Mesh_data> meshData)
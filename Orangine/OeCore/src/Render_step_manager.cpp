@@ -25,7 +25,7 @@ Render_step_manager::Render_step::Render_step(
 Render_step_manager::Render_step_manager(
         IScene_graph_manager& sceneGraphManager, IDev_tools_manager& devToolsManager, ITexture_manager& textureManager,
         IShadowmap_manager& shadowmapManager, IEntity_render_manager& entityRenderManager,
-        ILighting_manager& lightingManager)
+        ILighting_manager& lightingManager, IAnimation_manager& animationManager)
     : IRender_step_manager()
     , Manager_base()
     , Manager_deviceDependent()
@@ -38,6 +38,7 @@ Render_step_manager::Render_step_manager(
     , _shadowmapManager(shadowmapManager)
     , _entityRenderManager(entityRenderManager)
     , _lightingManager(lightingManager)
+    , _animationManager(animationManager)
 {
   _simpleLightProvider = [this](const BoundingSphere& target, std::vector<Entity*>& lights, uint32_t maxLights) {
     for (auto iter = _lightEntities->begin(); iter != _lightEntities->end(); ++iter) {
@@ -52,7 +53,6 @@ Render_step_manager::Render_step_manager(
 void Render_step_manager::initialize() {
   using namespace std::placeholders;
 
-  _renderableEntities = _sceneGraphManager.getEntityFilter({Renderable_component::type()});
   _lightEntities = _sceneGraphManager.getEntityFilter(
       {Directional_light_component::type(),
        Point_light_component::type(),
@@ -79,7 +79,6 @@ void Render_step_manager::shutdown() {
 
   _renderSteps.clear();
 
-  _renderableEntities.reset();
   _lightEntities.reset();
 }
 
@@ -324,6 +323,9 @@ void Render_step_manager::render() {
 
     cameraData = createCameraData(*cameraComponent);
     cameraPos = _cameraEntity->worldPosition();
+
+    // Animation LOD for the next frame is based on what this frame can see.
+    _animationManager.setViewFrustum(createFrustum(*cameraComponent));
   } else {
     cameraData = createCameraData(
         SSE::Matrix4::identity(),
@@ -333,7 +335,10 @@ void Render_step_manager::render() {
   }
   const auto frustum = BoundingFrustumRH(cameraData.projectionMatrix);
 
-  _cullSorter->beginSortAsync(_renderableEntities->begin(), _renderableEntities->end(), frustum);
+  // World transforms are final for this frame; compute bone transforms once, for all passes.
+  _animationManager.updateSkinningPalettes();
+
+  _cullSorter->beginSortRenderables(_sceneGraphManager, frustum);
 
   // Block on the cull sorter, since we can't render until it is done; and it is a good place to
   // kick off the alpha sort.
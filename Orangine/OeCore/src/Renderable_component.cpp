@@ -6,5 +6,5 @@ DEFINE_COMPONENT_TYPE(Renderable_component);
 
 Renderable_component::~Renderable_component() {
   _material.reset();
-  _rendererData.reset();
+  _rendererData.clear();
 }
\ No newline at end of file
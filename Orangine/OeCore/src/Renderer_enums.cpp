@@ -260,7 +260,8 @@ std::string g_elementComponentNames[] = {
     "Unsigned_short",
     "Signed_int",
     "Unsigned_int",
-    "Float"
+    "Float",
+    "Half_float"
 };
 static_assert(static_cast<size_t>(Element_component::Num_element_component) == array_size(g_elementComponentNames));
 const std::string& elementComponentToString(Element_component enumValue)
@@ -272,6 +273,25 @@ Element_component stringToElementComponent(const std::string & str)
     return stringToEnum<Element_component>(str, g_elementComponentNames);
 }
 
+///////////////////////////////////
+// Element_encoding
+//
+std::string g_elementEncodingNames[] = {
+    "None",
+    "Normalized",
+    "Octahedral",
+    "Octahedral_signed"
+};
+static_assert(static_cast<size_t>(Element_encoding::Num_element_encoding) == array_size(g_elementEncodingNames));
+const std::string& elementEncodingToString(Element_encoding enumValue)
+{
+    return g_elementEncodingNames[static_cast<size_t>(enumValue)];
+}
+Element_encoding stringToElementEncoding(const std::string & str)
+{
+    return stringToEnum<Element_encoding>(str, g_elementEncodingNames);
+}
+
 ///////////////////////////////////
 // Debug_display_mode
 //
@@ -3,7 +3,9 @@
 #include <imgui.h>
 
 #include <OeCore/EngineUtils.h>
+#include <OeCore/IConfigReader.h>
 #include <algorithm>
+#include <chrono>
 #include <deque>
 
 using namespace oe;
@@ -11,23 +13,45 @@ using namespace internal;
 
 std::string Scene_graph_manager::_name = "Scene_graph_manager";
 
+// Entities with at least this many children will update them in parallel.
+constexpr size_t g_parallelChildUpdateThreshold = 256;
+constexpr size_t g_childUpdateGrainSize = 64;
+
 template<>
 void oe::create_manager(
-        Manager_instance<IScene_graph_manager>& out, std::shared_ptr<IEntity_repository>& entityRepository)
+        Manager_instance<IScene_graph_manager>& out, std::shared_ptr<IEntity_repository>& entityRepository,
+        IJob_manager& jobManager)
 {
-  out = Manager_instance<IScene_graph_manager>(std::make_unique<Scene_graph_manager>(entityRepository));
+  out = Manager_instance<IScene_graph_manager>(std::make_unique<Scene_graph_manager>(entityRepository, jobManager));
 }
 
-Scene_graph_manager::Scene_graph_manager(std::shared_ptr<IEntity_repository> entityRepository)
+Scene_graph_manager::Scene_graph_manager(
+    std::shared_ptr<IEntity_repository> entityRepository,
+    IJob_manager& jobManager)
     : IScene_graph_manager()
     , Manager_base()
     , Manager_tickable()
     , _entityRepository(std::move(entityRepository))
+    , _jobManager(jobManager)
 {}
 
+void Scene_graph_manager::loadConfig(const IConfigReader& configReader)
+{
+  Manager_base::loadConfig(configReader);
+
+  _useTransformStore = configReader.readBool("OeCore.scenegraph_flat_transforms");
+}
+
 void Scene_graph_manager::initialize() { assert(_rootEntities.empty()); }
 
-void Scene_graph_manager::shutdown() {}
+void Scene_graph_manager::shutdown()
+{
+  // Waits for background loads to finish; their futures will report a broken promise.
+  _pendingLoads.clear();
+  _transformStore.clear();
+  _boundingVolumes.clear();
+  _boundsChangedEntities.clear();
+}
 
 const std::string& Scene_graph_manager::name() const { return _name; }
 
@@ -44,44 +68,133 @@ void Scene_graph_manager::tick() {
     _initialized = true;
   }
 
-  for (auto const& entity : _rootEntities) {
-    const auto entityPtr = entity.get();
-    if (entityPtr == nullptr) {
-      assert(false);
-      continue;
+  publishPendingLoads();
+
+  if (_useTransformStore) {
+    if (!_transformStore.hierarchyValid()) {
+      _transformStore.rebuild(_rootEntities);
     }
+    _recomputedTransformCount = _transformStore.update(&_boundsChangedEntities);
+    updateBoundingVolumes();
+    return;
+  }
 
-    if (!entityPtr->isActive()) {
-      continue;
+  _recomputedTransformCount = 0;
+
+  // Root entities are independent of each other, so can be updated in any order. Aim for a few batches per worker, so
+  // that workers which finish early can steal the remainder.
+  const auto rootCount = _rootEntities.size();
+  const auto grainSize = std::max<size_t>(1, rootCount / (static_cast<size_t>(_jobManager.workerCount()) * 4));
+  _jobManager.parallelFor(rootCount, grainSize, [this](size_t begin, size_t end) {
+    for (auto rootIdx = begin; rootIdx < end; ++rootIdx) {
+      const auto entityPtr = _rootEntities[rootIdx].get();
+      if (entityPtr == nullptr) {
+        assert(false);
+        continue;
+      }
+
+      if (!entityPtr->isActive()) {
+        continue;
+      }
+
+      updateEntity(entityPtr, false);
     }
+  });
 
-    updateEntity(entityPtr);
-  }
+  updateBoundingVolumes();
 }
 
-void Scene_graph_manager::updateEntity(Entity* entity) {
-  if (entity->calculateWorldTransform()) {
+bool Scene_graph_manager::updateEntity(Entity* entity, bool parentTransformChanged) {
+  const auto dirtyFlags = entity->_dirtyFlags;
+  const auto transformChanged =
+      parentTransformChanged || (dirtyFlags & Entity_transform_store::Transform_flag_transform_dirty);
+  if (!transformChanged && !(dirtyFlags & Entity_transform_store::Transform_flags_dirty_mask)) {
+    return false;
+  }
+  entity->_dirtyFlags = 0;
+
+  if (transformChanged && entity->calculateWorldTransform()) {
     entity->computeWorldTransform();
+    _recomputedTransformCount.fetch_add(1, std::memory_order_relaxed);
   }
 
+  auto boundsChanged = (dirtyFlags & Entity_transform_store::Transform_flag_bound_sphere_dirty) != 0;
   if (entity->hasChildren()) {
+    auto childBoundsChanged = (dirtyFlags & Entity_transform_store::Transform_flag_children_dirty) != 0;
+
     const auto& children = entity->children();
-    for (auto const& child : children) {
-      if (child->isActive()) {
-        updateEntity(child.get());
+    const auto updateChildren = [&children, transformChanged, this](size_t begin, size_t end) {
+      auto boundsChanged = false;
+      for (auto childIdx = begin; childIdx < end; ++childIdx) {
+        const auto& child = children[childIdx];
+        if (child->isActive()) {
+          boundsChanged |= updateEntity(child.get(), transformChanged);
+        } else if (child->_dirtyFlags & Entity_transform_store::Transform_flag_bound_sphere_dirty) {
+          // Inactive children are not updated, but their bounds are still merged.
+          child->_dirtyFlags &= ~Entity_transform_store::Transform_flag_bound_sphere_dirty;
+          queueBoundingVolumeUpdate(child.get());
+          boundsChanged = true;
+        }
       }
+      return boundsChanged;
+    };
+
+    if (children.size() < g_parallelChildUpdateThreshold) {
+      childBoundsChanged |= updateChildren(0, children.size());
+    } else {
+      std::atomic<bool> anyBoundsChanged = false;
+      _jobManager.parallelFor(
+          children.size(), g_childUpdateGrainSize, [&updateChildren, &anyBoundsChanged](size_t begin, size_t end) {
+            if (updateChildren(begin, end)) {
+              anyBoundsChanged.store(true, std::memory_order_relaxed);
+            }
+          });
+      childBoundsChanged |= anyBoundsChanged.load();
     }
 
-    if (entity->calculateBoundSphereFromChildren()) {
+    if (childBoundsChanged && entity->calculateBoundSphereFromChildren()) {
 
       auto accumulatedBounds = children[0]->boundSphere();
       for (auto pos = children.begin() + 1; pos < children.end(); ++pos) {
         BoundingSphere::createMerged(accumulatedBounds, accumulatedBounds, (*pos)->boundSphere());
       }
 
-      entity->setBoundSphere(accumulatedBounds);
+      // Assign directly rather than via setBoundSphere; our ancestors are already being visited.
+      entity->_boundSphere = accumulatedBounds;
+      boundsChanged = true;
     }
   }
+
+  if (boundsChanged) {
+    queueBoundingVolumeUpdate(entity);
+  }
+  return boundsChanged;
+}
+
+void Scene_graph_manager::queueBoundingVolumeUpdate(Entity* entity) {
+  std::lock_guard<std::mutex> lock(_boundsChangedEntitiesMutex);
+  _boundsChangedEntities.push_back(entity);
+}
+
+void Scene_graph_manager::updateBoundingVolumes() {
+  for (const auto entity : _boundsChangedEntities) {
+    const auto& boundSphere = entity->boundSphere();
+    if (boundSphere.radius <= 0.0f) {
+      removeBoundingVolume(*entity);
+    } else if (entity->_boundingVolumeProxy == Bounding_volume_hierarchy::invalid_proxy) {
+      entity->_boundingVolumeProxy = _boundingVolumes.createProxy(boundSphere, entity);
+    } else {
+      _boundingVolumes.moveProxy(entity->_boundingVolumeProxy, boundSphere);
+    }
+  }
+  _boundsChangedEntities.clear();
+}
+
+void Scene_graph_manager::removeBoundingVolume(Entity& entity) {
+  if (entity._boundingVolumeProxy != Bounding_volume_hierarchy::invalid_proxy) {
+    _boundingVolumes.destroyProxy(entity._boundingVolumeProxy);
+    entity._boundingVolumeProxy = Bounding_volume_hierarchy::invalid_proxy;
+  }
 }
 
 std::shared_ptr<Entity> Scene_graph_manager::clone(const Entity& srcEntity, Entity* newParent) {
@@ -120,6 +233,7 @@ std::shared_ptr<Entity> Scene_graph_manager::instantiate(
     Entity* parentEntity) {
   const auto entityPtr = _entityRepository->instantiate(name, *this, *this);
   _rootEntities.push_back(entityPtr);
+  invalidateTransformHierarchy();
 
   if (_initialized) {
     initializeEntity(entityPtr);
@@ -153,7 +267,7 @@ void Scene_graph_manager::loadFile(const std::string& filename) {
   loadFile(filename, nullptr);
 }
 
-void Scene_graph_manager::loadFile(const std::string& filename, Entity* parentEntity) {
+const Entity_graph_loader& Scene_graph_manager::findLoader(const std::string& filename) const {
   // Get the file extension
   const auto dotPos = filename.find_last_of('.');
   if (dotPos == std::string::npos) {
@@ -165,8 +279,11 @@ void Scene_graph_manager::loadFile(const std::string& filename, Entity* parentEn
   if (extPos == _extensionToEntityGraphLoader.end()) {
     OE_THROW(std::runtime_error("Cannot load mesh; no registered loader for extension: " + extension));
   }
+  return *extPos->second;
+}
 
-  std::vector<std::shared_ptr<Entity>> newRootEntities = extPos->second->loadFile(
+void Scene_graph_manager::loadFile(const std::string& filename, Entity* parentEntity) {
+  std::vector<std::shared_ptr<Entity>> newRootEntities = findLoader(filename).loadFile(
           filename, *this, *_entityRepository, *this, true);
 
   if (parentEntity) {
@@ -178,6 +295,64 @@ void Scene_graph_manager::loadFile(const std::string& filename, Entity* parentEn
   handleEntitiesLoaded(newRootEntities);
 }
 
+std::future<std::vector<std::shared_ptr<Entity>>> Scene_graph_manager::loadFileAsync(const std::string& filename) {
+  return loadFileAsync(filename, nullptr);
+}
+
+std::future<std::vector<std::shared_ptr<Entity>>> Scene_graph_manager::loadFileAsync(
+    const std::string& filename,
+    Entity* parentEntity) {
+  const auto& loader = findLoader(filename);
+
+  Pending_load pendingLoad;
+  pendingLoad.loader = &loader;
+  pendingLoad.parentEntityId = parentEntity ? parentEntity->getId() : Entity::invalid_id;
+  pendingLoad.preparedFile =
+      std::async(std::launch::async, [&loader, filename]() { return loader.prepareFile(filename, true); });
+
+  auto loadedEntities = pendingLoad.loadedEntities.get_future();
+  _pendingLoads.push_back(std::move(pendingLoad));
+  return loadedEntities;
+}
+
+void Scene_graph_manager::publishPendingLoads() {
+  // Files are published in the order that they finish loading.
+  for (auto pos = _pendingLoads.begin(); pos != _pendingLoads.end();) {
+    if (pos->preparedFile.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      ++pos;
+      continue;
+    }
+
+    try {
+      const auto preparedFile = pos->preparedFile.get();
+
+      Entity* parentEntity = nullptr;
+      if (pos->parentEntityId != Entity::invalid_id) {
+        parentEntity = findEntityById(pos->parentEntityId);
+        if (!parentEntity) {
+          OE_THROW(std::runtime_error("Parent entity was destroyed while loading " + preparedFile->filename));
+        }
+      }
+
+      auto newRootEntities =
+          pos->loader->instantiatePreparedFile(*preparedFile, *this, *_entityRepository, *this);
+      if (parentEntity) {
+        for (const auto& entity : newRootEntities) {
+          entity->setParent(*parentEntity);
+        }
+      }
+
+      handleEntitiesLoaded(newRootEntities);
+      pos->loadedEntities.set_value(std::move(newRootEntities));
+    } catch (const std::exception& ex) {
+      LOG(WARNING) << "Failed to load entity graph: " << ex.what();
+      pos->loadedEntities.set_exception(std::current_exception());
+    }
+
+    pos = _pendingLoads.erase(pos);
+  }
+}
+
 void Scene_graph_manager::initializeEntity(std::shared_ptr<Entity> entityPtr) const {
   std::deque<Entity*> entities;
   entities.push_back(entityPtr.get());
@@ -200,6 +375,7 @@ void Scene_graph_manager::initializeEntity(std::shared_ptr<Entity> entityPtr) co
 
 void Scene_graph_manager::addEntityToScene(std::shared_ptr<Entity> entityPtr) {
   entityPtr->_state = Entity_state::Ready;
+  queueBoundingVolumeUpdate(entityPtr.get());
 
   onEntityAdd(*entityPtr);
 }
@@ -214,6 +390,13 @@ void Scene_graph_manager::destroy(Entity::Id_type entityId) {
 
     removeFromRoot(entityPtr);
 
+    _transformStore.detach(*entityPtr);
+
+    removeBoundingVolume(*entityPtr);
+    _boundsChangedEntities.erase(
+        std::remove(_boundsChangedEntities.begin(), _boundsChangedEntities.end(), entityPtr.get()),
+        _boundsChangedEntities.end());
+
     onEntityRemove(*entityPtr);
 
     // This will delete the object. Make sure it is the last operation!
@@ -225,6 +408,10 @@ std::shared_ptr<Entity> Scene_graph_manager::getEntityPtrById(Entity::Id_type id
   return _entityRepository->getEntityPtrById(id);
 }
 
+Entity* Scene_graph_manager::findEntityById(Entity::Id_type id) const {
+  return _entityRepository->findEntityById(id);
+}
+
 std::shared_ptr<Entity> Scene_graph_manager::removeFromRoot(std::shared_ptr<Entity> entityPtr) {
   // remove from root array
   for (auto rootIter = _rootEntities.begin(); rootIter != _rootEntities.end(); ++rootIter) {
@@ -234,12 +421,14 @@ std::shared_ptr<Entity> Scene_graph_manager::removeFromRoot(std::shared_ptr<Enti
       break;
     }
   }
+  invalidateTransformHierarchy();
 
   return entityPtr;
 }
 
 void Scene_graph_manager::addToRoot(std::shared_ptr<Entity> entityPtr) {
   _rootEntities.push_back(entityPtr);
+  invalidateTransformHierarchy();
 }
 
 std::shared_ptr<Entity_filter> Scene_graph_manager::getEntityFilter(
@@ -252,7 +441,7 @@ std::shared_ptr<Entity_filter> Scene_graph_manager::getEntityFilter(
       continue;
     }
 
-    if (std::equal(componentTypes.begin(), componentTypes.end(), ef->componentTypes.begin())) {
+    if (ef->componentTypes == componentTypes) {
       return *efIter;
     }
   }
@@ -282,24 +471,26 @@ void Scene_graph_manager::onEntityRemove(const Entity& entity) {
   }
 }
 
-void Scene_graph_manager::onEntityComponentAdd(
-    const Entity& entity,
-    const Component& componentType) {
-  const auto entityPtr = _entityRepository->getEntityPtrById(entity.getId());
-  if (entityPtr) {
-    for (const auto& filter : m_entityFilters) {
-      filter->handleEntityComponentsUpdated(entityPtr);
-    }
+void Scene_graph_manager::onEntityComponentsUpdated(const Entity& entity, Component::Component_type componentType) {
+  // Entities that aren't in the scene yet (such as those being loaded) are matched against every filter once, when
+  // they are added.
+  if (entity.getState() != Entity_state::Ready) {
+    return;
   }
-}
-void Scene_graph_manager::onEntityComponentRemove(
-    const Entity& entity,
-    const Component& componentType) {
-  const auto entityPtr = _entityRepository->getEntityPtrById(entity.getId());
-  if (entityPtr) {
-    for (const auto& filter : m_entityFilters) {
-      filter->handleEntityComponentsUpdated(entityPtr);
+
+  std::shared_ptr<Entity> entityPtr;
+  for (const auto& filter : m_entityFilters) {
+    if (!filter->hasComponentType(componentType)) {
+      continue;
     }
+
+    if (!entityPtr) {
+      entityPtr = _entityRepository->getEntityPtrById(entity.getId());
+      if (!entityPtr) {
+        return;
+      }
+    }
+    filter->handleEntityComponentsUpdated(entityPtr);
   }
 }
 
@@ -310,6 +501,7 @@ void Scene_graph_manager::handleEntitiesLoaded(
       _rootEntities.push_back(entity);
     }
   }
+  invalidateTransformHierarchy();
 
   std::deque<std::shared_ptr<Entity>> newEntities(loadedEntities.begin(), loadedEntities.end());
   while (!newEntities.empty()) {
@@ -339,73 +531,65 @@ bool Scene_graph_manager::findCollidingEntity(
   foundEntity = nullptr;
   foundIntersection = {{}, FLT_MAX};
 
-  std::vector<const Entity*> work;
-  std::transform(
-      _rootEntities.begin(),
-      _rootEntities.end(),
-      std::back_inserter(work),
-      [](const std::shared_ptr<Entity>& ent) { return ent.get(); });
-
   Ray_intersection intersection;
-
-  while (!work.empty()) {
-    const auto ent = work.back();
-    work.pop_back();
-
-    if (ent->boundSphere().radius <= 0.0f ||
-        !intersect_ray_sphere(ray, ent->boundSphere(), intersection)) {
-      continue;
+  _boundingVolumes.queryRay(ray, maxDistance, [&](Entity* entity) {
+    // This bound sphere only exists to enclose the children, which are tested individually.
+    if (entity->hasChildren() && entity->calculateBoundSphereFromChildren()) {
+      return maxDistance;
     }
 
-    if (intersection.distance >= foundIntersection.distance && foundEntity != ent->parent().get()) {
-      // If the previous best was our parent, but we still collide; replace with this node even if it is farther away.
-
-      if (intersection.distance >= maxDistance) {
-        continue;
-      }
+    if (intersect_ray_sphere(ray, entity->boundSphere(), intersection) && intersection.distance < maxDistance) {
+      foundIntersection = intersection;
+      foundEntity = entity;
+      maxDistance = intersection.distance;
     }
+    return maxDistance;
+  });
 
-    foundIntersection = intersection;
-    foundEntity = ent;
+  return foundEntity != nullptr;
+}
 
-    std::transform(
-        ent->children().begin(),
-        ent->children().end(),
-        std::back_inserter(work),
-        [](const std::shared_ptr<Entity>& ent) { return ent.get(); });
-  }
+void Scene_graph_manager::findEntitiesIntersectingSphere(
+    const BoundingSphere& sphere,
+    std::vector<Entity*>& foundEntities) {
+  _boundingVolumes.querySphere(sphere, [&sphere, &foundEntities](Entity* entity) {
+    const auto& boundSphere = entity->boundSphere();
+    const auto radius = boundSphere.radius + sphere.radius;
+    if (SSE::lengthSqr(boundSphere.center - sphere.center) <= radius * radius) {
+      foundEntities.push_back(entity);
+    }
+  });
+}
 
-  return foundEntity != nullptr;
+void Scene_graph_manager::findEntitiesInFrustum(
+    const BoundingFrustumRH& frustum,
+    std::vector<Entity*>& foundEntities) {
+  _boundingVolumes.queryFrustum(frustum, [&frustum, &foundEntities](Entity* entity, bool contained) {
+    if (contained || frustum.Contains(entity->boundSphere()) != DirectX::DISJOINT) {
+      foundEntities.push_back(entity);
+    }
+  });
 }
+
 Component& Scene_graph_manager::addComponentToEntity(Component::Component_type typeId, Entity& entity)
 {
-  auto component = Component_factory::createComponent(typeId, entity);
+  auto& component = entity.attachComponent(Component_factory::createComponent(typeId, entity));
+  onEntityComponentsUpdated(entity, component.getType());
 
-  auto ptr = component.get();
-  entity._components.push_back(std::move(component));
-  onEntityComponentAdd(entity, *ptr);
-
-  return *ptr;
+  return component;
 }
 
 Component& Scene_graph_manager::cloneComponentToEntity(const Component& srcComponent, Entity& entity)
 {
-  auto component = srcComponent.clone(entity);
-
-  auto ptr = component.get();
-  entity._components.push_back(std::move(component));
-  onEntityComponentAdd(entity, *ptr);
+  auto& component = entity.attachComponent(srcComponent.clone(entity));
+  onEntityComponentsUpdated(entity, component.getType());
 
-  return *ptr;
+  return component;
 }
 void Scene_graph_manager::destroyComponent(Component& component)
 {
   auto& entity = component.getEntity();
-  onEntityComponentRemove(entity, component);
-  for (auto pos = entity._components.begin(); pos != entity._components.end(); ++pos) {
-    if (pos->get() == &component) {
-      entity._components.erase(pos);
-      break;
-    }
-  }
+  const auto componentType = component.getType();
+  entity.eraseComponent(component);
+  onEntityComponentsUpdated(entity, componentType);
 }
@@ -2,11 +2,17 @@
 
 #include "Entity_filter_impl.h"
 
+#include <OeCore/Bounding_volume_hierarchy.h>
 #include <OeCore/Component.h>
 #include <OeCore/Entity.h>
+#include <OeCore/Entity_transform_store.h>
 #include <OeCore/IEntity_repository.h>
+#include <OeCore/IJob_manager.h>
 #include <OeCore/IScene_graph_manager.h>
 
+#include <atomic>
+#include <future>
+#include <mutex>
 #include <vector>
 
 namespace oe::internal {
@@ -19,11 +25,12 @@ class Scene_graph_manager : public IScene_graph_manager,
   friend EntityRef;
 
  public:
-  explicit Scene_graph_manager(std::shared_ptr<IEntity_repository> entityRepository);
+  Scene_graph_manager(std::shared_ptr<IEntity_repository> entityRepository, IJob_manager& jobManager);
   Scene_graph_manager(const Scene_graph_manager& other) = delete;
   ~Scene_graph_manager() override = default;
 
   // Manager_base implementation
+  void loadConfig(const IConfigReader& configReader) override;
   void initialize() override;
   void shutdown() override;
   const std::string& name() const override;
@@ -42,6 +49,10 @@ class Scene_graph_manager : public IScene_graph_manager,
   void addLoader(std::unique_ptr<Entity_graph_loader> loader) override;
   void loadFile(const std::string& filename) override;
   void loadFile(const std::string& filename, Entity* parentEntity) override;
+  std::future<std::vector<std::shared_ptr<Entity>>> loadFileAsync(const std::string& filename) override;
+  std::future<std::vector<std::shared_ptr<Entity>>> loadFileAsync(
+      const std::string& filename,
+      Entity* parentEntity) override;
 
   /**
    * Will do nothing if no entity exists with the given ID.
@@ -49,6 +60,7 @@ class Scene_graph_manager : public IScene_graph_manager,
   void destroy(Entity::Id_type entityId) override;
 
   std::shared_ptr<Entity> getEntityPtrById(Entity::Id_type id) const override;
+  Entity* findEntityById(Entity::Id_type id) const override;
   std::shared_ptr<Entity_filter> getEntityFilter(
       const Component_type_set& componentTypes,
       Entity_filter_mode mode) override;
@@ -59,18 +71,33 @@ class Scene_graph_manager : public IScene_graph_manager,
       Entity const*& foundEntity,
       Ray_intersection& foundIntersection,
       float maxDistance) override;
+  void findEntitiesIntersectingSphere(const BoundingSphere& sphere, std::vector<Entity*>& foundEntities) override;
+  void findEntitiesInFrustum(const BoundingFrustumRH& frustum, std::vector<Entity*>& foundEntities) override;
 
   virtual Dispatcher<Entity&>& getEntityAddedDispatcher() override { return _entityAddedDispatcher; }
+  uint32_t getRecomputedTransformCount() const override { return _recomputedTransformCount.load(); }
   Component& addComponentToEntity(Component::Component_type typeId, Entity& entity) override;
   Component& cloneComponentToEntity(const Component& srcComponent, Entity& entity) override;
   void destroyComponent(Component& component) override;
 
  private:
+  struct Pending_load {
+    const Entity_graph_loader* loader;
+    // Entity::invalid_id if the entities are added to the root.
+    Entity::Id_type parentEntityId;
+    std::future<std::unique_ptr<Entity_graph_loader::Prepared_file>> preparedFile;
+    std::promise<std::vector<std::shared_ptr<Entity>>> loadedEntities;
+  };
+
+  const Entity_graph_loader& findLoader(const std::string& filename) const;
+
+  // Adds the entities of any files that have finished loading in the background to the scene.
+  void publishPendingLoads();
 
   void onEntityAdd(const Entity& entity);
   void onEntityRemove(const Entity& entity);
-  void onEntityComponentAdd(const Entity& entity, const Component& componentType);
-  void onEntityComponentRemove(const Entity& entity, const Component& componentType);
+  // Called after a component of the given type has been added to, or removed from, the entity.
+  void onEntityComponentsUpdated(const Entity& entity, Component::Component_type componentType);
 
   std::shared_ptr<Entity> removeFromRoot(std::shared_ptr<Entity> entity) override;
   void addToRoot(std::shared_ptr<Entity> entity) override;
@@ -82,9 +109,23 @@ class Scene_graph_manager : public IScene_graph_manager,
 
   /**
    * Applies transforms recursively down (from root -> leaves),
-   * then updates components from bottom up (from leaves -> root)
+   * then updates components from bottom up (from leaves -> root).
+   * Subtrees that have no dirty entities are skipped. The children of entities with many children are updated in
+   * parallel; bound spheres are always merged in child order, so results do not depend on the number of workers.
+   *
+   * Returns true if the bound sphere of the given entity changed.
    */
-  static void updateEntity(Entity* entity);
+  bool updateEntity(Entity* entity, bool parentTransformChanged);
+
+  // Must be called whenever the set of root entities, or the children of any entity, changes.
+  void invalidateTransformHierarchy() { _transformStore.invalidateHierarchy(); }
+
+  // Records that the bound sphere of the given entity changed. Thread safe.
+  void queueBoundingVolumeUpdate(Entity* entity);
+
+  // Refits the bounding volume hierarchy for all entities passed to queueBoundingVolumeUpdate.
+  void updateBoundingVolumes();
+  void removeBoundingVolume(Entity& entity);
 
   static std::string _name;
 
@@ -93,17 +134,33 @@ class Scene_graph_manager : public IScene_graph_manager,
   // All entities
   std::shared_ptr<IEntity_repository> _entityRepository;
 
+  IJob_manager& _jobManager;
+
   // A cache of entities that have no parents
   // TODO: Turn this into a filter?
   std::vector<std::shared_ptr<Entity>> _rootEntities;
 
   bool _initialized = false;
 
+  // Number of world transforms that were recomputed during the last tick. Incremented by job threads.
+  std::atomic<uint32_t> _recomputedTransformCount = 0;
+
+  // If true, transforms are stored in _transformStore and updated with a linear pass, rather than by recursing
+  // _rootEntities. Must be declared after _rootEntities, so that it is destroyed first.
+  bool _useTransformStore = false;
+  Entity_transform_store _transformStore;
+
+  // Entity bound spheres, used to accelerate collision queries.
+  Bounding_volume_hierarchy _boundingVolumes;
+  std::vector<Entity*> _boundsChangedEntities;
+  std::mutex _boundsChangedEntitiesMutex;
+
   Invokable_dispatcher<Entity&> _entityAddedDispatcher;
 
 
   std::vector<std::unique_ptr<Entity_graph_loader>> _entityGraphLoaders = {};
   std::map<std::string, Entity_graph_loader*> _extensionToEntityGraphLoader = {};
+  std::vector<Pending_load> _pendingLoads;
 };
 
 } // namespace oe::internal
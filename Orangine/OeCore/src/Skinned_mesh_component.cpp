@@ -1,10 +1,18 @@
 ﻿#include "OeCore/Skinned_mesh_component.h"
 
+#include "OeCore/Entity.h"
+
 using namespace oe;
 
 DEFINE_COMPONENT_TYPE(Skinned_mesh_component);
 
+void Skinned_mesh_component::setSkeletonTransformRoot(std::shared_ptr<Entity> root) {
+  _skeletonTransformRoot = std::move(root);
+  unshareSkinningPalette();
+}
+
 void Skinned_mesh_component::setJoints(std::vector<std::shared_ptr<Entity>>&& vector) {
+  unshareSkinningPalette();
   _joints = move(vector);
   _jointsRaw.resize(_joints.size());
   std::transform(_joints.begin(), _joints.end(), _jointsRaw.begin(), [](const auto& ptr) {
@@ -14,4 +22,32 @@ void Skinned_mesh_component::setJoints(std::vector<std::shared_ptr<Entity>>&& ve
 
 void Skinned_mesh_component::setInverseBindMatrices(std::vector<SSE::Matrix4>&& matrices) {
   _inverseBindMatrices = std::move(matrices);
+  unshareSkinningPalette();
+}
+
+void Skinned_mesh_component::shareSkinningPalette(const Skinned_mesh_component& other) {
+  _skinningPalette = other._skinningPalette;
+}
+
+void Skinned_mesh_component::unshareSkinningPalette() {
+  if (_skinningPalette.use_count() > 1) {
+    _skinningPalette = std::make_shared<Skinning_palette>();
+  }
+}
+
+void Skinned_mesh_component::updateSkinningPalette() {
+  auto& boneTransforms = _skinningPalette->boneTransforms;
+  if (_jointsRaw.size() != _inverseBindMatrices.size()) {
+    // Invalid skin; the renderer reports it.
+    boneTransforms.clear();
+    return;
+  }
+
+  const auto& rootEntity = _skeletonTransformRoot ? *_skeletonTransformRoot : getEntity();
+  const auto invRootWorld = SSE::inverse(rootEntity.worldTransform());
+
+  boneTransforms.resize(_jointsRaw.size());
+  for (size_t i = 0; i < _jointsRaw.size(); ++i) {
+    boneTransforms[i] = invRootWorld * _jointsRaw[i]->worldTransform() * _inverseBindMatrices[i];
+  }
 }
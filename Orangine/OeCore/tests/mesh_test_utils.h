@@ -0,0 +1,164 @@
+#pragma once
+
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Mesh_utils.h>
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Builders for the meshes and buffers that the mesh tests run on.
+namespace oe::mesh_test_utils {
+template <class T> std::shared_ptr<Mesh_buffer> create_buffer(const std::vector<T>& values)
+{
+  auto buffer = std::make_shared<Mesh_buffer>(values.size() * sizeof(T));
+  std::memcpy(buffer->data, values.data(), buffer->dataSize);
+  return buffer;
+}
+
+// Tightly packed elements of elementSize components each.
+template <class TComponent>
+std::unique_ptr<Mesh_buffer_accessor> create_accessor(const std::vector<TComponent>& components, size_t elementSize)
+{
+  return std::make_unique<Mesh_buffer_accessor>(
+      create_buffer(components),
+      static_cast<uint32_t>(components.size() / elementSize),
+      static_cast<uint32_t>(elementSize * sizeof(TComponent)),
+      0);
+}
+
+template <class TComponent>
+std::unique_ptr<Mesh_vertex_buffer_accessor> create_vertex_accessor(
+    const std::vector<TComponent>& components,
+    Vertex_attribute attribute,
+    Element_type type,
+    Element_component component,
+    size_t elementSize)
+{
+  return std::make_unique<Mesh_vertex_buffer_accessor>(
+      create_buffer(components),
+      Vertex_attribute_element{{attribute, 0}, type, component},
+      static_cast<uint32_t>(components.size() / elementSize),
+      static_cast<uint32_t>(elementSize * sizeof(TComponent)),
+      0);
+}
+
+// Float elements of the given type, taking as many components of each value as the type has.
+inline std::unique_ptr<Mesh_vertex_buffer_accessor> create_float_accessor(
+    Vertex_attribute attribute,
+    Element_type type,
+    const std::vector<SSE::Vector4>& values)
+{
+  const auto stride = mesh_utils::element_size(type, Element_component::Float);
+  auto buffer = std::make_shared<Mesh_buffer>(values.size() * stride);
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    const float value[4] = {values[idx].getX(), values[idx].getY(), values[idx].getZ(), values[idx].getW()};
+    std::memcpy(buffer->data + idx * stride, value, stride);
+  }
+  return std::make_unique<Mesh_vertex_buffer_accessor>(
+      buffer,
+      Vertex_attribute_element{{attribute, 0}, type, Element_component::Float},
+      static_cast<uint32_t>(values.size()),
+      static_cast<uint32_t>(stride),
+      0);
+}
+
+inline std::unique_ptr<Mesh_vertex_buffer_accessor> create_float3_accessor(
+    const std::vector<SSE::Vector3>& values,
+    Vertex_attribute attribute = Vertex_attribute::Position)
+{
+  std::vector<float> components;
+  components.reserve(values.size() * 3);
+  for (const auto& value : values) {
+    components.insert(components.end(), {value.getX(), value.getY(), value.getZ()});
+  }
+  return create_vertex_accessor(components, attribute, Element_type::Vector3, Element_component::Float, 3);
+}
+
+template <class TIndex>
+std::unique_ptr<Mesh_index_buffer_accessor> create_index_accessor(const std::vector<TIndex>& indices)
+{
+  constexpr auto component = sizeof(TIndex) == 2 ? Element_component::Unsigned_short : Element_component::Unsigned_int;
+  return std::make_unique<Mesh_index_buffer_accessor>(
+      create_buffer(indices),
+      component,
+      static_cast<uint32_t>(indices.size()),
+      static_cast<uint32_t>(sizeof(TIndex)),
+      0);
+}
+
+inline std::vector<uint32_t> read_indices(const Mesh_index_buffer_accessor& accessor)
+{
+  std::vector<uint32_t> indices(accessor.count);
+  for (size_t idx = 0; idx < indices.size(); ++idx) {
+    indices[idx] = mesh_utils::convert_index_value(accessor.component, accessor.getIndexed(idx));
+  }
+  return indices;
+}
+
+// A triangle list of the given positions, with indices of type TIndex.
+template <class TIndex>
+std::shared_ptr<Mesh_data> create_mesh_data(
+    const std::vector<SSE::Vector3>& positions,
+    const std::vector<uint32_t>& indices)
+{
+  auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  meshData->indexBufferAccessor = create_index_accessor(std::vector<TIndex>(indices.begin(), indices.end()));
+  meshData->vertexBufferAccessors[{Vertex_attribute::Position, 0}] = create_float3_accessor(positions);
+  return meshData;
+}
+
+inline void add_morph_target(Mesh_data& meshData, const std::vector<SSE::Vector3>& positionDeltas)
+{
+  std::vector<std::unique_ptr<Mesh_vertex_buffer_accessor>> morphTarget;
+  morphTarget.push_back(create_float3_accessor(positionDeltas));
+  meshData.attributeMorphBufferAccessors.push_back(std::move(morphTarget));
+}
+
+/*
+ * A unit square in the XZ plane, of size x size vertices numbered row by row. The height of the vertex at (x, z) is
+ * heightFn(x, z). Each quad is split into two triangles. If seamColumn isn't zero, the columns from seamColumn on use
+ * their own copy of the vertices along it, as if there were a UV seam there.
+ */
+inline void create_grid(
+    uint32_t size,
+    const std::function<float(float, float)>& heightFn,
+    std::vector<SSE::Vector3>& positions,
+    std::vector<uint32_t>& indices,
+    uint32_t seamColumn = 0)
+{
+  for (uint32_t z = 0; z < size; ++z) {
+    for (uint32_t x = 0; x < size; ++x) {
+      const auto u = static_cast<float>(x) / (size - 1);
+      const auto v = static_cast<float>(z) / (size - 1);
+      positions.emplace_back(u, heightFn(u, v), v);
+    }
+  }
+
+  const auto firstSeamVertex = static_cast<uint32_t>(positions.size());
+  if (seamColumn != 0) {
+    for (uint32_t z = 0; z < size; ++z) {
+      positions.push_back(positions[z * size + seamColumn]);
+    }
+  }
+  const auto vertex = [&](uint32_t x, uint32_t z, bool rightOfSeam) {
+    return rightOfSeam && x == seamColumn ? firstSeamVertex + z : z * size + x;
+  };
+
+  for (uint32_t z = 0; z + 1 < size; ++z) {
+    for (uint32_t x = 0; x + 1 < size; ++x) {
+      const auto rightOfSeam = seamColumn != 0 && x >= seamColumn;
+      const auto i0 = vertex(x, z, rightOfSeam);
+      const auto i1 = vertex(x + 1, z, rightOfSeam);
+      const auto i2 = vertex(x, z + 1, rightOfSeam);
+      const auto i3 = vertex(x + 1, z + 1, rightOfSeam);
+      indices.insert(indices.end(), {i0, i2, i1, i1, i2, i3});
+    }
+  }
+}
+
+// Height functions for create_grid.
+inline float flat(float, float) { return 0.0f; }
+inline float hill(float u, float v) { return 0.5f - (u - 0.5f) * (u - 0.5f) - (v - 0.5f) * (v - 0.5f); }
+} // namespace oe::mesh_test_utils
@@ -0,0 +1,276 @@
+#include "Animation_manager.h"
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+#include "Time_step_manager.h"
+#include "mesh_test_utils.h"
+
+#include <OeCore/Mesh_data.h>
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using oe::Animation_controller_component;
+using oe::Animation_interpolation;
+using oe::Animation_manager;
+using oe::Animation_type;
+using oe::BoundingFrustumRH;
+using oe::Component_factory;
+using oe::Element_component;
+using oe::Entity_repository;
+using oe::Pose_property;
+using oe::Time_step_manager;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+namespace mesh_test_utils = oe::mesh_test_utils;
+
+namespace {
+uint32_t findNextKeyframeLinear(const std::vector<float>& keyframeTimes, double time)
+{
+  uint32_t index = 0;
+  while (index < keyframeTimes.size() && keyframeTimes[index] <= time) {
+    ++index;
+  }
+  return index;
+}
+} // namespace
+
+TEST(AnimationManagerTest, find_next_keyframe_during_playback)
+{
+  const std::vector<float> keyframeTimes = {0.0f, 0.5f, 1.0f, 1.0f, 2.0f};
+
+  uint32_t cursor = 0;
+  for (const auto time : {-1.0, 0.0, 0.25, 0.5, 0.9, 1.0, 1.5, 2.0, 3.0}) {
+    cursor = Animation_manager::findNextKeyframe(keyframeTimes, time, cursor);
+    EXPECT_EQ(findNextKeyframeLinear(keyframeTimes, time), cursor) << "time: " << time;
+  }
+
+  // Looping back to the start
+  cursor = Animation_manager::findNextKeyframe(keyframeTimes, 0.1, cursor);
+  EXPECT_EQ(1u, cursor);
+}
+
+TEST(AnimationManagerTest, find_next_keyframe_with_seeks)
+{
+  std::vector<float> keyframeTimes;
+  for (auto idx = 0; idx < 1000; ++idx) {
+    keyframeTimes.push_back(static_cast<float>(idx) / 30.0f);
+  }
+
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<double> timeDistribution(-1.0, 35.0);
+  std::uniform_real_distribution<double> stepDistribution(0.0, 0.1);
+
+  uint32_t cursor = 0;
+  auto time = 0.0;
+  for (auto step = 0; step < 10000; ++step) {
+    // Mostly play forwards, with occasional seeks.
+    time = step % 50 == 0 ? timeDistribution(random) : time + stepDistribution(random);
+    cursor = Animation_manager::findNextKeyframe(keyframeTimes, time, cursor);
+    ASSERT_EQ(findNextKeyframeLinear(keyframeTimes, time), cursor) << "time: " << time;
+  }
+
+  // A stale cursor, past the end of the keyframes, is tolerated.
+  EXPECT_EQ(1u, Animation_manager::findNextKeyframe(keyframeTimes, 0.0, 5000));
+}
+
+TEST(AnimationManagerTest, decode_normalized_morph_weights)
+{
+  Animation_controller_component::Animation_channel channel;
+  channel.animationType = Animation_type::Morph;
+  channel.interpolationType = Animation_interpolation::Linear;
+  channel.valuesPerKeyFrame = 2;
+  channel.keyframeTimes = std::make_shared<std::vector<float>>(std::vector<float>{0.0f, 1.0f});
+  channel.keyframeValues = mesh_test_utils::create_accessor<uint8_t>({0, 255, 51, 102}, 1);
+  channel.keyframeValueComponent = Element_component::Unsigned_byte;
+
+  Animation_controller_component::decodeKeyframeValues(channel);
+
+  EXPECT_EQ(2u, channel.morphTargetCount);
+  const auto& weights = channel.morphWeightKeyframes.values;
+  ASSERT_EQ(4u, weights.size());
+  EXPECT_FLOAT_EQ(0.0f, weights[0]);
+  EXPECT_FLOAT_EQ(1.0f, weights[1]);
+  EXPECT_FLOAT_EQ(0.2f, weights[2]);
+  EXPECT_FLOAT_EQ(0.4f, weights[3]);
+  EXPECT_TRUE(channel.morphWeightKeyframes.inTangents.empty());
+}
+
+TEST(AnimationManagerTest, decode_cubic_spline_scales_tangents_by_keyframe_interval)
+{
+  Animation_controller_component::Animation_channel channel;
+  channel.animationType = Animation_type::Translation;
+  channel.interpolationType = Animation_interpolation::Cubic_spline;
+  channel.valuesPerKeyFrame = 3;
+  channel.keyframeTimes = std::make_shared<std::vector<float>>(std::vector<float>{1.0f, 3.0f});
+  // Each keyframe is an in-tangent, value, then out-tangent. Moving 1 unit along x over 2 seconds.
+  channel.keyframeValues = mesh_test_utils::create_accessor<float>(
+      {
+          9.0f, 9.0f, 9.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f, // keyframe 0
+          0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 9.0f, 9.0f, 9.0f, // keyframe 1
+      },
+      3);
+
+  Animation_controller_component::decodeKeyframeValues(channel);
+
+  const auto& keyframes = channel.vector3Keyframes;
+  ASSERT_EQ(2u, keyframes.values.size());
+  ASSERT_EQ(2u, keyframes.inTangents.size());
+  ASSERT_EQ(2u, keyframes.outTangents.size());
+  EXPECT_FLOAT_EQ(0.0f, keyframes.values[0].getX());
+  EXPECT_FLOAT_EQ(1.0f, keyframes.values[1].getX());
+  EXPECT_FLOAT_EQ(1.0f, keyframes.outTangents[0].getX());
+  EXPECT_FLOAT_EQ(1.0f, keyframes.inTangents[1].getX());
+
+  // Tangents outside of the keyframe range are never used.
+  EXPECT_FLOAT_EQ(0.0f, keyframes.inTangents[0].getX());
+  EXPECT_FLOAT_EQ(0.0f, keyframes.outTangents[1].getY());
+}
+
+TEST(AnimationManagerTest, sample_vector3_batch)
+{
+  Animation_controller_component::Animation_channel channel;
+  channel.animationType = Animation_type::Translation;
+  channel.interpolationType = Animation_interpolation::Linear;
+  channel.valuesPerKeyFrame = 1;
+  channel.keyframeTimes = std::make_shared<std::vector<float>>(std::vector<float>{0.0f, 1.0f, 2.0f});
+  channel.keyframeValues =
+      mesh_test_utils::create_accessor<float>({0.0f, 0.0f, 0.0f, 2.0f, 4.0f, 6.0f, 4.0f, 4.0f, 4.0f}, 3);
+  Animation_controller_component::decodeKeyframeValues(channel);
+
+  const std::vector<Animation_manager::Channel_sample> samples = {
+      {&channel, nullptr, 0, 1, 0.5f},
+      {&channel, nullptr, 1, 2, 0.25f},
+      {&channel, nullptr, 1, 2, 1.0f},
+  };
+
+  std::vector<SSE::Vector3> results;
+  Animation_manager::sampleVector3Batch(samples, Animation_interpolation::Linear, results);
+  ASSERT_EQ(3u, results.size());
+  EXPECT_FLOAT_EQ(1.0f, results[0].getX());
+  EXPECT_FLOAT_EQ(3.0f, results[0].getZ());
+  EXPECT_FLOAT_EQ(2.5f, results[1].getX());
+  EXPECT_FLOAT_EQ(5.5f, results[1].getZ());
+  EXPECT_FLOAT_EQ(4.0f, results[2].getY());
+
+  Animation_manager::sampleVector3Batch(samples, Animation_interpolation::Step, results);
+  ASSERT_EQ(3u, results.size());
+  EXPECT_FLOAT_EQ(0.0f, results[0].getX());
+  EXPECT_FLOAT_EQ(2.0f, results[1].getX());
+  EXPECT_FLOAT_EQ(2.0f, results[2].getX());
+}
+
+TEST(AnimationManagerTest, pose_property_blends_layers)
+{
+  Pose_property<SSE::Vector3> property;
+  EXPECT_FALSE(property.animated());
+
+  // Additive samples need an animated value to build on.
+  property.addAdditive(SSE::Vector3(1.0f), SSE::Vector3(0.0f), 1.0f);
+  EXPECT_FALSE(property.animated());
+
+  // The lowest layer is averaged by weight.
+  property.addOverride(SSE::Vector3(0.0f, 0.0f, 0.0f), 0.3f);
+  property.addOverride(SSE::Vector3(4.0f, 0.0f, 0.0f), 0.1f);
+  property.endOverrideLayer();
+  ASSERT_TRUE(property.animated());
+  EXPECT_FLOAT_EQ(1.0f, property.value().getX());
+
+  // Higher layers blend over it by their total weight.
+  property.addOverride(SSE::Vector3(3.0f, 0.0f, 0.0f), 0.5f);
+  property.endOverrideLayer();
+  EXPECT_FLOAT_EQ(2.0f, property.value().getX());
+
+  property.addAdditive(SSE::Vector3(3.0f, 1.0f, 0.0f), SSE::Vector3(1.0f, 1.0f, 0.0f), 0.5f);
+  EXPECT_FLOAT_EQ(3.0f, property.value().getX());
+  EXPECT_FLOAT_EQ(0.0f, property.value().getY());
+}
+
+class AnimationManagerSceneTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    Component_factory::initStatics();
+    Animation_controller_component::initStatics();
+
+    jobManager.initialize();
+    sceneGraphManager.initialize();
+  }
+
+  void TearDown() override
+  {
+    animationManager.shutdown();
+    sceneGraphManager.shutdown();
+    jobManager.shutdown();
+    Component_factory::destroyStatics();
+  }
+
+  void tick()
+  {
+    timeStepManager.progressTime(1.0 / 60.0);
+    sceneGraphManager.tick();
+    animationManager.tick();
+  }
+
+  Job_manager jobManager;
+  Time_step_manager timeStepManager;
+  Scene_graph_manager sceneGraphManager{std::make_shared<Entity_repository>(), jobManager};
+  Animation_manager animationManager{sceneGraphManager, timeStepManager, jobManager};
+};
+
+TEST_F(AnimationManagerSceneTest, tick_only_updates_controllers_of_its_scene_graph)
+{
+  Scene_graph_manager otherSceneGraphManager{std::make_shared<Entity_repository>(), jobManager};
+  otherSceneGraphManager.initialize();
+
+  // Controllers of both scene graphs share a component pool.
+  const auto entity = sceneGraphManager.instantiate("Animated");
+  entity->addComponent<Animation_controller_component>();
+  const auto otherEntity = otherSceneGraphManager.instantiate("Other animated");
+  otherEntity->addComponent<Animation_controller_component>();
+  otherSceneGraphManager.tick();
+
+  tick();
+  EXPECT_EQ(1u, animationManager.animationStats().fullRateControllers);
+
+  otherSceneGraphManager.shutdown();
+}
+
+TEST_F(AnimationManagerSceneTest, throttled_controller_interpolates_between_samples)
+{
+  // A distant controller, moving a child along X at 10 units per second.
+  const auto entity = sceneGraphManager.instantiate("Animated");
+  entity->setPosition({0.0f, 0.0f, -100.0f});
+  const auto child = sceneGraphManager.instantiate("Child", *entity);
+
+  auto channel = std::make_unique<Animation_controller_component::Animation_channel>();
+  channel->targetNode = child;
+  channel->animationType = Animation_type::Translation;
+  channel->interpolationType = Animation_interpolation::Linear;
+  channel->valuesPerKeyFrame = 1;
+  channel->keyframeTimes = std::make_shared<std::vector<float>>(std::vector<float>{0.0f, 10.0f});
+  channel->keyframeValues = mesh_test_utils::create_accessor<float>({0.0f, 0.0f, 0.0f, 100.0f, 0.0f, 0.0f}, 3);
+  auto animation = std::make_unique<Animation_controller_component::Animation>();
+  animation->channels.push_back(std::move(channel));
+
+  auto& animComponent = entity->addComponent<Animation_controller_component>();
+  animComponent.updatePolicy.pauseWhenCulled = false;
+  animComponent.updatePolicy.reducedRateInterval = 4;
+  animComponent.addAnimation("Move", std::move(animation));
+  animComponent.playAnimation("Move");
+  animationManager.setViewFrustum(BoundingFrustumRH());
+
+  // Allow for the first sample, which has nothing to interpolate from, then the child should move on every frame.
+  for (auto frame = 0; frame < 8; ++frame) {
+    tick();
+    ASSERT_EQ(1u, animationManager.animationStats().reducedRateControllers);
+  }
+  auto previousX = child->position().getX();
+  for (auto frame = 0; frame < 12; ++frame) {
+    tick();
+    const auto x = child->position().getX();
+    EXPECT_GT(x, previousX) << "frame " << frame;
+    previousX = x;
+  }
+}
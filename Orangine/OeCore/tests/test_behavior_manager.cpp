@@ -0,0 +1,124 @@
+#include "Behavior_manager.h"
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <OeCore/Camera_component.h>
+#include <OeCore/Test_component.h>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+
+using oe::Behavior_manager;
+using oe::Camera_component;
+using oe::Component_factory;
+using oe::Entity;
+using oe::Entity_behavior;
+using oe::Entity_repository;
+using oe::Test_component;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+namespace {
+// Counts the entities it handles, and calls onHandle for each.
+class Counting_behavior : public Entity_behavior {
+ public:
+  Counting_behavior(std::map<std::string, int>& handleCounts, std::function<void(Entity&)> onHandle)
+      : Entity_behavior("Counting_behavior")
+      , _handleCounts(handleCounts)
+      , _onHandle(std::move(onHandle))
+  {}
+
+  void handleEntity(Entity& entity) override
+  {
+    ++_handleCounts[entity.getName()];
+    _onHandle(entity);
+  }
+
+ private:
+  std::map<std::string, int>& _handleCounts;
+  std::function<void(Entity&)> _onHandle;
+};
+
+class BehaviorManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    Component_factory::initStatics();
+    Test_component::initStatics();
+    Camera_component::initStatics();
+
+    jobManager.initialize();
+    sceneGraphManager.initialize();
+    behaviorManager.initialize();
+  }
+
+  void TearDown() override
+  {
+    behaviorManager.shutdown();
+    sceneGraphManager.shutdown();
+    jobManager.shutdown();
+    Component_factory::destroyStatics();
+  }
+
+  std::shared_ptr<Entity> instantiate(const std::string& name)
+  {
+    const auto entity = sceneGraphManager.instantiate(name);
+    entity->addComponent<Test_component>();
+    entity->addComponent<Camera_component>();
+    return entity;
+  }
+
+  Job_manager jobManager;
+  Scene_graph_manager sceneGraphManager{std::make_shared<Entity_repository>(), jobManager};
+  Behavior_manager behaviorManager{sceneGraphManager};
+  std::map<std::string, int> handleCounts;
+};
+} // namespace
+
+TEST_F(BehaviorManagerTest, entities_that_leave_the_filter_during_tick_do_not_hide_others)
+{
+  const auto first = instantiate("First");
+  const auto second = instantiate("Second");
+  const auto third = instantiate("Third");
+
+  // Handling the first entity removes it from the filter, which moves the last member into its place.
+  behaviorManager.addForComponentTypes(
+      std::make_unique<Counting_behavior>(
+          handleCounts,
+          [this, &first](Entity& entity) {
+            if (&entity == first.get()) {
+              sceneGraphManager.destroyComponent(*entity.getFirstComponentOfType<Camera_component>());
+            }
+          }),
+      {Test_component::type(), Camera_component::type()});
+  behaviorManager.tick();
+
+  EXPECT_EQ((std::map<std::string, int>{{"First", 1}, {"Second", 1}, {"Third", 1}}), handleCounts);
+
+  handleCounts.clear();
+  behaviorManager.tick();
+  EXPECT_EQ((std::map<std::string, int>{{"Second", 1}, {"Third", 1}}), handleCounts);
+}
+
+TEST_F(BehaviorManagerTest, entities_removed_from_the_filter_before_their_turn_are_skipped)
+{
+  const auto first = instantiate("First");
+  const auto second = instantiate("Second");
+  const auto third = instantiate("Third");
+
+  behaviorManager.addForComponentTypes(
+      std::make_unique<Counting_behavior>(
+          handleCounts,
+          [this, &first, &third](Entity& entity) {
+            if (&entity == first.get()) {
+              sceneGraphManager.destroyComponent(*third->getFirstComponentOfType<Camera_component>());
+            }
+          }),
+      {Test_component::type(), Camera_component::type()});
+  behaviorManager.tick();
+
+  EXPECT_EQ((std::map<std::string, int>{{"First", 1}, {"Second", 1}}), handleCounts);
+}
@@ -0,0 +1,164 @@
+#include <OeCore/Bounding_volume_hierarchy.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using oe::BoundingSphere;
+using oe::Bounding_volume_hierarchy;
+using oe::Entity;
+using oe::Ray;
+
+namespace {
+// The hierarchy never dereferences entity pointers, so proxies are identified by fake pointers.
+Entity* fakeEntity(size_t index) { return reinterpret_cast<Entity*>(index + 1); }
+size_t fakeEntityIndex(Entity* entity) { return reinterpret_cast<size_t>(entity) - 1; }
+
+class BoundingVolumeHierarchyTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    std::uniform_real_distribution<float> positionDistribution(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radiusDistribution(0.5f, 5.0f);
+    for (size_t index = 0; index < 1000; ++index) {
+      spheres.emplace_back(
+          SSE::Vector3(positionDistribution(random), positionDistribution(random), positionDistribution(random)),
+          radiusDistribution(random));
+      proxies.push_back(bvh.createProxy(spheres.back(), fakeEntity(index)));
+    }
+  }
+
+  std::vector<size_t> querySphere(const BoundingSphere& sphere)
+  {
+    std::vector<size_t> found;
+    bvh.querySphere(sphere, [&](Entity* entity) {
+      const auto index = fakeEntityIndex(entity);
+      const auto radius = spheres[index].radius + sphere.radius;
+      if (SSE::lengthSqr(spheres[index].center - sphere.center) <= radius * radius) {
+        found.push_back(index);
+      }
+    });
+    std::sort(found.begin(), found.end());
+    return found;
+  }
+
+  std::vector<size_t> querySphereBruteForce(const BoundingSphere& sphere)
+  {
+    std::vector<size_t> found;
+    for (size_t index = 0; index < spheres.size(); ++index) {
+      const auto radius = spheres[index].radius + sphere.radius;
+      if (proxies[index] != Bounding_volume_hierarchy::invalid_proxy &&
+          SSE::lengthSqr(spheres[index].center - sphere.center) <= radius * radius) {
+        found.push_back(index);
+      }
+    }
+    return found;
+  }
+
+  std::mt19937 random{1234};
+  Bounding_volume_hierarchy bvh;
+  std::vector<BoundingSphere> spheres;
+  std::vector<uint32_t> proxies;
+};
+} // namespace
+
+TEST_F(BoundingVolumeHierarchyTest, sphere_query_matches_brute_force)
+{
+  EXPECT_EQ(1000u, bvh.proxyCount());
+  // A balanced tree of 1000 leaves has a height of at least 10; allow some slack for the incremental insertion.
+  EXPECT_LE(bvh.height(), 20);
+
+  for (const auto& center : {SSE::Vector3(0.0f), SSE::Vector3(50.0f, -20.0f, 10.0f)}) {
+    const auto querySphere = BoundingSphere(center, 25.0f);
+    EXPECT_EQ(querySphereBruteForce(querySphere), this->querySphere(querySphere));
+  }
+}
+
+TEST_F(BoundingVolumeHierarchyTest, sphere_query_matches_brute_force_after_move_and_destroy)
+{
+  std::uniform_real_distribution<float> moveDistribution(-10.0f, 10.0f);
+  for (size_t index = 0; index < spheres.size(); index += 3) {
+    spheres[index].center += SSE::Vector3(moveDistribution(random), moveDistribution(random), moveDistribution(random));
+    bvh.moveProxy(proxies[index], spheres[index]);
+  }
+  for (size_t index = 1; index < spheres.size(); index += 2) {
+    bvh.destroyProxy(proxies[index]);
+    proxies[index] = Bounding_volume_hierarchy::invalid_proxy;
+  }
+  EXPECT_EQ(500u, bvh.proxyCount());
+
+  const auto querySphere = BoundingSphere(SSE::Vector3(10.0f, 10.0f, 10.0f), 40.0f);
+  EXPECT_EQ(querySphereBruteForce(querySphere), this->querySphere(querySphere));
+}
+
+TEST_F(BoundingVolumeHierarchyTest, ray_query_finds_nearest_sphere)
+{
+  const auto ray = Ray{SSE::Point3(0.0f, 0.0f, 500.0f), SSE::Vector3(0.0f, 0.0f, -1.0f)};
+
+  auto bruteForceDistance = FLT_MAX;
+  oe::Ray_intersection intersection;
+  for (const auto& sphere : spheres) {
+    if (oe::intersect_ray_sphere(ray, sphere, intersection)) {
+      bruteForceDistance = std::min(bruteForceDistance, intersection.distance);
+    }
+  }
+
+  auto bvhDistance = FLT_MAX;
+  bvh.queryRay(ray, FLT_MAX, [&](Entity* entity) {
+    if (oe::intersect_ray_sphere(ray, spheres[fakeEntityIndex(entity)], intersection)) {
+      bvhDistance = std::min(bvhDistance, intersection.distance);
+    }
+    return bvhDistance;
+  });
+
+  EXPECT_EQ(bruteForceDistance, bvhDistance);
+}
+
+TEST_F(BoundingVolumeHierarchyTest, concurrent_queries_match_brute_force)
+{
+  const auto querySphere = BoundingSphere(SSE::Vector3(-20.0f, 30.0f, 0.0f), 30.0f);
+  const auto expected = querySphereBruteForce(querySphere);
+
+  // Queries are const, and may run at the same time on different threads.
+  std::vector<std::vector<size_t>> results(4);
+  std::vector<std::thread> threads;
+  for (auto& result : results) {
+    threads.emplace_back([&]() {
+      for (int iteration = 0; iteration < 100; ++iteration) {
+        result = this->querySphere(querySphere);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& result : results) {
+    EXPECT_EQ(expected, result);
+  }
+}
+
+TEST_F(BoundingVolumeHierarchyTest, axis_aligned_ray_starting_on_a_box_plane_hits)
+{
+  // A box of its own, with no margin, so that its planes are exactly those of the sphere's bounds.
+  Bounding_volume_hierarchy singleBox(0.0f);
+  singleBox.createProxy(BoundingSphere(SSE::Vector3(5.0f, 0.0f, 0.0f), 1.0f), fakeEntity(0));
+
+  const auto countHits = [&singleBox](const Ray& ray) {
+    size_t hits = 0;
+    singleBox.queryRay(ray, FLT_MAX, [&hits](Entity*) {
+      ++hits;
+      return FLT_MAX;
+    });
+    return hits;
+  };
+
+  // Starts on the plane y = -1 of the box and travels along x, so its distances to the y planes are 0 * inf.
+  EXPECT_EQ(1u, countHits(Ray{SSE::Point3(0.0f, -1.0f, 0.0f), SSE::Vector3(1.0f, 0.0f, 0.0f)}));
+  EXPECT_EQ(1u, countHits(Ray{SSE::Point3(0.0f, 1.0f, 1.0f), SSE::Vector3(1.0f, 0.0f, 0.0f)}));
+  EXPECT_EQ(0u, countHits(Ray{SSE::Point3(0.0f, -1.01f, 0.0f), SSE::Vector3(1.0f, 0.0f, 0.0f)}));
+  // Pointing away from the box.
+  EXPECT_EQ(0u, countHits(Ray{SSE::Point3(0.0f, -1.0f, 0.0f), SSE::Vector3(-1.0f, 0.0f, 0.0f)}));
+}
@@ -0,0 +1,108 @@
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <OeCore/Component_pool.h>
+#include <OeCore/Test_component.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+using oe::Component_factory;
+using oe::Component_pool;
+using oe::Component_span;
+using oe::Entity;
+using oe::Entity_repository;
+using oe::Test_component;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+namespace {
+struct Pooled_value {
+  uint64_t value;
+};
+
+std::vector<std::pair<Pooled_value*, size_t>> collectSpans(const Component_pool& pool)
+{
+  std::vector<std::pair<Pooled_value*, size_t>> spans;
+  pool.forEachSpan<Pooled_value>(
+      [&](const Component_span<Pooled_value>& span) { spans.emplace_back(span.data(), span.size()); });
+  return spans;
+}
+} // namespace
+
+TEST(ComponentPoolTest, allocations_are_packed)
+{
+  Component_pool pool(sizeof(Pooled_value), alignof(Pooled_value), nullptr);
+  std::vector<void*> allocations;
+  for (size_t idx = 0; idx < Component_pool::chunk_capacity + 1; ++idx) {
+    allocations.push_back(pool.allocate());
+  }
+  EXPECT_EQ(2u, pool.chunkCount());
+  EXPECT_EQ(Component_pool::chunk_capacity + 1, pool.size());
+
+  auto spans = collectSpans(pool);
+  ASSERT_EQ(2u, spans.size());
+  EXPECT_EQ(allocations[0], spans[0].first);
+  EXPECT_EQ(Component_pool::chunk_capacity, spans[0].second);
+  EXPECT_EQ(1u, spans[1].second);
+
+  // Freeing a slot splits the span; the next allocation fills the hole.
+  pool.deallocate(allocations[10]);
+  spans = collectSpans(pool);
+  ASSERT_EQ(3u, spans.size());
+  EXPECT_EQ(10u, spans[0].second);
+  EXPECT_EQ(Component_pool::chunk_capacity - 11, spans[1].second);
+
+  EXPECT_EQ(allocations[10], pool.allocate());
+  EXPECT_EQ(2u, collectSpans(pool).size());
+
+  for (const auto allocation : allocations) {
+    EXPECT_TRUE(pool.owns(allocation));
+    pool.deallocate(allocation);
+  }
+  EXPECT_EQ(0u, pool.size());
+  EXPECT_TRUE(collectSpans(pool).empty());
+}
+
+TEST(ComponentPoolTest, components_are_allocated_from_their_pool)
+{
+  Component_factory::initStatics();
+  Test_component::initStatics();
+  EXPECT_EQ(&Test_component::componentPool(), Component_factory::componentPool(Test_component::type()));
+
+  Job_manager jobManager;
+  jobManager.initialize();
+  Scene_graph_manager sceneGraphManager{std::make_shared<Entity_repository>(), jobManager};
+  sceneGraphManager.initialize();
+
+  {
+    const auto& pool = Test_component::componentPool();
+    const auto initialSize = pool.size();
+
+    std::vector<std::shared_ptr<Entity>> entities;
+    std::vector<Test_component*> components;
+    for (auto idx = 0; idx < 10; ++idx) {
+      entities.push_back(sceneGraphManager.instantiate("Entity"));
+      components.push_back(&entities.back()->addComponent<Test_component>());
+      EXPECT_TRUE(pool.owns(components.back()));
+    }
+    EXPECT_EQ(initialSize + 10, pool.size());
+
+    size_t foundCount = 0;
+    pool.forEachComponent([&](oe::Component& component) {
+      if (std::find(components.begin(), components.end(), &component) != components.end()) {
+        ++foundCount;
+      }
+    });
+    EXPECT_EQ(10u, foundCount);
+
+    sceneGraphManager.destroyComponent(*components[0]);
+    EXPECT_EQ(initialSize + 9, pool.size());
+  }
+
+  sceneGraphManager.shutdown();
+  jobManager.shutdown();
+  Component_factory::destroyStatics();
+}
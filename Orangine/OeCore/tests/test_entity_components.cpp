@@ -0,0 +1,150 @@
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <OeCore/Camera_component.h>
+#include <OeCore/Light_component.h>
+#include <OeCore/Mesh_data_component.h>
+#include <OeCore/Skinned_mesh_component.h>
+#include <OeCore/Test_component.h>
+
+#include <gtest/gtest.h>
+
+using oe::Camera_component;
+using oe::Component_factory;
+using oe::Directional_light_component;
+using oe::Entity;
+using oe::Entity_repository;
+using oe::Light_component;
+using oe::Mesh_data;
+using oe::Mesh_data_component;
+using oe::Mesh_vertex_layout;
+using oe::Point_light_component;
+using oe::Skinned_mesh_component;
+using oe::Test_component;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+class EntityComponentsTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    Component_factory::initStatics();
+    Test_component::initStatics();
+    Camera_component::initStatics();
+    Directional_light_component::initStatics();
+    Point_light_component::initStatics();
+    Mesh_data_component::initStatics();
+    Skinned_mesh_component::initStatics();
+
+    jobManager.initialize();
+    sceneGraphManager.initialize();
+    entity = sceneGraphManager.instantiate("Entity");
+  }
+
+  void TearDown() override
+  {
+    entity.reset();
+    sceneGraphManager.shutdown();
+    jobManager.shutdown();
+    Component_factory::destroyStatics();
+  }
+
+  Job_manager jobManager;
+  Scene_graph_manager sceneGraphManager{std::make_shared<Entity_repository>(), jobManager};
+  std::shared_ptr<Entity> entity;
+};
+
+TEST_F(EntityComponentsTest, typed_lookup_finds_components)
+{
+  EXPECT_EQ(nullptr, entity->getFirstComponentOfType<Test_component>());
+
+  auto& camera = entity->addComponent<Camera_component>();
+  auto& first = entity->addComponent<Test_component>();
+  auto& second = entity->addComponent<Test_component>();
+
+  EXPECT_EQ(&camera, entity->getFirstComponentOfType<Camera_component>());
+  EXPECT_EQ(&first, entity->getFirstComponentOfType<Test_component>());
+
+  // Components of the same type are returned in the order they were added.
+  const auto testComponents = entity->getComponentsOfType<Test_component>();
+  ASSERT_EQ(2u, testComponents.size());
+  EXPECT_EQ(&first, &testComponents[0].get());
+  EXPECT_EQ(&second, &testComponents[1].get());
+}
+
+TEST_F(EntityComponentsTest, typed_lookup_after_destroy)
+{
+  auto& first = entity->addComponent<Test_component>();
+  auto& second = entity->addComponent<Test_component>();
+  auto& camera = entity->addComponent<Camera_component>();
+
+  sceneGraphManager.destroyComponent(first);
+  EXPECT_EQ(&second, entity->getFirstComponentOfType<Test_component>());
+  EXPECT_EQ(&camera, entity->getFirstComponentOfType<Camera_component>());
+
+  sceneGraphManager.destroyComponent(second);
+  EXPECT_EQ(nullptr, entity->getFirstComponentOfType<Test_component>());
+  EXPECT_EQ(1u, entity->getComponentCount());
+}
+
+TEST_F(EntityComponentsTest, base_type_lookup_matches_derived_components)
+{
+  auto& directional = entity->addComponent<Directional_light_component>();
+  auto& point = entity->addComponent<Point_light_component>();
+
+  // Light_component has no type id of its own, so it is found by dynamic_cast.
+  EXPECT_EQ(2u, entity->getComponentsOfType<Light_component>().size());
+  EXPECT_EQ(&directional, entity->getFirstComponentOfType<Light_component>());
+  EXPECT_EQ(&point, entity->getFirstComponentOfType<Point_light_component>());
+}
+
+TEST_F(EntityComponentsTest, skinning_palette_is_shared_until_skin_changes)
+{
+  const auto root = sceneGraphManager.instantiate("Root");
+  const auto joint = sceneGraphManager.instantiate("Joint", *root);
+  const auto otherMesh = sceneGraphManager.instantiate("Other_mesh");
+  root->setPosition({10.0f, 0.0f, 0.0f});
+  joint->setPosition({0.0f, 2.0f, 0.0f});
+  sceneGraphManager.tick();
+
+  auto& skinnedMesh = entity->addComponent<Skinned_mesh_component>();
+  auto& otherSkinnedMesh = otherMesh->addComponent<Skinned_mesh_component>();
+  for (auto* component : {&skinnedMesh, &otherSkinnedMesh}) {
+    component->setJoints({joint});
+    component->setInverseBindMatrices({SSE::Matrix4::identity()});
+    component->setSkeletonTransformRoot(root);
+  }
+
+  otherSkinnedMesh.shareSkinningPalette(skinnedMesh);
+  ASSERT_EQ(&skinnedMesh.skinningPalette(), &otherSkinnedMesh.skinningPalette());
+
+  // Bone transforms are relative to the skeleton transform root.
+  skinnedMesh.updateSkinningPalette();
+  const auto& boneTransforms = otherSkinnedMesh.skinningPalette().boneTransforms;
+  ASSERT_EQ(1u, boneTransforms.size());
+  EXPECT_FLOAT_EQ(0.0f, boneTransforms[0].getTranslation().getX());
+  EXPECT_FLOAT_EQ(2.0f, boneTransforms[0].getTranslation().getY());
+
+  otherSkinnedMesh.setSkeletonTransformRoot(otherMesh);
+  EXPECT_NE(&skinnedMesh.skinningPalette(), &otherSkinnedMesh.skinningPalette());
+}
+
+TEST_F(EntityComponentsTest, cloned_mesh_data_components_share_mesh_data)
+{
+  const auto child = sceneGraphManager.instantiate("Mesh", *entity);
+  const auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  const auto lodMeshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  auto& meshDataComponent = child->addComponent<Mesh_data_component>();
+  meshDataComponent.setMeshData(meshData);
+  meshDataComponent.setLods({{lodMeshData, 0.1f}});
+
+  const auto clone = sceneGraphManager.clone(*entity);
+  ASSERT_EQ(1u, clone->children().size());
+  const auto* clonedComponent = clone->children()[0]->getFirstComponentOfType<Mesh_data_component>();
+  ASSERT_NE(nullptr, clonedComponent);
+  EXPECT_NE(&meshDataComponent, clonedComponent);
+  EXPECT_EQ(meshData, clonedComponent->meshData());
+  ASSERT_EQ(2u, clonedComponent->lodCount());
+  EXPECT_EQ(lodMeshData, clonedComponent->lodMeshData(1));
+}
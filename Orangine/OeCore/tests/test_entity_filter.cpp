@@ -0,0 +1,148 @@
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <OeCore/Camera_component.h>
+#include <OeCore/Test_component.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+using oe::Camera_component;
+using oe::Component_factory;
+using oe::Entity;
+using oe::Entity_filter;
+using oe::Entity_filter_mode;
+using oe::Entity_repository;
+using oe::Test_component;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+class EntityFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    Component_factory::initStatics();
+    Test_component::initStatics();
+    Camera_component::initStatics();
+
+    jobManager.initialize();
+    sceneGraphManager.initialize();
+  }
+
+  void TearDown() override
+  {
+    sceneGraphManager.shutdown();
+    jobManager.shutdown();
+    Component_factory::destroyStatics();
+  }
+
+  // Returns a listener that counts add and remove events.
+  std::shared_ptr<Entity_filter::Entity_filter_listener> listen(Entity_filter& filter)
+  {
+    auto listener = std::make_shared<Entity_filter::Entity_filter_listener>();
+    listener->onAdd = [this](Entity*) { ++addCount; };
+    listener->onRemove = [this](Entity*) { ++removeCount; };
+    filter.add_listener(listener);
+    return listener;
+  }
+
+  static size_t size(const Entity_filter& filter) { return std::distance(filter.begin(), filter.end()); }
+
+  Job_manager jobManager;
+  Scene_graph_manager sceneGraphManager{std::make_shared<Entity_repository>(), jobManager};
+  int addCount = 0;
+  int removeCount = 0;
+};
+
+TEST_F(EntityFilterTest, all_mode_requires_every_type)
+{
+  const auto filter = sceneGraphManager.getEntityFilter({Test_component::type(), Camera_component::type()});
+  const auto listener = listen(*filter);
+
+  const auto entity = sceneGraphManager.instantiate("Entity");
+  entity->addComponent<Test_component>();
+  EXPECT_TRUE(filter->empty());
+
+  entity->addComponent<Camera_component>();
+  EXPECT_EQ(1u, size(*filter));
+
+  // A second component of a type the entity already has doesn't change membership.
+  auto& secondTestComponent = entity->addComponent<Test_component>();
+  sceneGraphManager.destroyComponent(secondTestComponent);
+  EXPECT_EQ(1u, size(*filter));
+  EXPECT_EQ(1, addCount);
+  EXPECT_EQ(0, removeCount);
+
+  sceneGraphManager.destroyComponent(*entity->getFirstComponentOfType<Camera_component>());
+  EXPECT_TRUE(filter->empty());
+  EXPECT_EQ(1, removeCount);
+}
+
+TEST_F(EntityFilterTest, any_mode_requires_one_type)
+{
+  const auto filter = sceneGraphManager.getEntityFilter(
+      {Test_component::type(), Camera_component::type()}, Entity_filter_mode::Any);
+  const auto listener = listen(*filter);
+
+  const auto entity = sceneGraphManager.instantiate("Entity");
+  entity->addComponent<Test_component>();
+  entity->addComponent<Camera_component>();
+  EXPECT_EQ(1u, size(*filter));
+  EXPECT_EQ(1, addCount);
+
+  sceneGraphManager.destroyComponent(*entity->getFirstComponentOfType<Test_component>());
+  EXPECT_EQ(1u, size(*filter));
+  EXPECT_EQ(0, removeCount);
+
+  sceneGraphManager.destroy(entity->getId());
+  EXPECT_TRUE(filter->empty());
+  EXPECT_EQ(1, removeCount);
+}
+
+TEST_F(EntityFilterTest, filters_are_shared)
+{
+  const auto filter = sceneGraphManager.getEntityFilter({Test_component::type(), Camera_component::type()});
+  EXPECT_EQ(filter, sceneGraphManager.getEntityFilter({Camera_component::type(), Test_component::type()}));
+  EXPECT_NE(filter, sceneGraphManager.getEntityFilter({Test_component::type()}));
+  EXPECT_NE(
+      filter,
+      sceneGraphManager.getEntityFilter(
+          {Test_component::type(), Camera_component::type()}, Entity_filter_mode::Any));
+}
+
+TEST_F(EntityFilterTest, members_are_ordered_by_insertion)
+{
+  const auto filter = sceneGraphManager.getEntityFilter({Test_component::type()});
+
+  std::vector<std::shared_ptr<Entity>> entities;
+  for (auto idx = 0; idx < 4; ++idx) {
+    entities.push_back(sceneGraphManager.instantiate("Entity"));
+    entities.back()->addComponent<Test_component>();
+  }
+  EXPECT_EQ(entities, std::vector<std::shared_ptr<Entity>>(filter->begin(), filter->end()));
+
+  // Removing a member moves the last member into its place.
+  sceneGraphManager.destroyComponent(*entities[1]->getFirstComponentOfType<Test_component>());
+  EXPECT_EQ(
+      std::vector<std::shared_ptr<Entity>>({entities[0], entities[3], entities[2]}),
+      std::vector<std::shared_ptr<Entity>>(filter->begin(), filter->end()));
+  EXPECT_FALSE(filter->contains(entities[1].get()));
+  EXPECT_TRUE(filter->contains(entities[3].get()));
+}
+
+TEST_F(EntityFilterTest, parallel_iteration_visits_every_member)
+{
+  const auto filter = sceneGraphManager.getEntityFilter({Test_component::type()});
+  for (auto idx = 0; idx < 1000; ++idx) {
+    sceneGraphManager.instantiate("Entity")->addComponent<Test_component>();
+  }
+
+  std::atomic<size_t> visitedCount = 0;
+  filter->parallelForEach(jobManager, 64, [&visitedCount](const Entity_filter::Span& span) {
+    EXPECT_LE(span.size(), 64u);
+    visitedCount += span.size();
+  });
+  EXPECT_EQ(1000u, visitedCount);
+}
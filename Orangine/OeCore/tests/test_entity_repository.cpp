@@ -0,0 +1,89 @@
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <gtest/gtest.h>
+
+using oe::Entity;
+using oe::Entity_repository;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+class EntityRepositoryTest : public ::testing::Test {
+ protected:
+  // Entities hold references to a scene graph and component factory, but the repository under test doesn't use them.
+  std::shared_ptr<Entity> instantiate(const std::string& name)
+  {
+    return repository.instantiate(name, sceneGraphManager, sceneGraphManager);
+  }
+
+  Job_manager jobManager;
+  Scene_graph_manager sceneGraphManager{std::make_shared<Entity_repository>(), jobManager};
+  Entity_repository repository;
+};
+
+TEST_F(EntityRepositoryTest, lookup_by_id)
+{
+  const auto entity = instantiate("Entity");
+  EXPECT_NE(Entity::invalid_id, entity->getId());
+  EXPECT_EQ(entity.get(), repository.findEntityById(entity->getId()));
+  EXPECT_EQ(entity, repository.getEntityPtrById(entity->getId()));
+  EXPECT_EQ(nullptr, repository.findEntityById(Entity::invalid_id));
+  EXPECT_EQ(1u, repository.size());
+}
+
+TEST_F(EntityRepositoryTest, removed_ids_are_not_reused)
+{
+  auto entity = instantiate("Entity");
+  const auto staleId = entity->getId();
+  repository.remove(staleId);
+  EXPECT_EQ(nullptr, repository.findEntityById(staleId));
+  EXPECT_EQ(0u, repository.size());
+
+  // Once the entity is destroyed its slot is reused, with a new generation.
+  entity.reset();
+  const auto newEntity = instantiate("New entity");
+  EXPECT_EQ(Entity::idIndex(staleId), Entity::idIndex(newEntity->getId()));
+  EXPECT_NE(staleId, newEntity->getId());
+  EXPECT_EQ(nullptr, repository.findEntityById(staleId));
+  EXPECT_EQ(newEntity.get(), repository.findEntityById(newEntity->getId()));
+}
+
+TEST_F(EntityRepositoryTest, slot_is_not_reused_while_referenced)
+{
+  const auto entity = instantiate("Entity");
+  const auto id = entity->getId();
+  repository.remove(id);
+
+  const auto newEntity = instantiate("New entity");
+  EXPECT_NE(Entity::idIndex(id), Entity::idIndex(newEntity->getId()));
+  EXPECT_EQ("Entity", entity->getName());
+}
+
+TEST_F(EntityRepositoryTest, entities_outlive_repository)
+{
+  std::shared_ptr<Entity> entity;
+  {
+    Entity_repository scopedRepository;
+    entity = scopedRepository.instantiate("Entity", sceneGraphManager, sceneGraphManager);
+  }
+  EXPECT_EQ("Entity", entity->getName());
+}
+
+TEST_F(EntityRepositoryTest, stale_ids_never_resolve_after_many_reuses)
+{
+  auto entity = instantiate("Entity");
+  const auto staleId = entity->getId();
+  repository.remove(staleId);
+  entity.reset();
+
+  // More reuses than there are generations, so the generation of the slot would wrap around to that of staleId.
+  for (uint32_t iteration = 0; iteration <= Entity::id_generation_mask + 1; ++iteration) {
+    entity = instantiate("Entity");
+    EXPECT_NE(staleId, entity->getId());
+    ASSERT_EQ(nullptr, repository.findEntityById(staleId));
+    repository.remove(entity->getId());
+    entity.reset();
+  }
+  EXPECT_EQ(0u, repository.size());
+}
@@ -0,0 +1,157 @@
+#include <OeCore/Entity_graph_loader_gltf.h>
+#include <OeCore/Mapped_file.h>
+#include <OeCore/Mesh_data.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using oe::Element_component;
+using oe::Element_type;
+using oe::Mapped_file;
+using oe::Mesh_vertex_buffer_accessor;
+using oe::Vertex_attribute;
+using oe::Vertex_attribute_element;
+namespace gltf_utils = oe::gltf_utils;
+
+namespace {
+constexpr uint32_t g_chunkTypeJson = 0x4E4F534A;
+constexpr uint32_t g_chunkTypeBin = 0x004E4942;
+
+void appendUint32(std::vector<uint8_t>& bytes, uint32_t value)
+{
+  const auto pos = bytes.size();
+  bytes.resize(pos + sizeof(value));
+  std::memcpy(bytes.data() + pos, &value, sizeof(value));
+}
+
+void appendChunk(std::vector<uint8_t>& bytes, uint32_t chunkType, const uint8_t* data, size_t size)
+{
+  appendUint32(bytes, static_cast<uint32_t>(size));
+  appendUint32(bytes, chunkType);
+  bytes.insert(bytes.end(), data, data + size);
+}
+
+// A .glb with a JSON chunk, then a BIN chunk holding the given floats. The JSON is padded with spaces to 4 bytes, unless
+// padJson is false.
+std::vector<uint8_t> createGlb(std::string json, const std::vector<float>& binFloats, bool padJson = true)
+{
+  while (padJson && json.size() % 4 != 0) {
+    json.push_back(' ');
+  }
+
+  std::vector<uint8_t> bytes = {'g', 'l', 'T', 'F'};
+  appendUint32(bytes, 2);
+  appendUint32(bytes, 0);
+  appendChunk(bytes, g_chunkTypeJson, reinterpret_cast<const uint8_t*>(json.data()), json.size());
+  appendChunk(bytes, g_chunkTypeBin, reinterpret_cast<const uint8_t*>(binFloats.data()), binFloats.size() * 4);
+
+  const auto totalLength = static_cast<uint32_t>(bytes.size());
+  std::memcpy(bytes.data() + 8, &totalLength, sizeof(totalLength));
+  return bytes;
+}
+
+const std::string g_json = R"({"asset":{"version":"2.0"}})";
+
+class GltfUtilsTest : public ::testing::Test {
+ protected:
+  void TearDown() override
+  {
+    for (const auto& path : _paths) {
+      std::filesystem::remove(path);
+    }
+  }
+
+  // Writes the bytes to a file in the temp directory, which is deleted once the test finishes.
+  std::string writeFile(const std::string& filename, const std::vector<uint8_t>& bytes)
+  {
+    const auto path = std::filesystem::temp_directory_path() / filename;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    file.close();
+    _paths.push_back(path);
+    return path.string();
+  }
+
+ private:
+  std::vector<std::filesystem::path> _paths;
+};
+} // namespace
+
+TEST_F(GltfUtilsTest, glb_bin_chunk_is_viewed_in_place)
+{
+  const std::vector<float> positions = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  auto mappedFile = std::make_shared<Mapped_file>(writeFile("oe_valid.glb", createGlb(g_json, positions)));
+  ASSERT_TRUE(gltf_utils::is_glb(mappedFile->data(), mappedFile->size()));
+
+  size_t binChunkOffset = 0;
+  size_t binChunkSize = 0;
+  ASSERT_TRUE(gltf_utils::find_glb_bin_chunk(mappedFile->data(), mappedFile->size(), binChunkOffset, binChunkSize));
+  EXPECT_EQ(12u + 8u + 28u + 8u, binChunkOffset);
+  EXPECT_EQ(positions.size() * sizeof(float), binChunkSize);
+
+  const auto binChunkBuffer = gltf_utils::map_glb_bin_chunk(mappedFile);
+  ASSERT_NE(nullptr, binChunkBuffer);
+  EXPECT_EQ(mappedFile->data() + binChunkOffset, binChunkBuffer->data);
+  EXPECT_EQ(binChunkSize, binChunkBuffer->dataSize);
+
+  // Accessors read the mapped file itself, which the buffer keeps mapped.
+  const Mesh_vertex_buffer_accessor accessor(
+      binChunkBuffer,
+      Vertex_attribute_element{{Vertex_attribute::Position, 0}, Element_type::Vector3, Element_component::Float},
+      2,
+      12,
+      0);
+  const auto mappedData = mappedFile->data();
+  mappedFile.reset();
+
+  EXPECT_EQ(mappedData + binChunkOffset + 12, accessor.getIndexed(1));
+  float secondPosition[3];
+  std::memcpy(secondPosition, accessor.getIndexed(1), sizeof(secondPosition));
+  EXPECT_EQ(4.0f, secondPosition[0]);
+  EXPECT_EQ(5.0f, secondPosition[1]);
+  EXPECT_EQ(6.0f, secondPosition[2]);
+}
+
+TEST_F(GltfUtilsTest, truncated_chunk_table_has_no_bin_chunk)
+{
+  const auto glb = createGlb(g_json, {1.0f, 2.0f, 3.0f});
+
+  // Ends part way through the BIN chunk's data, then part way through its header.
+  for (const auto size : {glb.size() - 4, size_t(12 + 8 + 28 + 4)}) {
+    SCOPED_TRACE("Size " + std::to_string(size));
+    const auto truncated = std::vector<uint8_t>(glb.begin(), glb.begin() + size);
+    const auto mappedFile = std::make_shared<Mapped_file>(writeFile("oe_truncated.glb", truncated));
+    ASSERT_TRUE(gltf_utils::is_glb(mappedFile->data(), mappedFile->size()));
+
+    size_t binChunkOffset = 0;
+    size_t binChunkSize = 0;
+    EXPECT_FALSE(
+        gltf_utils::find_glb_bin_chunk(mappedFile->data(), mappedFile->size(), binChunkOffset, binChunkSize));
+    EXPECT_EQ(nullptr, gltf_utils::map_glb_bin_chunk(mappedFile));
+  }
+}
+
+TEST_F(GltfUtilsTest, misaligned_chunk_table_has_no_bin_chunk)
+{
+  // The JSON chunk isn't padded, so the BIN chunk would start at an offset that floats can't be read from in place.
+  const auto glb = createGlb(g_json, {1.0f, 2.0f, 3.0f}, false);
+  const auto mappedFile = std::make_shared<Mapped_file>(writeFile("oe_misaligned.glb", glb));
+
+  size_t binChunkOffset = 0;
+  size_t binChunkSize = 0;
+  EXPECT_FALSE(gltf_utils::find_glb_bin_chunk(mappedFile->data(), mappedFile->size(), binChunkOffset, binChunkSize));
+  EXPECT_EQ(nullptr, gltf_utils::map_glb_bin_chunk(mappedFile));
+}
+
+TEST_F(GltfUtilsTest, empty_file_is_not_glb)
+{
+  const auto mappedFile = std::make_shared<Mapped_file>(writeFile("oe_empty.glb", {}));
+  EXPECT_EQ(nullptr, mappedFile->data());
+  EXPECT_EQ(0u, mappedFile->size());
+
+  EXPECT_FALSE(gltf_utils::is_glb(mappedFile->data(), mappedFile->size()));
+  EXPECT_EQ(nullptr, gltf_utils::map_glb_bin_chunk(mappedFile));
+}
@@ -0,0 +1,100 @@
+#include "Job_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using oe::internal::Job_manager;
+
+TEST(JobManagerTest, parallel_for_visits_each_index_once)
+{
+  Job_manager jobManager;
+  jobManager.preInit_setWorkerCount(4);
+  jobManager.initialize();
+
+  std::vector<std::atomic<uint32_t>> visitCounts(10000);
+  jobManager.parallelFor(visitCounts.size(), 100, [&visitCounts](size_t begin, size_t end) {
+    for (auto idx = begin; idx < end; ++idx) {
+      ++visitCounts[idx];
+    }
+  });
+
+  for (const auto& visitCount : visitCounts) {
+    ASSERT_EQ(1u, visitCount.load());
+  }
+
+  jobManager.shutdown();
+}
+
+TEST(JobManagerTest, parallel_for_rethrows_job_exceptions)
+{
+  Job_manager jobManager;
+  jobManager.preInit_setWorkerCount(4);
+  jobManager.initialize();
+
+  EXPECT_THROW(
+      jobManager.parallelFor(
+          100,
+          10,
+          [](size_t begin, size_t) {
+            if (begin == 50) {
+              throw std::runtime_error("Job failed");
+            }
+          }),
+      std::runtime_error);
+
+  jobManager.shutdown();
+}
+
+TEST(JobManagerTest, waiting_thread_does_not_run_jobs_of_other_threads)
+{
+  Job_manager jobManager;
+  jobManager.preInit_setWorkerCount(4);
+  jobManager.initialize();
+
+  // While this thread runs the first job of its parallelFor, another thread (such as a background load) queues slow
+  // jobs behind the rest of it. Waiting on its own jobs, this thread must leave those to the workers.
+  std::atomic<bool> firstJobStarted = false;
+  std::atomic<bool> otherJobsQueued = false;
+  std::mutex otherThreadIdsMutex;
+  std::set<std::thread::id> otherThreadIds;
+  std::thread otherThread([&]() {
+    while (!firstJobStarted) {
+      std::this_thread::yield();
+    }
+    jobManager.parallelFor(32, 1, [&](size_t, size_t) {
+      {
+        std::lock_guard<std::mutex> lock(otherThreadIdsMutex);
+        otherThreadIds.insert(std::this_thread::get_id());
+      }
+      otherJobsQueued = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+  });
+
+  std::atomic<size_t> sum = 0;
+  jobManager.parallelFor(16, 1, [&](size_t begin, size_t) {
+    if (begin == 0) {
+      firstJobStarted = true;
+      while (!otherJobsQueued) {
+        std::this_thread::yield();
+      }
+    } else {
+      // Keeps the workers busy, so that this thread is still waiting once the other jobs are queued.
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    sum += begin;
+  });
+  EXPECT_EQ(16u * 15u / 2u, sum);
+
+  otherThread.join();
+  EXPECT_EQ(0u, otherThreadIds.count(std::this_thread::get_id()));
+
+  jobManager.shutdown();
+}
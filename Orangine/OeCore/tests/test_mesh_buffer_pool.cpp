@@ -0,0 +1,143 @@
+#include "mesh_test_utils.h"
+
+#include <OeCore/Mesh_buffer_pool.h>
+#include <OeCore/Mesh_data.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+
+using oe::Element_component;
+using oe::Mesh_buffer;
+using oe::Mesh_buffer_pool;
+using oe::Mesh_data;
+using oe::Mesh_index_buffer_accessor;
+using oe::Vertex_attribute;
+namespace mesh_test_utils = oe::mesh_test_utils;
+
+namespace {
+// A quad. Each is created with its own buffers, as when the same asset is loaded by two files.
+std::shared_ptr<Mesh_data> createMesh()
+{
+  auto meshData = mesh_test_utils::create_mesh_data<uint16_t>(
+      {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}}, {0, 1, 2, 2, 1, 3});
+  const std::vector<SSE::Vector3> normals(4, SSE::Vector3(0.0f, 0.0f, 1.0f));
+  meshData->vertexBufferAccessors[{Vertex_attribute::Normal, 0}] =
+      mesh_test_utils::create_float3_accessor(normals, Vertex_attribute::Normal);
+  return meshData;
+}
+} // namespace
+
+TEST(MeshBufferPoolTest, identical_contents_share_a_buffer)
+{
+  Mesh_buffer_pool pool;
+  const std::vector<uint8_t> bytes = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+  const auto first = pool.findOrCreate(bytes.data(), bytes.size());
+  const auto second = pool.findOrCreate(bytes.data(), bytes.size());
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(0, std::memcmp(bytes.data(), first->data, bytes.size()));
+
+  // Same hash input length, different contents.
+  const std::vector<uint8_t> otherBytes = {1, 2, 3, 4, 5, 6, 7, 8, 0};
+  EXPECT_NE(first, pool.findOrCreate(otherBytes.data(), otherBytes.size()));
+  // A prefix of the contents is a different buffer.
+  EXPECT_NE(first, pool.findOrCreate(bytes.data(), bytes.size() - 1));
+
+  const auto statistics = pool.statistics();
+  EXPECT_EQ(1u, statistics.bufferCount);
+  EXPECT_EQ(bytes.size(), statistics.bufferBytes);
+  EXPECT_EQ(1u, statistics.sharedCount);
+  EXPECT_EQ(bytes.size(), statistics.sharedBytes);
+}
+
+TEST(MeshBufferPoolTest, freed_buffers_leave_the_pool)
+{
+  Mesh_buffer_pool pool;
+  const std::vector<uint8_t> bytes = {1, 2, 3, 4};
+
+  std::weak_ptr<Mesh_buffer> weakBuffer = pool.findOrCreate(bytes.data(), bytes.size());
+  EXPECT_TRUE(weakBuffer.expired());
+  EXPECT_EQ(0u, pool.statistics().bufferCount);
+  EXPECT_EQ(0u, pool.statistics().bufferBytes);
+
+  const auto buffer = pool.findOrCreate(bytes.data(), bytes.size());
+  EXPECT_EQ(1u, pool.statistics().bufferCount);
+  EXPECT_EQ(0u, pool.statistics().sharedCount);
+}
+
+TEST(MeshBufferPoolTest, accessors_share_only_the_bytes_they_read)
+{
+  Mesh_buffer_pool pool;
+
+  // Two elements of 3 bytes, 4 apart, after a 2 byte header; bytes after the last stride aren't read.
+  const auto interleaved = mesh_test_utils::create_buffer<uint8_t>({9, 9, 10, 11, 12, 0, 20, 21, 22, 0, 9, 9});
+  Mesh_index_buffer_accessor interleavedAccessor(interleaved, Element_component::Unsigned_byte, 2, 4, 2);
+  pool.share(interleavedAccessor, 3);
+  EXPECT_NE(interleaved, interleavedAccessor.buffer);
+  EXPECT_EQ(0u, interleavedAccessor.offset);
+  EXPECT_EQ(8u, interleavedAccessor.buffer->dataSize);
+  EXPECT_EQ(20, *interleavedAccessor.getIndexed(1));
+
+  // The same elements, in a buffer of their own.
+  const auto own = mesh_test_utils::create_buffer<uint8_t>({10, 11, 12, 0, 20, 21, 22, 0});
+  Mesh_index_buffer_accessor ownAccessor(own, Element_component::Unsigned_byte, 2, 4, 0);
+  pool.share(ownAccessor, 3);
+  EXPECT_EQ(interleavedAccessor.buffer, ownAccessor.buffer);
+
+  // Sharing again changes nothing.
+  pool.share(ownAccessor, 3);
+  EXPECT_EQ(interleavedAccessor.buffer, ownAccessor.buffer);
+
+  const auto statistics = pool.statistics();
+  EXPECT_EQ(1u, statistics.bufferCount);
+  EXPECT_EQ(8u, statistics.bufferBytes);
+  EXPECT_EQ(1u, statistics.sharedCount);
+}
+
+TEST(MeshBufferPoolTest, identical_meshes_share_buffers)
+{
+  Mesh_buffer_pool pool;
+  const auto first = createMesh();
+  const auto second = createMesh();
+  ASSERT_NE(first->indexBufferAccessor->buffer, second->indexBufferAccessor->buffer);
+
+  pool.share(*first);
+  const auto bytesAfterFirst = pool.statistics().bufferBytes;
+  pool.share(*second);
+
+  EXPECT_EQ(first->indexBufferAccessor->buffer, second->indexBufferAccessor->buffer);
+  ASSERT_EQ(first->vertexBufferAccessors.size(), second->vertexBufferAccessors.size());
+  for (const auto& [semantic, accessor] : first->vertexBufferAccessors) {
+    EXPECT_EQ(accessor->buffer, second->vertexBufferAccessors.at(semantic)->buffer);
+  }
+
+  const auto statistics = pool.statistics();
+  EXPECT_EQ(bytesAfterFirst, statistics.bufferBytes);
+  EXPECT_EQ(bytesAfterFirst, statistics.sharedBytes);
+  EXPECT_EQ(first->vertexBufferAccessors.size() + 1, statistics.sharedCount);
+}
+
+TEST(MeshBufferPoolTest, parallel_sharing_resolves_to_one_buffer)
+{
+  Mesh_buffer_pool pool;
+  constexpr size_t threadCount = 8;
+  std::vector<std::shared_ptr<Mesh_data>> meshes;
+  for (size_t idx = 0; idx < threadCount; ++idx) {
+    meshes.push_back(createMesh());
+  }
+
+  std::vector<std::thread> threads;
+  for (const auto& meshData : meshes) {
+    threads.emplace_back([&pool, meshData]() { pool.share(*meshData); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& meshData : meshes) {
+    EXPECT_EQ(meshes.front()->indexBufferAccessor->buffer, meshData->indexBufferAccessor->buffer);
+  }
+  EXPECT_EQ(meshes.front()->vertexBufferAccessors.size() + 1, pool.statistics().bufferCount);
+}
@@ -0,0 +1,132 @@
+#include "mesh_test_utils.h"
+
+#include <OeCore/Math_constants.h>
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Mesh_deformer.h>
+
+#include <gtest/gtest.h>
+
+using oe::Deformed_mesh;
+using oe::Element_component;
+using oe::Element_type;
+using oe::Mesh_data;
+using oe::Mesh_deformer;
+using oe::Mesh_vertex_buffer_accessor;
+using oe::Mesh_vertex_layout;
+using oe::Vertex_attribute;
+namespace mesh_test_utils = oe::mesh_test_utils;
+
+namespace {
+// A triangle in the XY plane, with a morph target that raises it along Z. Vertex 0 follows joint 0, vertex 1 follows
+// joint 1, and vertex 2 is split evenly between them.
+std::shared_ptr<Mesh_data> createSkinnedMorphedTriangle()
+{
+  auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  meshData->vertexBufferAccessors[{Vertex_attribute::Position, 0}] = mesh_test_utils::create_vertex_accessor<float>(
+      {0, 0, 0, 1, 0, 0, 0, 1, 0}, Vertex_attribute::Position, Element_type::Vector3, Element_component::Float, 3);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Joints, 0}] = mesh_test_utils::create_vertex_accessor<uint8_t>(
+      {0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0},
+      Vertex_attribute::Joints,
+      Element_type::Vector4,
+      Element_component::Unsigned_byte,
+      4);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Weights, 0}] = mesh_test_utils::create_vertex_accessor<uint8_t>(
+      {255, 0, 0, 0, 255, 0, 0, 0, 128, 127, 0, 0},
+      Vertex_attribute::Weights,
+      Element_type::Vector4,
+      Element_component::Unsigned_byte,
+      4);
+
+  std::vector<std::unique_ptr<Mesh_vertex_buffer_accessor>> morphTarget;
+  morphTarget.push_back(mesh_test_utils::create_vertex_accessor<float>(
+      {0, 0, 2, 0, 0, 2, 0, 0, 2}, Vertex_attribute::Position, Element_type::Vector3, Element_component::Float, 3));
+  meshData->attributeMorphBufferAccessors.push_back(std::move(morphTarget));
+  return meshData;
+}
+} // namespace
+
+TEST(MeshDeformerTest, applies_morph_targets_then_skinning)
+{
+  const auto meshData = createSkinnedMorphedTriangle();
+  const Mesh_deformer deformer(*meshData);
+  ASSERT_EQ(3u, deformer.vertexCount());
+  ASSERT_EQ(1u, deformer.morphTargetCount());
+  ASSERT_TRUE(deformer.skinned());
+
+  const float morphWeights[] = {0.5f};
+  const std::vector<SSE::Matrix4> boneTransforms = {
+      SSE::Matrix4::identity(), SSE::Matrix4::translation({10.0f, 0.0f, 0.0f})};
+  Deformed_mesh deformedMesh;
+  deformer.deform(morphWeights, 1, boneTransforms, deformedMesh);
+
+  ASSERT_EQ(3u, deformedMesh.positions.size());
+  EXPECT_TRUE(deformedMesh.normals.empty());
+  EXPECT_FLOAT_EQ(0.0f, deformedMesh.positions[0].getX());
+  EXPECT_FLOAT_EQ(1.0f, deformedMesh.positions[0].getZ());
+  EXPECT_FLOAT_EQ(11.0f, deformedMesh.positions[1].getX());
+  EXPECT_FLOAT_EQ(1.0f, deformedMesh.positions[1].getZ());
+  EXPECT_NEAR(5.0f, deformedMesh.positions[2].getX(), 0.05f);
+  EXPECT_FLOAT_EQ(1.0f, deformedMesh.positions[2].getY());
+
+  // Without a palette, the mesh is only morphed.
+  deformer.deform(morphWeights, 1, {}, deformedMesh);
+  EXPECT_FLOAT_EQ(1.0f, deformedMesh.positions[1].getX());
+}
+
+TEST(MeshDeformerTest, intersects_ray_with_posed_triangles)
+{
+  const auto meshData = createSkinnedMorphedTriangle();
+  const Mesh_deformer deformer(*meshData);
+
+  const float morphWeights[] = {1.0f};
+  Deformed_mesh deformedMesh;
+  deformer.deform(morphWeights, 1, {}, deformedMesh);
+
+  const auto bounds = Mesh_deformer::boundingSphere(deformedMesh);
+  EXPECT_FLOAT_EQ(2.0f, bounds.center.getZ());
+
+  oe::Ray_intersection intersection;
+  const oe::Ray hitRay = {{0.25f, 0.25f, 10.0f}, {0.0f, 0.0f, -1.0f}};
+  ASSERT_TRUE(deformer.intersectRay(hitRay, deformedMesh, intersection));
+  EXPECT_FLOAT_EQ(8.0f, intersection.distance);
+
+  const oe::Ray missRay = {{2.0f, 2.0f, 10.0f}, {0.0f, 0.0f, -1.0f}};
+  EXPECT_FALSE(deformer.intersectRay(missRay, deformedMesh, intersection));
+}
+
+TEST(MeshDeformerTest, skins_normals_without_producing_nan)
+{
+  // Vertex 0 follows a bone that scales to nothing, vertex 1 a rotated bone, and vertex 2 has no weights.
+  auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  meshData->vertexBufferAccessors[{Vertex_attribute::Position, 0}] = mesh_test_utils::create_vertex_accessor<float>(
+      {0, 0, 0, 1, 0, 0, 0, 1, 0}, Vertex_attribute::Position, Element_type::Vector3, Element_component::Float, 3);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Normal, 0}] = mesh_test_utils::create_vertex_accessor<float>(
+      {0, 0, 1, 0, 0, 1, 0, 0, 1}, Vertex_attribute::Normal, Element_type::Vector3, Element_component::Float, 3);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Joints, 0}] = mesh_test_utils::create_vertex_accessor<uint8_t>(
+      {0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0},
+      Vertex_attribute::Joints,
+      Element_type::Vector4,
+      Element_component::Unsigned_byte,
+      4);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Weights, 0}] = mesh_test_utils::create_vertex_accessor<uint8_t>(
+      {255, 0, 0, 0, 255, 0, 0, 0, 0, 0, 0, 0},
+      Vertex_attribute::Weights,
+      Element_type::Vector4,
+      Element_component::Unsigned_byte,
+      4);
+  const Mesh_deformer deformer(*meshData);
+  ASSERT_TRUE(deformer.hasNormals());
+
+  const std::vector<SSE::Matrix4> boneTransforms = {
+      SSE::Matrix4::scale(SSE::Vector3(0.0f)), SSE::Matrix4::rotationY(oe::math::pi_div_2)};
+  Deformed_mesh deformedMesh;
+  deformer.deform(nullptr, 0, boneTransforms, deformedMesh);
+
+  ASSERT_EQ(3u, deformedMesh.normals.size());
+  EXPECT_FLOAT_EQ(0.0f, deformedMesh.positions[0].getX());
+  EXPECT_FLOAT_EQ(1.0f, deformedMesh.normals[0].getZ());
+  EXPECT_NEAR(1.0f, deformedMesh.normals[1].getX(), 1e-5f);
+  EXPECT_NEAR(-1.0f, deformedMesh.positions[1].getZ(), 1e-5f);
+  EXPECT_FLOAT_EQ(1.0f, deformedMesh.positions[2].getY());
+  EXPECT_FLOAT_EQ(1.0f, deformedMesh.normals[2].getZ());
+}
@@ -0,0 +1,162 @@
+#include "mesh_test_utils.h"
+
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Mesh_optimizer.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <set>
+
+using oe::Mesh_data;
+using oe::Mesh_optimizer;
+using oe::Mesh_optimizer_options;
+using oe::Mesh_vertex_buffer_accessor;
+using oe::Vertex_attribute;
+namespace mesh_test_utils = oe::mesh_test_utils;
+
+namespace {
+constexpr uint32_t g_cacheSize = 16;
+constexpr uint32_t g_gridSize = 48;
+
+std::array<float, 3> readFloat3(const Mesh_vertex_buffer_accessor& accessor, size_t idx)
+{
+  std::array<float, 3> value;
+  std::memcpy(value.data(), accessor.getIndexed(idx), sizeof(value));
+  return value;
+}
+
+/*
+ * A hill of g_gridSize x g_gridSize vertices, with its triangles in random order. The morph target moves each vertex by
+ * twice its position, so that tests can check that the streams are still in step after reordering.
+ */
+std::shared_ptr<Mesh_data> createShuffledHill()
+{
+  std::vector<SSE::Vector3> positions;
+  std::vector<uint32_t> gridIndices;
+  mesh_test_utils::create_grid(g_gridSize, mesh_test_utils::hill, positions, gridIndices);
+
+  std::vector<std::array<uint32_t, 3>> triangles;
+  for (size_t idx = 0; idx < gridIndices.size(); idx += 3) {
+    triangles.push_back({gridIndices[idx], gridIndices[idx + 1], gridIndices[idx + 2]});
+  }
+  std::mt19937 random(1234);
+  std::shuffle(triangles.begin(), triangles.end(), random);
+
+  std::vector<uint32_t> indices;
+  for (const auto& triangle : triangles) {
+    indices.insert(indices.end(), triangle.begin(), triangle.end());
+  }
+  auto meshData = mesh_test_utils::create_mesh_data<uint32_t>(positions, indices);
+
+  std::vector<SSE::Vector3> morphDeltas;
+  for (const auto& position : positions) {
+    morphDeltas.push_back(position * 2.0f);
+  }
+  mesh_test_utils::add_morph_target(*meshData, morphDeltas);
+  return meshData;
+}
+
+// Each triangle as the positions of its corners, starting from the smallest so that winding is kept.
+std::multiset<std::array<float, 9>> triangleSet(const Mesh_data& meshData)
+{
+  const auto& positions = *meshData.vertexBufferAccessors.at({Vertex_attribute::Position, 0});
+  const auto indices = mesh_test_utils::read_indices(*meshData.indexBufferAccessor);
+  std::multiset<std::array<float, 9>> triangles;
+  for (size_t idx = 0; idx < indices.size(); idx += 3) {
+    std::array<std::array<float, 3>, 3> corners = {
+        readFloat3(positions, indices[idx]), readFloat3(positions, indices[idx + 1]),
+        readFloat3(positions, indices[idx + 2])};
+    std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+
+    std::array<float, 9> triangle;
+    for (size_t corner = 0; corner < 3; ++corner) {
+      std::copy(corners[corner].begin(), corners[corner].end(), triangle.begin() + corner * 3);
+    }
+    triangles.insert(triangle);
+  }
+  return triangles;
+}
+
+void expectSameMeshAfterOptimizing(const Mesh_optimizer_options& options)
+{
+  const auto meshData = createShuffledHill();
+  const auto trianglesBefore = triangleSet(*meshData);
+  const auto report = Mesh_optimizer::optimize(*meshData, options);
+
+  EXPECT_GT(report.before.acmr, 2.0f);
+  EXPECT_LT(report.after.acmr, report.before.acmr * 0.5f);
+  EXPECT_LT(report.after.atvr, report.before.atvr * 0.5f);
+  EXPECT_FLOAT_EQ(report.after.acmr, Mesh_optimizer::analyzeVertexCache(*meshData, options.cacheSize).acmr);
+
+  EXPECT_EQ(trianglesBefore, triangleSet(*meshData));
+
+  // The morph target was reordered along with the positions.
+  const auto& positions = *meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0});
+  const auto& morphDeltas = *meshData->attributeMorphBufferAccessors[0][0];
+  for (uint32_t idx = 0; idx < positions.count; ++idx) {
+    const auto position = readFloat3(positions, idx);
+    const auto morphDelta = readFloat3(morphDeltas, idx);
+    for (size_t component = 0; component < 3; ++component) {
+      ASSERT_EQ(2 * position[component], morphDelta[component]) << "vertex " << idx;
+    }
+  }
+}
+} // namespace
+
+TEST(MeshOptimizerTest, analyzes_vertex_cache)
+{
+  const auto single = Mesh_optimizer::analyzeVertexCache({0, 1, 2}, g_cacheSize);
+  EXPECT_FLOAT_EQ(3.0f, single.acmr);
+  EXPECT_FLOAT_EQ(1.0f, single.atvr);
+
+  // The second triangle reuses two cached vertices.
+  const auto pair = Mesh_optimizer::analyzeVertexCache({0, 1, 2, 2, 1, 3}, g_cacheSize);
+  EXPECT_FLOAT_EQ(2.0f, pair.acmr);
+  EXPECT_FLOAT_EQ(1.0f, pair.atvr);
+
+  // With a cache of 3 entries, vertex 0 has been evicted by the time the last triangle uses it again.
+  const auto evicted = Mesh_optimizer::analyzeVertexCache({0, 1, 2, 3, 4, 5, 0, 1, 2}, 3);
+  EXPECT_FLOAT_EQ(3.0f, evicted.acmr);
+  EXPECT_FLOAT_EQ(1.5f, evicted.atvr);
+}
+
+TEST(MeshOptimizerTest, reorders_triangles_and_vertices)
+{
+  expectSameMeshAfterOptimizing({});
+
+  // Vertices are in the order the triangles first use them.
+  const auto meshData = createShuffledHill();
+  Mesh_optimizer::optimize(*meshData, {});
+  uint32_t nextVertex = 0;
+  for (const auto index : mesh_test_utils::read_indices(*meshData->indexBufferAccessor)) {
+    ASSERT_LE(index, nextVertex);
+    if (index == nextVertex) {
+      ++nextVertex;
+    }
+  }
+  EXPECT_EQ(g_gridSize * g_gridSize, nextVertex);
+}
+
+TEST(MeshOptimizerTest, optimizes_overdraw)
+{
+  Mesh_optimizer_options options;
+  options.optimizeOverdraw = true;
+  expectSameMeshAfterOptimizing(options);
+}
+
+TEST(MeshOptimizerTest, leaves_non_indexed_meshes_unchanged)
+{
+  auto meshData = createShuffledHill();
+  meshData->indexBufferAccessor.reset();
+  const auto* positions = meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0}).get();
+
+  const auto report = Mesh_optimizer::optimize(*meshData, {});
+  EXPECT_EQ(0.0f, report.before.acmr);
+  EXPECT_EQ(0.0f, report.after.acmr);
+  EXPECT_EQ(positions, meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0}).get());
+}
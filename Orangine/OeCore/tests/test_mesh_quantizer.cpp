@@ -0,0 +1,184 @@
+#include "mesh_test_utils.h"
+
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Mesh_quantizer.h>
+#include <OeCore/Mesh_utils.h>
+#include <OeCore/Primitive_mesh_data_factory.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+using oe::Element_component;
+using oe::Element_encoding;
+using oe::Element_type;
+using oe::Mesh_data;
+using oe::Mesh_quantizer;
+using oe::Mesh_quantizer_options;
+using oe::Mesh_vertex_layout;
+using oe::Primitive_mesh_data_factory;
+using oe::Tex_coord_quantization;
+using oe::Vertex_attribute;
+namespace mesh_test_utils = oe::mesh_test_utils;
+namespace mesh_utils = oe::mesh_utils;
+
+namespace {
+constexpr uint32_t g_gridSize = 17;
+
+// A wavy g_gridSize x g_gridSize patch, with analytic normals, tangents of alternating handedness, and UVs.
+std::shared_ptr<Mesh_data> createWavyPatch()
+{
+  std::vector<SSE::Vector3> grid;
+  std::vector<uint32_t> indices;
+  mesh_test_utils::create_grid(g_gridSize, mesh_test_utils::flat, grid, indices);
+
+  std::vector<SSE::Vector4> positions, normals, tangents, texCoords;
+  for (uint32_t idx = 0; idx < grid.size(); ++idx) {
+    const auto u = grid[idx].getX();
+    const auto v = grid[idx].getZ();
+    const auto slope = 2.0f * std::cos(u * 4.0f);
+    const auto handedness = (idx % g_gridSize + idx / g_gridSize) % 2 ? -1.0f : 1.0f;
+    positions.emplace_back(u * 10.0f - 3.0f, 5.0f * std::sin(u * 4.0f) / 4.0f, v * 7.0f + 2.0f, 0.0f);
+    normals.emplace_back(SSE::normalize(SSE::Vector3(-slope, 1.0f, 0.0f)), 0.0f);
+    tangents.emplace_back(SSE::normalize(SSE::Vector3(1.0f, slope, 0.0f)), handedness);
+    texCoords.emplace_back(u * 3.0f, v * 3.0f - 1.0f, 0.0f, 0.0f);
+  }
+
+  auto meshData = std::make_shared<Mesh_data>(Mesh_vertex_layout({}));
+  meshData->indexBufferAccessor =
+      mesh_test_utils::create_index_accessor(std::vector<uint16_t>(indices.begin(), indices.end()));
+  meshData->vertexBufferAccessors[{Vertex_attribute::Position, 0}] =
+      mesh_test_utils::create_float_accessor(Vertex_attribute::Position, Element_type::Vector3, positions);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Normal, 0}] =
+      mesh_test_utils::create_float_accessor(Vertex_attribute::Normal, Element_type::Vector3, normals);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Tangent, 0}] =
+      mesh_test_utils::create_float_accessor(Vertex_attribute::Tangent, Element_type::Vector4, tangents);
+  meshData->vertexBufferAccessors[{Vertex_attribute::Tex_coord, 0}] =
+      mesh_test_utils::create_float_accessor(Vertex_attribute::Tex_coord, Element_type::Vector2, texCoords);
+  return meshData;
+}
+
+std::vector<SSE::Vector4> readElements(const Mesh_data& meshData, Vertex_attribute attribute)
+{
+  const auto& accessor = *meshData.vertexBufferAccessors.at({attribute, 0});
+  std::vector<SSE::Vector4> values(accessor.count);
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    values[idx] = mesh_utils::read_vertex_element(accessor, idx);
+  }
+  return values;
+}
+
+float angleBetween(const SSE::Vector3& a, const SSE::Vector3& b)
+{
+  return std::acos(std::min(1.0f, SSE::dot(SSE::normalize(a), SSE::normalize(b))));
+}
+} // namespace
+
+TEST(MeshQuantizerTest, decodes_within_the_precision_of_each_encoding)
+{
+  const auto original = createWavyPatch();
+  const auto quantized = createWavyPatch();
+  const auto report = Mesh_quantizer::quantize(*quantized, Mesh_quantizer_options());
+
+  const auto vertexCount = g_gridSize * g_gridSize;
+  EXPECT_EQ(48u * vertexCount, report.bytesBefore);
+  EXPECT_EQ(20u * vertexCount, report.bytesAfter);
+
+  const auto& positionElement = quantized->vertexBufferAccessors.at({Vertex_attribute::Position, 0})->attributeElement;
+  EXPECT_EQ(Element_component::Unsigned_short, positionElement.component);
+  EXPECT_EQ(Element_encoding::Normalized, positionElement.encoding);
+  EXPECT_EQ(
+      Element_encoding::Octahedral_signed,
+      quantized->vertexBufferAccessors.at({Vertex_attribute::Tangent, 0})->attributeElement.encoding);
+
+  // Positions are within half a step of 16 bits across the 10 unit extent, and have a w of 1.
+  const auto positions = readElements(*original, Vertex_attribute::Position);
+  const auto quantizedPositions = readElements(*quantized, Vertex_attribute::Position);
+  for (size_t idx = 0; idx < positions.size(); ++idx) {
+    EXPECT_LE(SSE::length(quantizedPositions[idx].getXYZ() - positions[idx].getXYZ()), 2e-4f) << idx;
+    EXPECT_EQ(1.0f, quantizedPositions[idx].getW());
+  }
+
+  const auto normals = readElements(*original, Vertex_attribute::Normal);
+  const auto quantizedNormals = readElements(*quantized, Vertex_attribute::Normal);
+  const auto tangents = readElements(*original, Vertex_attribute::Tangent);
+  const auto quantizedTangents = readElements(*quantized, Vertex_attribute::Tangent);
+  for (size_t idx = 0; idx < normals.size(); ++idx) {
+    EXPECT_NEAR(1.0f, SSE::length(quantizedNormals[idx].getXYZ()), 1e-5f);
+    EXPECT_LE(angleBetween(normals[idx].getXYZ(), quantizedNormals[idx].getXYZ()), 1e-3f) << idx;
+    EXPECT_LE(angleBetween(tangents[idx].getXYZ(), quantizedTangents[idx].getXYZ()), 1e-3f) << idx;
+    EXPECT_EQ(tangents[idx].getW(), quantizedTangents[idx].getW()) << idx;
+  }
+
+  const auto texCoords = readElements(*original, Vertex_attribute::Tex_coord);
+  const auto quantizedTexCoords = readElements(*quantized, Vertex_attribute::Tex_coord);
+  for (size_t idx = 0; idx < texCoords.size(); ++idx) {
+    EXPECT_NEAR(texCoords[idx].getX(), quantizedTexCoords[idx].getX(), 5e-5f) << idx;
+    EXPECT_NEAR(texCoords[idx].getY(), quantizedTexCoords[idx].getY(), 5e-5f) << idx;
+  }
+}
+
+TEST(MeshQuantizerTest, stores_tex_coords_as_half_floats)
+{
+  const auto meshData = createWavyPatch();
+  const auto texCoords = readElements(*meshData, Vertex_attribute::Tex_coord);
+  Mesh_quantizer_options options;
+  options.quantizePositions = false;
+  options.quantizeNormals = false;
+  options.texCoords = Tex_coord_quantization::Half_float;
+  const auto report = Mesh_quantizer::quantize(*meshData, options);
+  EXPECT_EQ(4u * g_gridSize * g_gridSize, report.bytesAfter);
+
+  const auto& accessor = *meshData->vertexBufferAccessors.at({Vertex_attribute::Tex_coord, 0});
+  EXPECT_EQ(Element_component::Half_float, accessor.attributeElement.component);
+  EXPECT_EQ(Element_encoding::None, accessor.attributeElement.encoding);
+  EXPECT_EQ(Element_component::Float,
+            meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0})->attributeElement.component);
+
+  // Half floats have 11 bits of precision, so a relative error of 2^-11 at most.
+  const auto quantizedTexCoords = readElements(*meshData, Vertex_attribute::Tex_coord);
+  for (size_t idx = 0; idx < texCoords.size(); ++idx) {
+    EXPECT_NEAR(texCoords[idx].getX(), quantizedTexCoords[idx].getX(), std::abs(texCoords[idx].getX()) / 2048) << idx;
+    EXPECT_NEAR(texCoords[idx].getY(), quantizedTexCoords[idx].getY(), std::abs(texCoords[idx].getY()) / 2048) << idx;
+  }
+}
+
+TEST(MeshQuantizerTest, leaves_shared_buffers_and_encoded_attributes_alone)
+{
+  const auto meshData = createWavyPatch();
+  const auto originalBuffer = meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0})->buffer;
+  const std::vector<uint8_t> originalBytes(originalBuffer->data, originalBuffer->data + originalBuffer->dataSize);
+  Mesh_quantizer::quantize(*meshData, Mesh_quantizer_options());
+  EXPECT_NE(originalBuffer, meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0})->buffer);
+  EXPECT_EQ(originalBytes, std::vector<uint8_t>(originalBuffer->data, originalBuffer->data + originalBuffer->dataSize));
+
+  // Quantizing again changes nothing.
+  const auto quantizedBuffer = meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0})->buffer;
+  const auto report = Mesh_quantizer::quantize(*meshData, Mesh_quantizer_options());
+  EXPECT_EQ(0u, report.bytesBefore);
+  EXPECT_EQ(quantizedBuffer, meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0})->buffer);
+}
+
+TEST(MeshQuantizerTest, generates_normals_from_quantized_positions)
+{
+  const auto meshData = createWavyPatch();
+  const auto& indices = *meshData->indexBufferAccessor;
+  auto& floatNormals = *meshData->vertexBufferAccessors.at({Vertex_attribute::Normal, 0});
+  Primitive_mesh_data_factory::generateNormals(
+      indices, *meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0}), floatNormals);
+  const auto expected = readElements(*meshData, Vertex_attribute::Normal);
+
+  // Both the positions read and the normals written are quantized.
+  Mesh_quantizer::quantize(*meshData, Mesh_quantizer_options());
+  auto& quantizedNormals = *meshData->vertexBufferAccessors.at({Vertex_attribute::Normal, 0});
+  ASSERT_EQ(Element_encoding::Octahedral, quantizedNormals.attributeElement.encoding);
+  std::memset(quantizedNormals.buffer->data, 0, quantizedNormals.buffer->dataSize);
+  Primitive_mesh_data_factory::generateNormals(
+      indices, *meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0}), quantizedNormals);
+
+  const auto generated = readElements(*meshData, Vertex_attribute::Normal);
+  for (size_t idx = 0; idx < expected.size(); ++idx) {
+    EXPECT_LE(angleBetween(expected[idx].getXYZ(), generated[idx].getXYZ()), 2e-3f) << idx;
+  }
+}
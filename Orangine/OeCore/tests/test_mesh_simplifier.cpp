@@ -0,0 +1,154 @@
+#include "Job_manager.h"
+#include "mesh_test_utils.h"
+
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Mesh_data_component.h>
+#include <OeCore/Mesh_simplifier.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+
+using oe::Element_component;
+using oe::Mesh_data;
+using oe::Mesh_simplifier;
+using oe::Mesh_simplifier_options;
+using oe::Vertex_attribute;
+using oe::internal::Job_manager;
+namespace mesh_test_utils = oe::mesh_test_utils;
+
+namespace {
+constexpr uint32_t g_gridSize = 33;
+
+float area(const std::vector<uint32_t>& indices, const std::vector<SSE::Vector3>& positions)
+{
+  auto area = 0.0f;
+  for (size_t idx = 0; idx < indices.size(); idx += 3) {
+    const auto& p0 = positions[indices[idx]];
+    area += SSE::length(SSE::cross(positions[indices[idx + 1]] - p0, positions[indices[idx + 2]] - p0)) * 0.5f;
+  }
+  return area;
+}
+
+// A hill with 16 bit indices, and a morph target that flattens it.
+std::shared_ptr<Mesh_data> createHillMeshData()
+{
+  std::vector<SSE::Vector3> positions;
+  std::vector<uint32_t> indices;
+  mesh_test_utils::create_grid(g_gridSize, mesh_test_utils::hill, positions, indices);
+  auto meshData = mesh_test_utils::create_mesh_data<uint16_t>(positions, indices);
+
+  std::vector<SSE::Vector3> flattenDeltas;
+  for (const auto& position : positions) {
+    flattenDeltas.emplace_back(0.0f, -position.getY(), 0.0f);
+  }
+  mesh_test_utils::add_morph_target(*meshData, flattenDeltas);
+  return meshData;
+}
+} // namespace
+
+TEST(MeshSimplifierTest, simplifies_a_plane_without_moving_its_border)
+{
+  std::vector<SSE::Vector3> positions;
+  std::vector<uint32_t> indices;
+  mesh_test_utils::create_grid(g_gridSize, mesh_test_utils::flat, positions, indices);
+
+  auto error = 1.0f;
+  const auto simplified = Mesh_simplifier::simplify(indices, positions, {}, 0, 1e-3f, &error);
+  EXPECT_LT(simplified.size(), indices.size() / 20);
+  EXPECT_NEAR(0.0f, error, 1e-5f);
+
+  // Borders only slide along themselves, so the square still covers exactly the same area, corners included.
+  EXPECT_NEAR(1.0f, area(simplified, positions), 1e-4f);
+  const std::set<uint32_t> used(simplified.begin(), simplified.end());
+  for (const auto corner : {0u, g_gridSize - 1, g_gridSize * (g_gridSize - 1), g_gridSize * g_gridSize - 1}) {
+    EXPECT_EQ(1u, used.count(corner)) << "corner " << corner;
+  }
+}
+
+TEST(MeshSimplifierTest, keeps_seams_closed)
+{
+  constexpr uint32_t seamColumn = g_gridSize / 2;
+  std::vector<SSE::Vector3> positions;
+  std::vector<uint32_t> indices;
+  mesh_test_utils::create_grid(g_gridSize, mesh_test_utils::flat, positions, indices, seamColumn);
+
+  const auto simplified = Mesh_simplifier::simplify(indices, positions, {}, 0, 1e-3f);
+  EXPECT_LT(simplified.size(), indices.size() / 10);
+  EXPECT_NEAR(1.0f, area(simplified, positions), 1e-4f);
+
+  // Both sides of the seam keep every one of its vertices, so they still meet along it without cracks.
+  const std::set<uint32_t> used(simplified.begin(), simplified.end());
+  for (uint32_t z = 0; z < g_gridSize; ++z) {
+    EXPECT_EQ(1u, used.count(z * g_gridSize + seamColumn)) << "left of seam " << z;
+    EXPECT_EQ(1u, used.count(g_gridSize * g_gridSize + z)) << "right of seam " << z;
+  }
+}
+
+TEST(MeshSimplifierTest, preserves_the_shape_of_morph_targets)
+{
+  // A flat square, with a morph target that raises it into a hill.
+  std::vector<SSE::Vector3> positions, raised;
+  std::vector<uint32_t> indices, raisedIndices;
+  mesh_test_utils::create_grid(g_gridSize, mesh_test_utils::flat, positions, indices);
+  mesh_test_utils::create_grid(g_gridSize, mesh_test_utils::hill, raised, raisedIndices);
+
+  const auto withoutMorph = Mesh_simplifier::simplify(indices, positions, {}, 0, 1e-3f);
+  auto error = 0.0f;
+  const auto withMorph = Mesh_simplifier::simplify(indices, positions, {raised}, 0, 1e-3f, &error);
+  EXPECT_GT(withMorph.size(), withoutMorph.size() * 4);
+  EXPECT_LE(error, 1e-3f);
+}
+
+TEST(MeshSimplifierTest, generates_lods_that_share_vertex_buffers)
+{
+  const auto meshData = createHillMeshData();
+  Mesh_simplifier_options options;
+  options.lodCount = 3;
+  const auto lods = Mesh_simplifier::generateLods(*meshData, options);
+  ASSERT_EQ(3u, lods.size());
+
+  const auto& positions = *meshData->vertexBufferAccessors.at({Vertex_attribute::Position, 0});
+  auto previousIndexCount = meshData->indexBufferAccessor->count;
+  auto previousError = 0.0f;
+  for (const auto& lod : lods) {
+    const auto& lodMeshData = *lod.meshData;
+    EXPECT_EQ(Element_component::Unsigned_short, lodMeshData.indexBufferAccessor->component);
+    EXPECT_LT(lodMeshData.indexBufferAccessor->count, previousIndexCount);
+    EXPECT_LE(previousError, lod.error);
+    EXPECT_LE(lod.error, options.maxError);
+    previousIndexCount = lodMeshData.indexBufferAccessor->count;
+    previousError = lod.error;
+
+    EXPECT_EQ(positions.buffer, lodMeshData.vertexBufferAccessors.at({Vertex_attribute::Position, 0})->buffer);
+    ASSERT_EQ(1u, lodMeshData.attributeMorphBufferAccessors.size());
+    EXPECT_EQ(
+        meshData->attributeMorphBufferAccessors[0][0]->buffer, lodMeshData.attributeMorphBufferAccessors[0][0]->buffer);
+  }
+}
+
+TEST(MeshSimplifierTest, parallel_generation_matches_serial)
+{
+  const std::vector<std::shared_ptr<Mesh_data>> meshes = {
+      createHillMeshData(), createHillMeshData(), createHillMeshData(), createHillMeshData()};
+  const Mesh_simplifier_options options;
+
+  Job_manager jobManager;
+  jobManager.preInit_setWorkerCount(4);
+  jobManager.initialize();
+  const auto parallelLods = Mesh_simplifier::generateLods(meshes, options, jobManager);
+  jobManager.shutdown();
+
+  ASSERT_EQ(meshes.size(), parallelLods.size());
+  for (size_t mesh = 0; mesh < meshes.size(); ++mesh) {
+    const auto serialLods = Mesh_simplifier::generateLods(*meshes[mesh], options);
+    ASSERT_EQ(serialLods.size(), parallelLods[mesh].size());
+    for (size_t lod = 0; lod < serialLods.size(); ++lod) {
+      EXPECT_EQ(serialLods[lod].error, parallelLods[mesh][lod].error);
+      EXPECT_EQ(
+          mesh_test_utils::read_indices(*serialLods[lod].meshData->indexBufferAccessor),
+          mesh_test_utils::read_indices(*parallelLods[mesh][lod].meshData->indexBufferAccessor));
+    }
+  }
+}
@@ -0,0 +1,127 @@
+#include "Job_manager.h"
+#include "mesh_test_utils.h"
+
+#include <OeCore/Mesh_data.h>
+#include <OeCore/Primitive_mesh_data_factory.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using oe::Element_component;
+using oe::Element_type;
+using oe::Mesh_buffer;
+using oe::Mesh_vertex_buffer_accessor;
+using oe::Primitive_mesh_data_factory;
+using oe::Vertex_attribute;
+using oe::Vertex_attribute_element;
+using oe::internal::Job_manager;
+namespace mesh_test_utils = oe::mesh_test_utils;
+
+namespace {
+// Normals are written with a stride of 4 floats, to check that generation leaves the padding alone.
+constexpr float g_padding = 42.0f;
+std::unique_ptr<Mesh_vertex_buffer_accessor> createNormalAccessor(uint32_t vertexCount)
+{
+  auto buffer = std::make_shared<Mesh_buffer>(vertexCount * sizeof(float) * 4);
+  const std::vector<float> padded(vertexCount * 4, g_padding);
+  std::memcpy(buffer->data, padded.data(), buffer->dataSize);
+  return std::make_unique<Mesh_vertex_buffer_accessor>(
+      buffer,
+      Vertex_attribute_element{{Vertex_attribute::Normal, 0}, Element_type::Vector3, Element_component::Float},
+      vertexCount,
+      static_cast<uint32_t>(sizeof(float) * 4),
+      0);
+}
+
+std::array<float, 4> readNormal(const Mesh_vertex_buffer_accessor& accessor, size_t idx)
+{
+  std::array<float, 4> value;
+  std::memcpy(value.data(), accessor.getIndexed(idx), sizeof(value));
+  return value;
+}
+
+void expectNormal(const Mesh_vertex_buffer_accessor& accessor, size_t idx, const SSE::Vector3& expected)
+{
+  const auto actual = readNormal(accessor, idx);
+  EXPECT_NEAR(expected.getX(), actual[0], 1e-5f) << "vertex " << idx;
+  EXPECT_NEAR(expected.getY(), actual[1], 1e-5f) << "vertex " << idx;
+  EXPECT_NEAR(expected.getZ(), actual[2], 1e-5f) << "vertex " << idx;
+  EXPECT_EQ(g_padding, actual[3]) << "vertex " << idx;
+}
+
+/*
+ * Two right angled triangles that share the edge from vertex 0 to 1, folded 90 degrees along it. Triangle (0, 1, 2)
+ * lies in the XY plane with an area of 0.5, facing +Z; triangle (1, 0, 3) lies in the XZ plane with an area of 1,
+ * facing -Y. Vertex 4 isn't used.
+ */
+const std::vector<SSE::Vector3> g_hingePositions = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, -2}, {5, 5, 5}};
+
+template <class TIndex> void testHinge()
+{
+  const auto indexAccessor = mesh_test_utils::create_index_accessor<TIndex>({0, 1, 2, 1, 0, 3});
+  const auto positionAccessor = mesh_test_utils::create_float3_accessor(g_hingePositions);
+  const auto normalAccessor = createNormalAccessor(positionAccessor->count);
+  Primitive_mesh_data_factory::generateNormals(*indexAccessor, *positionAccessor, *normalAccessor);
+
+  // Reference normals: the sum of face normal * face area * interior angle at the vertex.
+  const auto pi = 3.14159265f;
+  const SSE::Vector3 faceA = {0.0f, 0.0f, 1.0f}, faceB = {0.0f, -1.0f, 0.0f};
+  const auto areaA = 0.5f, areaB = 1.0f;
+  // Both triangles have a right angle at vertex 0. At vertex 1, triangle A has 45 degrees, and triangle B has
+  // atan(2) between its legs of length 1 and 2.
+  expectNormal(*normalAccessor, 0, SSE::normalize(faceA * areaA * (pi / 2) + faceB * areaB * (pi / 2)));
+  expectNormal(*normalAccessor, 1, SSE::normalize(faceA * areaA * (pi / 4) + faceB * areaB * std::atan(2.0f)));
+  expectNormal(*normalAccessor, 2, faceA);
+  expectNormal(*normalAccessor, 3, faceB);
+  expectNormal(*normalAccessor, 4, {0.0f, 1.0f, 0.0f});
+}
+
+// Height of a rippled grid.
+float ripple(float u, float v) { return 0.05f * std::sin(u * 40.0f) * std::cos(v * 30.0f); }
+} // namespace
+
+TEST(PrimitiveMeshDataFactoryTest, generates_weighted_normals_for_16_bit_indices) { testHinge<uint16_t>(); }
+
+TEST(PrimitiveMeshDataFactoryTest, generates_weighted_normals_for_32_bit_indices) { testHinge<uint32_t>(); }
+
+TEST(PrimitiveMeshDataFactoryTest, rejects_out_of_range_indices)
+{
+  const auto indexAccessor = mesh_test_utils::create_index_accessor<uint32_t>({0, 1, 5});
+  const auto positionAccessor = mesh_test_utils::create_float3_accessor(g_hingePositions);
+  const auto normalAccessor = createNormalAccessor(positionAccessor->count);
+  EXPECT_THROW(
+      Primitive_mesh_data_factory::generateNormals(*indexAccessor, *positionAccessor, *normalAccessor),
+      std::logic_error);
+}
+
+TEST(PrimitiveMeshDataFactoryTest, parallel_generation_matches_serial)
+{
+  std::vector<SSE::Vector3> positions;
+  std::vector<uint32_t> indices;
+  mesh_test_utils::create_grid(300, ripple, positions, indices);
+  const auto indexAccessor = mesh_test_utils::create_index_accessor(indices);
+  const auto positionAccessor = mesh_test_utils::create_float3_accessor(positions);
+
+  const auto serialNormals = createNormalAccessor(positionAccessor->count);
+  Primitive_mesh_data_factory::generateNormals(*indexAccessor, *positionAccessor, *serialNormals);
+
+  Job_manager jobManager;
+  jobManager.preInit_setWorkerCount(4);
+  jobManager.initialize();
+  const auto parallelNormals = createNormalAccessor(positionAccessor->count);
+  Primitive_mesh_data_factory::generateNormals(*indexAccessor, *positionAccessor, *parallelNormals, &jobManager);
+  jobManager.shutdown();
+
+  // Each vertex sums its corners in the same order however the work is split, so the results are bit identical.
+  ASSERT_EQ(serialNormals->buffer->dataSize, parallelNormals->buffer->dataSize);
+  EXPECT_EQ(0, std::memcmp(serialNormals->buffer->data, parallelNormals->buffer->data, serialNormals->buffer->dataSize));
+
+  for (uint32_t idx = 0; idx < positionAccessor->count; ++idx) {
+    const auto normal = readNormal(*parallelNormals, idx);
+    ASSERT_NEAR(1.0f, std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]), 1e-5f);
+    ASSERT_GT(normal[1], 0.0f);
+  }
+}
@@ -0,0 +1,434 @@
+#include "Entity_repository.h"
+#include "Job_manager.h"
+#include "Scene_graph_manager.h"
+
+#include <OeCore/IConfigReader.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+using oe::BoundingSphere;
+using oe::Entity;
+using oe::Entity_repository;
+using oe::IConfigReader;
+using oe::internal::Job_manager;
+using oe::internal::Scene_graph_manager;
+
+namespace {
+// Answers the scene graph's only config setting; it has no other config to read.
+class Flat_transforms_config_reader : public IConfigReader {
+ public:
+  explicit Flat_transforms_config_reader(bool flatTransforms)
+      : _flatTransforms(flatTransforms)
+  {}
+
+  void setDefault(const std::string&, const std::string&) const override {}
+  void setDefault(const std::string&, int64_t) const override {}
+  void setDefault(const std::string&, double) const override {}
+  void setDefault(const std::string&, bool) const override {}
+
+  void setDefault(const std::string&, const std::vector<std::string>&) const override {}
+  void setDefault(const std::string&, const std::vector<int64_t>&) const override {}
+  void setDefault(const std::string&, const std::vector<double>&) const override {}
+  void setDefault(const std::string&, const std::vector<bool>&) const override {}
+
+  std::string readString(const std::string& configPath) const override { throw unknown(configPath); }
+  int64_t readInt(const std::string& configPath) const override { throw unknown(configPath); }
+  double readDouble(const std::string& configPath) const override { throw unknown(configPath); }
+  bool readBool(const std::string& configPath) const override
+  {
+    if (configPath != "OeCore.scenegraph_flat_transforms") {
+      throw unknown(configPath);
+    }
+    return _flatTransforms;
+  }
+
+  std::vector<std::string> readStringList(const std::string& configPath) const override { throw unknown(configPath); }
+  std::vector<int64_t> readIntList(const std::string& configPath) const override { throw unknown(configPath); }
+  std::vector<double> readDoubleList(const std::string& configPath) const override { throw unknown(configPath); }
+  std::vector<bool> readBoolList(const std::string& configPath) const override { throw unknown(configPath); }
+
+  std::unordered_map<std::string, std::string> readStringDict(const std::string& configPath) const override
+  {
+    throw unknown(configPath);
+  }
+  std::unordered_map<std::string, int64_t> readIntDict(const std::string& configPath) const override
+  {
+    throw unknown(configPath);
+  }
+  std::unordered_map<std::string, double> readDoubleDict(const std::string& configPath) const override
+  {
+    throw unknown(configPath);
+  }
+  std::unordered_map<std::string, bool> readBoolDict(const std::string& configPath) const override
+  {
+    throw unknown(configPath);
+  }
+
+  size_t getListSize(const std::string& configPath) const override { throw unknown(configPath); }
+  std::string getListElementPath(const std::string& configPath, size_t) const override { throw unknown(configPath); }
+  std::vector<std::string> getDictKeys(const std::string& configPath) const override { throw unknown(configPath); }
+
+ private:
+  static std::logic_error unknown(const std::string& configPath)
+  {
+    return std::logic_error("Unexpected config read: " + configPath);
+  }
+
+  bool _flatTransforms;
+};
+
+// A scene graph, along with every entity in it in creation order.
+class Scene_fixture {
+ public:
+  explicit Scene_fixture(uint32_t workerCount, bool flatTransforms = false)
+      : _entityRepository(std::make_shared<Entity_repository>())
+  {
+    _jobManager.preInit_setWorkerCount(workerCount);
+    _jobManager.initialize();
+
+    _sceneGraphManager = std::make_unique<Scene_graph_manager>(_entityRepository, _jobManager);
+    _sceneGraphManager->loadConfig(Flat_transforms_config_reader(flatTransforms));
+    _sceneGraphManager->initialize();
+  }
+
+  ~Scene_fixture()
+  {
+    _sceneGraphManager->shutdown();
+    _sceneGraphManager.reset();
+    _jobManager.shutdown();
+  }
+
+  // Creates the same hierarchy for a given seed: many small subtrees, and one root with enough children to be updated
+  // in parallel.
+  void createHierarchy(uint32_t seed)
+  {
+    std::mt19937 random(seed);
+
+    for (auto rootIdx = 0; rootIdx < 64; ++rootIdx) {
+      auto& root = createEntity(nullptr, random);
+      for (auto childIdx = 0; childIdx < 4; ++childIdx) {
+        auto& child = createEntity(&root, random);
+        for (auto grandChildIdx = 0; grandChildIdx < 3; ++grandChildIdx) {
+          createEntity(&child, random);
+        }
+      }
+    }
+
+    auto& wideRoot = createEntity(nullptr, random);
+    for (auto childIdx = 0; childIdx < 1000; ++childIdx) {
+      auto& child = createEntity(&wideRoot, random);
+      createEntity(&child, random);
+    }
+  }
+
+  // Moves every nth entity, using the given seed to generate new positions.
+  void moveEntities(uint32_t seed, size_t stride)
+  {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    for (size_t entityIdx = 0; entityIdx < _entities.size(); entityIdx += stride) {
+      _entities[entityIdx]->setPosition({distribution(random), distribution(random), distribution(random)});
+    }
+  }
+
+  void reparentEntity(size_t entityIdx, size_t newParentIdx)
+  {
+    _entities[entityIdx]->setParent(*_entities[newParentIdx]);
+  }
+
+  // Destroys the entity. Its descendants are no longer in the scene either, so they are forgotten along with it.
+  void destroyEntity(size_t entityIdx)
+  {
+    const auto entity = _entities[entityIdx];
+    std::set<const Entity*> subtree;
+    std::vector<const Entity*> toVisit = {entity.get()};
+    while (!toVisit.empty()) {
+      const auto visiting = toVisit.back();
+      toVisit.pop_back();
+      subtree.insert(visiting);
+      for (const auto& child : visiting->children()) {
+        toVisit.push_back(child.get());
+      }
+    }
+
+    _sceneGraphManager->destroy(entity->getId());
+    _entities.erase(
+        std::remove_if(
+            _entities.begin(),
+            _entities.end(),
+            [&subtree](const std::shared_ptr<Entity>& candidate) { return subtree.count(candidate.get()) > 0; }),
+        _entities.end());
+  }
+
+  void tick() { _sceneGraphManager->tick(); }
+
+  Scene_graph_manager& sceneGraphManager() { return *_sceneGraphManager; }
+  Job_manager& jobManager() { return _jobManager; }
+
+  const std::vector<std::shared_ptr<Entity>>& entities() const { return _entities; }
+
+ private:
+  Entity& createEntity(Entity* parent, std::mt19937& random)
+  {
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> scaleDistribution(0.5f, 2.0f);
+
+    auto entity = parent ? _sceneGraphManager->instantiate("Entity", *parent) : _sceneGraphManager->instantiate("Entity");
+    entity->setPosition({distribution(random), distribution(random), distribution(random)});
+    entity->setRotation(SSE::Quat::rotationY(distribution(random)) * SSE::Quat::rotationX(distribution(random)));
+    entity->setScale(scaleDistribution(random));
+    entity->setBoundSphere(BoundingSphere(
+        {distribution(random), distribution(random), distribution(random)}, scaleDistribution(random)));
+    entity->setCalculateBoundSphereFromChildren(true);
+
+    _entities.push_back(entity);
+    return *entity;
+  }
+
+  std::shared_ptr<Entity_repository> _entityRepository;
+  Job_manager _jobManager;
+  std::unique_ptr<Scene_graph_manager> _sceneGraphManager;
+  std::vector<std::shared_ptr<Entity>> _entities;
+};
+
+// Creates an entity named after the file, with a child.
+class Fake_entity_graph_loader : public oe::Entity_graph_loader {
+ public:
+  void getSupportedFileExtensions(std::vector<std::string>& extensions) const override
+  {
+    extensions.emplace_back("fake");
+  }
+
+  std::vector<std::shared_ptr<Entity>> loadFile(
+      std::string_view filename,
+      oe::IScene_graph_manager& sceneGraphManager,
+      oe::IEntity_repository& entityRepository,
+      oe::IComponent_factory& componentFactory,
+      bool) const override
+  {
+    auto root = entityRepository.instantiate(filename, sceneGraphManager, componentFactory);
+    auto child = entityRepository.instantiate("Child", sceneGraphManager, componentFactory);
+    child->setParent(*root);
+    return {root};
+  }
+};
+
+// Prepares files with slow jobs, as the glTF loader does with its meshes, and records the threads that ran them.
+class Job_entity_graph_loader : public Fake_entity_graph_loader {
+ public:
+  explicit Job_entity_graph_loader(Job_manager& jobManager)
+      : _jobManager(jobManager)
+  {}
+
+  std::unique_ptr<Prepared_file> prepareFile(std::string_view filename, bool calculateBounds) const override
+  {
+    _jobManager.parallelFor(64, 1, [this](size_t, size_t) {
+      {
+        std::lock_guard<std::mutex> lock(_jobThreadIdsMutex);
+        _jobThreadIds.insert(std::this_thread::get_id());
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+    return Fake_entity_graph_loader::prepareFile(filename, calculateBounds);
+  }
+
+  std::set<std::thread::id> jobThreadIds() const
+  {
+    std::lock_guard<std::mutex> lock(_jobThreadIdsMutex);
+    return _jobThreadIds;
+  }
+
+ private:
+  Job_manager& _jobManager;
+  mutable std::mutex _jobThreadIdsMutex;
+  mutable std::set<std::thread::id> _jobThreadIds;
+};
+
+void expectBitIdentical(const Scene_fixture& expected, const Scene_fixture& actual)
+{
+  ASSERT_EQ(expected.entities().size(), actual.entities().size());
+  for (size_t entityIdx = 0; entityIdx < expected.entities().size(); ++entityIdx) {
+    const auto& expectedEntity = *expected.entities()[entityIdx];
+    const auto& actualEntity = *actual.entities()[entityIdx];
+
+    EXPECT_EQ(
+        0, std::memcmp(&expectedEntity.worldTransform(), &actualEntity.worldTransform(), sizeof(SSE::Matrix4)))
+        << "World transform differs for entity " << entityIdx;
+    EXPECT_EQ(0, std::memcmp(&expectedEntity.boundSphere().center, &actualEntity.boundSphere().center, sizeof(float) * 3))
+        << "Bound sphere center differs for entity " << entityIdx;
+    EXPECT_EQ(0, std::memcmp(&expectedEntity.boundSphere().radius, &actualEntity.boundSphere().radius, sizeof(float)))
+        << "Bound sphere radius differs for entity " << entityIdx;
+  }
+}
+} // namespace
+
+TEST(SceneGraphManagerTest, parallel_update_is_bit_identical_to_serial)
+{
+  Scene_fixture serial(1);
+  Scene_fixture parallel(8);
+
+  serial.createHierarchy(1234);
+  parallel.createHierarchy(1234);
+
+  serial.tick();
+  parallel.tick();
+  expectBitIdentical(serial, parallel);
+
+  // Only dirty subtrees are updated on subsequent ticks.
+  serial.moveEntities(5678, 7);
+  parallel.moveEntities(5678, 7);
+
+  serial.tick();
+  parallel.tick();
+  expectBitIdentical(serial, parallel);
+}
+
+TEST(SceneGraphManagerTest, flat_transforms_match_recursive_update)
+{
+  Scene_fixture recursive(1);
+  Scene_fixture flat(1, true);
+
+  recursive.createHierarchy(1234);
+  flat.createHierarchy(1234);
+
+  recursive.tick();
+  flat.tick();
+  expectBitIdentical(recursive, flat);
+
+  recursive.moveEntities(5678, 7);
+  flat.moveEntities(5678, 7);
+
+  recursive.tick();
+  flat.tick();
+  expectBitIdentical(recursive, flat);
+
+  // Entity 1 is the first child of the first root, and has children of its own; entity 17 is the second root.
+  recursive.reparentEntity(1, 17);
+  flat.reparentEntity(1, 17);
+
+  recursive.tick();
+  flat.tick();
+  expectBitIdentical(recursive, flat);
+
+  // Entity 5 is the second child of the first root, with children of its own.
+  recursive.destroyEntity(5);
+  flat.destroyEntity(5);
+  recursive.moveEntities(9012, 5);
+  flat.moveEntities(9012, 5);
+
+  recursive.tick();
+  flat.tick();
+  expectBitIdentical(recursive, flat);
+}
+
+TEST(SceneGraphManagerTest, only_dirty_subtrees_are_recomputed)
+{
+  for (const auto flatTransforms : {false, true}) {
+    SCOPED_TRACE(flatTransforms ? "Flat transforms" : "Recursive update");
+    Scene_fixture scene(1, flatTransforms);
+    auto& sceneGraphManager = scene.sceneGraphManager();
+
+    // A root with two parents, each with three leaves.
+    auto root = sceneGraphManager.instantiate("Root");
+    std::vector<std::shared_ptr<Entity>> parents;
+    std::vector<std::shared_ptr<Entity>> leaves;
+    for (auto parentIdx = 0; parentIdx < 2; ++parentIdx) {
+      parents.push_back(sceneGraphManager.instantiate("Parent", *root));
+      for (auto leafIdx = 0; leafIdx < 3; ++leafIdx) {
+        leaves.push_back(sceneGraphManager.instantiate("Leaf", *parents.back()));
+      }
+    }
+
+    scene.tick();
+    EXPECT_EQ(9u, sceneGraphManager.getRecomputedTransformCount());
+
+    scene.tick();
+    EXPECT_EQ(0u, sceneGraphManager.getRecomputedTransformCount());
+
+    leaves[4]->setPosition({1.0f, 2.0f, 3.0f});
+    scene.tick();
+    EXPECT_EQ(1u, sceneGraphManager.getRecomputedTransformCount());
+
+    parents[0]->setPosition({1.0f, 2.0f, 3.0f});
+    scene.tick();
+    EXPECT_EQ(4u, sceneGraphManager.getRecomputedTransformCount());
+
+    root->setPosition({1.0f, 2.0f, 3.0f});
+    scene.tick();
+    EXPECT_EQ(9u, sceneGraphManager.getRecomputedTransformCount());
+
+    scene.tick();
+    EXPECT_EQ(0u, sceneGraphManager.getRecomputedTransformCount());
+  }
+}
+
+TEST(SceneGraphManagerTest, async_load_publishes_entities_on_tick)
+{
+  Scene_fixture scene(1);
+  auto& sceneGraphManager = scene.sceneGraphManager();
+  sceneGraphManager.addLoader(std::make_unique<Fake_entity_graph_loader>());
+
+  auto parent = sceneGraphManager.instantiate("Parent");
+  auto loadedEntities = sceneGraphManager.loadFileAsync("scene.fake", parent.get());
+  auto destroyedParent = sceneGraphManager.instantiate("Destroyed parent");
+  auto orphanedEntities = sceneGraphManager.loadFileAsync("orphan.fake", destroyedParent.get());
+  sceneGraphManager.destroy(destroyedParent->getId());
+  EXPECT_THROW(sceneGraphManager.loadFileAsync("scene.unknown"), std::runtime_error);
+
+  // Nothing is published until the main thread ticks.
+  ASSERT_TRUE(parent->children().empty());
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (loadedEntities.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+         std::chrono::steady_clock::now() < deadline) {
+    scene.tick();
+  }
+
+  const auto entities = loadedEntities.get();
+  ASSERT_EQ(1u, entities.size());
+  EXPECT_EQ("scene.fake", entities[0]->getName());
+  EXPECT_EQ(parent.get(), entities[0]->parent().get());
+  EXPECT_EQ(oe::Entity_state::Ready, entities[0]->getState());
+  ASSERT_EQ(1u, entities[0]->children().size());
+  EXPECT_EQ(oe::Entity_state::Ready, entities[0]->children()[0]->getState());
+
+  // The other parent was destroyed while its file was loading, so that load fails.
+  while (orphanedEntities.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+         std::chrono::steady_clock::now() < deadline) {
+    scene.tick();
+  }
+  EXPECT_THROW(orphanedEntities.get(), std::runtime_error);
+}
+
+TEST(SceneGraphManagerTest, tick_does_not_run_loader_jobs_inline)
+{
+  Scene_fixture scene(4);
+  scene.createHierarchy(1234);
+  auto loader = std::make_unique<Job_entity_graph_loader>(scene.jobManager());
+  const auto& jobLoader = *loader;
+  scene.sceneGraphManager().addLoader(std::move(loader));
+
+  // Each tick updates the hierarchy in parallel, waiting on its own jobs while the file is being prepared. Loader jobs
+  // must be left to the workers, rather than stalling the frame.
+  auto loadedEntities = scene.sceneGraphManager().loadFileAsync("scene.fake");
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  uint32_t seed = 0;
+  while (loadedEntities.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+         std::chrono::steady_clock::now() < deadline) {
+    scene.moveEntities(++seed, 1);
+    scene.tick();
+  }
+
+  ASSERT_EQ(1u, loadedEntities.get().size());
+  const auto jobThreadIds = jobLoader.jobThreadIds();
+  EXPECT_FALSE(jobThreadIds.empty());
+  EXPECT_EQ(0u, jobThreadIds.count(std::this_thread::get_id()));
+}